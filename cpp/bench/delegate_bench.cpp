@@ -0,0 +1,104 @@
+// ============================================================================
+/// @file  delegate_bench.cpp
+/// @brief Cost of a call through the different kinds of delegates
+///
+/// Callables measured:
+///   fastdelegate_member   fastdelegate::FastDelegate to a member function
+///   delegate_member       Delegate to a member function
+///   delegate_lambda       Delegate holding a capturing lambda
+///   std_function_member   std::function holding a std::bind to a member function
+///   std_function_lambda   std::function holding a capturing lambda
+///
+/// Output is one line per callable:
+///   callable=delegate_member calls=100000000 ns_per_call=...
+///
+/// Usage:
+///   $ make delegate_bench
+///   $ ./delegate_bench [-n calls]
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <functional>
+#include <stdint.h>
+#include <stdlib.h> // strtoull
+#include <unistd.h> // getopt
+#include "delegate/Delegate.h"
+
+#define BENCH_DEFAULT_CALLS 100000000
+
+class Counter
+{
+public:
+    Counter(): m_count(0) {}
+
+    // not inlined so every callable pays for the same function call
+    __attribute__((noinline)) void Add(uint64_t a_value)
+    {
+        m_count += a_value;
+    }
+
+    uint64_t m_count;
+};
+
+/// @brief calls a_callable a_calls times. Not inlined so the call can't be 
+///        devirtualised from the construction of the callable
+template <typename CALLABLE_T>
+__attribute__((noinline)) static void CallMany(const CALLABLE_T &a_callable, uint64_t a_calls)
+{
+    for (uint64_t i = 0; i < a_calls; i++)
+    {
+        a_callable(i);
+    }
+}
+
+template <typename CALLABLE_T>
+static void Bench(const char* a_name, const CALLABLE_T &a_callable, uint64_t a_calls)
+{
+    auto start = std::chrono::steady_clock::now();
+    CallMany(a_callable, a_calls);
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "callable=" << a_name
+              << " calls=" << a_calls
+              << " ns_per_call=" << (static_cast<double>(ns) / a_calls)
+              << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t calls = BENCH_DEFAULT_CALLS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': calls = strtoull(optarg, 0, 10); break;
+        default:
+            std::cerr << "Usage: " << argv[0] << " [-n calls]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "# bench=delegate compiler=\"" << __VERSION__ << "\"" << std::endl;
+
+    Counter counter;
+    Bench("fastdelegate_member", 
+          fastdelegate::MakeDelegate(&counter, &Counter::Add), calls);
+    Bench("delegate_member", 
+          MakeDelegate(&counter, &Counter::Add), calls);
+    Bench("delegate_lambda", 
+          Delegate<void(uint64_t)>([&counter](uint64_t a_value) { counter.Add(a_value); }), 
+          calls);
+    Bench("std_function_member", 
+          std::function<void(uint64_t)>(std::bind(&Counter::Add, &counter, std::placeholders::_1)), 
+          calls);
+    Bench("std_function_lambda", 
+          std::function<void(uint64_t)>([&counter](uint64_t a_value) { counter.Add(a_value); }), 
+          calls);
+
+    // so the compiler can't throw the calls away
+    return (counter.m_count == 0) ? 1 : 0;
+}
@@ -0,0 +1,228 @@
+// ============================================================================
+/// @file  lock_free_q_layout_bench.cpp
+/// @brief Throughput of the circular array based lock free queues with and
+///        without the cache line padding layout
+///
+/// This file is built twice by the Makefile in this directory, once with the
+/// default (packed) layout and once with _WITH_LOCK_FREE_Q_CACHE_LINE_PADDING
+/// defined, so the same benchmark can be run against both layouts:
+///   $ make layout
+///   $ ./lock_free_q_layout_bench_packed
+///   $ ./lock_free_q_layout_bench_padded
+///
+/// Each line printed is a set of key=value pairs:
+///   layout=padded line=64 policy=multiple_producers producers=2 consumers=2 items=10000000 best_ops_per_sec=...
+///
+/// Usage:
+///   $ ./lock_free_q_layout_bench_padded [items_per_run] [runs] [nopin]
+// ============================================================================
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <stdlib.h>  // atoi, strtoul
+#include <string.h>  // strcmp
+#include <pthread.h> // pthread_setaffinity_np
+#include <sched.h>   // sched_yield, CPU_SET
+#include "lock_free_queue.h"
+
+#define BENCH_QUEUE_SIZE      1024
+#define BENCH_DEFAULT_ITEMS   10000000
+#define BENCH_DEFAULT_RUNS    5
+// number of failed push/pop attempts before yielding the processor. It lets
+// the benchmark make progress on machines with less cores than threads
+#define BENCH_SPINS_BEFORE_YIELD 1024
+
+#ifdef _WITH_LOCK_FREE_Q_CACHE_LINE_PADDING
+static const char* LAYOUT_NAME = "padded";
+#else
+static const char* LAYOUT_NAME = "packed";
+#endif
+
+static bool g_pinThreads = true;
+
+/// @brief pin the calling thread to a_cpu (modulo the number of cpus)
+static void PinCurrentThread(unsigned a_cpu)
+{
+    if (!g_pinThreads)
+    {
+        return;
+    }
+
+    unsigned nCpus = std::max(1u, std::thread::hardware_concurrency());
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(a_cpu % nCpus, &cpuSet);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+}
+
+template <typename QUEUE_T>
+class LayoutBench
+{
+public:
+    LayoutBench(unsigned a_producers, unsigned a_consumers, uint64_t a_items):
+        m_queue(new QUEUE_T()),
+        m_nProducers(a_producers),
+        m_nConsumers(a_consumers),
+        m_itemsPerProducer(a_items / a_producers),
+        m_startFlag(false),
+        m_consumed(0)
+    {}
+
+    /// @brief run the benchmark once
+    /// @return number of elements pushed and popped per second
+    double run()
+    {
+        std::vector<std::thread> threads;
+        unsigned cpu = 0;
+
+        m_startFlag.store(false);
+        m_consumed.store(0);
+
+        for (unsigned i = 0; i < m_nConsumers; i++)
+        {
+            threads.push_back(std::thread(&LayoutBench::runConsumer, this, cpu++));
+        }
+        for (unsigned i = 0; i < m_nProducers; i++)
+        {
+            threads.push_back(std::thread(&LayoutBench::runProducer, this, cpu++));
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        m_startFlag.store(true);
+
+        for (std::size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i].join();
+        }
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - startTime;
+
+        return (m_itemsPerProducer * m_nProducers) / elapsed.count();
+    }
+
+private:
+    std::unique_ptr<QUEUE_T> m_queue;
+    unsigned m_nProducers;
+    unsigned m_nConsumers;
+    uint64_t m_itemsPerProducer;
+    std::atomic<bool> m_startFlag;
+    std::atomic<uint64_t> m_consumed;
+
+    void runProducer(unsigned a_cpu)
+    {
+        PinCurrentThread(a_cpu);
+        while (!m_startFlag.load())
+            ;
+
+        for (uint64_t i = 0; i < m_itemsPerProducer; i++)
+        {
+            unsigned spins = 0;
+            while (!m_queue->push(i))
+            {
+                if (++spins == BENCH_SPINS_BEFORE_YIELD)
+                {
+                    spins = 0;
+                    sched_yield();
+                }
+            }
+        }
+    }
+
+    void runConsumer(unsigned a_cpu)
+    {
+        uint64_t total = m_itemsPerProducer * m_nProducers;
+        uint64_t data;
+
+        PinCurrentThread(a_cpu);
+        while (!m_startFlag.load())
+            ;
+
+        unsigned spins = 0;
+        while (m_consumed.load(std::memory_order_relaxed) < total)
+        {
+            if (m_queue->pop(data))
+            {
+                m_consumed.fetch_add(1, std::memory_order_relaxed);
+                spins = 0;
+            }
+            else if (++spins == BENCH_SPINS_BEFORE_YIELD)
+            {
+                spins = 0;
+                sched_yield();
+            }
+        }
+    }
+};
+
+template <template <typename T, uint32_t S> class Q_TYPE>
+void RunLayoutBench(
+    const char* a_policyName,
+    unsigned    a_producers,
+    unsigned    a_consumers,
+    uint64_t    a_items,
+    unsigned    a_runs)
+{
+    typedef ArrayLockFreeQueue<uint64_t, BENCH_QUEUE_SIZE, Q_TYPE> Queue_t;
+
+    std::vector<double> results;
+    for (unsigned i = 0; i < a_runs; i++)
+    {
+        LayoutBench<Queue_t> bench(a_producers, a_consumers, a_items);
+        results.push_back(bench.run());
+    }
+    std::sort(results.begin(), results.end());
+
+    std::cout << "layout="            << LAYOUT_NAME
+              << " line="             << LOCK_FREE_Q_CACHE_LINE_SIZE
+              << " policy="           << a_policyName
+              << " producers="        << a_producers
+              << " consumers="        << a_consumers
+              << " items="            << a_items
+              << " sizeof_queue="     << sizeof(Queue_t)
+              << " best_ops_per_sec=" << static_cast<uint64_t>(results.back())
+              << " median_ops_per_sec="
+              << static_cast<uint64_t>(results[results.size() / 2])
+              << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t items = BENCH_DEFAULT_ITEMS;
+    unsigned runs  = BENCH_DEFAULT_RUNS;
+
+    if (argc > 1)
+    {
+        items = strtoul(argv[1], 0, 10);
+    }
+    if (argc > 2)
+    {
+        runs = std::max(1, atoi(argv[2]));
+    }
+    if ((argc > 3) && (strcmp(argv[3], "nopin") == 0))
+    {
+        g_pinThreads = false;
+    }
+
+    RunLayoutBench<ArrayLockFreeQueueSingleProducer>(
+        "single_producer", 1, 1, items, runs);
+    // always padded. Reference for the other policies
+    RunLayoutBench<ArrayLockFreeQueueSingleProducerSingleConsumer>(
+        "single_producer_single_consumer", 1, 1, items, runs);
+    RunLayoutBench<ArrayLockFreeQueueMultipleProducers>(
+        "multiple_producers", 1, 1, items, runs);
+    RunLayoutBench<ArrayLockFreeQueueMultipleProducers>(
+        "multiple_producers", 2, 2, items, runs);
+    // always padded. Reference for the multiple producers policy
+    RunLayoutBench<ArrayLockFreeQueueSequencedSlots>(
+        "sequenced_slots", 2, 2, items, runs);
+
+    return 0;
+}
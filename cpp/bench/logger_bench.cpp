@@ -0,0 +1,113 @@
+// ============================================================================
+/// @file  logger_bench.cpp
+/// @brief Cost of logging a message for the thread that logs it
+///
+/// Ways of logging measured, both in asynchronous mode:
+///   stream   DummyLogger::Instance() << ... << std::endl. The message is
+///            formatted by the calling thread
+///   binary   DUMMY_LOG. The calling thread copies the arguments into a 
+///            binary record, the consumer thread formats it
+///
+/// Messages are written into /dev/null. They are logged in rounds that fit 
+/// in the queue (nothing is dropped), and only the time spent logging is 
+/// measured, not the time the consumer thread needs to write the round.
+///
+/// Output is one line per way of logging:
+///   mode=binary messages=1000000 ns_per_message=... dropped=0
+///
+/// Usage:
+///   $ make logger_bench
+///   $ ./logger_bench [-n messages]
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <stdint.h>
+#include <stdlib.h> // strtoull
+#include <fcntl.h>  // open
+#include <unistd.h> // getopt, close
+#include "dummylogger.h"
+
+#define BENCH_DEFAULT_MESSAGES 1000000
+#define BENCH_ROUND            (DUMMY_LOGGER_DEFAULT_QUEUE_SIZE / 2)
+
+enum BenchMode
+{
+    BENCH_STREAM,
+    BENCH_BINARY
+};
+
+/// @brief logs a message the same way real code would. Not inlined so both
+///        modes pay for the same function call
+__attribute__((noinline)) static void LogOne(BenchMode a_mode, uint64_t a_i)
+{
+    if (a_mode == BENCH_STREAM)
+    {
+        DummyLogger::Instance() << "order " << a_i << " filled at " 
+            << (a_i * 0.25) << " by " << "trader" << std::endl;
+    }
+    else
+    {
+        DUMMY_LOG(DUMMY_LOGGER_INFO, "order %d filled at %g by %s", 
+            a_i, (a_i * 0.25), "trader");
+    }
+}
+
+static void Bench(const char* a_name, BenchMode a_mode, int a_fd, uint64_t a_messages)
+{
+    uint64_t droppedBefore = DummyLogger::Instance().Dropped();
+    std::chrono::steady_clock::duration elapsed(0);
+
+    for (uint64_t logged = 0; logged < a_messages; logged += BENCH_ROUND)
+    {
+        DummyLogger::Instance().StartAsync(a_fd);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = logged; (i < logged + BENCH_ROUND) && (i < a_messages); i++)
+        {
+            LogOne(a_mode, i);
+        }
+        elapsed += std::chrono::steady_clock::now() - start;
+
+        DummyLogger::Instance().StopAsync();
+    }
+
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    std::cout << "mode=" << a_name
+              << " messages=" << a_messages
+              << " ns_per_message=" << (static_cast<double>(ns) / a_messages)
+              << " dropped=" << (DummyLogger::Instance().Dropped() - droppedBefore)
+              << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t messages = BENCH_DEFAULT_MESSAGES;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': messages = strtoull(optarg, 0, 10); break;
+        default:
+            std::cerr << "Usage: " << argv[0] << " [-n messages]" << std::endl;
+            return 1;
+        }
+    }
+
+    int fd = open("/dev/null", O_WRONLY);
+    if (fd < 0)
+    {
+        std::cerr << "can't open /dev/null" << std::endl;
+        return 1;
+    }
+
+    std::cout << "# bench=logger compiler=\"" << __VERSION__ << "\"" << std::endl;
+
+    Bench("stream", BENCH_STREAM, fd, messages);
+    Bench("binary", BENCH_BINARY, fd, messages);
+
+    close(fd);
+    return 0;
+}
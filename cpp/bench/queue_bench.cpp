@@ -0,0 +1,733 @@
+// ============================================================================
+/// @file  queue_bench.cpp
+/// @brief Throughput and latency of every queue in this directory's parent
+///
+/// Queues measured:
+///   safe_queue                       SafeQueue (mutex + condition variables)
+///   two_lock_safe_queue              TwoLockSafeQueue (a lock per side)
+///   single_producer                  ArrayLockFreeQueueSingleProducer
+///   single_producer_single_consumer  ArrayLockFreeQueueSingleProducerSingleConsumer
+///   multiple_producers               ArrayLockFreeQueueMultipleProducers
+///   sequenced_slots                  ArrayLockFreeQueueSequencedSlots
+///   consumer_thread                  ConsumerThread on top of SafeQueue
+///   consumer_thread_lock_free        ConsumerThread on top of
+///                                    ArrayLockFreeQueueAdapter (sequenced slots)
+///   consumer_thread_linked           ConsumerThread on top of
+///                                    LinkedLockFreeQueueAdapter (unbounded. The
+///                                    capacity is the number of nodes 
+///                                    allocated upfront)
+///
+/// The benchmark sweeps the number of producers and consumers (only the
+/// combinations each queue supports), the size of the elements and the
+/// capacity of the queue. Each combination is run once to warm up and then
+/// [runs] times. Threads are pinned to a different cpu each (modulo the
+/// number of cpus) unless -n is passed.
+///
+/// Latency is the time from the moment a producer is about to push an
+/// element until a consumer has popped it, so it includes the time the
+/// producer waits if the queue is full. Every element is timed. The
+/// percentiles come from the histogram of all the measured runs together (see
+/// QueueStatsHistogram), so they are within 12.5% of the real value.
+///
+/// The lock-free queues are driven with their non-blocking calls (spinning
+/// and yielding the processor every BENCH_SPINS_BEFORE_YIELD failed
+/// attempts), SafeQueue with its blocking calls, and ConsumerThread with
+/// ProduceOrBlock. TwoLockSafeQueue is driven like SafeQueue.
+///
+/// Output is one line per combination. key=value pairs by default:
+///   queue=multiple_producers producers=2 consumers=2 elem_size=64 capacity=1024 items=1000000 runs=5 median_ops_per_sec=... best_ops_per_sec=... p50_ns=... p99_ns=... p999_ns=...
+/// or comma separated values with a header line (-f csv). Either way the
+/// first line starts with '#' and describes the machine and the build.
+///
+/// Usage:
+///   $ make queue_bench
+///   $ ./queue_bench [-i items_per_run] [-r runs] [-q queue] [-s elem_size]
+///                   [-c capacity] [-p max_producers] [-f kv|csv] [-n]
+///   -q, -s and -c restrict the sweep to one queue, element size or capacity
+// ============================================================================
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <stdlib.h>  // atoi, strtoull
+#include <string.h>  // strcmp
+#include <unistd.h>  // getopt
+#include <pthread.h> // pthread_setaffinity_np
+#include <sched.h>   // sched_yield, CPU_SET
+#include "lock_free_queue.h"
+#include "lock_free_queue_adapter.h"
+#include "linked_lock_free_queue_adapter.h"
+#include "safe_queue.h"
+#include "two_lock_safe_queue.h"
+#include "consumer_thread.h"
+#include "queue_stats.h"
+
+#define BENCH_DEFAULT_ITEMS   1000000
+#define BENCH_DEFAULT_RUNS    5
+#define BENCH_MAX_PRODUCERS   4
+#define BENCH_MAX_CONSUMERS   4
+// number of failed push/pop attempts before yielding the processor. It lets
+// the benchmark make progress on machines with less cores than threads
+#define BENCH_SPINS_BEFORE_YIELD 1024
+// sequence number of the element that tells a consumer to finish
+#define BENCH_END_OF_STREAM   UINT64_MAX
+
+static bool g_pinThreads = true;
+
+/// @brief settings of the whole benchmark (command line)
+struct BenchOptions
+{
+    BenchOptions():
+        m_items(BENCH_DEFAULT_ITEMS),
+        m_runs(BENCH_DEFAULT_RUNS),
+        m_maxProducers(BENCH_MAX_PRODUCERS),
+        m_queue(),
+        m_elemSize(0),
+        m_capacity(0),
+        m_csv(false)
+    {}
+
+    uint64_t    m_items;
+    unsigned    m_runs;
+    unsigned    m_maxProducers;
+    /// empty to run every queue
+    std::string m_queue;
+    /// 0 to run every element size
+    uint32_t    m_elemSize;
+    /// 0 to run every capacity
+    uint32_t    m_capacity;
+    bool        m_csv;
+};
+
+/// @brief one point of the sweep
+struct BenchConfig
+{
+    const char* m_queueName;
+    unsigned    m_producers;
+    unsigned    m_consumers;
+    uint32_t    m_elemSize;
+    uint32_t    m_capacity;
+    uint64_t    m_items;
+};
+
+/// @brief results of all the runs of one point of the sweep
+struct BenchResult
+{
+    std::vector<double> m_opsPerSec;
+    QueueStatsHistogram m_latency;
+};
+
+/// @brief element pushed through the queues. SIZE bytes in total
+template <uint32_t SIZE>
+struct BenchElement
+{
+    BenchElement():
+        m_stamp(0),
+        m_seq(0)
+    {}
+
+    uint64_t m_stamp;
+    uint64_t m_seq;
+    char     m_payload[SIZE - (2 * sizeof(uint64_t))];
+};
+
+/// @brief current time in nanoseconds
+static inline uint64_t Now()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/// @brief pin the calling thread to a_cpu (modulo the number of cpus)
+static void PinCurrentThread(unsigned a_cpu)
+{
+    if (!g_pinThreads)
+    {
+        return;
+    }
+
+    unsigned nCpus = std::max(1u, std::thread::hardware_concurrency());
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(a_cpu % nCpus, &cpuSet);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+}
+
+/// @brief add the values of a_src into a_dst
+static void MergeHistogram(QueueStatsHistogram &a_dst, const QueueStatsHistogram &a_src)
+{
+    for (uint32_t i = 0; i < QueueStatsHistogram::BUCKETS; i++)
+    {
+        a_dst.Add(i, a_src.m_counts[i]);
+    }
+}
+
+/// @brief how the benchmark drives the lock-free queues
+template <typename QUEUE_T>
+struct LockFreeBenchOps
+{
+    static QUEUE_T* Create(uint32_t /*a_capacity*/)
+    {
+        // the capacity is a template parameter
+        return new QUEUE_T();
+    }
+
+    template <typename ELEM_T>
+    static inline void Push(QUEUE_T &a_queue, const ELEM_T &a_elem)
+    {
+        unsigned spins = 0;
+        while (!a_queue.push(a_elem))
+        {
+            if (++spins == BENCH_SPINS_BEFORE_YIELD)
+            {
+                spins = 0;
+                sched_yield();
+            }
+        }
+    }
+
+    template <typename ELEM_T>
+    static inline void Pop(QUEUE_T &a_queue, ELEM_T &out_elem)
+    {
+        unsigned spins = 0;
+        while (!a_queue.pop(out_elem))
+        {
+            if (++spins == BENCH_SPINS_BEFORE_YIELD)
+            {
+                spins = 0;
+                sched_yield();
+            }
+        }
+    }
+};
+
+/// @brief how the benchmark drives SafeQueue
+template <typename QUEUE_T>
+struct SafeQueueBenchOps
+{
+    static QUEUE_T* Create(uint32_t a_capacity)
+    {
+        return new QUEUE_T(a_capacity);
+    }
+
+    template <typename ELEM_T>
+    static inline void Push(QUEUE_T &a_queue, const ELEM_T &a_elem)
+    {
+        a_queue.Push(a_elem);
+    }
+
+    template <typename ELEM_T>
+    static inline void Pop(QUEUE_T &a_queue, ELEM_T &out_elem)
+    {
+        a_queue.Pop(out_elem);
+    }
+};
+
+/// @brief producers and consumers working directly on a queue
+template <typename ELEM_T, typename QUEUE_T, typename OPS_T>
+class QueueBench
+{
+public:
+    explicit QueueBench(const BenchConfig &a_config):
+        m_config(a_config),
+        m_queue(OPS_T::Create(a_config.m_capacity)),
+        m_itemsPerProducer(a_config.m_items / a_config.m_producers),
+        m_startFlag(false),
+        m_latencies(a_config.m_consumers)
+    {}
+
+    /// @brief run the benchmark once
+    /// @param out_latency latencies of the run are added to it
+    /// @return number of elements pushed and popped per second
+    double run(QueueStatsHistogram &out_latency)
+    {
+        std::vector<std::thread> producers;
+        std::vector<std::thread> consumers;
+        unsigned cpu = 0;
+
+        for (unsigned i = 0; i < m_config.m_consumers; i++)
+        {
+            consumers.push_back(
+                std::thread(&QueueBench::runConsumer, this, cpu++, i));
+        }
+        for (unsigned i = 0; i < m_config.m_producers; i++)
+        {
+            producers.push_back(
+                std::thread(&QueueBench::runProducer, this, cpu++, i));
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        m_startFlag.store(true);
+
+        for (std::size_t i = 0; i < producers.size(); i++)
+        {
+            producers[i].join();
+        }
+
+        // every element is already in the queue. One end of stream per
+        // consumer behind them (the producers are done, so this thread can
+        // push into the single producer queues too)
+        ELEM_T endOfStream;
+        endOfStream.m_seq = BENCH_END_OF_STREAM;
+        for (std::size_t i = 0; i < consumers.size(); i++)
+        {
+            OPS_T::Push(*m_queue, endOfStream);
+        }
+
+        for (std::size_t i = 0; i < consumers.size(); i++)
+        {
+            consumers[i].join();
+        }
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - startTime;
+
+        for (std::size_t i = 0; i < m_latencies.size(); i++)
+        {
+            MergeHistogram(out_latency, m_latencies[i]);
+        }
+
+        return (m_itemsPerProducer * m_config.m_producers) / elapsed.count();
+    }
+
+private:
+    BenchConfig              m_config;
+    std::unique_ptr<QUEUE_T> m_queue;
+    uint64_t                 m_itemsPerProducer;
+    std::atomic<bool>        m_startFlag;
+    /// one per consumer. Each consumer only touches its own
+    std::vector<QueueStatsHistogram> m_latencies;
+
+    void runProducer(unsigned a_cpu, unsigned a_index)
+    {
+        ELEM_T elem;
+
+        PinCurrentThread(a_cpu);
+        while (!m_startFlag.load())
+            ;
+
+        uint64_t seq = a_index * m_itemsPerProducer;
+        for (uint64_t i = 0; i < m_itemsPerProducer; i++)
+        {
+            elem.m_seq   = seq++;
+            elem.m_stamp = Now();
+            OPS_T::Push(*m_queue, elem);
+        }
+    }
+
+    void runConsumer(unsigned a_cpu, unsigned a_index)
+    {
+        QueueStatsHistogram latency;
+        ELEM_T elem;
+
+        PinCurrentThread(a_cpu);
+        while (!m_startFlag.load())
+            ;
+
+        while (true)
+        {
+            OPS_T::Pop(*m_queue, elem);
+            if (elem.m_seq == BENCH_END_OF_STREAM)
+            {
+                break;
+            }
+
+            uint64_t now = Now();
+            latency.Add(QueueStatsHistogram::BucketIndex(
+                (now > elem.m_stamp) ? (now - elem.m_stamp) : 0), 1);
+        }
+
+        m_latencies[a_index] = latency;
+    }
+};
+
+/// @brief producers feeding a ConsumerThread
+template <typename ELEM_T, typename QUEUE_T>
+class ConsumerThreadBench
+{
+public:
+    explicit ConsumerThreadBench(const BenchConfig &a_config):
+        m_config(a_config),
+        m_itemsPerProducer(a_config.m_items / a_config.m_producers),
+        m_startFlag(false)
+    {}
+
+    /// @brief run the benchmark once. See QueueBench::run
+    double run(QueueStatsHistogram &out_latency)
+    {
+        QueueStatsHistogram latency;
+        std::vector<std::thread> producers;
+        unsigned cpu = 0;
+
+        // the consumer thread takes the first cpu, as in QueueBench
+        ConsumerThreadAttributes attributes(
+            "bench-consumer",
+            g_pinThreads ?
+                std::vector<int>(1, cpu++ % std::max(1u, std::thread::hardware_concurrency())) :
+                std::vector<int>());
+        ConsumerThread<ELEM_T, QUEUE_T> consumer(
+            m_config.m_capacity,
+            attributes,
+            [&latency](ELEM_T a_elem)
+            {
+                uint64_t now = Now();
+                latency.Add(QueueStatsHistogram::BucketIndex(
+                    (now > a_elem.m_stamp) ? (now - a_elem.m_stamp) : 0), 1);
+            });
+
+        for (unsigned i = 0; i < m_config.m_producers; i++)
+        {
+            producers.push_back(std::thread(
+                &ConsumerThreadBench::runProducer, this, cpu++, i, &consumer));
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        m_startFlag.store(true);
+
+        for (std::size_t i = 0; i < producers.size(); i++)
+        {
+            producers[i].join();
+        }
+
+        // drains everything that is still in the queue
+        consumer.Join();
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - startTime;
+
+        MergeHistogram(out_latency, latency);
+
+        return (m_itemsPerProducer * m_config.m_producers) / elapsed.count();
+    }
+
+private:
+    BenchConfig       m_config;
+    uint64_t          m_itemsPerProducer;
+    std::atomic<bool> m_startFlag;
+
+    void runProducer(
+        unsigned                          a_cpu,
+        unsigned                          a_index,
+        ConsumerThread<ELEM_T, QUEUE_T>  *a_consumer)
+    {
+        ELEM_T elem;
+
+        PinCurrentThread(a_cpu);
+        while (!m_startFlag.load())
+            ;
+
+        uint64_t seq = a_index * m_itemsPerProducer;
+        for (uint64_t i = 0; i < m_itemsPerProducer; i++)
+        {
+            elem.m_seq   = seq++;
+            elem.m_stamp = Now();
+            a_consumer->ProduceOrBlock(elem);
+        }
+    }
+};
+
+static void PrintHeader(const BenchOptions &a_options)
+{
+    std::cout << "# bench=queue"
+              << " cpus="     << std::thread::hardware_concurrency()
+              << " pinned="   << (g_pinThreads ? 1 : 0)
+              << " compiler=\"" << __VERSION__ << "\""
+              << " cache_line=" << LOCK_FREE_Q_CACHE_LINE_SIZE
+#ifdef _WITH_LOCK_FREE_Q_CACHE_LINE_PADDING
+              << " layout=padded"
+#else
+              << " layout=packed"
+#endif
+              << std::endl;
+
+    if (a_options.m_csv)
+    {
+        std::cout << "queue,producers,consumers,elem_size,capacity,items,runs,"
+                  << "median_ops_per_sec,best_ops_per_sec,p50_ns,p99_ns,p999_ns"
+                  << std::endl;
+    }
+}
+
+static void PrintResult(
+    const BenchOptions &a_options,
+    const BenchConfig  &a_config,
+    BenchResult        &a_result)
+{
+    std::vector<double> &ops = a_result.m_opsPerSec;
+    std::sort(ops.begin(), ops.end());
+
+    uint64_t median = static_cast<uint64_t>(ops[ops.size() / 2]);
+    uint64_t best   = static_cast<uint64_t>(ops.back());
+    uint64_t p50    = a_result.m_latency.Percentile(50.0);
+    uint64_t p99    = a_result.m_latency.Percentile(99.0);
+    uint64_t p999   = a_result.m_latency.Percentile(99.9);
+
+    if (a_options.m_csv)
+    {
+        std::cout << a_config.m_queueName << ","
+                  << a_config.m_producers << ","
+                  << a_config.m_consumers << ","
+                  << a_config.m_elemSize  << ","
+                  << a_config.m_capacity  << ","
+                  << a_config.m_items     << ","
+                  << ops.size()           << ","
+                  << median << "," << best << ","
+                  << p50 << "," << p99 << "," << p999
+                  << std::endl;
+    }
+    else
+    {
+        std::cout << "queue="               << a_config.m_queueName
+                  << " producers="          << a_config.m_producers
+                  << " consumers="          << a_config.m_consumers
+                  << " elem_size="          << a_config.m_elemSize
+                  << " capacity="           << a_config.m_capacity
+                  << " items="              << a_config.m_items
+                  << " runs="               << ops.size()
+                  << " median_ops_per_sec=" << median
+                  << " best_ops_per_sec="   << best
+                  << " p50_ns="             << p50
+                  << " p99_ns="             << p99
+                  << " p999_ns="            << p999
+                  << std::endl;
+    }
+}
+
+/// @brief warm up run plus a_options.m_runs measured runs of one point of
+///        the sweep
+template <typename BENCH_T>
+static void RunBench(const BenchOptions &a_options, const BenchConfig &a_config)
+{
+    BenchResult result;
+
+    {
+        QueueStatsHistogram discarded;
+        BENCH_T bench(a_config);
+        bench.run(discarded);
+    }
+
+    for (unsigned i = 0; i < a_options.m_runs; i++)
+    {
+        BENCH_T bench(a_config);
+        result.m_opsPerSec.push_back(bench.run(result.m_latency));
+    }
+
+    PrintResult(a_options, a_config, result);
+}
+
+/// @brief the lock-free queue Q_TYPE with elements of ELEM_SIZE bytes and
+///        the capacity in a_config
+/// The capacity of the queue is a template parameter. Only the capacities in
+/// the sweep (see main) are instantiated
+template <template <typename T, uint32_t S> class Q_TYPE, uint32_t ELEM_SIZE>
+static void RunLockFreeBench(const BenchOptions &a_options, const BenchConfig &a_config)
+{
+    typedef BenchElement<ELEM_SIZE> Elem_t;
+
+    switch (a_config.m_capacity)
+    {
+    case 64:
+    {
+        typedef ArrayLockFreeQueue<Elem_t, 64, Q_TYPE> Queue_t;
+        RunBench<QueueBench<Elem_t, Queue_t, LockFreeBenchOps<Queue_t> > >(
+            a_options, a_config);
+        break;
+    }
+    case 1024:
+    {
+        typedef ArrayLockFreeQueue<Elem_t, 1024, Q_TYPE> Queue_t;
+        RunBench<QueueBench<Elem_t, Queue_t, LockFreeBenchOps<Queue_t> > >(
+            a_options, a_config);
+        break;
+    }
+    case 16384:
+    {
+        typedef ArrayLockFreeQueue<Elem_t, 16384, Q_TYPE> Queue_t;
+        RunBench<QueueBench<Elem_t, Queue_t, LockFreeBenchOps<Queue_t> > >(
+            a_options, a_config);
+        break;
+    }
+    default:
+        std::cerr << "capacity " << a_config.m_capacity
+                  << " not supported by the lock-free queues" << std::endl;
+        break;
+    }
+}
+
+/// @brief every queue with elements of ELEM_SIZE bytes
+template <uint32_t ELEM_SIZE>
+static void RunElemSize(const BenchOptions &a_options, BenchConfig a_config)
+{
+    typedef BenchElement<ELEM_SIZE> Elem_t;
+    const std::string &queue = a_options.m_queue;
+
+    a_config.m_elemSize = ELEM_SIZE;
+
+    for (unsigned producers = 1; producers <= a_options.m_maxProducers; producers *= 2)
+    {
+        a_config.m_producers = producers;
+
+        for (unsigned consumers = 1; consumers <= BENCH_MAX_CONSUMERS; consumers *= 2)
+        {
+            a_config.m_consumers = consumers;
+
+            if (queue.empty() || (queue == "safe_queue"))
+            {
+                a_config.m_queueName = "safe_queue";
+                RunBench<QueueBench<Elem_t, SafeQueue<Elem_t>,
+                                    SafeQueueBenchOps<SafeQueue<Elem_t> > > >(
+                    a_options, a_config);
+            }
+
+            if (queue.empty() || (queue == "two_lock_safe_queue"))
+            {
+                typedef TwoLockSafeQueue<Elem_t> TwoLock_t;
+
+                a_config.m_queueName = "two_lock_safe_queue";
+                RunBench<QueueBench<Elem_t, TwoLock_t, SafeQueueBenchOps<TwoLock_t> > >(
+                    a_options, a_config);
+            }
+
+            if ((producers == 1) && (queue.empty() || (queue == "single_producer")))
+            {
+                a_config.m_queueName = "single_producer";
+                RunLockFreeBench<ArrayLockFreeQueueSingleProducer, ELEM_SIZE>(
+                    a_options, a_config);
+            }
+
+            if ((producers == 1) && (consumers == 1) &&
+                (queue.empty() || (queue == "single_producer_single_consumer")))
+            {
+                a_config.m_queueName = "single_producer_single_consumer";
+                RunLockFreeBench<ArrayLockFreeQueueSingleProducerSingleConsumer, ELEM_SIZE>(
+                    a_options, a_config);
+            }
+
+            if (queue.empty() || (queue == "multiple_producers"))
+            {
+                a_config.m_queueName = "multiple_producers";
+                RunLockFreeBench<ArrayLockFreeQueueMultipleProducers, ELEM_SIZE>(
+                    a_options, a_config);
+            }
+
+            if (queue.empty() || (queue == "sequenced_slots"))
+            {
+                a_config.m_queueName = "sequenced_slots";
+                RunLockFreeBench<ArrayLockFreeQueueSequencedSlots, ELEM_SIZE>(
+                    a_options, a_config);
+            }
+
+            // there is only one consumer in a ConsumerThread
+            if ((consumers == 1) && (queue.empty() || (queue == "consumer_thread")))
+            {
+                a_config.m_queueName = "consumer_thread";
+                RunBench<ConsumerThreadBench<Elem_t, SafeQueue<Elem_t> > >(
+                    a_options, a_config);
+            }
+
+            if ((consumers == 1) &&
+                (queue.empty() || (queue == "consumer_thread_lock_free")))
+            {
+                typedef ArrayLockFreeQueueAdapter<
+                    Elem_t, 0, ArrayLockFreeQueueSequencedSlots> Adapter_t;
+
+                a_config.m_queueName = "consumer_thread_lock_free";
+                RunBench<ConsumerThreadBench<Elem_t, Adapter_t> >(
+                    a_options, a_config);
+            }
+
+            if ((consumers == 1) &&
+                (queue.empty() || (queue == "consumer_thread_linked")))
+            {
+                a_config.m_queueName = "consumer_thread_linked";
+                RunBench<ConsumerThreadBench<Elem_t, LinkedLockFreeQueueAdapter<Elem_t> > >(
+                    a_options, a_config);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:r:q:s:c:p:f:n")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i':
+            options.m_items = std::max(1ULL, strtoull(optarg, 0, 10));
+            break;
+        case 'r':
+            options.m_runs = std::max(1, atoi(optarg));
+            break;
+        case 'q':
+            options.m_queue = optarg;
+            break;
+        case 's':
+            options.m_elemSize = static_cast<uint32_t>(atoi(optarg));
+            break;
+        case 'c':
+            options.m_capacity = static_cast<uint32_t>(atoi(optarg));
+            break;
+        case 'p':
+            options.m_maxProducers = std::max(1, atoi(optarg));
+            break;
+        case 'f':
+            options.m_csv = (strcmp(optarg, "csv") == 0);
+            break;
+        case 'n':
+            g_pinThreads = false;
+            break;
+        default:
+            std::cerr << "usage: " << argv[0]
+                      << " [-i items_per_run] [-r runs] [-q queue] [-s elem_size]"
+                      << " [-c capacity] [-p max_producers] [-f kv|csv] [-n]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    PrintHeader(options);
+
+    static const uint32_t CAPACITIES[] = {64, 1024, 16384};
+
+    for (std::size_t i = 0; i < sizeof(CAPACITIES) / sizeof(CAPACITIES[0]); i++)
+    {
+        if ((options.m_capacity != 0) && (options.m_capacity != CAPACITIES[i]))
+        {
+            continue;
+        }
+
+        BenchConfig config;
+        config.m_queueName = "";
+        config.m_producers = 1;
+        config.m_consumers = 1;
+        config.m_elemSize  = 0;
+        config.m_capacity  = CAPACITIES[i];
+        config.m_items     = options.m_items;
+
+        if ((options.m_elemSize == 0) || (options.m_elemSize == 16))
+        {
+            RunElemSize<16>(options, config);
+        }
+        if ((options.m_elemSize == 0) || (options.m_elemSize == 64))
+        {
+            RunElemSize<64>(options, config);
+        }
+        if ((options.m_elemSize == 0) || (options.m_elemSize == 256))
+        {
+            RunElemSize<256>(options, config);
+        }
+    }
+
+    return 0;
+}
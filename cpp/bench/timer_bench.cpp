@@ -0,0 +1,169 @@
+// ============================================================================
+/// @file  timer_bench.cpp
+/// @brief Cost of driving many virtual timers
+///
+/// Drivers measured:
+///   vtimer        one VTimer per timer, every one of them updated per tick
+///   vtimer_set    every timer in a VTimerSet with a plain function pointer
+///                 as the callback, updated once per tick
+///   vtimer_wheel  every timer in a VTimerWheel updated once per tick
+///
+/// Each timer is periodic. The periods are spread between BENCH_MIN_PERIOD
+/// and BENCH_MAX_PERIOD ticks, so only a few of the timers expire per tick.
+/// The time is advanced one tick at a time for [ticks] ticks.
+///
+/// Output is one line per driver and number of timers:
+///   driver=vtimer_wheel timers=50000 ticks=10000 ns_per_tick=... callbacks=...
+///
+/// Usage:
+///   $ make timer_bench
+///   $ ./timer_bench [-t ticks] [-n timers]
+///   -n runs only that number of timers (1000, 10000 and 50000 by default)
+// ============================================================================
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <functional>
+#include <stdlib.h> // strtoull
+#include <unistd.h> // getopt
+#include "vtimer.h"
+#include "vtimer_wheel.h"
+
+#define BENCH_DEFAULT_TICKS 10000
+#define BENCH_MIN_PERIOD    100
+#define BENCH_MAX_PERIOD    10000
+
+typedef uint64_t Time_t;
+
+/// @brief what the callbacks do. Something the compiler can't throw away
+static uint64_t g_callbacks = 0;
+
+static void OnExpiry(const Time_t &/*a_currentTime*/)
+{
+    g_callbacks++;
+}
+
+/// @brief period of the a_timer-th timer
+static inline Time_t PeriodOf(uint64_t a_timer)
+{
+    return BENCH_MIN_PERIOD + 
+        ((a_timer * 7919) % (BENCH_MAX_PERIOD - BENCH_MIN_PERIOD));
+}
+
+static void PrintResult(
+    const char*                         a_driver, 
+    uint64_t                            a_timers, 
+    uint64_t                            a_ticks, 
+    std::chrono::steady_clock::duration a_elapsed)
+{
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(a_elapsed).count();
+
+    std::cout << "driver=" << a_driver
+              << " timers=" << a_timers
+              << " ticks=" << a_ticks
+              << " ns_per_tick=" << (ns / a_ticks)
+              << " callbacks=" << g_callbacks
+              << std::endl;
+}
+
+static void BenchVTimer(uint64_t a_timers, uint64_t a_ticks)
+{
+    std::vector<std::unique_ptr<VTimer<Time_t> > > timers;
+    for (uint64_t i = 0; i < a_timers; i++)
+    {
+        timers.push_back(std::unique_ptr<VTimer<Time_t> >(
+            new VTimer<Time_t>(&OnExpiry, PeriodOf(i))));
+        timers.back()->Update(1);
+    }
+
+    g_callbacks = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (Time_t now = 2; now < a_ticks + 2; now++)
+    {
+        for (uint64_t i = 0; i < a_timers; i++)
+        {
+            timers[i]->Update(now);
+        }
+    }
+    PrintResult("vtimer", a_timers, a_ticks, std::chrono::steady_clock::now() - start);
+}
+
+static void BenchSet(uint64_t a_timers, uint64_t a_ticks)
+{
+    VTimerSet<Time_t, void (*)(const Time_t&)> timers;
+    timers.Reserve(a_timers);
+    for (uint64_t i = 0; i < a_timers; i++)
+    {
+        timers.Add(&OnExpiry, PeriodOf(i));
+    }
+    timers.Update(1);
+
+    g_callbacks = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (Time_t now = 2; now < a_ticks + 2; now++)
+    {
+        timers.Update(now);
+    }
+    PrintResult("vtimer_set", a_timers, a_ticks, std::chrono::steady_clock::now() - start);
+}
+
+static void BenchWheel(uint64_t a_timers, uint64_t a_ticks)
+{
+    VTimerWheel<Time_t> wheel(1);
+    for (uint64_t i = 0; i < a_timers; i++)
+    {
+        wheel.SchedulePeriodic(&OnExpiry, PeriodOf(i));
+    }
+
+    g_callbacks = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (Time_t now = 2; now < a_ticks + 2; now++)
+    {
+        wheel.Update(now);
+    }
+    PrintResult("vtimer_wheel", a_timers, a_ticks, std::chrono::steady_clock::now() - start);
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t ticks = BENCH_DEFAULT_TICKS;
+    uint64_t onlyTimers = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:n:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't': ticks = strtoull(optarg, 0, 10); break;
+        case 'n': onlyTimers = strtoull(optarg, 0, 10); break;
+        default:
+            std::cerr << "Usage: " << argv[0] << " [-t ticks] [-n timers]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "# bench=timer compiler=\"" << __VERSION__ << "\"" << std::endl;
+
+    std::vector<uint64_t> sweep;
+    if (onlyTimers != 0)
+    {
+        sweep.push_back(onlyTimers);
+    }
+    else
+    {
+        sweep.push_back(1000);
+        sweep.push_back(10000);
+        sweep.push_back(50000);
+    }
+
+    for (std::size_t i = 0; i < sweep.size(); i++)
+    {
+        BenchVTimer(sweep[i], ticks);
+        BenchSet(sweep[i], ticks);
+        BenchWheel(sweep[i], ticks);
+    }
+
+    return 0;
+}
@@ -41,36 +41,169 @@
 
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <functional>
 #include "safe_queue.h"
+#include "consumer_thread_attributes.h"
 
-template <typename T>
+/// @brief a thread that consumes the elements pushed into its queue calling
+///        a delegate per element
+/// T type of the elements to be consumed
+/// QUEUE_T type of the queue. SafeQueue<T> by default (mutex + condition 
+///         variables). Any class with the same interface can be used, for 
+///         instance ArrayLockFreeQueueAdapter (lock_free_queue_adapter.h) to
+///         run the consumer on top of a lock-free queue:
+///   ConsumerThread<int, ArrayLockFreeQueueAdapter<int, 1024> > consumer(...);
+///         or TwoLockSafeQueue (two_lock_safe_queue.h) to keep the consumer
+///         and the producers off each other's lock, PrioritySafeQueue
+///         (priority_safe_queue.h) to consume elements by priority, or 
+///         LinkedLockFreeQueueAdapter (linked_lock_free_queue_adapter.h) for
+///         an unbounded lock-free queue producers are never turned away from
+///         Its blocking Push and Emplace must return false when the element
+///         is discarded because the queue is (or gets) closed
+/// DELEGATE_T template of the delegates called by the thread: the consume
+///         delegate is a DELEGATE_T<void(T)> and the init one a 
+///         DELEGATE_T<void()>. std::function by default. Delegate 
+///         (delegate/Delegate.h) never allocates and calls member functions
+///         and small lambdas without the type erased call of std::function:
+///   ConsumerThread<int, SafeQueue<int>, Delegate> consumer(
+///       MakeDelegate(&obj, &MyClass::Consume));
+///
+/// Back-pressure: producers can be told when the backlog (elements produced
+/// and not popped yet) crosses a high watermark and when it goes back 
+/// under a low one (see SetWatermarks), and they can wait a limited time for
+/// space in the queue (ProduceFor). In coalescing mode (see the COALESCE 
+/// constructor) the consumer gets every pending element at once in a span,
+/// and the maximum size of the span grows with the backlog, so the cost per
+/// element falls as the load rises
+template <typename T, 
+          typename QUEUE_T = SafeQueue<T>, 
+          template <typename> class DELEGATE_T = std::function>
 class ConsumerThread
 {
 public:
+    typedef DELEGATE_T<void(T)> ConsumeDelegate_t;
+    typedef DELEGATE_T<void( )> InitDelegate_t;
+    typedef DELEGATE_T<void( )> BatchEndDelegate_t;
+    /// consume delegate of the coalescing mode: an array of elements and 
+    /// its size. Elements can be moved out of it
+    typedef DELEGATE_T<void(T*, std::size_t)> SpanDelegate_t;
+    /// watermark delegates. They receive the backlog
+    typedef DELEGATE_T<void(std::size_t)> WatermarkDelegate_t;
+
+    /// @brief tag of the constructor of the coalescing mode
+    enum CoalesceMode
+    {
+        COALESCE
+    };
+
+    /// @brief what happens to the elements still in the queue when the 
+    ///        consumer thread is told to finish (see Join)
+    enum JoinMode
+    {
+        /// the elements already in the queue are consumed before the thread
+        /// finishes
+        JOIN_DRAIN,
+        /// the thread finishes after the element being consumed. The rest 
+        /// are destroyed with the queue
+        JOIN_DROP
+    };
+
     /// @brief ConsumerThread constructor
     /// The queue size will be set to the safe queue's default
     /// @param a_consumeDelegate delegate to the function to be called per consumable
     /// @param a_initDelegate a delegate to the initialise function. It does nothing by default
     ///        This function will get called from the context of the consumer thread
+    /// @param a_batchEndDelegate called by the consumer thread every time it 
+    ///        has consumed the elements it popped at once from the queue. A 
+    ///        good moment to flush the work the consume delegate buffered.
+    ///        It does nothing by default
     ConsumerThread(
-        std::function<void(T)> a_consumeDelegate,
-        std::function<void( )> a_initDelegate = std::bind(&ConsumerThread::DoNothing) );
+        ConsumeDelegate_t a_consumeDelegate,
+        InitDelegate_t     a_initDelegate = &ConsumerThread::DoNothing,
+        BatchEndDelegate_t a_batchEndDelegate = &ConsumerThread::DoNothing );
     /// @brief ConsumerThread constructor
-    /// @param a_queueSize safe queue size
+    /// @param a_queueSize size of the queue. For SafeQueue it is the maximum 
+    ///        size. ArrayLockFreeQueueAdapter only supports it for queue 
+    ///        implementations with a size chosen at run time (Q_SIZE = 0)
     /// @param a_consumeDelegate delegate to the function to be called per consumable
     /// @param a_initDelegate a delegate to the initialise function. It does nothing by default
     ///        This function will get called from the context of the consumer thread
+    /// @param a_batchEndDelegate called by the consumer thread every time it 
+    ///        has consumed the elements it popped at once from the queue. A 
+    ///        good moment to flush the work the consume delegate buffered.
+    ///        It does nothing by default
     ConsumerThread(
         std::size_t a_queueSize,
-        std::function<void(T)> a_consumeDelegate,
-        std::function<void( )> a_initDelegate = std::bind(&ConsumerThread::DoNothing) );
+        ConsumeDelegate_t a_consumeDelegate,
+        InitDelegate_t     a_initDelegate = &ConsumerThread::DoNothing,
+        BatchEndDelegate_t a_batchEndDelegate = &ConsumerThread::DoNothing );
+    /// @brief ConsumerThread constructor
+    /// The queue size will be set to the safe queue's default
+    /// @param a_attributes CPU affinity, NUMA node, priority and name of the
+    ///        thread. They are applied by the thread before calling 
+    ///        a_initDelegate. It's best effort: the thread runs anyway if the
+    ///        system refuses any of them (ConsumerThreadAttributes::Apply 
+    ///        can be called again from the init delegate to check it)
+    /// @param a_consumeDelegate delegate to the function to be called per consumable
+    /// @param a_initDelegate a delegate to the initialise function. It does nothing by default
+    ///        This function will get called from the context of the consumer thread
+    /// @param a_batchEndDelegate called by the consumer thread every time it 
+    ///        has consumed the elements it popped at once from the queue. A 
+    ///        good moment to flush the work the consume delegate buffered.
+    ///        It does nothing by default
+    ConsumerThread(
+        const ConsumerThreadAttributes &a_attributes,
+        ConsumeDelegate_t a_consumeDelegate,
+        InitDelegate_t     a_initDelegate = &ConsumerThread::DoNothing,
+        BatchEndDelegate_t a_batchEndDelegate = &ConsumerThread::DoNothing );
+    /// @brief ConsumerThread constructor
+    /// @param a_queueSize size of the queue. See above
+    /// @param a_attributes placement and scheduling of the thread. See above
+    /// @param a_consumeDelegate delegate to the function to be called per consumable
+    /// @param a_initDelegate a delegate to the initialise function. It does nothing by default
+    ///        This function will get called from the context of the consumer thread
+    /// @param a_batchEndDelegate called by the consumer thread every time it 
+    ///        has consumed the elements it popped at once from the queue. A 
+    ///        good moment to flush the work the consume delegate buffered.
+    ///        It does nothing by default
+    ConsumerThread(
+        std::size_t a_queueSize,
+        const ConsumerThreadAttributes &a_attributes,
+        ConsumeDelegate_t a_consumeDelegate,
+        InitDelegate_t     a_initDelegate = &ConsumerThread::DoNothing,
+        BatchEndDelegate_t a_batchEndDelegate = &ConsumerThread::DoNothing );
+    /// @brief ConsumerThread constructor of the coalescing mode
+    /// Every time the thread wakes up it pops all the elements pending, up
+    /// to a maximum that doubles each time the queue had at least that many
+    /// (until CONSUMER_THREAD_MAX_SPAN_SIZE) and halves (until 
+    /// CONSUMER_THREAD_BATCH_SIZE) when the backlog goes down, and passes 
+    /// them at once to a_spanDelegate
+    /// @param a_queueSize size of the queue. See above
+    /// @param a_attributes placement and scheduling of the thread. See above
+    /// @param a_spanDelegate called by the consumer thread with the elements
+    ///        it popped. The span is only valid while the call lasts
+    /// @param a_initDelegate a delegate to the initialise function. See above
+    /// @param a_batchEndDelegate called after each call to a_spanDelegate
+    ConsumerThread(
+        CoalesceMode,
+        std::size_t a_queueSize,
+        const ConsumerThreadAttributes &a_attributes,
+        SpanDelegate_t a_spanDelegate,
+        InitDelegate_t     a_initDelegate = &ConsumerThread::DoNothing,
+        BatchEndDelegate_t a_batchEndDelegate = &ConsumerThread::DoNothing );
 
     virtual ~ConsumerThread();
 
     /// @brief Tell the consumer thread to finish and wait until it does so
     /// suspends execution of the calling thread until the target thread terminates
-    void Join();
+    /// The queue is closed, so nothing else can be produced and the consumer
+    /// is woken up straight away if it was waiting for data
+    /// @param a_mode what to do with the elements still in the queue. They 
+    ///        are consumed by default
+    void Join(JoinMode a_mode = JOIN_DRAIN);
 
     /// @brief inserts data into the consumable queue to be processed by the ConsumerThread
     /// This call can block for a short period of time if another thread owns the lock that 
@@ -78,28 +211,145 @@ public:
     /// function will return as soon as possible
     /// @param a const reference to the element to insert into the queue
     /// @return true if the element was successfully inserted into the queue. False otherwise
+    ///         (the queue is full, or Join was already called)
     bool Produce(const T &a_data);
+
+    /// @brief moves data into the consumable queue to be processed by the ConsumerThread
+    /// The element is moved all the way from here into the consume delegate. a_data is 
+    /// not modified if it can't be pushed into the queue (it is full)
+    /// @param an rvalue reference to the element to move into the queue
+    /// @return true if the element was successfully inserted into the queue. False otherwise
+    bool Produce(T &&a_data);
+
+    /// @brief constructs an element in place in the consumable queue
+    /// @param a_args arguments forwarded to the constructor of T
+    /// @return true if the element was successfully inserted into the queue. False otherwise
+    template <typename... ARGS>
+    bool Emplace(ARGS&&... a_args);
     
     /// @brief inserts data into the consumable queue to be processed by the ConsumerThread
-    /// This call will block until a_data can be pushed into the queue
+    /// This call will block until a_data can be pushed into the queue. It is
+    /// discarded if Join was already called
     /// @param a const reference to the element to insert into the queue
     void ProduceOrBlock(const T &a_data);
 
+    /// @brief moves data into the consumable queue to be processed by the ConsumerThread
+    /// This call will block until a_data can be pushed into the queue. It is
+    /// discarded if Join was already called
+    /// @param an rvalue reference to the element to move into the queue
+    void ProduceOrBlock(T &&a_data);
+
+    /// @brief constructs an element in place in the consumable queue
+    /// This call will block until there is space for the element in the queue.
+    /// Nothing is constructed if Join was already called
+    /// @param a_args arguments forwarded to the constructor of T
+    template <typename... ARGS>
+    void EmplaceOrBlock(ARGS&&... a_args);
+
+    /// @brief inserts data into the consumable queue waiting at most 
+    ///        a_timeout for space in it
+    /// The producer is woken up by the consumer thread each time it pops 
+    /// elements from the queue, so it doesn't spin while it waits
+    /// @param a const reference to the element to insert into the queue
+    /// @param a_timeout maximum time to wait if the queue is full
+    /// @return true if the element was inserted. False if the queue was 
+    ///         still full after a_timeout or Join was called
+    bool ProduceFor(const T &a_data, std::chrono::microseconds a_timeout);
+
+    /// @brief moves data into the consumable queue waiting at most a_timeout
+    ///        for space in it. a_data is not modified if it can't be pushed
+    /// @return true if the element was inserted. False otherwise
+    bool ProduceFor(T &&a_data, std::chrono::microseconds a_timeout);
+
+    /// @brief tells the producers when the backlog grows too big and when 
+    ///        it goes back to normal
+    /// a_onHigh is called once when the backlog reaches a_high, by the 
+    /// producer that made it reach it. a_onLow is called once when the 
+    /// backlog goes back to a_low or less, by the consumer thread. Then 
+    /// a_onHigh can be called again, and so on. The backlog is only kept 
+    /// track of from this call on (it costs an atomic operation per element
+    /// produced), so it must be called before anything is produced
+    /// @param a_high backlog that triggers a_onHigh. Greater than a_low
+    /// @param a_low backlog that triggers a_onLow after a_onHigh was called
+    /// @param a_onHigh called with the backlog when it reaches a_high
+    /// @param a_onLow called with the backlog when it goes down to a_low
+    void SetWatermarks(
+        std::size_t         a_high, 
+        std::size_t         a_low, 
+        WatermarkDelegate_t a_onHigh, 
+        WatermarkDelegate_t a_onLow);
+
+    /// @brief keeps track of the backlog without watermarks, so it can be 
+    ///        read with Backlog. SetWatermarks does it too. It must be called
+    ///        before anything is produced
+    void TrackBacklog();
+
+    /// @return elements produced and not popped by the consumer thread yet
+    ///         (an upper bound while they are being produced). Always 0 if
+    ///         neither SetWatermarks nor TrackBacklog were called
+    std::size_t Backlog() const;
+
+    /// @return true between the calls to the high and the low watermark 
+    ///         delegates (see SetWatermarks)
+    bool IsAboveHighWatermark() const;
+
+    /// @brief statistics of the consumable queue
+    /// They are only kept if the queue was built with a statistics policy 
+    /// (see queue_stats.h). Everything is 0 otherwise:
+    ///   ConsumerThread<int, SafeQueue<int, QueueStats> > consumer(...);
+    /// It can be called from any thread at any time
+    /// @param out_stats where the statistics are copied into
+    void GetQueueStats(QueueStatsSnapshot &out_stats) const;
+
 private:
     /// the worker thread
     std::unique_ptr<std::thread> m_producerThread;
 
-    /// flag to control if the execution of the thread must terminate
+    /// flag to tell the thread to stop consuming elements (JOIN_DROP)
     std::atomic<bool> m_terminate;
 
-    /// Delegate to the Consume function
-    std::function<void(T)> m_consumeDelegate;
+    /// Delegate to the Consume function. Elements are moved into it
+    ConsumeDelegate_t m_consumeDelegate;
 
     /// Delegate to the Init function
-    std::function<void()> m_initDelegate;
+    InitDelegate_t m_initDelegate;
+
+    /// Delegate called after each batch of elements is consumed
+    BatchEndDelegate_t m_batchEndDelegate;
+
+    /// Delegate to the span consume function. Empty unless in coalescing
+    /// mode
+    SpanDelegate_t m_spanDelegate;
+
+    /// watermarks. Set before anything is produced (see SetWatermarks). 
+    /// m_trackBacklog can be set without them (see TrackBacklog)
+    bool                m_trackBacklog;
+    std::size_t         m_highWatermark;
+    std::size_t         m_lowWatermark;
+    WatermarkDelegate_t m_onHighWatermark;
+    WatermarkDelegate_t m_onLowWatermark;
+
+    /// elements produced and not popped yet (see m_trackBacklog)
+    std::atomic<std::size_t> m_backlog;
+
+    /// true after m_onHighWatermark and before m_onLowWatermark are called
+    std::atomic<bool> m_aboveHighWatermark;
+
+    /// producers waiting in ProduceFor for space in the queue. The consumer
+    /// thread only takes m_spaceMutex to wake them up if there are any
+    std::atomic<int>        m_waitingProducers;
+    std::mutex              m_spaceMutex;
+    std::condition_variable m_spaceCond;
+    /// times the consumer woke up the producers. Protected by m_spaceMutex. 
+    /// The producers try to push without the lock, so they check it to know
+    /// if they missed a wake up in between
+    std::size_t             m_spaceSignals;
+
+    /// applied by the thread to itself before calling m_initDelegate
+    ConsumerThreadAttributes m_attributes;
 
     /// The queue with the data to be processed
-    SafeQueue<T> m_consumableQueue;
+    QUEUE_T m_consumableQueue;
 
     /// Creates the consumer thread calling to the necessary system functions
     void SpawnThread();
@@ -107,6 +357,31 @@ private:
     /// brief the routine that will be run by the consumer thread
     void ThreadRoutine();
 
+    /// @brief TryPush keeping track of the backlog
+    template <typename U>
+    inline bool TryProduce(U &&a_data);
+
+    /// @brief implementation of both ProduceFor
+    template <typename U>
+    bool ProduceForImpl(U &&a_data, std::chrono::microseconds a_timeout);
+
+    /// @brief to be called before an element is pushed. Returns the backlog
+    ///        including it
+    inline std::size_t AddBacklog();
+
+    /// @brief undoes AddBacklog when the element couldn't be pushed
+    inline void RemoveBacklog();
+
+    /// @brief to be called after an element was pushed. Calls the high 
+    ///        watermark delegate if needed
+    /// @param a_backlog what AddBacklog returned
+    inline void CheckHighWatermark(std::size_t a_backlog);
+
+    /// @brief to be called by the consumer thread after popping elements.
+    ///        Calls the low watermark delegate if needed and wakes up the 
+    ///        producers waiting for space
+    inline void Popped(std::size_t a_count);
+
     /// @brief dummy function 
     /// To be used when the user doesn't specify the init function
     static void DoNothing() {};
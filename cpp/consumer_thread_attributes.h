@@ -0,0 +1,96 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file  consumer_thread_attributes.h
+/// @brief Placement and scheduling attributes of a consumer thread
+/// CPU affinity, NUMA node, SCHED_FIFO priority and name of the thread. They
+/// are applied by the thread to itself when it starts, before the init 
+/// delegate is called, so anything allocated by the init delegate is already
+/// local to the CPUs the thread will run on
+///
+// ============================================================================
+
+#ifndef _CONSUMERTHREADATTRIBUTES_H_
+#define _CONSUMERTHREADATTRIBUTES_H_
+
+#include <string>
+#include <vector>
+
+// maximum NUMA node number that can be passed in the attributes
+#define CONSUMER_THREAD_MAX_NUMA_NODE 1023
+
+// maximum length of a thread name in linux (not counting the '\0'). Longer
+// names are truncated
+#define CONSUMER_THREAD_MAX_NAME_LEN 15
+
+/// @brief how a consumer thread must be placed and scheduled
+/// Every attribute is optional. A default constructed object leaves the thread
+/// as std::thread creates it
+struct ConsumerThreadAttributes
+{
+    /// @brief constructor
+    /// @param a_name name of the thread (pthread_setname_np). It is what 
+    ///        gdb, top -H or ps -L show. Empty means the name is not changed
+    /// @param a_cpus CPUs the thread can run on. Empty means no affinity (or 
+    ///        the CPUs of a_numaNode if a node is given)
+    /// @param a_numaNode NUMA node the thread must run on. Its memory is 
+    ///        allocated preferably from that node, and if a_cpus is empty the
+    ///        thread is pinned to the CPUs of the node. -1 means no node
+    /// @param a_fifoPriority real-time priority (SCHED_FIFO) of the thread, 
+    ///        from 1 to 99. 0 means the scheduling policy is not changed. It
+    ///        usually needs CAP_SYS_NICE (or an RLIMIT_RTPRIO limit)
+    explicit ConsumerThreadAttributes(
+        const std::string      &a_name         = std::string(),
+        const std::vector<int> &a_cpus         = std::vector<int>(),
+        int                     a_numaNode     = -1,
+        int                     a_fifoPriority = 0):
+        m_name(a_name),
+        m_cpus(a_cpus),
+        m_numaNode(a_numaNode),
+        m_fifoPriority(a_fifoPriority)
+    {}
+
+    std::string      m_name;
+    std::vector<int> m_cpus;
+    int              m_numaNode;
+    int              m_fifoPriority;
+
+    /// @brief apply the attributes to the calling thread
+    /// Every attribute is tried even if a previous one failed
+    /// @return true if all of them could be applied. False if the system 
+    ///         refused any of them (not enough privileges for SCHED_FIFO, 
+    ///         CPUs or node that don't exist...)
+    inline bool Apply() const;
+
+private:
+    inline bool ApplyName() const;
+    inline bool ApplyAffinity() const;
+    inline bool ApplyNumaNode() const;
+    inline bool ApplyFifoPriority() const;
+
+    /// @brief read the CPUs of a NUMA node from sysfs
+    /// @return false if the node doesn't exist
+    static inline bool ReadNodeCpus(int a_node, std::vector<int> &out_cpus);
+};
+
+#include "consumer_thread_attributes_impl.h"
+
+#endif /* _CONSUMERTHREADATTRIBUTES_H_ */
@@ -0,0 +1,189 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file  consumer_thread_attributes_impl.h
+/// @brief Implementation of the placement and scheduling attributes of a 
+///        consumer thread
+///
+// ============================================================================
+
+#ifndef _CONSUMERTHREADATTRIBUTESIMPL_H_
+#define _CONSUMERTHREADATTRIBUTESIMPL_H_
+
+#include <assert.h>
+#include <stdio.h>      // fopen, snprintf
+#include <string.h>     // memset
+#include <pthread.h>    // pthread_setname_np, pthread_setaffinity_np
+#include <sched.h>      // cpu_set_t, SCHED_FIFO
+#include <unistd.h>     // syscall
+#include <sys/syscall.h>// SYS_set_mempolicy
+
+// policy for set_mempolicy as defined in linux/mempolicy.h. numaif.h 
+// (libnuma) is not needed. Preferred (not bind) so the thread can still get
+// memory if its node runs out of it
+#define CONSUMER_THREAD_MPOL_PREFERRED 1
+
+inline bool ConsumerThreadAttributes::Apply() const
+{
+    bool rv = true;
+
+    // affinity is set before the memory policy. Whatever the kernel allocates
+    // for the thread from now on (the stack pages it touches...) is local
+    rv = ApplyName() && rv;
+    rv = ApplyAffinity() && rv;
+    rv = ApplyNumaNode() && rv;
+    rv = ApplyFifoPriority() && rv;
+
+    return rv;
+}
+
+inline bool ConsumerThreadAttributes::ApplyName() const
+{
+    if (m_name.empty())
+    {
+        return true;
+    }
+
+#ifdef __linux__
+    // pthread_setname_np fails with ERANGE on names over 16 bytes
+    std::string name = m_name.substr(0, CONSUMER_THREAD_MAX_NAME_LEN);
+    return (pthread_setname_np(pthread_self(), name.c_str()) == 0);
+#else
+    return false;
+#endif
+}
+
+inline bool ConsumerThreadAttributes::ApplyAffinity() const
+{
+    std::vector<int> cpus(m_cpus);
+    if (cpus.empty() && (m_numaNode >= 0))
+    {
+        if (!ReadNodeCpus(m_numaNode, cpus))
+        {
+            return false;
+        }
+    }
+
+    if (cpus.empty())
+    {
+        return true;
+    }
+
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (std::size_t i = 0; i < cpus.size(); i++)
+    {
+        if ((cpus[i] < 0) || (cpus[i] >= CPU_SETSIZE))
+        {
+            return false;
+        }
+        CPU_SET(cpus[i], &cpuSet);
+    }
+
+    return (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0);
+#else
+    return false;
+#endif
+}
+
+inline bool ConsumerThreadAttributes::ApplyNumaNode() const
+{
+    if (m_numaNode < 0)
+    {
+        return true;
+    }
+
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    if (m_numaNode > CONSUMER_THREAD_MAX_NUMA_NODE)
+    {
+        return false;
+    }
+
+    const std::size_t bitsPerLong = 8 * sizeof(unsigned long);
+    unsigned long nodeMask[(CONSUMER_THREAD_MAX_NUMA_NODE / (8 * sizeof(unsigned long))) + 1];
+    memset(nodeMask, 0, sizeof(nodeMask));
+    nodeMask[m_numaNode / bitsPerLong] |= (1UL << (m_numaNode % bitsPerLong));
+
+    // the kernel reads (maxnode - 1) bits of the mask
+    return (syscall(SYS_set_mempolicy, CONSUMER_THREAD_MPOL_PREFERRED, 
+                    nodeMask, (8 * sizeof(nodeMask)) + 1) == 0);
+#else
+    return false;
+#endif
+}
+
+inline bool ConsumerThreadAttributes::ApplyFifoPriority() const
+{
+    if (m_fifoPriority == 0)
+    {
+        return true;
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = m_fifoPriority;
+
+    return (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0);
+}
+
+inline bool ConsumerThreadAttributes::ReadNodeCpus(int a_node, std::vector<int> &out_cpus)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", a_node);
+
+    FILE* file = fopen(path, "r");
+    if (file == 0)
+    {
+        return false;
+    }
+
+    // the list looks like "0-3,8-11" (or just "0")
+    int first;
+    while (fscanf(file, "%d", &first) == 1)
+    {
+        int last = first;
+        int separator = fgetc(file);
+        if (separator == '-')
+        {
+            if (fscanf(file, "%d", &last) != 1)
+            {
+                break;
+            }
+            separator = fgetc(file);
+        }
+
+        for (int cpu = first; cpu <= last; cpu++)
+        {
+            out_cpus.push_back(cpu);
+        }
+
+        if (separator != ',')
+        {
+            break;
+        }
+    }
+    fclose(file);
+
+    return !out_cpus.empty();
+}
+
+#endif /* _CONSUMERTHREADATTRIBUTESIMPL_H_ */
@@ -35,33 +35,99 @@
 #define _CONSUMERTHREADIMPL_H_
 
 #include <assert.h>
+#include <vector>
+#include <algorithm> // std::min, std::max
+#include <limits>
+#include <utility> // std::move, std::forward
 
-// wake up timeout. The consumer thread will wake up when the timeout is hit
-// when there is no data to consume to check if it has been told to finish
-#define CONSUMER_THREAD_TIMEOUT_USEC 1000 // (1ms = 1000us)
+// maximum number of elements extracted from the queue per wake up. They are 
+// all popped with a single lock acquisition and then consumed one by one
+#define CONSUMER_THREAD_BATCH_SIZE 64
 
-template <typename T>
-ConsumerThread<T>::ConsumerThread(std::function<void(T)> a_consumeDelegate, std::function<void()>  a_initDelegate) :
+// maximum number of elements passed at once to the span delegate in 
+// coalescing mode. Spans start at CONSUMER_THREAD_BATCH_SIZE elements
+#define CONSUMER_THREAD_MAX_SPAN_SIZE 1024
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+ConsumerThread<T, QUEUE_T, DELEGATE_T>::ConsumerThread(ConsumeDelegate_t a_consumeDelegate, InitDelegate_t a_initDelegate, BatchEndDelegate_t a_batchEndDelegate) :
+    ConsumerThread(ConsumerThreadAttributes(), std::move(a_consumeDelegate), std::move(a_initDelegate), std::move(a_batchEndDelegate))
+{
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+ConsumerThread<T, QUEUE_T, DELEGATE_T>::ConsumerThread(std::size_t a_queueSize, ConsumeDelegate_t a_consumeDelegate, InitDelegate_t a_initDelegate, BatchEndDelegate_t a_batchEndDelegate) :
+    ConsumerThread(a_queueSize, ConsumerThreadAttributes(), std::move(a_consumeDelegate), std::move(a_initDelegate), std::move(a_batchEndDelegate))
+{
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+ConsumerThread<T, QUEUE_T, DELEGATE_T>::ConsumerThread(const ConsumerThreadAttributes &a_attributes, ConsumeDelegate_t a_consumeDelegate, InitDelegate_t a_initDelegate, BatchEndDelegate_t a_batchEndDelegate) :
     m_terminate(false),
-    m_consumeDelegate(a_consumeDelegate),
-    m_initDelegate(a_initDelegate),
+    m_consumeDelegate(std::move(a_consumeDelegate)),
+    m_initDelegate(std::move(a_initDelegate)),
+    m_batchEndDelegate(std::move(a_batchEndDelegate)),
+    m_spanDelegate(),
+    m_trackBacklog(false),
+    m_highWatermark(std::numeric_limits<std::size_t>::max()),
+    m_lowWatermark(0),
+    m_onHighWatermark(),
+    m_onLowWatermark(),
+    m_backlog(0),
+    m_aboveHighWatermark(false),
+    m_waitingProducers(0),
+    m_spaceSignals(0),
+    m_attributes(a_attributes),
     m_consumableQueue()
 {
     SpawnThread();
 }
 
-template <typename T>
-ConsumerThread<T>::ConsumerThread(std::size_t a_queueSize, std::function<void(T)> a_consumeDelegate, std::function<void()>  a_initDelegate) :
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+ConsumerThread<T, QUEUE_T, DELEGATE_T>::ConsumerThread(std::size_t a_queueSize, const ConsumerThreadAttributes &a_attributes, ConsumeDelegate_t a_consumeDelegate, InitDelegate_t a_initDelegate, BatchEndDelegate_t a_batchEndDelegate) :
     m_terminate(false),
-    m_consumeDelegate(a_consumeDelegate),
-    m_initDelegate(a_initDelegate),
+    m_consumeDelegate(std::move(a_consumeDelegate)),
+    m_initDelegate(std::move(a_initDelegate)),
+    m_batchEndDelegate(std::move(a_batchEndDelegate)),
+    m_spanDelegate(),
+    m_trackBacklog(false),
+    m_highWatermark(std::numeric_limits<std::size_t>::max()),
+    m_lowWatermark(0),
+    m_onHighWatermark(),
+    m_onLowWatermark(),
+    m_backlog(0),
+    m_aboveHighWatermark(false),
+    m_waitingProducers(0),
+    m_spaceSignals(0),
+    m_attributes(a_attributes),
     m_consumableQueue(a_queueSize)
 {
     SpawnThread();
 }
 
-template <typename T>
-ConsumerThread<T>::~ConsumerThread()
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+ConsumerThread<T, QUEUE_T, DELEGATE_T>::ConsumerThread(CoalesceMode, std::size_t a_queueSize, const ConsumerThreadAttributes &a_attributes, SpanDelegate_t a_spanDelegate, InitDelegate_t a_initDelegate, BatchEndDelegate_t a_batchEndDelegate) :
+    m_terminate(false),
+    m_consumeDelegate(),
+    m_initDelegate(std::move(a_initDelegate)),
+    m_batchEndDelegate(std::move(a_batchEndDelegate)),
+    m_spanDelegate(std::move(a_spanDelegate)),
+    m_trackBacklog(false),
+    m_highWatermark(std::numeric_limits<std::size_t>::max()),
+    m_lowWatermark(0),
+    m_onHighWatermark(),
+    m_onLowWatermark(),
+    m_backlog(0),
+    m_aboveHighWatermark(false),
+    m_waitingProducers(0),
+    m_spaceSignals(0),
+    m_attributes(a_attributes),
+    m_consumableQueue(a_queueSize)
+{
+    SpawnThread();
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+ConsumerThread<T, QUEUE_T, DELEGATE_T>::~ConsumerThread()
 {
     if (m_producerThread.get())
     {
@@ -69,8 +135,8 @@ ConsumerThread<T>::~ConsumerThread()
     }
 }
 
-template <typename T>
-void ConsumerThread<T>::SpawnThread()
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::SpawnThread()
 {
     m_producerThread.reset(
         new std::thread(std::bind(&ConsumerThread::ThreadRoutine, this)));
@@ -78,46 +144,348 @@ void ConsumerThread<T>::SpawnThread()
     //m_producerThread->detach(); // the consumer thread will run as no joinable
 }
 
-template <typename T>
-void ConsumerThread<T>::Join()
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::Join(JoinMode a_mode)
 {
-    m_terminate.store(true);
+    if (a_mode == JOIN_DROP)
+    {
+        m_terminate.store(true);
+    }
+
+    // wakes up the consumer if it was waiting for data. It finishes as soon
+    // as the queue is empty
+    m_consumableQueue.Close();
+
+    // and the producers waiting for space. Nothing can be produced anymore
+    {
+        std::lock_guard<std::mutex> lock(m_spaceMutex);
+        m_spaceCond.notify_all();
+    }
     
     m_producerThread->join();
     m_producerThread.reset();
 }
 
-template <typename T>
-bool ConsumerThread<T>::Produce(const T &a_data)
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+bool ConsumerThread<T, QUEUE_T, DELEGATE_T>::Produce(const T &a_data)
+{
+    assert(m_producerThread.get() != 0);
+
+    return TryProduce(a_data);
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+bool ConsumerThread<T, QUEUE_T, DELEGATE_T>::Produce(T &&a_data)
+{
+    assert(m_producerThread.get() != 0);
+
+    return TryProduce(std::move(a_data));
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+template <typename... ARGS>
+bool ConsumerThread<T, QUEUE_T, DELEGATE_T>::Emplace(ARGS&&... a_args)
+{
+    assert(m_producerThread.get() != 0);
+
+    std::size_t backlog = AddBacklog();
+    if (!m_consumableQueue.TryEmplace(std::forward<ARGS>(a_args)...))
+    {
+        RemoveBacklog();
+        return false;
+    }
+
+    CheckHighWatermark(backlog);
+    return true;
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::ProduceOrBlock(const T &a_data)
 {
     assert(m_producerThread.get() != 0);
+    
+    // the queue discards what is pushed once it is closed (Join), even if 
+    // the producer was already blocked waiting for space in it
+    std::size_t backlog = AddBacklog();
+    if (!m_consumableQueue.Push(a_data))
+    {
+        RemoveBacklog();
+        return;
+    }
 
-    return m_consumableQueue.TryPush(a_data);
+    CheckHighWatermark(backlog);
 }
 
-template <typename T>
-void ConsumerThread<T>::ProduceOrBlock(const T &a_data)
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::ProduceOrBlock(T &&a_data)
 {
     assert(m_producerThread.get() != 0);
     
-    m_consumableQueue.Push(a_data);
+    // the queue discards what is pushed once it is closed (Join), even if 
+    // the producer was already blocked waiting for space in it
+    std::size_t backlog = AddBacklog();
+    if (!m_consumableQueue.Push(std::move(a_data)))
+    {
+        RemoveBacklog();
+        return;
+    }
+
+    CheckHighWatermark(backlog);
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+template <typename... ARGS>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::EmplaceOrBlock(ARGS&&... a_args)
+{
+    assert(m_producerThread.get() != 0);
+    
+    // the queue discards what is pushed once it is closed (Join), even if 
+    // the producer was already blocked waiting for space in it
+    std::size_t backlog = AddBacklog();
+    if (!m_consumableQueue.Emplace(std::forward<ARGS>(a_args)...))
+    {
+        RemoveBacklog();
+        return;
+    }
+
+    CheckHighWatermark(backlog);
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+bool ConsumerThread<T, QUEUE_T, DELEGATE_T>::ProduceFor(const T &a_data, std::chrono::microseconds a_timeout)
+{
+    assert(m_producerThread.get() != 0);
+
+    return ProduceForImpl(a_data, a_timeout);
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+bool ConsumerThread<T, QUEUE_T, DELEGATE_T>::ProduceFor(T &&a_data, std::chrono::microseconds a_timeout)
+{
+    assert(m_producerThread.get() != 0);
+
+    return ProduceForImpl(std::move(a_data), a_timeout);
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::SetWatermarks(std::size_t a_high, std::size_t a_low, WatermarkDelegate_t a_onHigh, WatermarkDelegate_t a_onLow)
+{
+    assert(a_high > a_low);
+
+    m_highWatermark = a_high;
+    m_lowWatermark = a_low;
+    m_onHighWatermark = std::move(a_onHigh);
+    m_onLowWatermark = std::move(a_onLow);
+    m_trackBacklog = true;
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::TrackBacklog()
+{
+    m_trackBacklog = true;
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+std::size_t ConsumerThread<T, QUEUE_T, DELEGATE_T>::Backlog() const
+{
+    return m_backlog.load(std::memory_order_relaxed);
 }
 
-template <typename T>
-void ConsumerThread<T>::ThreadRoutine()
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+bool ConsumerThread<T, QUEUE_T, DELEGATE_T>::IsAboveHighWatermark() const
 {
+    return m_aboveHighWatermark.load(std::memory_order_relaxed);
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::GetQueueStats(QueueStatsSnapshot &out_stats) const
+{
+    m_consumableQueue.GetStats(out_stats);
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::ThreadRoutine()
+{
+    // placement and scheduling first, so the init function already runs 
+    // where the thread will consume. Best effort (see the constructor)
+    this->m_attributes.Apply();
+
     // init function
     this->m_initDelegate();
 
-    // loop to check if the thread must be terminated
+    // elements are drained in batches to pay for the queue's lock only once
+    // per batch. In coalescing mode the batch grows while the queue has more
+    // elements than fit in it
+    const bool coalesce = static_cast<bool>(this->m_spanDelegate);
+    std::vector<T> batch(coalesce ? CONSUMER_THREAD_MAX_SPAN_SIZE : CONSUMER_THREAD_BATCH_SIZE);
+    std::size_t maxCount = CONSUMER_THREAD_BATCH_SIZE;
+
+    // the thread sleeps in the queue while there is nothing to consume. It
+    // finishes when the queue is closed and empty (or straight away if it is
+    // told to drop the elements left)
     while (this->m_terminate.load() == false)
     {
-        T thisElem;
-        if (this->m_consumableQueue.TimedWaitPop(
-            thisElem, std::chrono::microseconds(CONSUMER_THREAD_TIMEOUT_USEC)))
+        std::size_t count = this->m_consumableQueue.WaitPopBulk(
+            &batch[0], maxCount);
+        if (count == 0)
+        {
+            // closed and drained
+            break;
+        }
+        this->Popped(count);
+
+        if (coalesce)
+        {
+            if (this->m_terminate.load() == false)
+            {
+                this->m_spanDelegate(&batch[0], count);
+            }
+
+            // doubled while the backlog fills the batch, halved once it 
+            // falls under a quarter of it
+            if ((count == maxCount) && (maxCount < batch.size()))
+            {
+                maxCount = std::min(2 * maxCount, batch.size());
+            }
+            else if ((count <= maxCount / 4) && (maxCount > CONSUMER_THREAD_BATCH_SIZE))
+            {
+                maxCount = std::max<std::size_t>(maxCount / 2, CONSUMER_THREAD_BATCH_SIZE);
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; 
+                 (i < count) && (this->m_terminate.load() == false); 
+                 i++)
+            {
+                // the consumed element is moved out of the batch into the 
+                // delegate's parameter. It's not used here anymore
+                this->m_consumeDelegate(std::move(batch[i]));
+            }
+        }
+
+        this->m_batchEndDelegate();
+    }
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+template <typename U>
+bool ConsumerThread<T, QUEUE_T, DELEGATE_T>::TryProduce(U &&a_data)
+{
+    std::size_t backlog = AddBacklog();
+    if (!m_consumableQueue.TryPush(std::forward<U>(a_data)))
+    {
+        RemoveBacklog();
+        return false;
+    }
+
+    CheckHighWatermark(backlog);
+    return true;
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+template <typename U>
+bool ConsumerThread<T, QUEUE_T, DELEGATE_T>::ProduceForImpl(U &&a_data, std::chrono::microseconds a_timeout)
+{
+    // a_data is only moved from if it gets pushed, so it can be tried again
+    if (TryProduce(std::forward<U>(a_data)))
+    {
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point deadline = 
+        std::chrono::steady_clock::now() + a_timeout;
+
+    // the consumer checks if there are producers waiting after popping. 
+    // Either it sees this one or this one sees the space it made
+    m_waitingProducers.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // TryProduce may call the high watermark delegate, which may be slow or 
+    // produce too, so the lock is only held to wait. A wake up that comes 
+    // while it is released shows up in m_spaceSignals
+    bool produced = false;
+    std::unique_lock<std::mutex> lock(m_spaceMutex);
+    for (;;)
+    {
+        std::size_t spaceSignals = m_spaceSignals;
+        lock.unlock();
+
+        produced = TryProduce(std::forward<U>(a_data));
+        if (produced || 
+            m_consumableQueue.IsClosed() || 
+            (std::chrono::steady_clock::now() >= deadline))
         {
-            this->m_consumeDelegate(thisElem);
+            break;
         }
+
+        lock.lock();
+        m_spaceCond.wait_until(lock, deadline, 
+            [this, spaceSignals]()
+            {
+                return (m_spaceSignals != spaceSignals) || 
+                       m_consumableQueue.IsClosed();
+            });
+    }
+
+    m_waitingProducers.fetch_sub(1);
+    return produced;
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+std::size_t ConsumerThread<T, QUEUE_T, DELEGATE_T>::AddBacklog()
+{
+    if (!m_trackBacklog)
+    {
+        return 0;
+    }
+    return m_backlog.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::RemoveBacklog()
+{
+    if (m_trackBacklog)
+    {
+        m_backlog.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::CheckHighWatermark(std::size_t a_backlog)
+{
+    // the exchange makes sure only one producer calls the delegate
+    if (m_trackBacklog && 
+        (a_backlog >= m_highWatermark) && 
+        !m_aboveHighWatermark.load(std::memory_order_relaxed) &&
+        !m_aboveHighWatermark.exchange(true))
+    {
+        m_onHighWatermark(a_backlog);
+    }
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void ConsumerThread<T, QUEUE_T, DELEGATE_T>::Popped(std::size_t a_count)
+{
+    if (m_trackBacklog)
+    {
+        std::size_t backlog = 
+            m_backlog.fetch_sub(a_count, std::memory_order_relaxed) - a_count;
+        if ((backlog <= m_lowWatermark) && 
+            m_aboveHighWatermark.load(std::memory_order_relaxed) &&
+            m_aboveHighWatermark.exchange(false))
+        {
+            m_onLowWatermark(backlog);
+        }
+    }
+
+    // see ProduceForImpl
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waitingProducers.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_spaceMutex);
+        m_spaceSignals++;
+        m_spaceCond.notify_all();
     }
 }
 
@@ -0,0 +1,228 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file  consumer_thread_pool.h
+/// @brief A pool of consumer threads with work stealing
+/// Same delegate model as ConsumerThread: the consume delegate is called per
+/// element and the init delegate is called once from each worker. Every 
+/// worker has a local queue, and idle workers steal elements from the 
+/// queues of busy ones so an expensive element doesn't hold back the ones 
+/// produced after it. Elements produced with a key always go to the same 
+/// worker and are never stolen, so they are consumed in order per key
+///
+/// Your compiler must have support for c++11. This is an example of how to 
+/// compile an application that makes use of this pool with gcc 4.8:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c app.cpp
+///   $ g++ app.o -o app
+///
+// ============================================================================
+
+#ifndef _CONSUMERTHREADPOOL_H_
+#define _CONSUMERTHREADPOOL_H_
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory> // std::unique_ptr
+#include "safe_queue.h" // SAFE_QUEUE_DEFAULT_MAX_SIZE
+
+/// @brief a set of threads that consume the elements pushed into the pool
+///        calling a delegate per element
+/// The consume delegate is called concurrently from all the workers
+template <typename T>
+class ConsumerThreadPool
+{
+public:
+    /// @brief what happens to the elements still in the queues when the 
+    ///        pool is told to finish (see Join)
+    enum JoinMode
+    {
+        /// the elements already in the queues are consumed before the 
+        /// workers finish
+        JOIN_DRAIN,
+        /// every worker finishes after the element it is consuming. The rest
+        /// are destroyed with the pool
+        JOIN_DROP
+    };
+
+    /// @brief ConsumerThreadPool constructor
+    /// @param a_nWorkers number of worker threads. It must be at least 1
+    /// @param a_consumeDelegate delegate to the function to be called per 
+    ///        consumable. It is called from every worker thread
+    /// @param a_initDelegate a delegate to the initialise function. It does 
+    ///        nothing by default. It gets called once from the context of 
+    ///        every worker thread, before it consumes anything
+    /// @param a_workerQueueSize maximum number of elements in the local queue
+    ///        of a worker
+    ConsumerThreadPool(
+        std::size_t            a_nWorkers,
+        std::function<void(T)> a_consumeDelegate,
+        std::function<void( )> a_initDelegate = std::bind(&ConsumerThreadPool::DoNothing),
+        std::size_t            a_workerQueueSize = SAFE_QUEUE_DEFAULT_MAX_SIZE);
+
+    virtual ~ConsumerThreadPool();
+
+    /// @brief number of worker threads in the pool
+    std::size_t GetNumWorkers() const;
+
+    /// @brief Tell the workers to finish and wait until they do so
+    /// Nothing else can be produced after that, and workers waiting for data
+    /// are woken up straight away
+    /// @param a_mode what to do with the elements still in the queues. They 
+    ///        are consumed by default
+    void Join(JoinMode a_mode = JOIN_DRAIN);
+
+    /// @brief inserts data into the pool to be consumed by any of the workers
+    /// Elements are handed out to the workers' queues in round robin, but 
+    /// they can be stolen by any idle worker
+    /// @param a const reference to the element to insert
+    /// @return true if the element was successfully inserted. False if the 
+    ///         queue of the chosen worker was full or Join was already called
+    bool Produce(const T &a_data);
+
+    /// @brief moves data into the pool to be consumed by any of the workers
+    /// a_data is not modified if the element can't be inserted
+    /// @param an rvalue reference to the element to move into the pool
+    /// @return true if the element was successfully inserted. False if the 
+    ///         queue of the chosen worker was full or Join was already called
+    bool Produce(T &&a_data);
+
+    /// @brief inserts data into the pool to be consumed by the worker a_key 
+    ///        is mapped to
+    /// All the elements produced with the same key go to the same worker and
+    /// can't be stolen, so they are consumed in the order they were produced
+    /// @param a_key routing key (std::hash can be used to get it, for 
+    ///        instance). Elements are sent to worker a_key % GetNumWorkers()
+    /// @param a const reference to the element to insert
+    /// @return true if the element was successfully inserted. False if the 
+    ///         queue of the worker was full or Join was already called
+    bool ProduceWithKey(std::size_t a_key, const T &a_data);
+
+    /// @brief moves data into the pool to be consumed by the worker a_key 
+    ///        is mapped to. See ProduceWithKey
+    /// a_data is not modified if the element can't be inserted
+    bool ProduceWithKey(std::size_t a_key, T &&a_data);
+
+private:
+    /// @brief everything the pool keeps per worker thread
+    struct Worker
+    {
+        Worker():
+            m_stealable(),
+            m_affine(),
+            m_stolen(),
+            m_mutex(),
+            m_sleeping(false),
+            m_signalled(false),
+            m_wakeUp(),
+            m_thread()
+        {}
+
+        /// elements any worker can consume. The owner pops from the front, 
+        /// thieves take them from the back
+        std::deque<T> m_stealable;
+        /// elements produced with a key. Only the owner consumes them
+        std::deque<T> m_affine;
+        /// scratch space where the owner keeps what it steals from others
+        std::vector<T> m_stolen;
+        /// protects m_stealable and m_affine
+        std::mutex m_mutex;
+
+        /// the worker is waiting in m_wakeUp (protected by m_idleMutex)
+        bool m_sleeping;
+        /// someone told the worker to wake up (protected by m_idleMutex)
+        bool m_signalled;
+        /// where the worker sleeps when there is nothing to consume
+        std::condition_variable m_wakeUp;
+
+        /// the worker thread
+        std::unique_ptr<std::thread> m_thread;
+    };
+
+    /// the workers of the pool
+    std::vector<std::unique_ptr<Worker> > m_workers;
+
+    /// Delegate to the Consume function. Elements are moved into it
+    std::function<void(T)> m_consumeDelegate;
+
+    /// Delegate to the Init function
+    std::function<void()> m_initDelegate;
+
+    /// maximum number of elements in the local queue of a worker
+    std::size_t m_workerQueueSize;
+
+    /// next worker an element without key will be given to
+    std::atomic<std::size_t> m_nextWorker;
+
+    /// set by Join. Nothing can be produced anymore
+    std::atomic<bool> m_closed;
+
+    /// flag to tell the workers to stop consuming elements (JOIN_DROP)
+    std::atomic<bool> m_terminate;
+
+    /// protects the sleeping state of the workers
+    std::mutex m_idleMutex;
+
+    /// number of sleeping workers. Producers only take m_idleMutex if it 
+    /// isn't 0
+    std::atomic<std::size_t> m_sleepers;
+
+    /// @brief insert an element into the queue of a worker and wake up 
+    ///        someone to consume it
+    template <typename U>
+    bool ProduceTo(std::size_t a_worker, bool a_stealable, U &&a_data);
+
+    /// @brief wake up a_worker if it is sleeping. If it is not and the 
+    ///        element can be stolen, wake up any other sleeping worker
+    void WakeUp(std::size_t a_worker, bool a_stealable);
+
+    /// @brief get the next element from the worker's own queues
+    bool PopLocal(std::size_t a_worker, T &out_data);
+
+    /// @brief take half of the stealable elements from another worker
+    bool Steal(std::size_t a_worker, T &out_data);
+
+    /// @brief check if there is anything a_worker could consume
+    /// It assumes the caller holds m_idleMutex
+    bool HasWork(std::size_t a_worker);
+
+    /// @brief put a_worker to sleep until there is something to consume or
+    ///        the pool is closed
+    void Sleep(std::size_t a_worker);
+
+    /// @brief the routine that will be run by every worker thread
+    void ThreadRoutine(std::size_t a_worker);
+
+    /// @brief dummy function 
+    /// To be used when the user doesn't specify the init function
+    static void DoNothing() {};
+
+    /// @brief disable copy constructor declaring it private
+    ConsumerThreadPool(const ConsumerThreadPool<T> &a_src);
+};
+
+#include "consumer_thread_pool_impl.h"
+
+#endif /* _CONSUMERTHREADPOOL_H_ */
@@ -0,0 +1,342 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file  consumer_thread_pool_impl.h
+/// @brief This file contains the ConsumerThreadPool class implementation.
+///
+// ============================================================================
+
+#ifndef _CONSUMERTHREADPOOLIMPL_H_
+#define _CONSUMERTHREADPOOLIMPL_H_
+
+#include <assert.h>
+#include <utility> // std::move, std::forward
+
+template <typename T>
+ConsumerThreadPool<T>::ConsumerThreadPool(
+    std::size_t            a_nWorkers,
+    std::function<void(T)> a_consumeDelegate,
+    std::function<void( )> a_initDelegate,
+    std::size_t            a_workerQueueSize) :
+    m_workers(),
+    m_consumeDelegate(a_consumeDelegate),
+    m_initDelegate(a_initDelegate),
+    m_workerQueueSize(a_workerQueueSize),
+    m_nextWorker(0),
+    m_closed(false),
+    m_terminate(false),
+    m_idleMutex(),
+    m_sleepers(0)
+{
+    assert(a_nWorkers > 0);
+
+    // every worker must exist before any thread starts stealing
+    for (std::size_t i = 0; i < a_nWorkers; i++)
+    {
+        m_workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    }
+
+    for (std::size_t i = 0; i < a_nWorkers; i++)
+    {
+        m_workers[i]->m_thread.reset(new std::thread(
+            std::bind(&ConsumerThreadPool::ThreadRoutine, this, i)));
+    }
+}
+
+template <typename T>
+ConsumerThreadPool<T>::~ConsumerThreadPool()
+{
+    if (m_workers[0]->m_thread.get())
+    {
+        Join();
+    }
+}
+
+template <typename T>
+std::size_t ConsumerThreadPool<T>::GetNumWorkers() const
+{
+    return m_workers.size();
+}
+
+template <typename T>
+void ConsumerThreadPool<T>::Join(JoinMode a_mode)
+{
+    assert(m_workers[0]->m_thread.get() != 0);
+
+    if (a_mode == JOIN_DROP)
+    {
+        m_terminate.store(true);
+    }
+
+    {
+        // workers check m_closed holding m_idleMutex before going to sleep
+        std::lock_guard<std::mutex> lk(m_idleMutex);
+        m_closed.store(true);
+
+        for (std::size_t i = 0; i < m_workers.size(); i++)
+        {
+            m_workers[i]->m_wakeUp.notify_one();
+        }
+    }
+
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        m_workers[i]->m_thread->join();
+        m_workers[i]->m_thread.reset();
+    }
+}
+
+template <typename T>
+bool ConsumerThreadPool<T>::Produce(const T &a_data)
+{
+    return ProduceTo(
+        m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size(), 
+        true, 
+        a_data);
+}
+
+template <typename T>
+bool ConsumerThreadPool<T>::Produce(T &&a_data)
+{
+    return ProduceTo(
+        m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size(), 
+        true, 
+        std::move(a_data));
+}
+
+template <typename T>
+bool ConsumerThreadPool<T>::ProduceWithKey(std::size_t a_key, const T &a_data)
+{
+    return ProduceTo(a_key % m_workers.size(), false, a_data);
+}
+
+template <typename T>
+bool ConsumerThreadPool<T>::ProduceWithKey(std::size_t a_key, T &&a_data)
+{
+    return ProduceTo(a_key % m_workers.size(), false, std::move(a_data));
+}
+
+template <typename T>
+template <typename U>
+bool ConsumerThreadPool<T>::ProduceTo(std::size_t a_worker, bool a_stealable, U &&a_data)
+{
+    Worker &worker = *m_workers[a_worker];
+    bool wakeUpNeeded;
+    {
+        std::lock_guard<std::mutex> lk(worker.m_mutex);
+
+        // m_closed is checked with the worker's mutex held. A worker that 
+        // saw the pool closed and its queues empty won't get anything else
+        if (m_closed.load() ||
+            ((worker.m_stealable.size() + worker.m_affine.size()) >= m_workerQueueSize))
+        {
+            return false;
+        }
+
+        if (a_stealable)
+        {
+            worker.m_stealable.push_back(std::forward<U>(a_data));
+        }
+        else
+        {
+            worker.m_affine.push_back(std::forward<U>(a_data));
+        }
+
+        // read with the worker's mutex held: a worker about to sleep 
+        // increments m_sleepers before checking (locking this same mutex) if
+        // there is work. Either it finds this element, or this sees it 
+        wakeUpNeeded = (m_sleepers.load() > 0);
+    }
+
+    if (wakeUpNeeded)
+    {
+        WakeUp(a_worker, a_stealable);
+    }
+
+    return true;
+}
+
+template <typename T>
+void ConsumerThreadPool<T>::WakeUp(std::size_t a_worker, bool a_stealable)
+{
+    std::lock_guard<std::mutex> lk(m_idleMutex);
+
+    Worker &worker = *m_workers[a_worker];
+    if (worker.m_sleeping)
+    {
+        worker.m_signalled = true;
+        worker.m_wakeUp.notify_one();
+    }
+    else if (a_stealable)
+    {
+        // the owner is busy. Anyone else can take the element
+        for (std::size_t i = 0; i < m_workers.size(); i++)
+        {
+            Worker &thief = *m_workers[i];
+            if (thief.m_sleeping && !thief.m_signalled)
+            {
+                thief.m_signalled = true;
+                thief.m_wakeUp.notify_one();
+                break;
+            }
+        }
+    }
+}
+
+template <typename T>
+bool ConsumerThreadPool<T>::PopLocal(std::size_t a_worker, T &out_data)
+{
+    Worker &worker = *m_workers[a_worker];
+    std::lock_guard<std::mutex> lk(worker.m_mutex);
+
+    if (!worker.m_affine.empty())
+    {
+        out_data = std::move(worker.m_affine.front());
+        worker.m_affine.pop_front();
+        return true;
+    }
+    else if (!worker.m_stealable.empty())
+    {
+        out_data = std::move(worker.m_stealable.front());
+        worker.m_stealable.pop_front();
+        return true;
+    }
+
+    return false;
+}
+
+template <typename T>
+bool ConsumerThreadPool<T>::Steal(std::size_t a_worker, T &out_data)
+{
+    Worker &self = *m_workers[a_worker];
+
+    for (std::size_t i = 1; i < m_workers.size(); i++)
+    {
+        Worker &victim = *m_workers[(a_worker + i) % m_workers.size()];
+        {
+            std::lock_guard<std::mutex> lk(victim.m_mutex);
+
+            // half of what the victim has (rounded up) from the back of its
+            // queue, the side its owner will get to last
+            std::size_t count = (victim.m_stealable.size() + 1) / 2;
+            for (std::size_t j = 0; j < count; j++)
+            {
+                self.m_stolen.push_back(std::move(victim.m_stealable.back()));
+                victim.m_stealable.pop_back();
+            }
+        }
+
+        // the victim's lock is released before taking our own. Two workers
+        // stealing from each other would deadlock otherwise
+        if (!self.m_stolen.empty())
+        {
+            out_data = std::move(self.m_stolen.back());
+            self.m_stolen.pop_back();
+
+            if (!self.m_stolen.empty())
+            {
+                std::lock_guard<std::mutex> lk(self.m_mutex);
+                for (std::size_t j = 0; j < self.m_stolen.size(); j++)
+                {
+                    self.m_stealable.push_back(std::move(self.m_stolen[j]));
+                }
+            }
+            self.m_stolen.clear();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <typename T>
+bool ConsumerThreadPool<T>::HasWork(std::size_t a_worker)
+{
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        Worker &worker = *m_workers[i];
+        std::lock_guard<std::mutex> lk(worker.m_mutex);
+
+        if ((!worker.m_stealable.empty()) || 
+            ((i == a_worker) && (!worker.m_affine.empty())))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <typename T>
+void ConsumerThreadPool<T>::Sleep(std::size_t a_worker)
+{
+    Worker &self = *m_workers[a_worker];
+    std::unique_lock<std::mutex> lk(m_idleMutex);
+
+    self.m_sleeping = true;
+    m_sleepers.fetch_add(1);
+
+    // anything produced from now on will find m_sleepers > 0 and wake this
+    // worker up. Check what was produced before
+    if (!HasWork(a_worker))
+    {
+        while ((!self.m_signalled) && (!m_closed.load()))
+        {
+            self.m_wakeUp.wait(lk);
+        }
+    }
+
+    m_sleepers.fetch_sub(1);
+    self.m_signalled = false;
+    self.m_sleeping = false;
+}
+
+template <typename T>
+void ConsumerThreadPool<T>::ThreadRoutine(std::size_t a_worker)
+{
+    // init function
+    this->m_initDelegate();
+
+    T data;
+    while (this->m_terminate.load() == false)
+    {
+        // m_closed must be read before looking for work. Nothing can be 
+        // produced once it is set, so if it was already set and there is 
+        // nothing to consume the worker is done
+        bool closed = this->m_closed.load();
+
+        if (PopLocal(a_worker, data) || Steal(a_worker, data))
+        {
+            this->m_consumeDelegate(std::move(data));
+        }
+        else if (closed)
+        {
+            break;
+        }
+        else
+        {
+            Sleep(a_worker);
+        }
+    }
+}
+
+#endif /* _CONSUMERTHREADPOOLIMPL_H_ */
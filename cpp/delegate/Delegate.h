@@ -7,7 +7,7 @@
 /// certain behaviour but in reality delegates responsibility for implementing
 /// that behavior to an associated object in an Inversion of Responsibility
 ///
-/// It defines delegates from 0 arguments up to 8. Example of use
+/// It defines delegates with any number of arguments. Example of use
 ///
 /// // This defines a delegate that returns void and receives an UInt16 and a std::string
 /// Delegate<void(UInt16, std::string)> delegateFunction;
@@ -16,67 +16,303 @@
 /// delegateFunction = MakeDelegate(&obj, &A::f);
 /// // Actual call to the delegate
 /// delegateFunction(0, std::string("Hello world"));
+///
+/// A delegate can also be assigned a function that is not part of any class or
+/// a small function object such as a lambda:
+///
+/// delegateFunction = [&counter](UInt16 a_value, std::string) { counter += a_value; };
+///
+/// Member functions are called through a single member function pointer, the
+/// same way FastDelegate does (detail/FastDelegate.h). Function objects are
+/// stored inside the delegate, so a delegate never allocates memory. Because of
+/// that they must fit in DELEGATE_INPLACE_SIZE bytes and be trivially copyable
+/// and destructible: a lambda capturing pointers, references or numbers is fine,
+/// a lambda capturing a std::string by value doesn't compile. Delegates are
+/// then trivially copyable themselves, they can be moved around with memcpy
+/// (inside a queue, a vector...) and they can replace a std::function of the
+/// same signature (see ConsumerThread and VTimer)
+///
+/// Delegate used to derive from fastdelegate::FastDelegate. It doesn't 
+/// anymore, but a FastDelegate of the same signature (Base_t, up to 8 
+/// arguments) can still be converted and assigned to a Delegate
 
 
 #ifndef DELEGATE_H_
 #define DELEGATE_H_
 
+#include <string.h> // memset, memcmp
+#include <assert.h>
+#include <new>      // placement new
+#include <utility>  // std::forward
+#include <type_traits>
+
+// FastDelegate checks the size of member function pointers using typedefs
+// gcc warns about when they are not used
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-local-typedefs"
+#endif
 #include "detail/FastDelegate.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+// Maximum size in bytes of a function object stored in a delegate. Enough
+// for a lambda capturing 4 pointers
+#define DELEGATE_INPLACE_SIZE (4 * sizeof(void*))
 
 // Define Delegate as a template to be able to use the same name for
-// all the different Delegate templates (there is one template per number
-// of parameters)
+// all the different signatures
 template <typename Signature>
 class Delegate;
 
-///@brief Delegate for functions with 0 arguments
-template<typename RETURN_TYPE>
-class Delegate < RETURN_TYPE ( ) > :
-    public fastdelegate::FastDelegate < RETURN_TYPE ( ) >
+///@brief Delegate for functions with any number of arguments
+template<typename RETURN_TYPE, typename... ARGS>
+class Delegate < RETURN_TYPE ( ARGS... ) >
 {
 public:
-    typedef fastdelegate::FastDelegate < RETURN_TYPE ( ) > Base_t;
-
-    // default constructor&destructor
-    Delegate ()
-    {}
-    ~Delegate()
-    {}
-
-    // copy constructor
-    Delegate (const Delegate& source) :
-        Base_t(source)
-    {}
+    // default constructor. The delegate is empty
+    Delegate () :
+        m_object(0),
+        m_invoke(0)
+    {
+        memset(&m_storage, 0, sizeof(m_storage));
+    }
 
-    // RETURN_TYPE (X::*xMethod) (void) is the C++ way of describing a pointer to the function xMethod in the class X
+    // RETURN_TYPE (X::*xMethod) (ARGS...) is the C++ way of describing a pointer to the function xMethod in the class X
     template <class X, class Y>
-    Delegate (Y *pObject, RETURN_TYPE (X::*XMethod) ()) :
-        Base_t(pObject, XMethod)
-    {}
+    Delegate (Y *pObject, RETURN_TYPE (X::*xMethod) (ARGS...)) :
+        m_invoke(0)
+    {
+        memset(&m_storage, 0, sizeof(m_storage));
+        m_object = fastdelegate::detail::SimplifyMemFunc< sizeof(xMethod) >
+            ::Convert(static_cast<X*>(pObject), xMethod, m_storage.method);
+    }
 
     // The same as above but for const members
     template <class X, class Y>
-    Delegate (Y *pObject, RETURN_TYPE (X::*XConstMethod) () const) :
-        Base_t(pObject, XConstMethod)
-    {}
+    Delegate (const Y *pObject, RETURN_TYPE (X::*xMethod) (ARGS...) const) :
+        m_invoke(0)
+    {
+        memset(&m_storage, 0, sizeof(m_storage));
+        // since the member function is const it's safe to call it on a non
+        // const pointer
+        m_object = fastdelegate::detail::SimplifyMemFunc< sizeof(xMethod) >
+            ::Convert(const_cast<X*>(static_cast<const X*>(pObject)), xMethod, m_storage.method);
+    }
 
     // The same as above but for functions that are not part of any class
-    Delegate (RETURN_TYPE (*function) ()) :
-        Base_t(function)
-    {}
+    Delegate (RETURN_TYPE (*function) (ARGS...)) :
+        m_object(0),
+        m_invoke(0)
+    {
+        memset(&m_storage, 0, sizeof(m_storage));
+        if (function != 0)
+        {
+            StoreFunctor(function);
+        }
+    }
+
+    // function objects (lambdas...). They are copied inside the delegate
+    template <typename FUNCTOR_T,
+              typename = typename std::enable_if<
+                  !std::is_same<typename std::decay<FUNCTOR_T>::type, Delegate>::value>::type>
+    Delegate (FUNCTOR_T functor) :
+        m_object(0),
+        m_invoke(0)
+    {
+        memset(&m_storage, 0, sizeof(m_storage));
+        StoreFunctor(functor);
+    }
+
+    // the FastDelegate of the same signature. Only defined up to 8 arguments
+    typedef fastdelegate::FastDelegate < RETURN_TYPE ( ARGS... ) > Base_t;
+
+    // a delegate bound to what a FastDelegate is bound to
+    Delegate (const Base_t &source) :
+        m_object(0),
+        m_invoke(0)
+    {
+        memset(&m_storage, 0, sizeof(m_storage));
+        CopyFastDelegate(source);
+    }
 
-    // copying delegates
+    // copy constructor, operator= and destructor are the ones generated by the
+    // compiler, so the delegate is trivially copyable
+
+    // copying FastDelegates
     Delegate& operator= (const Base_t &source)
     {
-        *static_cast<Base_t*>(this) = source;
+        clear();
+        CopyFastDelegate(source);
         return *this;
     }
 
+    // calls the function the delegate is bound to. It must not be empty
+    inline RETURN_TYPE operator() (ARGS... args) const
+    {
+        if (m_invoke != 0)
+        {
+            return m_invoke(&m_storage, std::forward<ARGS>(args)...);
+        }
+
+        assert(m_object != 0);
+        return (m_object->*(m_storage.method))(std::forward<ARGS>(args)...);
+    }
+
+    // true if the delegate is not bound to anything
+    inline bool empty() const
+    {
+        return (m_object == 0) && (m_invoke == 0);
+    }
+
+    // unbinds the delegate
+    inline void clear()
+    {
+        m_object = 0;
+        m_invoke = 0;
+        memset(&m_storage, 0, sizeof(m_storage));
+    }
+
     // operator to check if the Delegate is valid. It would be the same as !(!Delegate)
     // so using !Delegate is faster
     operator bool () const
     {
-        return !(static_cast<const Base_t*>(this)->empty());
+        return !empty();
+    }
+
+    inline bool operator! () const
+    {
+        return empty();
+    }
+
+    // two delegates are equal if they are bound to the same member function of
+    // the same object or to the same function. Function objects are compared
+    // byte by byte: a delegate is equal to its copies, but two delegates made
+    // from equal function objects might not be (the padding between their 
+    // members is compared too), so equality is only meaningful for member
+    // and free function delegates
+    inline bool operator== (const Delegate &other) const
+    {
+        if (m_invoke != other.m_invoke)
+        {
+            return false;
+        }
+        if (m_invoke == 0)
+        {
+            // member functions, and empty delegates. The storage after the
+            // member function pointer is not part of it
+            return (m_object == other.m_object) &&
+                   (m_storage.method == other.m_storage.method);
+        }
+        return memcmp(&m_storage, &other.m_storage, sizeof(m_storage)) == 0;
+    }
+
+    inline bool operator!= (const Delegate &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    typedef RETURN_TYPE (fastdelegate::detail::GenericClass::*GenericMemFunc_t)(ARGS...);
+    typedef RETURN_TYPE (*Invoke_t)(const void*, ARGS...);
+    typedef RETURN_TYPE (*Function_t)(ARGS...);
+
+    /// object a member function is called on. 0 for the rest
+    fastdelegate::detail::GenericClass *m_object;
+
+    /// calls the function object in m_storage. 0 for member functions
+    Invoke_t m_invoke;
+
+    /// the member function or a copy of the function object
+    union Storage
+    {
+        GenericMemFunc_t method;
+        typename std::aligned_storage<DELEGATE_INPLACE_SIZE>::type inplace;
+    } m_storage;
+
+    template <typename FUNCTOR_T>
+    inline void StoreFunctor(const FUNCTOR_T &functor)
+    {
+        static_assert(sizeof(FUNCTOR_T) <= sizeof(m_storage.inplace),
+            "function object too big to be stored in a Delegate (see DELEGATE_INPLACE_SIZE)");
+        static_assert(std::alignment_of<FUNCTOR_T>::value <= std::alignment_of<Storage>::value,
+            "function object alignment not supported by Delegate");
+        static_assert(std::is_trivially_copyable<FUNCTOR_T>::value &&
+                      std::is_trivially_destructible<FUNCTOR_T>::value,
+            "Delegate only stores trivially copyable and destructible function objects");
+
+        new (&m_storage.inplace) FUNCTOR_T(functor);
+        m_invoke = &Delegate::template InvokeFunctor<FUNCTOR_T>;
+    }
+
+    /// reads the protected members of the storage of a FastDelegate
+    struct MementoReader : public fastdelegate::DelegateMemento
+    {
+        static fastdelegate::detail::GenericClass* Object(
+            const fastdelegate::DelegateMemento &memento)
+        {
+            return memento.*(&MementoReader::m_pthis);
+        }
+
+        static GenericMemFunc_t Method(const fastdelegate::DelegateMemento &memento)
+        {
+            return reinterpret_cast<GenericMemFunc_t>(memento.*(&MementoReader::m_pFunction));
+        }
+
+#if !defined(FASTDELEGATE_USESTATICFUNCTIONHACK)
+        static Function_t Function(const fastdelegate::DelegateMemento &memento)
+        {
+            return reinterpret_cast<Function_t>(memento.*(&MementoReader::m_pStaticFunction));
+        }
+#endif
+    };
+
+    // the delegate must be empty
+    inline void CopyFastDelegate(const Base_t &source)
+    {
+        // GetMemento doesn't modify the FastDelegate, it is just not const
+        const fastdelegate::DelegateMemento &memento = 
+            const_cast<Base_t&>(source).GetMemento();
+        fastdelegate::detail::GenericClass *object = MementoReader::Object(memento);
+
+        // free functions are called by FastDelegate through a member function
+        // of its own. They are stored as a plain function here
+#if !defined(FASTDELEGATE_USESTATICFUNCTIONHACK)
+        Function_t function = MementoReader::Function(memento);
+#else
+        // the function is kept in the object pointer. It is one if the member
+        // function is the one FastDelegate binds with free functions
+        Function_t function = 0;
+        if (object != 0)
+        {
+            function = fastdelegate::detail::horrible_cast<Function_t>(object);
+            Base_t probe(function);
+            if (MementoReader::Method(probe.GetMemento()) != MementoReader::Method(memento))
+            {
+                function = 0;
+            }
+        }
+#endif
+
+        if (function != 0)
+        {
+            StoreFunctor(function);
+        }
+        else if (object != 0)
+        {
+            m_object = object;
+            m_storage.method = MementoReader::Method(memento);
+        }
+    }
+
+    template <typename FUNCTOR_T>
+    static RETURN_TYPE InvokeFunctor(const void *storage, ARGS... args)
+    {
+        // function objects are allowed to modify themselves (mutable lambdas)
+        // like they do when called through a std::function
+        FUNCTOR_T &functor = *const_cast<FUNCTOR_T*>(static_cast<const FUNCTOR_T*>(storage));
+        return functor(std::forward<ARGS>(args)...);
     }
 };
 
@@ -84,59 +320,24 @@ public:
 // Global functions to create delegates
 
 // create a delegate to a non-const function
-template <class X, class Y, typename RETURN_TYPE>
-Delegate <RETURN_TYPE ()> MakeDelegate ( Y * pObject, RETURN_TYPE (X::*XMethod)() )
+template <class X, class Y, typename RETURN_TYPE, typename... ARGS>
+Delegate <RETURN_TYPE (ARGS...)> MakeDelegate ( Y * pObject, RETURN_TYPE (X::*XMethod)(ARGS...) )
 {
-    return Delegate <RETURN_TYPE ()>(pObject, XMethod);    // return Delegate on the stack
+    return Delegate <RETURN_TYPE (ARGS...)>(pObject, XMethod);    // return Delegate on the stack
 }
 
 // create a delegate to a const function
-template <class X, class Y, typename RETURN_TYPE>
-Delegate <RETURN_TYPE ()> MakeDelegate ( const Y * pObject, RETURN_TYPE (X::*XConstMethod)() const )
+template <class X, class Y, typename RETURN_TYPE, typename... ARGS>
+Delegate <RETURN_TYPE (ARGS...)> MakeDelegate ( const Y * pObject, RETURN_TYPE (X::*XConstMethod)(ARGS...) const )
 {
-    return Delegate <RETURN_TYPE ()>(pObject, XConstMethod);    // return Delegate on the stack
+    return Delegate <RETURN_TYPE (ARGS...)>(pObject, XConstMethod);    // return Delegate on the stack
 }
 
 // create a delegate to a static function (without object)
-template <typename RETURN_TYPE>
-Delegate <RETURN_TYPE ()> MakeDelegate ( RETURN_TYPE (*Function)() )
+template <typename RETURN_TYPE, typename... ARGS>
+Delegate <RETURN_TYPE (ARGS...)> MakeDelegate ( RETURN_TYPE (*Function)(ARGS...) )
 {
-    return Delegate <RETURN_TYPE ()>(Function);    // return Delegate on the stack
+    return Delegate <RETURN_TYPE (ARGS...)>(Function);    // return Delegate on the stack
 }
 
-// N_DELEGATE_ARGS is used as sort of a parameter to include the file detail/DelegateN.h
-// depending on that value DelegateN.h will define a Delegate with 1, 2, etc. parameters
-// The maximum is 8 since it is the maximum number of parameters defined in FastDelegate.h
-#undef  N_DELEGATE_ARGS
-#define N_DELEGATE_ARGS 1
-#include "detail/DelegateN.h"
-
-#undef  N_DELEGATE_ARGS
-#define N_DELEGATE_ARGS 2
-#include "detail/DelegateN.h"
-
-#undef  N_DELEGATE_ARGS
-#define N_DELEGATE_ARGS 3
-#include "detail/DelegateN.h"
-
-#undef  N_DELEGATE_ARGS
-#define N_DELEGATE_ARGS 4
-#include "detail/DelegateN.h"
-
-#undef  N_DELEGATE_ARGS
-#define N_DELEGATE_ARGS 5
-#include "detail/DelegateN.h"
-
-#undef  N_DELEGATE_ARGS
-#define N_DELEGATE_ARGS 6
-#include "detail/DelegateN.h"
-
-#undef  N_DELEGATE_ARGS
-#define N_DELEGATE_ARGS 7
-#include "detail/DelegateN.h"
-
-#undef  N_DELEGATE_ARGS
-#define N_DELEGATE_ARGS 8
-#include "detail/DelegateN.h"
-
 #endif /* DELEGATE_H_ */
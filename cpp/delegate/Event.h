@@ -0,0 +1,409 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file  Event.h
+/// @brief Multicast delegate. Calls every delegate subscribed to the event
+///
+/// The subscribed delegates (see Delegate.h) are kept in a contiguous array 
+/// which is never modified once it's published. Subscribe and Unsubscribe 
+/// build a copy with the change and swap it in as the current snapshot of 
+/// the subscribers (RCU style), so Fire reads the current snapshot and calls
+/// the delegates one after the other with no locks or allocations. Example:
+///
+/// Event<void(int)> onValue;
+/// onValue.Subscribe(MakeDelegate(&obj, &MyClass::OnValue));
+/// onValue.Subscribe([&total](int a_value) { total += a_value; });
+/// onValue.Fire(5); // or onValue(5)
+///
+/// Fire can be called from any number of threads while others subscribe and
+/// unsubscribe. Each call of Fire sees a complete snapshot: the delegates 
+/// subscribed before it started, minus the ones unsubscribed. Snapshots
+/// replaced are freed by Subscribe/Unsubscribe once the threads that might
+/// still be calling them are done, so those calls wait for the Fire calls in
+/// progress in other threads to return (never for the ones that start 
+/// later). Subscribing and unsubscribing from a delegate that is being 
+/// called by an event (this one or any other) is allowed. Those calls don't
+/// wait: the snapshots they replace are freed by the next change made from
+/// a thread that is not firing any event (or by the destructor). Two 
+/// threads firing different events whose delegates change each other's
+/// event would otherwise wait for each other forever
+///
+/// The return value of the delegates, if any, is ignored
+///
+/// Your compiler must have support for c++11
+// ============================================================================
+
+#ifndef _EVENT_H_
+#define _EVENT_H_
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uint64_t
+#include <assert.h>
+#include <atomic>
+#include <mutex>
+#include <thread>   // std::this_thread::yield
+#include <vector>
+#include "Delegate.h"
+
+// size in bytes of a cache line. The counters Fire updates are kept this far
+// from each other and from the snapshot pointer, which is only read
+#ifndef EVENT_CACHE_LINE_SIZE
+#define EVENT_CACHE_LINE_SIZE 64
+#endif
+
+/// @return number of Event::Fire calls in progress in the calling thread 
+///        (of any event), so an event knows if it is being changed from a 
+///        delegate
+inline unsigned& EventFiringDepth()
+{
+    static thread_local unsigned t_depth = 0;
+    return t_depth;
+}
+
+template <typename Signature>
+class Event;
+
+/// @brief multicast delegate with a Delegate<RETURN_TYPE(ARGS...)> per 
+///        subscriber
+template <typename RETURN_TYPE, typename... ARGS>
+class Event < RETURN_TYPE ( ARGS... ) >
+{
+public:
+    typedef Delegate<RETURN_TYPE(ARGS...)> Delegate_t;
+
+    Event();
+
+    /// @brief destructor. No thread can be firing the event anymore
+    ~Event();
+
+    /// @brief adds a_delegate to the end of the list of subscribers. The 
+    ///        same delegate can be subscribed more than once, it will be 
+    ///        called once per subscription
+    /// It allocates the new snapshot and might wait for Fire calls in 
+    /// progress in other threads
+    /// @param a_delegate. It must not be empty
+    void Subscribe(const Delegate_t &a_delegate);
+
+    /// @brief removes the first subscription of a delegate equal to a_delegate
+    /// (see Delegate::operator==)
+    /// @return true if a_delegate was subscribed. False otherwise
+    bool Unsubscribe(const Delegate_t &a_delegate);
+
+    /// @brief removes all the subscribers
+    void Clear();
+
+    /// @return number of subscribers
+    size_t Size() const;
+
+    /// @brief calls every delegate subscribed with a_args, in the order they
+    ///        were subscribed. Lock and allocation free. The calls made to
+    ///        the delegates are the only ones that might block
+    void Fire(ARGS... a_args) const;
+
+    /// @brief same as Fire
+    inline void operator() (ARGS... a_args) const
+    {
+        Fire(a_args...);
+    }
+
+private:
+    /// the subscribers as they were at a particular time. Never modified
+    /// once it is published
+    struct Snapshot
+    {
+        std::vector<Delegate_t> m_delegates;
+    };
+
+    /// current snapshot (0 when there are no subscribers)
+    std::atomic<Snapshot*> m_snapshot;
+
+    /// incremented each time a snapshot is replaced and the threads firing 
+    /// the event have to be waited for. Fire registers in the reader counter
+    /// this generation's parity points to
+    std::atomic<uint64_t> m_generation;
+
+    char m_padding[EVENT_CACHE_LINE_SIZE];
+
+    /// @brief number of Fire calls in progress registered in a generation 
+    ///        parity. Each one takes a whole cache line
+    struct Readers
+    {
+        std::atomic<size_t> m_count;
+        char m_padding[EVENT_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    };
+
+    /// number of Fire calls in progress per generation parity
+    mutable Readers m_readers[2];
+
+    /// serialises the changes to the list of subscribers. It is never held
+    /// while waiting for the threads firing the event, so the delegates can
+    /// subscribe and unsubscribe while another thread is waiting for them
+    mutable std::mutex m_writeMutex;
+
+    /// snapshots replaced that might still be in use by Fire calls
+    std::vector<Snapshot*> m_retired;
+
+    /// serialises the waits for the threads firing the event
+    std::mutex m_reclaimMutex;
+
+    /// @brief publishes a_newSnapshot as the current one. The old one is 
+    ///        retired. m_writeMutex must be locked
+    void PublishLocked(Snapshot *a_newSnapshot);
+
+    /// @brief frees the retired snapshots once nobody can be using them
+    void Reclaim();
+
+    /// @brief waits until no Fire call started before this one can still 
+    ///        be using a snapshot retired before it
+    void WaitForReaders();
+
+    // not copyable nor movable
+    Event(const Event&);
+    Event& operator=(const Event&);
+};
+
+template <typename RETURN_TYPE, typename... ARGS>
+Event<RETURN_TYPE(ARGS...)>::Event() :
+    m_snapshot(0),
+    m_generation(0),
+    m_writeMutex(),
+    m_retired(),
+    m_reclaimMutex()
+{
+    m_readers[0].m_count.store(0);
+    m_readers[1].m_count.store(0);
+}
+
+template <typename RETURN_TYPE, typename... ARGS>
+Event<RETURN_TYPE(ARGS...)>::~Event()
+{
+    assert(m_readers[0].m_count.load() == 0);
+    assert(m_readers[1].m_count.load() == 0);
+
+    for (size_t i = 0; i < m_retired.size(); i++)
+    {
+        delete m_retired[i];
+    }
+    delete m_snapshot.load();
+}
+
+template <typename RETURN_TYPE, typename... ARGS>
+void Event<RETURN_TYPE(ARGS...)>::Subscribe(const Delegate_t &a_delegate)
+{
+    assert(!a_delegate.empty());
+
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+
+        Snapshot *current = m_snapshot.load(std::memory_order_relaxed);
+        Snapshot *newSnapshot = new Snapshot();
+        if (current != 0)
+        {
+            newSnapshot->m_delegates.reserve(current->m_delegates.size() + 1);
+            newSnapshot->m_delegates = current->m_delegates;
+        }
+        newSnapshot->m_delegates.push_back(a_delegate);
+
+        PublishLocked(newSnapshot);
+    }
+
+    Reclaim();
+}
+
+template <typename RETURN_TYPE, typename... ARGS>
+bool Event<RETURN_TYPE(ARGS...)>::Unsubscribe(const Delegate_t &a_delegate)
+{
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+
+        Snapshot *current = m_snapshot.load(std::memory_order_relaxed);
+        if (current == 0)
+        {
+            return false;
+        }
+
+        const std::vector<Delegate_t> &delegates = current->m_delegates;
+        for (size_t i = 0; (i < delegates.size()) && !found; i++)
+        {
+            if (delegates[i] == a_delegate)
+            {
+                Snapshot *newSnapshot = 0;
+                if (delegates.size() > 1)
+                {
+                    newSnapshot = new Snapshot();
+                    newSnapshot->m_delegates.reserve(delegates.size() - 1);
+                    newSnapshot->m_delegates.insert(
+                        newSnapshot->m_delegates.end(), delegates.begin(), delegates.begin() + i);
+                    newSnapshot->m_delegates.insert(
+                        newSnapshot->m_delegates.end(), delegates.begin() + i + 1, delegates.end());
+                }
+
+                PublishLocked(newSnapshot);
+                found = true;
+            }
+        }
+    }
+
+    if (found)
+    {
+        Reclaim();
+    }
+    return found;
+}
+
+template <typename RETURN_TYPE, typename... ARGS>
+void Event<RETURN_TYPE(ARGS...)>::Clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+
+        if (m_snapshot.load(std::memory_order_relaxed) != 0)
+        {
+            PublishLocked(0);
+        }
+    }
+
+    Reclaim();
+}
+
+template <typename RETURN_TYPE, typename... ARGS>
+size_t Event<RETURN_TYPE(ARGS...)>::Size() const
+{
+    // the snapshot can't be freed while the write lock is held
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+
+    Snapshot *current = m_snapshot.load(std::memory_order_relaxed);
+    return (current == 0) ? 0 : current->m_delegates.size();
+}
+
+template <typename RETURN_TYPE, typename... ARGS>
+void Event<RETURN_TYPE(ARGS...)>::Fire(ARGS... a_args) const
+{
+    // registers this call in the reader counter of the current generation.
+    // If a new generation started in the meantime the writer might not be 
+    // waiting for this counter, so it registers again in the new one
+    size_t readerIndex;
+    while (true)
+    {
+        uint64_t generation = m_generation.load();
+        readerIndex = static_cast<size_t>(generation & 1);
+        m_readers[readerIndex].m_count.fetch_add(1);
+        if (m_generation.load() == generation)
+        {
+            break;
+        }
+        m_readers[readerIndex].m_count.fetch_sub(1);
+    }
+
+    // unregisters even if a delegate throws
+    struct Guard
+    {
+        std::atomic<size_t> &m_readers;
+
+        Guard(std::atomic<size_t> &a_readers) :
+            m_readers(a_readers)
+        {
+            EventFiringDepth()++;
+        }
+
+        ~Guard()
+        {
+            EventFiringDepth()--;
+            m_readers.fetch_sub(1);
+        }
+    } guard(m_readers[readerIndex].m_count);
+
+    const Snapshot *snapshot = m_snapshot.load();
+    if (snapshot != 0)
+    {
+        const Delegate_t *delegates = snapshot->m_delegates.data();
+        size_t count = snapshot->m_delegates.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            delegates[i](a_args...);
+        }
+    }
+}
+
+template <typename RETURN_TYPE, typename... ARGS>
+void Event<RETURN_TYPE(ARGS...)>::PublishLocked(Snapshot *a_newSnapshot)
+{
+    Snapshot *old = m_snapshot.exchange(a_newSnapshot);
+    if (old != 0)
+    {
+        m_retired.push_back(old);
+    }
+}
+
+template <typename RETURN_TYPE, typename... ARGS>
+void Event<RETURN_TYPE(ARGS...)>::Reclaim()
+{
+    if (EventFiringDepth() != 0)
+    {
+        // waiting here would wait for this thread if it is firing this 
+        // event, or for a thread that might be waiting for this one if it is
+        // firing another. The retired snapshots are freed by the next change
+        // made from outside Fire
+        return;
+    }
+
+    std::vector<Snapshot*> retired;
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        retired.swap(m_retired);
+    }
+
+    if (!retired.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_reclaimMutex);
+            WaitForReaders();
+        }
+
+        for (size_t i = 0; i < retired.size(); i++)
+        {
+            delete retired[i];
+        }
+    }
+}
+
+template <typename RETURN_TYPE, typename... ARGS>
+void Event<RETURN_TYPE(ARGS...)>::WaitForReaders()
+{
+    // a Fire call using a retired snapshot registered itself in the counter
+    // of the generation that was current when it started. Moving on to a 
+    // new generation twice, and waiting each time for the counter left 
+    // behind, covers both counters. New calls of Fire register in the 
+    // current counter, so the one being waited for can only go down.
+    // m_reclaimMutex must be locked
+    for (int i = 0; i < 2; i++)
+    {
+        uint64_t previous = m_generation.fetch_add(1);
+        std::atomic<size_t> &readers = m_readers[previous & 1].m_count;
+        while (readers.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+#endif /* _EVENT_H_ */
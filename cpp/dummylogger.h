@@ -22,6 +22,28 @@
 /// @file dummylogger.h
 /// @brief A simple log based on C++ streams
 ///
+/// Messages are written straight into std::cout by the thread that logs them
+/// by default. In asynchronous mode (see DummyLogger::StartAsync) each thread
+/// formats its messages into a buffer of its own, and complete messages are
+/// pushed through a lock-free queue into a consumer thread that writes them
+/// in batches (writev) into a file descriptor. Logging never blocks: if the
+/// queue is full the message is dropped and the drop is reported in the 
+/// output
+///
+/// Define DUMMY_LOGGER_UNBOUNDED_QUEUE to push the messages through the 
+/// unbounded linked queue (linked_lock_free_queue_adapter.h) instead. No 
+/// message is dropped then, and the queue size given to StartAsync is the 
+/// number of records allocated upfront. The queue grows (allocates) if the 
+/// consumer thread falls behind
+///
+/// DUMMY_LOG logs binary records (see dummylogger_binary.h): the calling 
+/// thread only copies the time, the address of the static format of the call
+/// site and the arguments. The message is formatted by the consumer thread
+/// in asynchronous mode (by the calling thread otherwise) as
+///   [dd/Mon/yyyy HH:MM:SS.mmm] LEVEL message
+/// which is what scripts/log_merger.py parses:
+///   DUMMY_LOG(DUMMY_LOGGER_INFO, "order %d filled at %.2f", id, price);
+///
 /// @author Faustino Frechilla
 /// @history
 /// Ref       Who                When         What
@@ -32,20 +54,107 @@
 
 #pragma once
 
+#include <stdint.h>     // uint32_t, uint64_t
+#include <stdio.h>      // snprintf
+#include <string.h>     // memcpy
+#include <errno.h>
+#include <unistd.h>     // STDOUT_FILENO
+#include <sys/uio.h>    // writev
 #include <iostream>
+#include <streambuf>
+#include <atomic>
 #include "singleton.h"
+#include "consumer_thread.h"
+#ifdef DUMMY_LOGGER_UNBOUNDED_QUEUE
+#include "linked_lock_free_queue_adapter.h"
+#else
+#include "lock_free_queue_adapter.h"
+#endif
+#include "delegate/Delegate.h"
+#include "dummylogger_binary.h"
+
+// default number of messages that can be waiting to be written in 
+// asynchronous mode. The ones logged when it is full are dropped
+#define DUMMY_LOGGER_DEFAULT_QUEUE_SIZE 4096
+
+// maximum number of messages written with a single call to writev
+#define DUMMY_LOGGER_WRITEV_BATCH 64
+
+/// @brief logs a binary record with the level a_level. The message is
+///        formatted later using the printf-like a_format (a string literal)
+///        and the arguments that follow it
+#define DUMMY_LOG(a_level, a_format, ...)                                      \
+    do                                                                         \
+    {                                                                          \
+        static const DummyLoggerFormat s_dummyLoggerFormat = {a_level, a_format}; \
+        DummyLogger::Instance().Log(s_dummyLoggerFormat, ##__VA_ARGS__);       \
+    } while (0)
+
+/// @brief where a thread formats its messages in asynchronous mode
+/// The stream writes straight into a DummyLoggerRecord. When it is full the 
+/// stream fails and the rest of the message is lost
+class DummyLoggerThreadBuffer : public std::streambuf
+{
+public:
+    DummyLoggerThreadBuffer():
+        m_record(),
+        m_stream(this)
+    {
+        Reset();
+    }
+
+    /// @return the stream the thread's messages are formatted with
+    inline std::ostream& Stream()
+    {
+        return m_stream;
+    }
+
+    /// @brief the message formatted so far
+    /// @param a_newLine true to finish it with a new line
+    /// @return the record. Its size is 0 if there is nothing to log
+    inline DummyLoggerRecord& Complete(bool a_newLine)
+    {
+        char* end = pptr();
+        if (a_newLine)
+        {
+            // there is always space left for it (see Reset)
+            *end++ = '\n';
+        }
+        m_record.m_size = static_cast<uint32_t>(end - m_record.m_text);
+        m_record.m_type = DUMMY_LOGGER_RECORD_TEXT;
+        return m_record;
+    }
 
+    /// @brief starts a new message
+    inline void Reset()
+    {
+        setp(m_record.m_text, m_record.m_text + DUMMY_LOGGER_RECORD_SIZE - 1);
+        m_stream.clear();
+    }
+
+private:
+    DummyLoggerRecord m_record;
+    std::ostream      m_stream;
+};
 
 /// @brief 
 /// This is a singleton class to log messages using C++ streams
 ///
 /// Example of usage:
 /// DummyLogger::instance() << "This is a log message" << std::endl;
+///
+/// In asynchronous mode a message is complete (and pushed to be written) 
+/// when std::endl or std::flush are logged:
+/// DummyLogger::Instance().StartAsync();
+/// DummyLogger::Instance() << "from any thread " << i << std::endl;
+/// DummyLogger::Instance().StopAsync(); // writes everything left
 class DummyLogger : public Singleton<DummyLogger>
 {
 public:
     /// @brief getStream returns a reference to the stream being used by this 
     ///        logger instance
+    /// In asynchronous mode whatever is written directly into this stream 
+    /// doesn't go through the queue
     /// @return
     inline std::ostream& getStream() const
     {
@@ -57,18 +166,150 @@ public:
     /// @return
     DummyLogger& operator<<(std::ostream& (*pf)(std::ostream&))
     {
-        pf(_stream);
+        Backend_t* backend = m_backend.load(std::memory_order_acquire);
+        if (backend == 0)
+        {
+            pf(_stream);
+            return *this;
+        }
+
+        DummyLoggerThreadBuffer &buffer = ThreadBuffer();
+        if (pf == static_cast<std::ostream& (*)(std::ostream&)>(&std::endl))
+        {
+            Push(backend, buffer.Complete(true));
+            buffer.Reset();
+        }
+        else if (pf == static_cast<std::ostream& (*)(std::ostream&)>(&std::flush))
+        {
+            Push(backend, buffer.Complete(false));
+            buffer.Reset();
+        }
+        else
+        {
+            pf(buffer.Stream());
+        }
+
         return *this;
     }
 
+    /// @brief logs a binary record. Use DUMMY_LOG instead, which declares
+    ///        a_format
+    /// @param a_format it must live as long as the logger
+    template <typename... ARGS>
+    void Log(const DummyLoggerFormat &a_format, const ARGS&... a_args)
+    {
+        DummyLoggerRecord record;
+        DummyLoggerEncode(record, a_format, a_args...);
+
+        Backend_t* backend = m_backend.load(std::memory_order_acquire);
+        if (backend == 0)
+        {
+            char text[DUMMY_LOGGER_RECORD_SIZE];
+            uint32_t size = m_renderer.Render(record, text, sizeof(text));
+            _stream.write(text, size);
+            return;
+        }
+
+        Push(backend, record);
+    }
+
+    /// @brief switches to asynchronous mode
+    /// It must not be called while other threads are logging (at start up)
+    /// @param a_fd where the messages are written. The standard output by 
+    ///        default (std::cout is flushed first)
+    /// @param a_queueSize maximum number of messages waiting to be written
+    ///        (records allocated upfront with DUMMY_LOGGER_UNBOUNDED_QUEUE)
+    void StartAsync(
+        int         a_fd = STDOUT_FILENO, 
+        std::size_t a_queueSize = DUMMY_LOGGER_DEFAULT_QUEUE_SIZE)
+    {
+        assert(m_backend.load() == 0);
+
+        _stream.flush();
+        m_fd = a_fd;
+        m_pendingCount = 0;
+        m_backend.store(
+            new Backend_t(
+                a_queueSize, 
+                MakeDelegate(this, &DummyLogger::Consume),
+                []() {},
+                MakeDelegate(this, &DummyLogger::Flush)),
+            std::memory_order_release);
+    }
+
+    /// @brief writes the messages still in the queue and goes back to the 
+    ///        synchronous mode
+    /// It must not be called while other threads are logging (at shut down)
+    void StopAsync()
+    {
+        Backend_t* backend = m_backend.exchange(0);
+        if (backend != 0)
+        {
+            backend->Join();
+            delete backend;
+
+            // the last drops, if there are any
+            Flush();
+        }
+    }
+
+    /// @return true in asynchronous mode
+    inline bool IsAsync() const
+    {
+        return m_backend.load(std::memory_order_relaxed) != 0;
+    }
+
+    /// @return number of messages dropped since the logger was created 
+    ///         because the queue was full
+    inline uint64_t Dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
 private:
+#ifdef DUMMY_LOGGER_UNBOUNDED_QUEUE
+    typedef LinkedLockFreeQueueAdapter<DummyLoggerRecord> Queue_t;
+#else
+    typedef ArrayLockFreeQueueAdapter<DummyLoggerRecord, 0, 
+        ArrayLockFreeQueueSequencedSlots, ArrayLockFreeQueueParkWait> Queue_t;
+#endif
+    typedef ConsumerThread<DummyLoggerRecord, Queue_t, Delegate> Backend_t;
+
     /// @brief the strem where log messages will be forwarded
     std::ostream& _stream;
 
-    DummyLogger(): _stream(std::cout)
+    /// consumer thread writing the messages (asynchronous mode only)
+    std::atomic<Backend_t*> m_backend;
+
+    /// where the consumer thread writes
+    int m_fd;
+
+    /// messages dropped because the queue was full
+    std::atomic<uint64_t> m_dropped;
+
+    /// drops already reported in the output (consumer thread only)
+    uint64_t m_droppedReported;
+
+    /// formats binary records
+    const DummyLoggerRenderer m_renderer;
+
+    /// messages consumed but not written yet (consumer thread only)
+    DummyLoggerRecord m_pending[DUMMY_LOGGER_WRITEV_BATCH];
+    std::size_t       m_pendingCount;
+
+    DummyLogger(): 
+        _stream(std::cout),
+        m_backend(0),
+        m_fd(STDOUT_FILENO),
+        m_dropped(0),
+        m_droppedReported(0),
+        m_renderer(),
+        m_pendingCount(0)
     {}
     ~DummyLogger()
-    {}
+    {
+        StopAsync();
+    }
 
     // usage of "friend" is discouraged, but it is the only way to design a templatized singleton
     friend class Singleton<DummyLogger>;
@@ -76,6 +317,116 @@ private:
     // template method needed to be able to log strings ending with std::endl
     template <typename T>
     friend DummyLogger& operator<<(DummyLogger& log, T const& val);
+
+    /// @return the stream the calling thread logs into
+    inline std::ostream& Stream()
+    {
+        if (m_backend.load(std::memory_order_acquire) == 0)
+        {
+            return _stream;
+        }
+        return ThreadBuffer().Stream();
+    }
+
+    /// @return the buffer of the calling thread
+    static inline DummyLoggerThreadBuffer& ThreadBuffer()
+    {
+        static thread_local DummyLoggerThreadBuffer t_buffer;
+        return t_buffer;
+    }
+
+    /// @brief pushes a complete message into the queue. Dropped if it's full
+    inline void Push(Backend_t* a_backend, const DummyLoggerRecord &a_record)
+    {
+        if ((a_record.m_size > 0) && !a_backend->Produce(a_record))
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief consume delegate of the consumer thread
+    void Consume(DummyLoggerRecord a_record)
+    {
+        DummyLoggerRecord &pending = m_pending[m_pendingCount++];
+        if (a_record.m_type == DUMMY_LOGGER_RECORD_BINARY)
+        {
+            pending.m_size = m_renderer.Render(a_record, pending.m_text, sizeof(pending.m_text));
+        }
+        else
+        {
+            pending.m_size = a_record.m_size;
+            memcpy(pending.m_text, a_record.m_text, a_record.m_size);
+        }
+
+        if (m_pendingCount == DUMMY_LOGGER_WRITEV_BATCH)
+        {
+            Flush();
+        }
+    }
+
+    /// @brief writes the pending messages with a single writev, preceded by
+    ///        a notice if messages were dropped since the last one
+    /// Called by the consumer thread after each batch it pops from the queue
+    void Flush()
+    {
+        struct iovec iov[DUMMY_LOGGER_WRITEV_BATCH + 1];
+        int count = 0;
+
+        char notice[64];
+        uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped != m_droppedReported)
+        {
+            int size = snprintf(notice, sizeof(notice), 
+                "DummyLogger: %llu messages dropped\n", 
+                static_cast<unsigned long long>(dropped - m_droppedReported));
+            m_droppedReported = dropped;
+
+            iov[count].iov_base = notice;
+            iov[count].iov_len = static_cast<std::size_t>(size);
+            count++;
+        }
+
+        for (std::size_t i = 0; i < m_pendingCount; i++)
+        {
+            iov[count].iov_base = m_pending[i].m_text;
+            iov[count].iov_len = m_pending[i].m_size;
+            count++;
+        }
+        m_pendingCount = 0;
+
+        WriteAll(iov, count);
+    }
+
+    /// @brief writes every buffer in a_iov, even if writev writes them 
+    ///        partially. Whatever can't be written (the sink failed) is lost
+    void WriteAll(struct iovec *a_iov, int a_count)
+    {
+        while (a_count > 0)
+        {
+            ssize_t written = writev(m_fd, a_iov, a_count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return;
+            }
+
+            std::size_t left = static_cast<std::size_t>(written);
+            while ((a_count > 0) && (left >= a_iov->iov_len))
+            {
+                left -= a_iov->iov_len;
+                a_iov++;
+                a_count--;
+            }
+            if (a_count > 0)
+            {
+                a_iov->iov_base = static_cast<char*>(a_iov->iov_base) + left;
+                a_iov->iov_len -= left;
+            }
+        }
+    }
    
 private:
     // prevent copying of this singleton
@@ -87,6 +438,6 @@ private:
 template <typename T>
 DummyLogger& operator<<(DummyLogger& log, T const& val)
 {
-    log._stream << val;
+    log.Stream() << val;
     return log;
 }
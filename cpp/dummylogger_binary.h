@@ -0,0 +1,522 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file dummylogger_binary.h
+/// @brief Binary log records of DummyLogger, formatted after they are logged
+///
+/// A call to DUMMY_LOG stores in a DummyLoggerRecord the time, a pointer to
+/// the format of the call site (a static DummyLoggerFormat: level and 
+/// printf-like format string) and the raw bytes of the arguments. Nothing is
+/// formatted by the thread who logs. The record is turned into text later
+/// (by the consumer thread of DummyLogger in asynchronous mode) with the 
+/// layout scripts/log_merger.py parses:
+///   [01/Jun/2012 12:29:17.953] INFO the formatted message
+///
+/// Arguments can be integers, enums, floating point numbers, pointers, C 
+/// strings and std::string. Strings are copied into the record: they don't
+/// need to be alive when the record is formatted. Each conversion of the 
+/// format string takes the next argument. If the conversion doesn't fit the
+/// type of the argument the argument is formatted according to its type 
+/// (keeping flags, width and precision), so a bad format won't ever read the
+/// wrong type. Length modifiers (l, ll, h, z...) are not needed. Widths and
+/// precisions taken from the arguments (%*d, %.*s) are not supported: those
+/// conversions are written as they are
+///
+// ============================================================================
+
+#pragma once
+
+#include <stdint.h>     // uint8_t, int64_t, uint64_t
+#include <stdio.h>      // snprintf
+#include <string.h>     // memcpy, strlen
+#include <time.h>       // localtime_r, strftime
+#include <string>
+#include <chrono>
+#include <type_traits>
+
+// maximum size in bytes of a message logged in asynchronous mode, new line
+// included. Longer messages are truncated. It is also the size of the binary
+// records, so the arguments of a DUMMY_LOG call have to fit in it
+#ifndef DUMMY_LOGGER_RECORD_SIZE
+#define DUMMY_LOGGER_RECORD_SIZE 256
+#endif
+
+/// @brief kinds of DummyLoggerRecord
+enum DummyLoggerRecordType
+{
+    /// m_text is the message, already formatted
+    DUMMY_LOGGER_RECORD_TEXT,
+    /// m_text holds a DummyLoggerBinaryHeader and the arguments
+    DUMMY_LOGGER_RECORD_BINARY
+};
+
+/// @brief a message logged in asynchronous mode
+struct DummyLoggerRecord
+{
+    /// bytes of m_text in use
+    uint32_t m_size;
+    /// DummyLoggerRecordType
+    uint32_t m_type;
+    char     m_text[DUMMY_LOGGER_RECORD_SIZE];
+};
+
+/// @brief severity of binary log records
+enum DummyLoggerLevel
+{
+    DUMMY_LOGGER_DEBUG,
+    DUMMY_LOGGER_INFO,
+    DUMMY_LOGGER_WARNING,
+    DUMMY_LOGGER_ERROR
+};
+
+/// @brief the static part of a binary log record. One per call site
+/// It's an aggregate so the static object DUMMY_LOG declares is initialised
+/// at compile time
+struct DummyLoggerFormat
+{
+    DummyLoggerLevel m_level;
+    const char*      m_format;
+};
+
+/// @brief what is stored at the beginning of a binary record. The arguments
+///        go after it
+struct DummyLoggerBinaryHeader
+{
+    /// steady_clock time of the call in nanoseconds
+    int64_t                  m_time;
+    const DummyLoggerFormat* m_format;
+    /// number of arguments stored after the header
+    uint32_t                 m_argCount;
+};
+
+/// @brief type of each argument stored in a binary record. It precedes the
+///        bytes of the argument
+enum DummyLoggerArgType
+{
+    DUMMY_LOGGER_ARG_INT,      // int64_t
+    DUMMY_LOGGER_ARG_UINT,     // uint64_t
+    DUMMY_LOGGER_ARG_DOUBLE,   // double
+    DUMMY_LOGGER_ARG_POINTER,  // const void*
+    DUMMY_LOGGER_ARG_STRING    // uint16_t length, the chars and '\0'
+};
+
+/// @brief appends the arguments of a DUMMY_LOG call to a binary record
+class DummyLoggerArgWriter
+{
+public:
+    DummyLoggerArgWriter(DummyLoggerRecord &a_record):
+        m_record(a_record),
+        m_argCount(0),
+        m_full(false)
+    {}
+
+    /// @return number of arguments written
+    inline uint32_t ArgCount() const { return m_argCount; }
+
+    template <typename T>
+    inline void Write(const T &a_arg)
+    {
+        WriteArg(a_arg, Category<T>());
+    }
+
+    inline void Write(const std::string &a_arg)
+    {
+        WriteString(a_arg.data(), a_arg.size());
+    }
+
+    inline void Write(const char* a_arg)
+    {
+        WriteString(a_arg, (a_arg == 0) ? 0 : strlen(a_arg));
+    }
+
+    inline void Write(char* a_arg)
+    {
+        Write(static_cast<const char*>(a_arg));
+    }
+
+private:
+    DummyLoggerRecord &m_record;
+    uint32_t           m_argCount;
+    /// set when an argument didn't fit. The rest are not written either
+    bool               m_full;
+
+    template <int N> struct CategoryTag {};
+    typedef CategoryTag<0> SignedTag;
+    typedef CategoryTag<1> UnsignedTag;
+    typedef CategoryTag<2> FloatTag;
+    typedef CategoryTag<3> PointerTag;
+
+    template <typename T>
+    struct Category : 
+        CategoryTag<
+            std::is_floating_point<T>::value ? 2 :
+            std::is_pointer<T>::value ? 3 :
+            (std::is_integral<T>::value && std::is_unsigned<T>::value) ? 1 : 0>
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || 
+                      std::is_pointer<T>::value,
+            "DUMMY_LOG arguments: numbers, enums, pointers, C strings and std::string");
+    };
+
+    template <typename T>
+    inline void WriteArg(const T &a_arg, SignedTag)
+    {
+        WriteValue(DUMMY_LOGGER_ARG_INT, static_cast<int64_t>(a_arg));
+    }
+
+    template <typename T>
+    inline void WriteArg(const T &a_arg, UnsignedTag)
+    {
+        WriteValue(DUMMY_LOGGER_ARG_UINT, static_cast<uint64_t>(a_arg));
+    }
+
+    template <typename T>
+    inline void WriteArg(const T &a_arg, FloatTag)
+    {
+        WriteValue(DUMMY_LOGGER_ARG_DOUBLE, static_cast<double>(a_arg));
+    }
+
+    template <typename T>
+    inline void WriteArg(const T &a_arg, PointerTag)
+    {
+        WriteValue(DUMMY_LOGGER_ARG_POINTER, static_cast<const void*>(a_arg));
+    }
+
+    template <typename V>
+    inline void WriteValue(DummyLoggerArgType a_type, V a_value)
+    {
+        if (m_full || (m_record.m_size + 1 + sizeof(V) > DUMMY_LOGGER_RECORD_SIZE))
+        {
+            m_full = true;
+            return;
+        }
+
+        char* dst = m_record.m_text + m_record.m_size;
+        *dst = static_cast<char>(a_type);
+        memcpy(dst + 1, &a_value, sizeof(V));
+        m_record.m_size += 1 + sizeof(V);
+        m_argCount++;
+    }
+
+    /// strings are truncated to the space left in the record
+    inline void WriteString(const char* a_str, size_t a_size)
+    {
+        // type, length and '\0'
+        const size_t overhead = 1 + sizeof(uint16_t) + 1;
+        if (m_full || (m_record.m_size + overhead > DUMMY_LOGGER_RECORD_SIZE))
+        {
+            m_full = true;
+            return;
+        }
+
+        size_t space = DUMMY_LOGGER_RECORD_SIZE - m_record.m_size - overhead;
+        uint16_t size = static_cast<uint16_t>((a_size < space) ? a_size : space);
+
+        char* dst = m_record.m_text + m_record.m_size;
+        *dst = static_cast<char>(DUMMY_LOGGER_ARG_STRING);
+        memcpy(dst + 1, &size, sizeof(size));
+        memcpy(dst + 1 + sizeof(size), a_str, size);
+        dst[1 + sizeof(size) + size] = '\0';
+        m_record.m_size += overhead + size;
+        m_argCount++;
+    }
+};
+
+/// @brief fills a_record with a binary record for a_format and a_args
+template <typename... ARGS>
+inline void DummyLoggerEncode(
+    DummyLoggerRecord       &a_record, 
+    const DummyLoggerFormat &a_format, 
+    const ARGS&...           a_args)
+{
+    DummyLoggerBinaryHeader header;
+    header.m_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    header.m_format = &a_format;
+
+    a_record.m_type = DUMMY_LOGGER_RECORD_BINARY;
+    a_record.m_size = sizeof(header);
+
+    DummyLoggerArgWriter writer(a_record);
+    // writes the arguments in order (the initialisation of an array is 
+    // sequenced left to right)
+    int expand[] = { 0, (writer.Write(a_args), 0)... };
+    (void)expand;
+
+    header.m_argCount = writer.ArgCount();
+    memcpy(a_record.m_text, &header, sizeof(header));
+}
+
+/// @brief formats a binary record. Given the steady_clock time and the 
+///        system_clock time at a same moment it converts the time of the 
+///        record into the wall clock time
+class DummyLoggerRenderer
+{
+public:
+    DummyLoggerRenderer():
+        m_steadyBase(std::chrono::steady_clock::now()),
+        m_systemBase(std::chrono::system_clock::now())
+    {}
+
+    /// @brief formats a_record into a_out: [dd/Mon/yyyy HH:MM:SS.mmm] LEVEL msg
+    /// @param a_outSize the text is truncated to it. The last char written
+    ///        is always a new line
+    /// @return number of chars written into a_out
+    uint32_t Render(const DummyLoggerRecord &a_record, char* a_out, size_t a_outSize) const
+    {
+        DummyLoggerBinaryHeader header;
+        memcpy(&header, a_record.m_text, sizeof(header));
+
+        // a new line is always kept at the end
+        Output out(a_out, a_outSize - 1);
+        RenderTime(header.m_time, out);
+        out.Append(LevelName(header.m_format->m_level));
+        out.Append(" ");
+
+        const char* args = a_record.m_text + sizeof(header);
+        uint32_t argsLeft = header.m_argCount;
+        const char* fmt = header.m_format->m_format;
+        while (*fmt != '\0')
+        {
+            if (*fmt != '%')
+            {
+                out.Append(fmt, 1);
+                fmt++;
+                continue;
+            }
+            if (fmt[1] == '%')
+            {
+                out.Append("%");
+                fmt += 2;
+                continue;
+            }
+
+            // flags, width and precision are kept. Length modifiers dropped
+            char spec[32];
+            size_t specSize = 0;
+            const char* conv = fmt + 1;
+            spec[specSize++] = '%';
+            while ((*conv != '\0') && (strchr("-+ #0123456789.hlLqjzt", *conv) != 0))
+            {
+                if ((strchr("hlLqjzt", *conv) == 0) && (specSize < sizeof(spec) - 4))
+                {
+                    spec[specSize++] = *conv;
+                }
+                conv++;
+            }
+            if (*conv == '*')
+            {
+                // width or precision taken from an argument (%*d, %.*s) is 
+                // not supported. The conversion is written as it is and it 
+                // uses no argument
+                while ((*conv != '\0') && (strchr("-+ #0123456789.*hlLqjzt", *conv) != 0))
+                {
+                    conv++;
+                }
+                if (*conv != '\0')
+                {
+                    out.Append(fmt, conv - fmt + 1);
+                    fmt = conv + 1;
+                    continue;
+                }
+            }
+            if (*conv == '\0')
+            {
+                // unfinished conversion. Written as it is
+                out.Append(fmt);
+                break;
+            }
+
+            if (argsLeft == 0)
+            {
+                // not enough arguments. The conversion is written as it is
+                out.Append(fmt, conv - fmt + 1);
+            }
+            else
+            {
+                args = RenderArg(args, spec, specSize, *conv, out);
+                argsLeft--;
+            }
+            fmt = conv + 1;
+        }
+
+        *out.m_end = '\n';
+        return static_cast<uint32_t>(out.m_end - a_out + 1);
+    }
+
+    static const char* LevelName(DummyLoggerLevel a_level)
+    {
+        switch (a_level)
+        {
+        case DUMMY_LOGGER_DEBUG:   return "DEBUG";
+        case DUMMY_LOGGER_INFO:    return "INFO";
+        case DUMMY_LOGGER_WARNING: return "WARNING";
+        case DUMMY_LOGGER_ERROR:   return "ERROR";
+        }
+        return "UNKNOWN";
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_steadyBase;
+    std::chrono::system_clock::time_point m_systemBase;
+
+    /// @brief text being written. It never goes beyond m_limit
+    struct Output
+    {
+        Output(char* a_begin, size_t a_size):
+            m_end(a_begin),
+            m_limit(a_begin + a_size)
+        {}
+
+        inline void Append(const char* a_str)
+        {
+            Append(a_str, strlen(a_str));
+        }
+
+        inline void Append(const char* a_str, size_t a_size)
+        {
+            size_t space = m_limit - m_end;
+            size_t size = (a_size < space) ? a_size : space;
+            memcpy(m_end, a_str, size);
+            m_end += size;
+        }
+
+        /// @brief snprintf of a single conversion
+        template <typename V>
+        inline void Print(const char* a_spec, V a_value)
+        {
+            size_t space = m_limit - m_end;
+            // snprintf needs space for the '\0', which is overwritten later
+            char buffer[DUMMY_LOGGER_RECORD_SIZE];
+            int size = snprintf(buffer, sizeof(buffer), a_spec, a_value);
+            if (size > 0)
+            {
+                size_t written = (static_cast<size_t>(size) < sizeof(buffer)) ? size : sizeof(buffer) - 1;
+                Append(buffer, (written < space) ? written : space);
+            }
+        }
+
+        char* m_end;
+        char* m_limit;
+    };
+
+    void RenderTime(int64_t a_steadyNs, Output &a_out) const
+    {
+        std::chrono::system_clock::time_point wall = m_systemBase + 
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(a_steadyNs) - m_steadyBase.time_since_epoch());
+
+        time_t seconds = std::chrono::system_clock::to_time_t(wall);
+        // to_time_t might round the seconds up
+        if (std::chrono::system_clock::from_time_t(seconds) > wall)
+        {
+            seconds--;
+        }
+        int64_t millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            wall - std::chrono::system_clock::from_time_t(seconds)).count();
+
+        struct tm brokenDown;
+        localtime_r(&seconds, &brokenDown);
+
+        char buffer[64];
+        size_t size = strftime(buffer, sizeof(buffer), "[%d/%b/%Y %H:%M:%S", &brokenDown);
+        size += snprintf(buffer + size, sizeof(buffer) - size, ".%03d] ", static_cast<int>(millis));
+        a_out.Append(buffer, size);
+    }
+
+    /// @brief formats the argument at a_args with the conversion a_conv. 
+    ///        a_spec holds the flags, width and precision of the conversion
+    /// @return where the next argument starts
+    static const char* RenderArg(
+        const char* a_args, char* a_spec, size_t a_specSize, char a_conv, Output &a_out)
+    {
+        DummyLoggerArgType type = static_cast<DummyLoggerArgType>(*a_args);
+        const char* value = a_args + 1;
+        switch (type)
+        {
+        case DUMMY_LOGGER_ARG_INT:
+        case DUMMY_LOGGER_ARG_UINT:
+        {
+            uint64_t bits;
+            memcpy(&bits, value, sizeof(bits));
+            if (a_conv == 'c')
+            {
+                Finish(a_spec, a_specSize, "", 'c');
+                a_out.Print(a_spec, static_cast<int>(bits));
+            }
+            else
+            {
+                if (strchr("diouxX", a_conv) == 0)
+                {
+                    a_conv = (type == DUMMY_LOGGER_ARG_INT) ? 'd' : 'u';
+                }
+                Finish(a_spec, a_specSize, "ll", a_conv);
+                if (type == DUMMY_LOGGER_ARG_INT)
+                {
+                    a_out.Print(a_spec, static_cast<long long>(static_cast<int64_t>(bits)));
+                }
+                else
+                {
+                    a_out.Print(a_spec, static_cast<unsigned long long>(bits));
+                }
+            }
+            return value + sizeof(bits);
+        }
+
+        case DUMMY_LOGGER_ARG_DOUBLE:
+        {
+            double number;
+            memcpy(&number, value, sizeof(number));
+            Finish(a_spec, a_specSize, "", (strchr("eEfFgGaA", a_conv) != 0) ? a_conv : 'g');
+            a_out.Print(a_spec, number);
+            return value + sizeof(number);
+        }
+
+        case DUMMY_LOGGER_ARG_POINTER:
+        {
+            const void* pointer;
+            memcpy(&pointer, value, sizeof(pointer));
+            Finish(a_spec, a_specSize, "", 'p');
+            a_out.Print(a_spec, pointer);
+            return value + sizeof(pointer);
+        }
+
+        case DUMMY_LOGGER_ARG_STRING:
+        default:
+        {
+            uint16_t size;
+            memcpy(&size, value, sizeof(size));
+            Finish(a_spec, a_specSize, "", 's');
+            a_out.Print(a_spec, value + sizeof(size));
+            return value + sizeof(size) + size + 1;
+        }
+        }
+    }
+
+    /// @brief appends the length modifier and the conversion to a_spec
+    static void Finish(char* a_spec, size_t a_specSize, const char* a_length, char a_conv)
+    {
+        size_t length = strlen(a_length);
+        memcpy(a_spec + a_specSize, a_length, length);
+        a_spec[a_specSize + length] = a_conv;
+        a_spec[a_specSize + length + 1] = '\0';
+    }
+};
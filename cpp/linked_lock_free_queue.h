@@ -0,0 +1,271 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file linked_lock_free_queue.h
+/// @brief Unbounded intrusive lock-free queue for many producers and a 
+///        single consumer
+/// The queue is a linked list of nodes provided by the caller (Dmitry 
+/// Vyukov's intrusive MPSC algorithm). A node is any class that derives from
+/// LinkedLockFreeQueueNode:
+///
+///   struct Message : public LinkedLockFreeQueueNode { int m_id; };
+///   LinkedLockFreeQueue<Message> queue;
+///   queue.push(message);          // any thread. Wait-free
+///   Message* next = queue.pop();  // the consumer thread only
+///
+/// push is a single atomic exchange plus a store, whatever the number of 
+/// producers: it never retries nor waits for other threads. The price is 
+/// that an element whose push is still halfway (between the exchange and 
+/// the store) holds back the elements pushed after it. pop returns 0 until 
+/// the push is complete, as if the queue was empty.
+///
+/// The queue never allocates memory. LinkedLockFreeQueueNodePool recycles 
+/// the nodes so a steady flow of elements doesn't allocate either (see 
+/// LinkedLockFreeQueueAdapter in linked_lock_free_queue_adapter.h, which 
+/// stores elements of any type in pooled nodes behind the SafeQueue 
+/// interface ConsumerThread works with)
+///
+// ============================================================================
+
+#ifndef __LINKED_LOCK_FREE_QUEUE_H__
+#define __LINKED_LOCK_FREE_QUEUE_H__
+
+#include <stddef.h>     // size_t
+#include <atomic>
+#include <type_traits>  // std::is_base_of
+#include "lock_free_queue.h" // LOCK_FREE_Q_CACHE_LINE_PAD
+
+/// @brief what a class needs to be a node of a LinkedLockFreeQueue
+struct LinkedLockFreeQueueNode
+{
+    LinkedLockFreeQueueNode():
+        m_next(0)
+    {}
+
+    std::atomic<LinkedLockFreeQueueNode*> m_next;
+};
+
+/// @brief unbounded intrusive queue. Many producers, one consumer
+/// NODE_T type of the nodes. It must derive from LinkedLockFreeQueueNode. A
+///        node can only be in one queue at a time, and it belongs to the 
+///        queue from the moment it's pushed until it is popped
+template <typename NODE_T>
+class LinkedLockFreeQueue
+{
+    static_assert(std::is_base_of<LinkedLockFreeQueueNode, NODE_T>::value,
+        "The nodes of a LinkedLockFreeQueue must derive from LinkedLockFreeQueueNode");
+
+public:
+    LinkedLockFreeQueue():
+        m_back(&m_stub),
+        m_front(&m_stub),
+        m_stub()
+    {}
+
+    /// @brief inserts a node at the end of the queue. Wait-free
+    /// It can be called from any thread
+    inline void push(NODE_T *a_node)
+    {
+        pushNode(a_node);
+    }
+
+    /// @brief extracts the node at the front of the queue
+    /// Only the consumer thread can call it
+    /// @return the node. 0 if the queue is empty, or if the node at the front
+    ///         is still being pushed
+    NODE_T* pop()
+    {
+        LinkedLockFreeQueueNode* front = m_front;
+        LinkedLockFreeQueueNode* next = front->m_next.load(std::memory_order_acquire);
+
+        // the stub isn't an element. Skip it
+        if (front == &m_stub)
+        {
+            if (next == 0)
+            {
+                return 0;
+            }
+            m_front = next;
+            front = next;
+            next = next->m_next.load(std::memory_order_acquire);
+        }
+
+        if (next != 0)
+        {
+            m_front = next;
+            return static_cast<NODE_T*>(front);
+        }
+
+        // front is the last node linked. If it is not the last one pushed a
+        // producer is in the middle of linking the next one
+        if (front != m_back.load(std::memory_order_acquire))
+        {
+            return 0;
+        }
+
+        // front can't be taken out while it's the last node: the next push
+        // links to it. The stub takes its place
+        pushNode(&m_stub);
+        next = front->m_next.load(std::memory_order_acquire);
+        if (next != 0)
+        {
+            m_front = next;
+            return static_cast<NODE_T*>(front);
+        }
+
+        // a producer got in between and its push isn't complete yet
+        return 0;
+    }
+
+    /// @brief check if there is nothing to pop
+    /// Only the consumer thread can call it. Pushes halfway through don't count
+    inline bool empty() const
+    {
+        return (m_front == &m_stub) && 
+               (m_stub.m_next.load(std::memory_order_acquire) == 0);
+    }
+
+private:
+    /// last node pushed. Producers only
+    std::atomic<LinkedLockFreeQueueNode*> m_back;
+    LOCK_FREE_Q_CACHE_LINE_PAD(m_padding0, sizeof(std::atomic<LinkedLockFreeQueueNode*>))
+
+    /// next node to be popped. Consumer only
+    LinkedLockFreeQueueNode* m_front;
+
+    /// placeholder that keeps the list linked while it has no elements
+    LinkedLockFreeQueueNode m_stub;
+
+    inline void pushNode(LinkedLockFreeQueueNode *a_node)
+    {
+        a_node->m_next.store(0, std::memory_order_relaxed);
+        // from here on the node is the last one. The previous last one is 
+        // linked to it afterwards
+        LinkedLockFreeQueueNode* prev = m_back.exchange(a_node, std::memory_order_acq_rel);
+        prev->m_next.store(a_node, std::memory_order_release);
+    }
+
+    /// @brief disable copy constructor declaring it private
+    LinkedLockFreeQueue(const LinkedLockFreeQueue &a_src);
+};
+
+/// @brief recycles the nodes of a queue so a steady flow of elements doesn't 
+///        allocate memory
+/// Nodes are allocated by the producers and released by the consumer. Each 
+/// thread keeps a free list of its own (shared by the pools of every queue 
+/// with the same NODE_T), so taking a node is a pop from a thread local 
+/// list. The consumer gives the released nodes back through the pool: a 
+/// stack it pushes into and that producers empty at once (an exchange) when
+/// their own free list runs out. Only when both are empty a node is 
+/// allocated. Nodes on the free list of a thread are freed when the thread 
+/// finishes. NODE_T must be default constructible
+template <typename NODE_T>
+class LinkedLockFreeQueueNodePool
+{
+public:
+    LinkedLockFreeQueueNodePool():
+        m_released(0)
+    {}
+
+    /// @brief frees the nodes released into the pool and not taken yet
+    ~LinkedLockFreeQueueNodePool()
+    {
+        FreeList(m_released.exchange(0));
+    }
+
+    /// @brief creates a_count nodes and releases them into the pool, so the
+    ///        first allocations don't hit the memory allocator
+    void Reserve(size_t a_count)
+    {
+        for (size_t i = 0; i < a_count; i++)
+        {
+            NODE_T* node = new NODE_T();
+            Release(node, node);
+        }
+    }
+
+    /// @brief gets a node. Any thread can call it
+    inline NODE_T* Allocate()
+    {
+        LinkedLockFreeQueueNode*& free = ThreadFreeList().m_head;
+        if (free == 0)
+        {
+            // every node the consumer released so far
+            free = m_released.exchange(0, std::memory_order_acquire);
+            if (free == 0)
+            {
+                return new NODE_T();
+            }
+        }
+
+        LinkedLockFreeQueueNode* node = free;
+        free = node->m_next.load(std::memory_order_relaxed);
+        return static_cast<NODE_T*>(node);
+    }
+
+    /// @brief gives back the nodes from a_first to a_last, linked through 
+    ///        m_next. Any thread can call it
+    inline void Release(NODE_T *a_first, NODE_T *a_last)
+    {
+        // nodes are only taken out of the stack all at once, never one at a
+        // time, so there is no ABA problem
+        LinkedLockFreeQueueNode* head = m_released.load(std::memory_order_relaxed);
+        do
+        {
+            a_last->m_next.store(head, std::memory_order_relaxed);
+        } while (!m_released.compare_exchange_weak(
+            head, a_first, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+private:
+    /// nodes released by the consumer, waiting to be taken by a producer
+    std::atomic<LinkedLockFreeQueueNode*> m_released;
+
+    /// @brief free list of a thread. Its nodes are freed when it finishes
+    struct FreeList_t
+    {
+        FreeList_t(): m_head(0) {}
+        ~FreeList_t() { FreeList(m_head); }
+
+        LinkedLockFreeQueueNode* m_head;
+    };
+
+    static inline FreeList_t& ThreadFreeList()
+    {
+        static thread_local FreeList_t t_freeList;
+        return t_freeList;
+    }
+
+    static void FreeList(LinkedLockFreeQueueNode *a_node)
+    {
+        while (a_node != 0)
+        {
+            LinkedLockFreeQueueNode* next = a_node->m_next.load(std::memory_order_relaxed);
+            delete static_cast<NODE_T*>(a_node);
+            a_node = next;
+        }
+    }
+
+    /// @brief disable copy constructor declaring it private
+    LinkedLockFreeQueueNodePool(const LinkedLockFreeQueueNodePool &a_src);
+};
+
+#endif // __LINKED_LOCK_FREE_QUEUE_H__
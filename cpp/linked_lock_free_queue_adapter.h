@@ -0,0 +1,403 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file linked_lock_free_queue_adapter.h
+/// @brief SafeQueue-like interface on top of the unbounded linked lock-free 
+///        queue
+/// It allows ConsumerThread (and anything else written against SafeQueue) to
+/// run on top of LinkedLockFreeQueue when producers must never be turned 
+/// away because the queue is full:
+///   ConsumerThread<int, LinkedLockFreeQueueAdapter<int> > consumer(...);
+///
+/// Any number of threads can push, and only one can pop (the consumer 
+/// thread). Each element is stored in a node taken from a 
+/// LinkedLockFreeQueueNodePool, so once the pool is warm (the size given to 
+/// the constructor is the number of nodes allocated upfront) pushing and 
+/// popping don't allocate memory. Pushes are wait-free and always succeed 
+/// unless the queue is closed: Push never blocks, and TryPush only fails 
+/// after Close. The nodes a producer takes stay in its free list until it 
+/// pushes them or finishes
+///
+/// The calls that block the consumer while the queue is empty (Pop, 
+/// TimedWaitPop...) follow the wait strategy WAIT_T of lock_free_queue_wait.h.
+/// ArrayLockFreeQueueParkWait, the default, puts the idle consumer to sleep
+///
+/// Close follows SafeQueue::Close, though a push racing with Close might still
+/// get its element into the queue (the state is checked before the element is
+/// pushed, not atomically with it)
+///
+/// With the statistics policy QueueStats (see queue_stats.h) every node keeps
+/// the time its element was pushed, and the queue keeps count of its depth
+///
+// ============================================================================
+
+#ifndef __LINKED_LOCK_FREE_QUEUE_ADAPTER_H__
+#define __LINKED_LOCK_FREE_QUEUE_ADAPTER_H__
+
+#include <stddef.h>     // size_t
+#include <stdint.h>     // uint64_t
+#include <atomic>
+#include <chrono>
+#include <new>          // placement new
+#include <type_traits>  // std::aligned_storage
+#include <utility>      // std::move, std::forward
+#include "linked_lock_free_queue.h"
+#include "lock_free_queue_wait.h"
+#include "queue_stats.h"
+
+/// @brief node of LinkedLockFreeQueueAdapter. Storage for an element that is
+///        only constructed while the node is in the queue
+template <typename T>
+struct LinkedLockFreeQueueElementNode : public LinkedLockFreeQueueNode
+{
+    LinkedLockFreeQueueElementNode():
+        LinkedLockFreeQueueNode(),
+        m_stamp(0)
+    {}
+
+    inline T* Elem()
+    {
+        return reinterpret_cast<T*>(&m_storage);
+    }
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+
+    /// time the element was pushed (only with statistics enabled)
+    uint64_t m_stamp;
+};
+
+/// @brief SafeQueue interface for LinkedLockFreeQueue. Many producers, one 
+///        consumer
+/// WAIT_T wait strategy of the consumer (see lock_free_queue_wait.h). STATS_T
+/// is the statistics policy (see queue_stats.h)
+template <
+    typename T, 
+    typename WAIT_T = ArrayLockFreeQueueParkWait,
+    typename STATS_T = QueueNoStats>
+class LinkedLockFreeQueueAdapter
+{
+public:
+    typedef LinkedLockFreeQueueElementNode<T> Node_t;
+
+    /// @brief constructor. Nodes are allocated as they are needed
+    LinkedLockFreeQueueAdapter():
+        m_queue(),
+        m_pool(),
+        m_closed(false),
+        m_size(0),
+        m_wait(),
+        m_stats()
+    {}
+
+    /// @brief constructor
+    /// @param a_size number of nodes allocated upfront. There is no limit to
+    ///        the number of elements in the queue
+    explicit LinkedLockFreeQueueAdapter(size_t a_size):
+        m_queue(),
+        m_pool(),
+        m_closed(false),
+        m_size(0),
+        m_wait(),
+        m_stats()
+    {
+        m_pool.Reserve(a_size);
+    }
+
+    /// @brief destroys the elements still in the queue
+    ~LinkedLockFreeQueueAdapter()
+    {
+        Node_t* node;
+        while ((node = m_queue.pop()) != 0)
+        {
+            node->Elem()->~T();
+            delete node;
+        }
+    }
+
+    /// @brief Check if the queue is empty
+    /// Only the consumer thread can call it
+    /// @return true if the queue is empty. False otherwise
+    bool IsEmpty()
+    {
+        return m_queue.empty();
+    }
+
+    /// @brief closes the queue and wakes up the consumer if it is blocked in it
+    /// See SafeQueue::Close
+    void Close()
+    {
+        m_closed.store(true, std::memory_order_release);
+
+        // the consumer sees the new state the next time it tries
+        m_wait.notify();
+    }
+
+    /// @brief Check if Close was called on the queue
+    bool IsClosed()
+    {
+        return m_closed.load(std::memory_order_acquire);
+    }
+
+    /// @brief inserts an element into the queue. It never blocks
+    /// The element is discarded if the queue is closed
+    /// @return true if the element was inserted. False if it was discarded
+    bool Push(const T &a_elem)
+    {
+        return TryPush(a_elem);
+    }
+
+    /// @brief moves an element into the queue. It never blocks
+    /// The element is discarded if the queue is closed
+    bool Push(T &&a_elem)
+    {
+        return TryPush(std::move(a_elem));
+    }
+
+    /// @brief constructs an element in the queue. It never blocks
+    /// Nothing is constructed if the queue is closed
+    template <typename... ARGS>
+    bool Emplace(ARGS&&... a_args)
+    {
+        return TryEmplace(std::forward<ARGS>(a_args)...);
+    }
+
+    /// @brief inserts an element into the queue
+    /// @return true if the element was inserted. False if the queue was closed
+    bool TryPush(const T &a_elem)
+    {
+        if (IsClosed())
+        {
+            return false;
+        }
+        Insert(a_elem);
+        return true;
+    }
+
+    /// @brief moves an element into the queue
+    /// @return true if the element was inserted. False if the queue was 
+    ///         closed (a_elem is not modified then)
+    bool TryPush(T &&a_elem)
+    {
+        if (IsClosed())
+        {
+            return false;
+        }
+        Insert(std::move(a_elem));
+        return true;
+    }
+
+    /// @brief constructs an element in the queue
+    /// @return true if the element was inserted. False if the queue was closed
+    template <typename... ARGS>
+    bool TryEmplace(ARGS&&... a_args)
+    {
+        if (IsClosed())
+        {
+            return false;
+        }
+        Insert(std::forward<ARGS>(a_args)...);
+        return true;
+    }
+
+    /// @brief extracts an element from the queue. Waits while it is empty
+    /// It returns without modifying out_data if the queue is (or gets) closed
+    /// while it is empty
+    void Pop(T &out_data)
+    {
+        WaitExtract(&out_data, 1, std::chrono::steady_clock::time_point::max());
+    }
+
+    /// @brief extracts an element from the queue
+    /// @return true if an element was extracted. False if the queue was empty
+    bool TryPop(T &out_data)
+    {
+        return (Extract(&out_data, 1) == 1);
+    }
+
+    /// @brief extracts an element from the queue waiting up to a_microsecs 
+    ///        if the queue is empty
+    /// @return true if an element was extracted. False if the timeout was hit
+    ///         (or the queue is closed) and the queue is empty
+    bool TimedWaitPop(T &data, std::chrono::microseconds a_microsecs)
+    {
+        return (WaitExtract(
+            &data, 1, std::chrono::steady_clock::now() + a_microsecs) == 1);
+    }
+
+    /// @brief inserts a_count elements into the queue
+    /// @return the number of elements inserted. a_count unless the queue is 
+    ///         closed
+    size_t TryPushBulk(const T* a_elems, size_t a_count)
+    {
+        if (IsClosed())
+        {
+            return 0;
+        }
+        for (size_t i = 0; i < a_count; i++)
+        {
+            Insert(a_elems[i]);
+        }
+        return a_count;
+    }
+
+    /// @brief extracts up to a_maxCount elements from the queue
+    /// @return the number of elements extracted
+    size_t TryPopBulk(T* out_data, size_t a_maxCount)
+    {
+        return Extract(out_data, a_maxCount);
+    }
+
+    /// @brief extracts up to a_maxCount elements from the queue waiting up to
+    ///        a_microsecs if the queue is empty
+    /// @return the number of elements extracted. 0 if the timeout was hit
+    ///         (or the queue is closed) and the queue is empty
+    size_t TimedWaitPopBulk(
+        T*                        out_data, 
+        size_t                    a_maxCount, 
+        std::chrono::microseconds a_microsecs)
+    {
+        return WaitExtract(
+            out_data, a_maxCount, std::chrono::steady_clock::now() + a_microsecs);
+    }
+
+    /// @brief extracts up to a_maxCount elements from the queue waiting with
+    ///        no timeout if the queue is empty
+    /// @return the number of elements extracted. 0 only if the queue is 
+    ///         closed and empty
+    size_t WaitPopBulk(T* out_data, size_t a_maxCount)
+    {
+        return WaitExtract(
+            out_data, a_maxCount, std::chrono::steady_clock::time_point::max());
+    }
+
+    /// @brief statistics of the queue (see queue_stats.h). Everything is 0 if
+    ///        STATS_T is QueueNoStats
+    void GetStats(QueueStatsSnapshot &out_stats) const
+    {
+        m_stats.GetSnapshot(out_stats);
+    }
+
+private:
+    /// the actual queue
+    LinkedLockFreeQueue<Node_t> m_queue;
+
+    /// where the nodes come from and go back to
+    LinkedLockFreeQueueNodePool<Node_t> m_pool;
+
+    /// set by Close
+    std::atomic<bool> m_closed;
+
+    /// number of elements in the queue (only with statistics enabled)
+    std::atomic<size_t> m_size;
+
+    /// what the consumer does while the queue is empty
+    WAIT_T m_wait;
+
+    /// statistics of the queue
+    STATS_T m_stats;
+
+    /// @brief constructs an element in a node and pushes it
+    template <typename... ARGS>
+    inline void Insert(ARGS&&... a_args)
+    {
+        Node_t* node = m_pool.Allocate();
+        new (node->Elem()) T(std::forward<ARGS>(a_args)...);
+        if (STATS_T::ENABLED)
+        {
+            node->m_stamp = m_stats.Stamp();
+        }
+
+        m_queue.push(node);
+
+        if (STATS_T::ENABLED)
+        {
+            m_stats.OnPush(m_size.fetch_add(1, std::memory_order_relaxed) + 1);
+        }
+        m_wait.notify();
+    }
+
+    /// @brief moves up to a_maxCount elements out of the queue and gives 
+    ///        their nodes back to the pool all at once
+    inline size_t Extract(T* out_data, size_t a_maxCount)
+    {
+        Node_t* first = 0;
+        Node_t* last  = 0;
+        size_t count = 0;
+        while (count < a_maxCount)
+        {
+            Node_t* node = m_queue.pop();
+            if (node == 0)
+            {
+                break;
+            }
+
+            out_data[count] = std::move(*node->Elem());
+            node->Elem()->~T();
+            if (STATS_T::ENABLED)
+            {
+                m_size.fetch_sub(1, std::memory_order_relaxed);
+                m_stats.OnPop(node->m_stamp);
+            }
+
+            node->m_next.store(first, std::memory_order_relaxed);
+            if (first == 0)
+            {
+                last = node;
+            }
+            first = node;
+            count++;
+        }
+
+        if (count > 0)
+        {
+            m_pool.Release(first, last);
+        }
+        return count;
+    }
+
+    /// @brief Extract waiting until there is something in the queue, the 
+    ///        queue is closed or a_deadline is hit
+    inline size_t WaitExtract(
+        T*                                    out_data, 
+        size_t                                a_maxCount, 
+        std::chrono::steady_clock::time_point a_deadline)
+    {
+        size_t count = 0;
+        if (m_wait.wait(
+            [this, out_data, a_maxCount, &count]() 
+            { 
+                count = this->Extract(out_data, a_maxCount); 
+                return ((count > 0) || this->IsClosed()); 
+            },
+            a_deadline) && (count == 0))
+        {
+            // woken up by Close(). Last attempt for what was pushed before it
+            count = Extract(out_data, a_maxCount);
+        }
+
+        return count;
+    }
+
+    /// @brief disable copy constructor declaring it private
+    LinkedLockFreeQueueAdapter(const LinkedLockFreeQueueAdapter &a_src);
+};
+
+#endif // __LINKED_LOCK_FREE_QUEUE_ADAPTER_H__
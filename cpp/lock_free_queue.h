@@ -40,7 +40,12 @@
 #define _LOCK_FREE_QUEUE_H__
 
 #include <stdint.h>     // uint32_t
+#include <assert.h>     // assert()
 #include <atomic>
+#include <new>          // placement new
+#include <utility>      // std::move, std::forward
+#include <type_traits>  // std::aligned_storage
+#include <chrono>
 
 // default Queue size
 #define LOCK_FREE_Q_DEFAULT_SIZE 65536 // (2^16)
@@ -50,12 +55,272 @@
 // the queue, but returned value might be bogus
 //#define _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
 
+// value the read and write counters of the circular array based queues start
+// from. Counters only grow, so from 0 a queue has to move 2^32 elements 
+// before they roll over and the code paths that deal with the roll over run.
+// Tests define it close to 0xFFFFFFFF to get there after a few elements (see
+// test/lock_free_queue_stress_test.cpp)
+#ifndef LOCK_FREE_Q_INITIAL_COUNT
+#define LOCK_FREE_Q_INITIAL_COUNT 0
+#endif
+
+// define this macro to count the failed compare and swap operations of the
+// queues in every thread (see ArrayLockFreeQueueCasRetries). They show how 
+// much producers (or consumers) contend with each other. It costs a thread 
+// local increment per failed compare and swap, nothing when there is no 
+// contention
+//#define _WITH_LOCK_FREE_Q_CAS_STATS
+
+// define this macro to place each of the indexes of the queue in its own 
+// cache line. Producers and consumers update different indexes, so when they 
+// share a cache line every push invalidates the line the consumer is reading
+// from and viceversa (false sharing). With the padding in place each queue
+// takes (3 or 4) * LOCK_FREE_Q_CACHE_LINE_SIZE extra bytes of memory
+//#define _WITH_LOCK_FREE_Q_CACHE_LINE_PADDING
+
+// size in bytes of a cache line. 64 is the right value for most x86 and ARM
+// processors. Define it to 128 when building for processors with 128 byte
+// cache lines or for those that prefetch cache lines in pairs (adjacent line
+// prefetch in Intel processors)
+#ifndef LOCK_FREE_Q_CACHE_LINE_SIZE
+#define LOCK_FREE_Q_CACHE_LINE_SIZE 64
+#endif
+
+#if (LOCK_FREE_Q_CACHE_LINE_SIZE & (LOCK_FREE_Q_CACHE_LINE_SIZE - 1)) != 0
+#error LOCK_FREE_Q_CACHE_LINE_SIZE must be a power of 2
+#endif
+
+/// @brief number of failed compare and swap operations of the lock-free 
+///        queues in the calling thread. Always 0 unless the queues are built 
+///        with _WITH_LOCK_FREE_Q_CAS_STATS
+inline uint64_t& ArrayLockFreeQueueCasRetries()
+{
+    static thread_local uint64_t s_retries = 0;
+    return s_retries;
+}
+
+/// @brief count a failed compare and swap operation
+/// It always returns true so it can be chained to the condition of the loops
+/// that retry the operation
+inline bool ArrayLockFreeQueueCasRetry()
+{
+#ifdef _WITH_LOCK_FREE_Q_CAS_STATS
+    ArrayLockFreeQueueCasRetries()++;
+#endif
+    return true;
+}
+
+// memory for the slots of the queues that are not kept inline (heap, huge
+// pages, NUMA...). It needs LOCK_FREE_Q_CACHE_LINE_SIZE
+#include "lock_free_queue_storage.h"
+
+// strategies for the blocking calls (pop_wait, push_wait...)
+#include "lock_free_queue_wait.h"
+
+// declares an array of chars as a member of the class to fill up the space 
+// left in a cache line after an attribute that uses a_usedBytes bytes of it
+// It is expanded to nothing if the padding layout is disabled
+#ifdef _WITH_LOCK_FREE_Q_CACHE_LINE_PADDING
+#define LOCK_FREE_Q_CACHE_LINE_PAD(a_name, a_usedBytes) \
+    char a_name[LOCK_FREE_Q_CACHE_LINE_SIZE - (a_usedBytes)];
+#else
+#define LOCK_FREE_Q_CACHE_LINE_PAD(a_name, a_usedBytes)
+#endif
+
+/// @brief arithmetic of the "count" values kept by the circular array based
+///        queues
+/// Indexes into the queue are kept as uint32_t counters that only grow. The 
+/// position in the circular array is obtained from them with toIndex. When 
+/// Q_SIZE is a power of 2 the counters can roll over from FFFFFFFF to 0 at 
+/// will, since 2^32 is a multiple of Q_SIZE, and toIndex is just a mask.
+/// Any other Q_SIZE is handled by the specialisation below
+template <uint32_t Q_SIZE, bool Q_SIZE_IS_POWER_OF_2 = ((Q_SIZE & (Q_SIZE - 1)) == 0)>
+struct ArrayLockFreeQueueCounter
+{
+    static_assert(Q_SIZE >= 2, 
+        "The queue must be able to hold at least 1 element (Q_SIZE >= 2)");
+
+    /// @brief position in the circular array that corresponds to a_count
+    static inline uint32_t toIndex(uint32_t a_count)
+    {
+        return (a_count & (Q_SIZE - 1));
+    }
+
+    /// @brief value of the counters of a new queue
+    static inline uint32_t initial()
+    {
+        return LOCK_FREE_Q_INITIAL_COUNT;
+    }
+
+    /// @brief the count value a_n positions after a_count
+    static inline uint32_t add(uint32_t a_count, uint32_t a_n)
+    {
+        return (a_count + a_n);
+    }
+
+    /// @brief number of positions between a_from and a_to (a_from being
+    ///        the oldest one)
+    static inline uint32_t distance(uint32_t a_from, uint32_t a_to)
+    {
+        return (a_to - a_from);
+    }
+};
+
+/// @brief arithmetic of the "count" values when Q_SIZE is not a power of 2
+/// 2^32 is not a multiple of Q_SIZE, so if counters were allowed to roll over 
+/// from FFFFFFFF to 0 the position in the array would jump backwards (some of
+/// the last elements wouldn't ever be used and the queue would look empty or
+/// full when it isn't). Counters are reset to 0 explicitly when they reach 
+/// WRAP_LIMIT instead, the biggest multiple of Q_SIZE that fits in a uint32_t.
+/// It is correct over any uptime, but toIndex needs a division
+template <uint32_t Q_SIZE>
+struct ArrayLockFreeQueueCounter<Q_SIZE, false>
+{
+    static_assert(Q_SIZE >= 2, 
+        "The queue must be able to hold at least 1 element (Q_SIZE >= 2)");
+
+    /// biggest multiple of Q_SIZE that fits in a uint32_t. Counters are 
+    /// always in the range [0, WRAP_LIMIT)
+    static const uint32_t WRAP_LIMIT = (0xFFFFFFFFu / Q_SIZE) * Q_SIZE;
+
+    static inline uint32_t toIndex(uint32_t a_count)
+    {
+        return (a_count % Q_SIZE);
+    }
+
+    static inline uint32_t initial()
+    {
+        // it must be in the range [0, WRAP_LIMIT) too
+        return (LOCK_FREE_Q_INITIAL_COUNT % WRAP_LIMIT);
+    }
+
+    static inline uint32_t add(uint32_t a_count, uint32_t a_n)
+    {
+        // a_count + a_n could overflow. Compare without adding first
+        return (a_count >= (WRAP_LIMIT - a_n)) ? 
+            (a_count - (WRAP_LIMIT - a_n)) : (a_count + a_n);
+    }
+
+    static inline uint32_t distance(uint32_t a_from, uint32_t a_to)
+    {
+        return (a_to >= a_from) ? 
+            (a_to - a_from) : ((WRAP_LIMIT - a_from) + a_to);
+    }
+};
+
+/// @brief "count" arithmetic of the queues that keep their slots out of line
+/// These queues also accept the size of the circular array at construction
+/// time (Q_SIZE = 0). For any other Q_SIZE the arithmetic is the one of 
+/// ArrayLockFreeQueueCounter and the size given to the constructor must be 
+/// Q_SIZE
+template <uint32_t Q_SIZE>
+struct ArrayLockFreeQueueSizedCounter : public ArrayLockFreeQueueCounter<Q_SIZE>
+{
+    explicit ArrayLockFreeQueueSizedCounter(uint32_t a_size)
+    {
+        assert(a_size == Q_SIZE); 
+        (void)a_size;
+    }
+
+    /// @brief number of slots in the circular array
+    inline uint32_t size() const
+    {
+        return Q_SIZE;
+    }
+};
+
+/// @brief "count" arithmetic for a size of the circular array only known at
+///        run time
+/// The size is rounded up to the next power of 2 so the position in the array
+/// is still a mask and counters can roll over at will
+template <>
+struct ArrayLockFreeQueueSizedCounter<0>
+{
+    explicit ArrayLockFreeQueueSizedCounter(uint32_t a_size):
+        m_size(2)
+    {
+        assert(a_size <= 0x80000000u);
+        while (m_size < a_size)
+        {
+            m_size <<= 1;
+        }
+    }
+
+    inline uint32_t size() const
+    {
+        return m_size;
+    }
+
+    inline uint32_t toIndex(uint32_t a_count) const
+    {
+        return (a_count & (m_size - 1));
+    }
+
+    inline uint32_t initial() const
+    {
+        return LOCK_FREE_Q_INITIAL_COUNT;
+    }
+
+    inline uint32_t add(uint32_t a_count, uint32_t a_n) const
+    {
+        return (a_count + a_n);
+    }
+
+    inline uint32_t distance(uint32_t a_from, uint32_t a_to) const
+    {
+        return (a_to - a_from);
+    }
+
+    /// number of slots in the circular array. A power of 2
+    uint32_t m_size;
+};
+
+/// @brief uninitialised storage for one element of the queue
+/// The element is constructed in place when it is pushed and destroyed when
+/// it is popped, so ELEM_T doesn't need a default constructor and it can be
+/// move-only. Creating the queue doesn't touch the memory of the Q_SIZE 
+/// elements either
+template <typename ELEM_T>
+struct ArrayLockFreeQueueRawSlot
+{
+    // slots can be allocated from the heap aligned to the cache line size
+    static_assert(alignof(ELEM_T) <= LOCK_FREE_Q_CACHE_LINE_SIZE,
+        "Elements aligned to more than LOCK_FREE_Q_CACHE_LINE_SIZE are not supported");
+
+    /// @brief raw memory where the element lives
+    typename std::aligned_storage<sizeof(ELEM_T), alignof(ELEM_T)>::type m_storage;
+
+    /// @brief pointer to the element. It must have been constructed
+    inline ELEM_T* get()
+    {
+        return reinterpret_cast<ELEM_T*>(&m_storage);
+    }
+
+    /// @brief construct the element in place forwarding a_args to its 
+    ///        constructor. The slot must be empty
+    template <typename... ARGS>
+    inline void construct(ARGS&&... a_args)
+    {
+        new (&m_storage) ELEM_T(std::forward<ARGS>(a_args)...);
+    }
+
+    /// @brief destroy the element. The slot is empty afterwards
+    inline void destroy()
+    {
+        get()->~ELEM_T();
+    }
+};
+
 // forward declarations for default template values
 //
 template <typename ELEM_T, uint32_t Q_SIZE>
 class ArrayLockFreeQueueSingleProducer;
 template <typename ELEM_T, uint32_t Q_SIZE>
 class ArrayLockFreeQueueMultipleProducers;
+template <typename ELEM_T, uint32_t Q_SIZE>
+class ArrayLockFreeQueueSingleProducerSingleConsumer;
+template <typename ELEM_T, uint32_t Q_SIZE>
+class ArrayLockFreeQueueSequencedSlots;
 
 
 /// @brief Lock-free queue based on a circular array
@@ -76,10 +341,8 @@ class ArrayLockFreeQueueMultipleProducers;
 ///
 /// ELEM_T represents the type of elementes pushed and popped from the queue
 /// Q_SIZE size of the queue. The actual size of the queue is (Q_SIZE-1)
-///        This number should be a power of 2 to ensure 
-///        indexes in the circular queue keep stable when the uint32_t 
-///        variable that holds the current position rolls over from FFFFFFFF
-///        to 0. For instance
+///        It must be at least 2 (checked at compile time). This number 
+///        should be a power of 2. For instance
 ///        2    -> 0x02 
 ///        4    -> 0x04
 ///        8    -> 0x08
@@ -87,31 +350,70 @@ class ArrayLockFreeQueueMultipleProducers;
 ///        (...) 
 ///        1024 -> 0x400
 ///        2048 -> 0x800
+///        
+///        The position in the circular array is then calculated masking the 
+///        uint32_t variable that holds the current position, which keeps 
+///        stable when it rolls over from FFFFFFFF to 0.
 ///
-///        if queue size is not defined as requested, let's say, for
-///        instance 100, when current position is FFFFFFFF (4,294,967,295)
-///        index in the circular array is 4,294,967,295 % 100 = 95. 
-///        When that value is incremented it will be set to 0, that is the 
-///        last 4 elements of the queue are not used when the counter rolls
-///        over to 0
-/// Q_TYPE type of queue implementation. ArrayLockFreeQueueSingleProducer and 
-///        ArrayLockFreeQueueMultipleProducers are supported (single producer
-///        by default)
+///        Any other size, let's say, for instance 100, is also supported but
+///        it is slower. Every access to the array needs a division 
+///        (position % 100) and the variable that holds the current position 
+///        must be explicitly reset to 0 before reaching FFFFFFFF, since 
+///        4,294,967,295 % 100 = 95 and the last 4 elements of the queue 
+///        would be skipped when the counter rolls over to 0. 
+///        See ArrayLockFreeQueueCounter
+///
+///        ArrayLockFreeQueueSingleProducerSingleConsumer and 
+///        ArrayLockFreeQueueSequencedSlots keep their slots out of the queue 
+///        object (in the heap by default, see ArrayLockFreeQueueStorageOptions)
+///        and also accept Q_SIZE = 0. The size is then passed to the 
+///        constructor and rounded up to the next power of 2:
+///          ArrayLockFreeQueue<int, 0, ArrayLockFreeQueueSequencedSlots> q(1000);
+///                              // 1024 slots
+/// Q_TYPE type of queue implementation. ArrayLockFreeQueueSingleProducer, 
+///        ArrayLockFreeQueueMultipleProducers, 
+///        ArrayLockFreeQueueSingleProducerSingleConsumer and 
+///        ArrayLockFreeQueueSequencedSlots are supported (single producer by
+///        default)
+/// WAIT_T what threads do in the blocking calls (pop_wait, push_wait...) while
+///        the queue is empty or full. ArrayLockFreeQueueBusySpinWait, 
+///        ArrayLockFreeQueueSpinYieldWait (default) and 
+///        ArrayLockFreeQueueParkWait are supported. 
+///        See lock_free_queue_wait.h
 template <
     typename ELEM_T, 
     uint32_t Q_SIZE = LOCK_FREE_Q_DEFAULT_SIZE, 
-    template <typename T, uint32_t S> class Q_TYPE = ArrayLockFreeQueueSingleProducer >
+    template <typename T, uint32_t S> class Q_TYPE = ArrayLockFreeQueueSingleProducer,
+    typename WAIT_T = ArrayLockFreeQueueSpinYieldWait >
 class ArrayLockFreeQueue
 {
 public:    
     /// @brief constructor of the class
     ArrayLockFreeQueue();
+
+    /// @brief constructor of the class with the size of the queue and where
+    ///        its memory comes from
+    /// Only ArrayLockFreeQueueSingleProducerSingleConsumer and 
+    /// ArrayLockFreeQueueSequencedSlots support it. They keep their slots out
+    /// of the queue object, in memory obtained following a_options (heap 
+    /// by default)
+    /// @param a_size number of slots of the circular array. It must be Q_SIZE
+    ///        unless Q_SIZE is 0, which means the size is chosen at run time.
+    ///        A run time size is rounded up to the next power of 2
+    /// @param a_options where the memory of the slots comes from (see 
+    ///        ArrayLockFreeQueueStorageOptions)
+    explicit ArrayLockFreeQueue(
+        uint32_t                                a_size,
+        const ArrayLockFreeQueueStorageOptions &a_options = ArrayLockFreeQueueStorageOptions());
     
     /// @brief destructor of the class. 
     /// Note it is not virtual since it is not expected to inherit from this
     /// template
     ~ArrayLockFreeQueue();
 
+    /// @brief maximum number of elements the queue can hold at the same time
+    inline uint32_t capacity();
+
     /// @brief returns the current number of items in the queue
     /// It tries to take a snapshot of the size of the queue, but in busy environments
     /// this function might return bogus values. 
@@ -136,21 +438,157 @@ public:
     /// @return true if the element was inserted in the queue. False if the queue was full
     inline bool push(const ELEM_T &a_data);
 
+    /// @brief push an element at the tail of the queue moving it into the queue
+    /// a_data is left in a valid but unspecified state if the element was
+    /// inserted. It is not modified if the queue was full
+    /// @param the element to move into the queue
+    /// @return true if the element was inserted in the queue. False if the queue was full
+    inline bool push(ELEM_T &&a_data);
+
+    /// @brief construct an element at the tail of the queue
+    /// ArrayLockFreeQueueSingleProducerSingleConsumer and 
+    /// ArrayLockFreeQueueSequencedSlots construct the element directly in its
+    /// slot. The other implementations build it and move it into the slot
+    /// @param a_args arguments forwarded to the constructor of ELEM_T
+    /// @return true if the element was inserted in the queue. False if the 
+    ///         queue was full (nothing is constructed then)
+    template <typename... ARGS>
+    inline bool emplace(ARGS&&... a_args);
+
     /// @brief pop the element at the head of the queue
+    /// ArrayLockFreeQueueSingleProducerSingleConsumer and 
+    /// ArrayLockFreeQueueSequencedSlots move the element out of the queue 
+    /// (allowing move-only types like std::unique_ptr). The other 
+    /// implementations read the element before they know for sure it is theirs
+    /// (another consumer might win the race for it), so the element is copied
     /// @param a reference where the element in the head of the queue will be saved to
     /// Note that the a_data parameter might contain rubbish if the function returns false
     /// @return true if the element was successfully extracted from the queue. False if the queue was empty
     inline bool pop(ELEM_T &a_data);
 
+    /// @brief push up to a_count elements at the tail of the queue
+    /// The space for all the elements is reserved at once (one update of the
+    /// index of the queue, one CAS operation when there are multiple 
+    /// producers) and then the elements are copied into the queue in order.
+    /// If there is not enough space for the a_count elements as many as 
+    /// possible are inserted
+    /// @param a_data pointer to the first element of the array to be inserted
+    /// @param a_count number of elements in the a_data array
+    /// @return number of elements inserted. They are always the first ones of
+    ///         a_data. 0 if the queue was full
+    inline uint32_t push_bulk(const ELEM_T *a_data, uint32_t a_count);
+
+    /// @brief pop up to a_maxCount elements from the head of the queue
+    /// All the elements are claimed at once (one update of the index of the
+    /// queue) and copied in order into the a_data array
+    /// @param a_data pointer to an array where at least a_maxCount elements
+    ///        can be saved to
+    /// @param a_maxCount maximum number of elements to extract
+    /// @return number of elements extracted and saved into a_data. 0 if the 
+    ///         queue was empty
+    inline uint32_t pop_bulk(ELEM_T *a_data, uint32_t a_maxCount);
+
+    /// @brief close the queue and wake up every thread waiting in it
+    /// It is an event for the blocking calls (push_wait, pop_wait...), they 
+    /// don't wait anymore once the queue is closed: the pop calls still 
+    /// extract whatever is left in the queue, but return false (or 0) instead
+    /// of waiting when it is empty, and the push calls give up if the queue 
+    /// is full. The non-blocking calls are not affected (checking the state in
+    /// them would cost every push and pop an extra atomic load), users that 
+    /// want pushes to fail after closing the queue must check closed() first
+    /// A queue can't be reopened
+    void close();
+
+    /// @brief return true if close() was called on the queue
+    inline bool closed();
+
+    /// @brief push an element at the tail of the queue. If the queue is full
+    ///        the calling thread waits (see WAIT_T) until there is space for it
+    /// @param the element to insert in the queue
+    /// @return true if the element was inserted in the queue. False if the 
+    ///         queue was closed before there was space for it
+    bool push_wait(const ELEM_T &a_data);
+
+    /// @brief move an element at the tail of the queue. If the queue is full
+    ///        the calling thread waits (see WAIT_T) until there is space for it
+    /// @param the element to move into the queue
+    /// @return true if the element was inserted in the queue. False if the 
+    ///         queue was closed before there was space for it (a_data is not
+    ///         modified then)
+    bool push_wait(ELEM_T &&a_data);
+
+    /// @brief push an element at the tail of the queue. If the queue is full
+    ///        the calling thread waits (see WAIT_T) up to a_timeout for space
+    /// @param the element to insert in the queue
+    /// @param a_timeout maximum time to wait
+    /// @return true if the element was inserted in the queue. False if the 
+    ///         timeout was hit and the queue was still full, or if the queue
+    ///         was closed
+    bool push_wait_for(const ELEM_T &a_data, std::chrono::microseconds a_timeout);
+
+    /// @brief pop the element at the head of the queue. If the queue is empty
+    ///        the calling thread waits (see WAIT_T) until there is something
+    ///        to pop
+    /// @param a reference where the element in the head of the queue will be saved to
+    /// @return true if the element was extracted from the queue. False if the
+    ///         queue is closed and empty
+    bool pop_wait(ELEM_T &a_data);
+
+    /// @brief pop the element at the head of the queue. If the queue is empty
+    ///        the calling thread waits (see WAIT_T) up to a_timeout
+    /// @param a reference where the element in the head of the queue will be saved to
+    /// @param a_timeout maximum time to wait
+    /// @return true if the element was extracted from the queue. False if the
+    ///         timeout was hit and the queue was still empty, or if the queue
+    ///         is closed and empty
+    bool pop_wait_for(ELEM_T &a_data, std::chrono::microseconds a_timeout);
+
+    /// @brief pop up to a_maxCount elements from the head of the queue. If the
+    ///        queue is empty the calling thread waits (see WAIT_T) up to 
+    ///        a_timeout for something to pop. It doesn't wait for a_maxCount
+    ///        elements to be there
+    /// @param a_data pointer to an array where at least a_maxCount elements
+    ///        can be saved to
+    /// @param a_maxCount maximum number of elements to extract
+    /// @param a_timeout maximum time to wait
+    /// @return number of elements extracted and saved into a_data. 0 if the 
+    ///         timeout was hit and the queue was still empty, or if the queue
+    ///         is closed and empty
+    uint32_t pop_bulk_wait_for(
+        ELEM_T                   *a_data, 
+        uint32_t                  a_maxCount, 
+        std::chrono::microseconds a_timeout);
+
+    /// @brief pop up to a_maxCount elements from the head of the queue. If the
+    ///        queue is empty the calling thread waits (see WAIT_T) with no 
+    ///        timeout until there is something to pop or the queue is closed
+    /// @param a_data pointer to an array where at least a_maxCount elements
+    ///        can be saved to
+    /// @param a_maxCount maximum number of elements to extract
+    /// @return number of elements extracted and saved into a_data. 0 only if 
+    ///         the queue is closed and empty
+    uint32_t pop_bulk_wait(ELEM_T *a_data, uint32_t a_maxCount);
+
 protected:
     /// @brief the actual queue. methods are forwarded into the real 
     ///        implementation
     Q_TYPE<ELEM_T, Q_SIZE> m_qImpl;
 
+    /// @brief where consumers wait for the queue to have something to pop. 
+    ///        Notified by producers
+    WAIT_T m_notEmptyWait;
+
+    /// @brief where producers wait for the queue to have space. Notified by
+    ///        consumers
+    WAIT_T m_notFullWait;
+
+    /// @brief set by close(). It wakes up every waiting thread
+    std::atomic<bool> m_closed;
+
 private:
     /// @brief disable copy constructor declaring it private
-    ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE>(
-        const ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE> &a_src);
+    ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>(
+        const ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T> &a_src);
 };
 
 /// @brief implementation of an array based lock free queue with support for a
@@ -166,39 +604,71 @@ class ArrayLockFreeQueueSingleProducer
     template <
         typename ELEM_T_, 
         uint32_t Q_SIZE_, 
-        template <typename T_, uint32_t S_> class Q_TYPE>
+        template <typename T_, uint32_t S_> class Q_TYPE,
+        typename WAIT_T_>
     friend class ArrayLockFreeQueue;
 
 private:
     /// @brief constructor of the class
     ArrayLockFreeQueueSingleProducer();
     virtual ~ArrayLockFreeQueueSingleProducer();
+
+    inline uint32_t capacity();
     
     inline uint32_t size();
     
     inline bool full();
     
     bool push(const ELEM_T &a_data);
+
+    bool push(ELEM_T &&a_data);
+
+    template <typename... ARGS>
+    bool emplace(ARGS&&... a_args);
     
     bool pop(ELEM_T &a_data);
+
+    uint32_t push_bulk(const ELEM_T *a_data, uint32_t a_count);
+
+    uint32_t pop_bulk(ELEM_T *a_data, uint32_t a_maxCount);
+
+    /// @brief assign a_data (copying or moving it) to the slot at the tail
+    ///        of the queue
+    template <typename U>
+    bool pushElement(U &&a_data);
     
     /// @brief calculate the index in the circular array that corresponds
     /// to a particular "count" value
     inline uint32_t countToIndex(uint32_t a_count);
 
+    /// @brief calculate the "count" value a_n positions after a_count
+    inline uint32_t countAdd(uint32_t a_count, uint32_t a_n = 1);
+
 private:    
     /// @brief array to keep the elements
+    /// Consumers read an element before they know for sure it is theirs, so
+    /// the slots must always hold constructed elements
     ELEM_T m_theQueue[Q_SIZE];
 
+    // the last elements of the array must not share the cache line with
+    // the write index
+    LOCK_FREE_Q_CACHE_LINE_PAD(m_padding0, 0)
+
     /// @brief where a new element will be inserted
     std::atomic<uint32_t> m_writeIndex;
 
+    LOCK_FREE_Q_CACHE_LINE_PAD(m_padding1, sizeof(std::atomic<uint32_t>))
+
     /// @brief where the next element where be extracted from
     std::atomic<uint32_t> m_readIndex;
 
+    LOCK_FREE_Q_CACHE_LINE_PAD(m_padding2, sizeof(std::atomic<uint32_t>))
+
 #ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
     /// @brief number of elements in the queue
     std::atomic<uint32_t> m_count;
+
+    LOCK_FREE_Q_CACHE_LINE_PAD(m_padding3, sizeof(std::atomic<uint32_t>))
 #endif
 
 private:
@@ -220,7 +690,8 @@ class ArrayLockFreeQueueMultipleProducers
     template <
         typename ELEM_T_, 
         uint32_t Q_SIZE_, 
-        template <typename T_, uint32_t S_> class Q_TYPE>
+        template <typename T_, uint32_t S_> class Q_TYPE,
+        typename WAIT_T_>
     friend class ArrayLockFreeQueue;
 
 private:
@@ -228,28 +699,63 @@ private:
     ArrayLockFreeQueueMultipleProducers();
     
     virtual ~ArrayLockFreeQueueMultipleProducers();
+
+    inline uint32_t capacity();
     
     inline uint32_t size();
     
     inline bool full();
     
     bool push(const ELEM_T &a_data);   
+
+    bool push(ELEM_T &&a_data);
+
+    template <typename... ARGS>
+    bool emplace(ARGS&&... a_args);
     
     bool pop(ELEM_T &a_data);
+
+    uint32_t push_bulk(const ELEM_T *a_data, uint32_t a_count);
+
+    uint32_t pop_bulk(ELEM_T *a_data, uint32_t a_maxCount);
+
+    /// @brief assign a_data (copying or moving it) to the slot at the tail
+    ///        of the queue
+    template <typename U>
+    bool pushElement(U &&a_data);
+
+    /// @brief make the a_count elements reserved at a_writeIndex visible to 
+    ///        consumers updating m_maximumReadIndex
+    /// It waits for all the producers that reserved space before a_writeIndex
+    /// to commit their data first
+    inline void commit(uint32_t a_writeIndex, uint32_t a_count);
     
     /// @brief calculate the index in the circular array that corresponds
     /// to a particular "count" value
     inline uint32_t countToIndex(uint32_t a_count);
+
+    /// @brief calculate the "count" value a_n positions after a_count
+    inline uint32_t countAdd(uint32_t a_count, uint32_t a_n = 1);
     
 private:    
     /// @brief array to keep the elements
+    /// Consumers read an element before they know for sure it is theirs, so
+    /// the slots must always hold constructed elements
     ELEM_T m_theQueue[Q_SIZE];
 
+    // the last elements of the array must not share the cache line with
+    // the write index
+    LOCK_FREE_Q_CACHE_LINE_PAD(m_padding0, 0)
+
     /// @brief where a new element will be inserted
     std::atomic<uint32_t> m_writeIndex;
 
+    LOCK_FREE_Q_CACHE_LINE_PAD(m_padding1, sizeof(std::atomic<uint32_t>))
+
     /// @brief where the next element where be extracted from
     std::atomic<uint32_t> m_readIndex;
+
+    LOCK_FREE_Q_CACHE_LINE_PAD(m_padding2, sizeof(std::atomic<uint32_t>))
     
     /// @brief maximum read index for multiple producer queues
     /// If it's not the same as m_writeIndex it means
@@ -261,9 +767,13 @@ private:
     /// note this is only used for multiple producers
     std::atomic<uint32_t> m_maximumReadIndex;
 
+    LOCK_FREE_Q_CACHE_LINE_PAD(m_padding3, sizeof(std::atomic<uint32_t>))
+
 #ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
     /// @brief number of elements in the queue
     std::atomic<uint32_t> m_count;
+
+    LOCK_FREE_Q_CACHE_LINE_PAD(m_padding4, sizeof(std::atomic<uint32_t>))
 #endif
 
 private:
@@ -272,9 +782,270 @@ private:
         const ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE> &a_src);
 };
 
+/// @brief implementation of an array based lock free queue with support for a
+///        single producer and a single consumer
+/// There is no CAS operation involved in push or pop. Each index is only 
+/// written by one thread (the write index by the producer, the read index by
+/// the consumer) so they are updated using plain stores with release semantics
+/// and read by the other side with acquire semantics.
+/// The producer keeps a local copy of the last read index it saw (and the 
+/// consumer a local copy of the last write index) so the cache line owned by
+/// the other thread is only accessed when the local copy says the queue is full
+/// (or empty). Both indexes are always placed in their own cache line 
+/// (see LOCK_FREE_Q_CACHE_LINE_SIZE). The slots are kept out of the queue 
+/// object, in memory allocated following ArrayLockFreeQueueStorageOptions
+///
+/// WARNING: Only one thread can push and only one thread can pop elements. 
+/// Calling push (or pop) concurrently from 2 different threads corrupts the 
+/// queue. 
+///
+/// This class is prevented from being instantiated directly (all members and
+/// methods are private). To instantiate a single producer single consumer lock
+/// free queue you must use the ArrayLockFreeQueue fachade:
+///   ArrayLockFreeQueue<int, 100, ArrayLockFreeQueueSingleProducerSingleConsumer> q;
+template <typename ELEM_T, uint32_t Q_SIZE>
+class ArrayLockFreeQueueSingleProducerSingleConsumer
+{
+    // ArrayLockFreeQueue will be using this' private members
+    template <
+        typename ELEM_T_, 
+        uint32_t Q_SIZE_, 
+        template <typename T_, uint32_t S_> class Q_TYPE,
+        typename WAIT_T_>
+    friend class ArrayLockFreeQueue;
+
+private:
+    /// @brief constructor of the class. Q_SIZE slots allocated from the heap
+    ArrayLockFreeQueueSingleProducerSingleConsumer();
+
+    /// @brief constructor of the class
+    /// @param a_size number of slots (see ArrayLockFreeQueueSizedCounter)
+    /// @param a_options where the memory of the slots comes from
+    ArrayLockFreeQueueSingleProducerSingleConsumer(
+        uint32_t                                a_size,
+        const ArrayLockFreeQueueStorageOptions &a_options);
+    
+    virtual ~ArrayLockFreeQueueSingleProducerSingleConsumer();
+
+    inline uint32_t capacity();
+    
+    /// The size is calculated from the value of both indexes. It is always 
+    /// a value between 0 and (Q_SIZE - 1), though it might be out of date by
+    /// the time the caller uses it. _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE is not 
+    /// used by this implementation
+    inline uint32_t size();
+    
+    inline bool full();
+    
+    /// @brief to be called only from the producer thread
+    bool push(const ELEM_T &a_data);
+
+    /// @brief to be called only from the producer thread
+    bool push(ELEM_T &&a_data);
+
+    /// @brief to be called only from the producer thread
+    template <typename... ARGS>
+    bool emplace(ARGS&&... a_args);
+    
+    /// @brief to be called only from the consumer thread
+    bool pop(ELEM_T &a_data);
+
+    /// @brief to be called only from the producer thread
+    uint32_t push_bulk(const ELEM_T *a_data, uint32_t a_count);
+
+    /// @brief to be called only from the consumer thread
+    uint32_t pop_bulk(ELEM_T *a_data, uint32_t a_maxCount);
+    
+    /// @brief calculate the index in the circular array that corresponds
+    /// to a particular "count" value
+    inline uint32_t countToIndex(uint32_t a_count);
+
+    /// @brief calculate the "count" value a_n positions after a_count
+    inline uint32_t countAdd(uint32_t a_count, uint32_t a_n = 1);
+
+private:    
+    /// @brief "count" arithmetic and size of the circular array
+    ArrayLockFreeQueueSizedCounter<Q_SIZE> m_counter;
+
+    /// @brief memory where the slots are kept
+    ArrayLockFreeQueueMemory m_memory;
+
+    /// @brief array to keep the elements (in m_memory). Only the slots 
+    ///        between the read and the write index hold constructed elements
+    ArrayLockFreeQueueRawSlot<ELEM_T>* m_theQueue;
+
+    // the members above are only read after construction. They must not 
+    // share the cache line with the write index
+    char m_padding0[LOCK_FREE_Q_CACHE_LINE_SIZE];
+
+    // cache line owned by the producer thread
+    //
+
+    /// @brief where a new element will be inserted. Written only by the 
+    ///        producer
+    std::atomic<uint32_t> m_writeIndex;
+
+    /// @brief copy of m_readIndex the producer saw the last time it had to 
+    ///        read it. Accessed only by the producer
+    uint32_t m_cachedReadIndex;
+
+    char m_padding1[LOCK_FREE_Q_CACHE_LINE_SIZE - 
+                    sizeof(std::atomic<uint32_t>) - sizeof(uint32_t)];
+
+    // cache line owned by the consumer thread
+    //
+
+    /// @brief where the next element where be extracted from. Written only 
+    ///        by the consumer
+    std::atomic<uint32_t> m_readIndex;
+
+    /// @brief copy of m_writeIndex the consumer saw the last time it had to
+    ///        read it. Accessed only by the consumer
+    uint32_t m_cachedWriteIndex;
+
+    char m_padding2[LOCK_FREE_Q_CACHE_LINE_SIZE - 
+                    sizeof(std::atomic<uint32_t>) - sizeof(uint32_t)];
+
+private:
+    /// @brief disable copy constructor declaring it private
+    ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>(
+        const ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE> &a_src);
+};
+
+/// @brief implementation of an array based lock free queue with support for 
+///        multiple producers and multiple consumers where every slot of the 
+///        array keeps its own sequence number
+/// This is the bounded MPMC queue described by Dmitry Vyukov:
+/// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+///
+/// The sequence number of a slot says whether the slot is ready to be written
+/// by the producer that reserves the position "count" (sequence == count) or 
+/// ready to be read by the consumer that reserves it (sequence == count + 1).
+/// A producer publishes its element updating the sequence of its own slot, so
+/// unlike ArrayLockFreeQueueMultipleProducers there is no m_maximumReadIndex
+/// and producers never wait for each other to commit their data. A consumer 
+/// that reaches a slot reserved by a producer that is still writing into it 
+/// returns false straight away (as if the queue was empty) instead of spinning
+///
+/// All the Q_SIZE slots of the array can be used (the actual size of the queue
+/// is Q_SIZE, not Q_SIZE - 1). The slots are kept out of the queue object, in
+/// memory allocated following ArrayLockFreeQueueStorageOptions. 
+/// Q_SIZE must be a power of 2 (checked at compile
+/// time) since sequence numbers are compared through the difference of two
+/// uint32_t counters, which is only meaningful if they roll over naturally.
+///
+/// This class is prevented from being instantiated directly (all members and
+/// methods are private). To instantiate a sequenced slots lock free queue you
+/// must use the ArrayLockFreeQueue fachade:
+///   ArrayLockFreeQueue<int, 128, ArrayLockFreeQueueSequencedSlots> q;
+template <typename ELEM_T, uint32_t Q_SIZE>
+class ArrayLockFreeQueueSequencedSlots
+{
+    // ArrayLockFreeQueue will be using this' private members
+    template <
+        typename ELEM_T_, 
+        uint32_t Q_SIZE_, 
+        template <typename T_, uint32_t S_> class Q_TYPE,
+        typename WAIT_T_>
+    friend class ArrayLockFreeQueue;
+
+    static_assert((Q_SIZE & (Q_SIZE - 1)) == 0,
+        "ArrayLockFreeQueueSequencedSlots needs Q_SIZE to be a power of 2");
+
+private:
+    /// @brief constructor of the class. Q_SIZE slots allocated from the heap
+    ArrayLockFreeQueueSequencedSlots();
+
+    /// @brief constructor of the class
+    /// @param a_size number of slots (see ArrayLockFreeQueueSizedCounter)
+    /// @param a_options where the memory of the slots comes from
+    ArrayLockFreeQueueSequencedSlots(
+        uint32_t                                a_size,
+        const ArrayLockFreeQueueStorageOptions &a_options);
+    
+    virtual ~ArrayLockFreeQueueSequencedSlots();
+
+    inline uint32_t capacity();
+    
+    inline uint32_t size();
+    
+    inline bool full();
+    
+    bool push(const ELEM_T &a_data);   
+
+    bool push(ELEM_T &&a_data);
+
+    template <typename... ARGS>
+    bool emplace(ARGS&&... a_args);
+    
+    bool pop(ELEM_T &a_data);
+
+    uint32_t push_bulk(const ELEM_T *a_data, uint32_t a_count);
+
+    uint32_t pop_bulk(ELEM_T *a_data, uint32_t a_maxCount);
+    
+    /// @brief calculate the index in the circular array that corresponds
+    /// to a particular "count" value
+    inline uint32_t countToIndex(uint32_t a_count);
+
+    /// @brief calculate the "count" value a_n positions after a_count
+    inline uint32_t countAdd(uint32_t a_count, uint32_t a_n = 1);
+
+    /// @brief a position of the circular array
+    struct Slot
+    {
+        /// @brief count value of the next operation allowed on this slot
+        /// "count" for a push, "count + 1" for a pop
+        std::atomic<uint32_t> m_sequence;
+        /// @brief the element. Constructed only while the slot holds an 
+        ///        element that hasn't been popped yet
+        ArrayLockFreeQueueRawSlot<ELEM_T> m_data;
+    };
+    
+private:    
+    /// @brief "count" arithmetic and size of the circular array
+    ArrayLockFreeQueueSizedCounter<Q_SIZE> m_counter;
+
+    /// @brief memory where the slots are kept
+    ArrayLockFreeQueueMemory m_memory;
+
+    /// @brief array to keep the elements (in m_memory)
+    Slot* m_theQueue;
+
+    // the members above are only read after construction. They must not 
+    // share the cache line with the write index
+    char m_padding0[LOCK_FREE_Q_CACHE_LINE_SIZE];
+
+    /// @brief where the next producer will reserve space for its element. 
+    ///        Shared only by producers
+    std::atomic<uint32_t> m_writeIndex;
+
+    char m_padding1[LOCK_FREE_Q_CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+
+    /// @brief where the next consumer will extract an element from. Shared 
+    ///        only by consumers
+    std::atomic<uint32_t> m_readIndex;
+
+    char m_padding2[LOCK_FREE_Q_CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+    /// @brief number of elements in the queue
+    std::atomic<uint32_t> m_count;
+
+    char m_padding3[LOCK_FREE_Q_CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+#endif
+
+private:
+    /// @brief disable copy constructor declaring it private
+    ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>(
+        const ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE> &a_src);
+};
+
 // include implementation files
 #include "lock_free_queue_impl.h"
 #include "lock_free_queue_impl_single_producer.h"
 #include "lock_free_queue_impl_multiple_producer.h"
+#include "lock_free_queue_impl_single_producer_single_consumer.h"
+#include "lock_free_queue_impl_sequenced_slots.h"
 
 #endif // _LOCK_FREE_QUEUE_H__
@@ -0,0 +1,621 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file lock_free_queue_adapter.h
+/// @brief SafeQueue-like interface on top of the circular array based 
+///        lock-free queue
+/// It allows ConsumerThread (and anything else written against SafeQueue) to
+/// run on top of ArrayLockFreeQueue:
+///   ConsumerThread<int, ArrayLockFreeQueueAdapter<int, 1024, 
+///       ArrayLockFreeQueueSingleProducerSingleConsumer, 
+///       ArrayLockFreeQueueParkWait> > consumer(...);
+///
+/// The calls that block in SafeQueue (Push, Pop, TimedWaitPop...) wait for 
+/// the queue following the wait strategy of the ArrayLockFreeQueue (WAIT_T). 
+/// Only ArrayLockFreeQueueParkWait puts idle threads to sleep, the other 
+/// strategies keep the waiting thread (an idle consumer) busy on the CPU. 
+/// The restrictions of the queue implementation (Q_TYPE) still apply: only 
+/// one thread can call the push functions of a queue based on 
+/// ArrayLockFreeQueueSingleProducer or 
+/// ArrayLockFreeQueueSingleProducerSingleConsumer, for instance
+///
+/// Close follows SafeQueue::Close, though a push racing with Close might still
+/// get its element into the queue (the state is checked before the element is
+/// pushed, not atomically with it)
+///
+/// The statistics policy STATS_T (see queue_stats.h) is QueueNoStats by 
+/// default, which forwards every call straight into the queue. With 
+/// QueueStats every element carries the time it was pushed next to it
+///
+// ============================================================================
+
+#ifndef __LOCK_FREE_QUEUE_ADAPTER_H__
+#define __LOCK_FREE_QUEUE_ADAPTER_H__
+
+#include <stddef.h> // size_t
+#include <chrono>
+#include <utility>  // std::move, std::forward
+#include "lock_free_queue.h"
+#include "queue_stats.h"
+
+// number of elements the adapter extracts at once from the queue in the bulk
+// calls when statistics are enabled (they are popped into an array in the
+// stack before being moved into the caller's)
+#define LOCK_FREE_Q_ADAPTER_STATS_CHUNK 16
+
+/// @brief element of the queue when statistics are enabled. It keeps the time
+///        it was pushed into the queue
+template <typename T>
+struct ArrayLockFreeQueueStampedElement
+{
+    ArrayLockFreeQueueStampedElement():
+        m_elem(),
+        m_stamp(0)
+    {}
+
+    template <typename... ARGS>
+    explicit ArrayLockFreeQueueStampedElement(uint64_t a_stamp, ARGS&&... a_args):
+        m_elem(std::forward<ARGS>(a_args)...),
+        m_stamp(a_stamp)
+    {}
+
+    T        m_elem;
+    uint64_t m_stamp;
+};
+
+/// @brief what ArrayLockFreeQueueAdapter does in each call. Without 
+///        statistics everything is forwarded into the queue
+template <typename T, typename STATS_T, bool ENABLED = STATS_T::ENABLED>
+struct ArrayLockFreeQueueAdapterOps
+{
+    typedef T Stored_t;
+
+    template <typename Q, typename U>
+    static inline bool TryPush(Q &a_queue, STATS_T &, U &&a_elem)
+    {
+        return a_queue.push(std::forward<U>(a_elem));
+    }
+
+    template <typename Q, typename U>
+    static inline bool PushWait(Q &a_queue, STATS_T &, U &&a_elem)
+    {
+        return a_queue.push_wait(std::forward<U>(a_elem));
+    }
+
+    template <typename Q, typename... ARGS>
+    static inline bool TryEmplace(Q &a_queue, STATS_T &, ARGS&&... a_args)
+    {
+        return a_queue.emplace(std::forward<ARGS>(a_args)...);
+    }
+
+    template <typename Q>
+    static inline bool TryPop(Q &a_queue, STATS_T &, T &out_data)
+    {
+        return a_queue.pop(out_data);
+    }
+
+    template <typename Q>
+    static inline bool PopWait(Q &a_queue, STATS_T &, T &out_data)
+    {
+        return a_queue.pop_wait(out_data);
+    }
+
+    template <typename Q>
+    static inline bool TimedWaitPop(
+        Q &a_queue, STATS_T &, T &out_data, std::chrono::microseconds a_timeout)
+    {
+        return a_queue.pop_wait_for(out_data, a_timeout);
+    }
+
+    template <typename Q>
+    static inline size_t TryPushBulk(
+        Q &a_queue, STATS_T &, const T *a_elems, uint32_t a_count)
+    {
+        return a_queue.push_bulk(a_elems, a_count);
+    }
+
+    template <typename Q>
+    static inline size_t TryPopBulk(
+        Q &a_queue, STATS_T &, T *out_data, uint32_t a_maxCount)
+    {
+        return a_queue.pop_bulk(out_data, a_maxCount);
+    }
+
+    template <typename Q>
+    static inline size_t TimedWaitPopBulk(
+        Q &a_queue, STATS_T &, T *out_data, uint32_t a_maxCount, 
+        std::chrono::microseconds a_timeout)
+    {
+        return a_queue.pop_bulk_wait_for(out_data, a_maxCount, a_timeout);
+    }
+
+    template <typename Q>
+    static inline size_t WaitPopBulk(
+        Q &a_queue, STATS_T &, T *out_data, uint32_t a_maxCount)
+    {
+        return a_queue.pop_bulk_wait(out_data, a_maxCount);
+    }
+};
+
+/// @brief what ArrayLockFreeQueueAdapter does in each call when statistics 
+///        are enabled. Elements are stamped on the way in and the time in the
+///        queue is recorded on the way out
+template <typename T, typename STATS_T>
+struct ArrayLockFreeQueueAdapterOps<T, STATS_T, true>
+{
+    typedef ArrayLockFreeQueueStampedElement<T> Stored_t;
+
+    template <typename Q, typename U>
+    static inline bool TryPush(Q &a_queue, STATS_T &a_stats, U &&a_elem)
+    {
+        uint64_t retries = ArrayLockFreeQueueCasRetries();
+
+        Stored_t stored(a_stats.Stamp(), std::forward<U>(a_elem));
+        bool rv = a_queue.push(std::move(stored));
+        if (rv)
+        {
+            a_stats.OnPush(a_queue.size());
+        }
+        else
+        {
+            // the caller's element must be left as it was
+            a_stats.OnPushFull();
+            Restore(a_elem, stored);
+        }
+
+        a_stats.OnCasRetries(ArrayLockFreeQueueCasRetries() - retries);
+        return rv;
+    }
+
+    template <typename Q, typename U>
+    static inline bool PushWait(Q &a_queue, STATS_T &a_stats, U &&a_elem)
+    {
+        uint64_t retries = ArrayLockFreeQueueCasRetries();
+
+        Stored_t stored(a_stats.Stamp(), std::forward<U>(a_elem));
+        bool rv = a_queue.push(std::move(stored));
+        if (!rv)
+        {
+            a_stats.OnPushFull();
+            rv = a_queue.push_wait(std::move(stored));
+        }
+        if (rv)
+        {
+            a_stats.OnPush(a_queue.size());
+        }
+        else
+        {
+            Restore(a_elem, stored);
+        }
+
+        a_stats.OnCasRetries(ArrayLockFreeQueueCasRetries() - retries);
+        return rv;
+    }
+
+    template <typename Q, typename... ARGS>
+    static inline bool TryEmplace(Q &a_queue, STATS_T &a_stats, ARGS&&... a_args)
+    {
+        uint64_t retries = ArrayLockFreeQueueCasRetries();
+
+        bool rv = a_queue.emplace(a_stats.Stamp(), std::forward<ARGS>(a_args)...);
+        if (rv)
+        {
+            a_stats.OnPush(a_queue.size());
+        }
+        else
+        {
+            a_stats.OnPushFull();
+        }
+
+        a_stats.OnCasRetries(ArrayLockFreeQueueCasRetries() - retries);
+        return rv;
+    }
+
+    template <typename Q>
+    static inline bool TryPop(Q &a_queue, STATS_T &a_stats, T &out_data)
+    {
+        uint64_t retries = ArrayLockFreeQueueCasRetries();
+
+        Stored_t stored;
+        bool rv = a_queue.pop(stored);
+        if (rv)
+        {
+            Unpack(a_stats, stored, out_data);
+        }
+
+        a_stats.OnCasRetries(ArrayLockFreeQueueCasRetries() - retries);
+        return rv;
+    }
+
+    template <typename Q>
+    static inline bool PopWait(Q &a_queue, STATS_T &a_stats, T &out_data)
+    {
+        uint64_t retries = ArrayLockFreeQueueCasRetries();
+
+        Stored_t stored;
+        bool rv = a_queue.pop_wait(stored);
+        if (rv)
+        {
+            Unpack(a_stats, stored, out_data);
+        }
+
+        a_stats.OnCasRetries(ArrayLockFreeQueueCasRetries() - retries);
+        return rv;
+    }
+
+    template <typename Q>
+    static inline bool TimedWaitPop(
+        Q &a_queue, STATS_T &a_stats, T &out_data, std::chrono::microseconds a_timeout)
+    {
+        uint64_t retries = ArrayLockFreeQueueCasRetries();
+
+        Stored_t stored;
+        bool rv = a_queue.pop_wait_for(stored, a_timeout);
+        if (rv)
+        {
+            Unpack(a_stats, stored, out_data);
+        }
+
+        a_stats.OnCasRetries(ArrayLockFreeQueueCasRetries() - retries);
+        return rv;
+    }
+
+    template <typename Q>
+    static inline size_t TryPushBulk(
+        Q &a_queue, STATS_T &a_stats, const T *a_elems, uint32_t a_count)
+    {
+        uint64_t retries = ArrayLockFreeQueueCasRetries();
+
+        Stored_t chunk[LOCK_FREE_Q_ADAPTER_STATS_CHUNK];
+        uint32_t count = 0;
+        while (count < a_count)
+        {
+            uint32_t chunkCount = a_count - count;
+            if (chunkCount > LOCK_FREE_Q_ADAPTER_STATS_CHUNK)
+            {
+                chunkCount = LOCK_FREE_Q_ADAPTER_STATS_CHUNK;
+            }
+
+            uint64_t stamp = a_stats.Stamp();
+            for (uint32_t i = 0; i < chunkCount; i++)
+            {
+                chunk[i].m_elem  = a_elems[count + i];
+                chunk[i].m_stamp = stamp;
+            }
+
+            uint32_t pushed = a_queue.push_bulk(chunk, chunkCount);
+            count += pushed;
+            for (uint32_t i = 0; i < pushed; i++)
+            {
+                a_stats.OnPush(a_queue.size());
+            }
+
+            if (pushed < chunkCount)
+            {
+                a_stats.OnPushFull();
+                break;
+            }
+        }
+
+        a_stats.OnCasRetries(ArrayLockFreeQueueCasRetries() - retries);
+        return count;
+    }
+
+    template <typename Q>
+    static inline size_t TryPopBulk(
+        Q &a_queue, STATS_T &a_stats, T *out_data, uint32_t a_maxCount)
+    {
+        uint64_t retries = ArrayLockFreeQueueCasRetries();
+
+        size_t count = PopBulkChunks(a_queue, a_stats, out_data, a_maxCount);
+
+        a_stats.OnCasRetries(ArrayLockFreeQueueCasRetries() - retries);
+        return count;
+    }
+
+    template <typename Q>
+    static inline size_t TimedWaitPopBulk(
+        Q &a_queue, STATS_T &a_stats, T *out_data, uint32_t a_maxCount, 
+        std::chrono::microseconds a_timeout)
+    {
+        uint64_t retries = ArrayLockFreeQueueCasRetries();
+
+        // wait for the first element, then take whatever else is there
+        size_t count = 0;
+        if (a_maxCount > 0)
+        {
+            Stored_t stored;
+            if (a_queue.pop_wait_for(stored, a_timeout))
+            {
+                Unpack(a_stats, stored, out_data[0]);
+                count = 1 + PopBulkChunks(
+                    a_queue, a_stats, out_data + 1, a_maxCount - 1);
+            }
+        }
+
+        a_stats.OnCasRetries(ArrayLockFreeQueueCasRetries() - retries);
+        return count;
+    }
+
+    template <typename Q>
+    static inline size_t WaitPopBulk(
+        Q &a_queue, STATS_T &a_stats, T *out_data, uint32_t a_maxCount)
+    {
+        uint64_t retries = ArrayLockFreeQueueCasRetries();
+
+        size_t count = 0;
+        if (a_maxCount > 0)
+        {
+            Stored_t stored;
+            if (a_queue.pop_wait(stored))
+            {
+                Unpack(a_stats, stored, out_data[0]);
+                count = 1 + PopBulkChunks(
+                    a_queue, a_stats, out_data + 1, a_maxCount - 1);
+            }
+        }
+
+        a_stats.OnCasRetries(ArrayLockFreeQueueCasRetries() - retries);
+        return count;
+    }
+
+private:
+    /// @brief move the element out of a_stored and record its time in queue
+    static inline void Unpack(STATS_T &a_stats, Stored_t &a_stored, T &out_data)
+    {
+        out_data = std::move(a_stored.m_elem);
+        a_stats.OnPop(a_stored.m_stamp);
+    }
+
+    /// @brief give the caller's element back after a failed push
+    static inline void Restore(T &out_elem, Stored_t &a_stored)
+    {
+        out_elem = std::move(a_stored.m_elem);
+    }
+
+    /// @brief nothing to give back. The element was copied
+    static inline void Restore(const T &, Stored_t &)
+    {}
+
+    /// @brief non-blocking pop of up to a_maxCount elements, 
+    ///        LOCK_FREE_Q_ADAPTER_STATS_CHUNK at a time
+    template <typename Q>
+    static inline size_t PopBulkChunks(
+        Q &a_queue, STATS_T &a_stats, T *out_data, uint32_t a_maxCount)
+    {
+        Stored_t chunk[LOCK_FREE_Q_ADAPTER_STATS_CHUNK];
+        uint32_t count = 0;
+        while (count < a_maxCount)
+        {
+            uint32_t chunkCount = a_maxCount - count;
+            if (chunkCount > LOCK_FREE_Q_ADAPTER_STATS_CHUNK)
+            {
+                chunkCount = LOCK_FREE_Q_ADAPTER_STATS_CHUNK;
+            }
+
+            uint32_t popped = a_queue.pop_bulk(chunk, chunkCount);
+            for (uint32_t i = 0; i < popped; i++)
+            {
+                Unpack(a_stats, chunk[i], out_data[count + i]);
+            }
+            count += popped;
+
+            if (popped < chunkCount)
+            {
+                break;
+            }
+        }
+
+        return count;
+    }
+};
+
+/// @brief SafeQueue interface for ArrayLockFreeQueue
+/// The first template parameters are the ones of ArrayLockFreeQueue. STATS_T
+/// is the statistics policy (see queue_stats.h)
+template <
+    typename T, 
+    uint32_t Q_SIZE = LOCK_FREE_Q_DEFAULT_SIZE, 
+    template <typename T_, uint32_t S_> class Q_TYPE = ArrayLockFreeQueueSingleProducerSingleConsumer,
+    typename WAIT_T = ArrayLockFreeQueueSpinYieldWait,
+    typename STATS_T = QueueNoStats>
+class ArrayLockFreeQueueAdapter
+{
+    typedef ArrayLockFreeQueueAdapterOps<T, STATS_T> Ops_t;
+
+public:
+    typedef ArrayLockFreeQueue<typename Ops_t::Stored_t, Q_SIZE, Q_TYPE, WAIT_T> Queue_t;
+
+    /// @brief constructor. The size of the queue is Q_SIZE
+    ArrayLockFreeQueueAdapter():
+        m_queue(),
+        m_stats()
+    {}
+
+    /// @brief constructor for the queue implementations that take the size
+    ///        at run time (Q_SIZE = 0). See ArrayLockFreeQueue
+    /// @param a_size number of slots of the queue
+    explicit ArrayLockFreeQueueAdapter(size_t a_size):
+        m_queue(static_cast<uint32_t>(a_size)),
+        m_stats()
+    {}
+
+    /// @brief Check if the queue is empty
+    /// @return true if the queue is empty. False otherwise
+    bool IsEmpty()
+    {
+        return (m_queue.size() == 0);
+    }
+
+    /// @brief closes the queue and wakes up every thread blocked in it
+    /// See SafeQueue::Close
+    void Close()
+    {
+        m_queue.close();
+    }
+
+    /// @brief Check if Close was called on the queue
+    bool IsClosed()
+    {
+        return m_queue.closed();
+    }
+
+    /// @brief inserts an element into the queue. Waits while it is full
+    /// The element is discarded if the queue is (or gets) closed
+    /// @return true if the element was inserted. False if it was discarded
+    bool Push(const T &a_elem)
+    {
+        return (!m_queue.closed()) && Ops_t::PushWait(m_queue, m_stats, a_elem);
+    }
+
+    /// @brief moves an element into the queue. Waits while it is full
+    /// The element is discarded if the queue is (or gets) closed
+    bool Push(T &&a_elem)
+    {
+        return (!m_queue.closed()) && 
+               Ops_t::PushWait(m_queue, m_stats, std::move(a_elem));
+    }
+
+    /// @brief constructs an element in the queue. Waits while it is full
+    /// Nothing is constructed if the queue is (or gets) closed
+    template <typename... ARGS>
+    bool Emplace(ARGS&&... a_args)
+    {
+        // the element has to be built before waiting, emplace only succeeds 
+        // once and the arguments can't be forwarded more than once
+        return (!m_queue.closed()) && 
+               Ops_t::PushWait(m_queue, m_stats, T(std::forward<ARGS>(a_args)...));
+    }
+
+    /// @brief inserts an element into the queue
+    /// @return true if the element was inserted. False if the queue was full
+    ///         or closed
+    bool TryPush(const T &a_elem)
+    {
+        return (!m_queue.closed()) && Ops_t::TryPush(m_queue, m_stats, a_elem);
+    }
+
+    /// @brief moves an element into the queue
+    /// @return true if the element was inserted. False if the queue was full
+    ///         or closed (a_elem is not modified then)
+    bool TryPush(T &&a_elem)
+    {
+        return (!m_queue.closed()) && 
+               Ops_t::TryPush(m_queue, m_stats, std::move(a_elem));
+    }
+
+    /// @brief constructs an element in the queue
+    /// @return true if the element was inserted. False if the queue was full
+    ///         or closed
+    template <typename... ARGS>
+    bool TryEmplace(ARGS&&... a_args)
+    {
+        return (!m_queue.closed()) && 
+               Ops_t::TryEmplace(m_queue, m_stats, std::forward<ARGS>(a_args)...);
+    }
+
+    /// @brief extracts an element from the queue. Waits while it is empty
+    /// It returns without modifying out_data if the queue is (or gets) closed
+    /// while it is empty
+    void Pop(T &out_data)
+    {
+        Ops_t::PopWait(m_queue, m_stats, out_data);
+    }
+
+    /// @brief extracts an element from the queue
+    /// @return true if an element was extracted. False if the queue was empty
+    bool TryPop(T &out_data)
+    {
+        return Ops_t::TryPop(m_queue, m_stats, out_data);
+    }
+
+    /// @brief extracts an element from the queue waiting up to a_microsecs 
+    ///        if the queue is empty
+    /// @return true if an element was extracted. False if the timeout was hit
+    ///         (or the queue is closed) and the queue is empty
+    bool TimedWaitPop(T &data, std::chrono::microseconds a_microsecs)
+    {
+        return Ops_t::TimedWaitPop(m_queue, m_stats, data, a_microsecs);
+    }
+
+    /// @brief inserts up to a_count elements into the queue
+    /// @return the number of elements inserted
+    size_t TryPushBulk(const T* a_elems, size_t a_count)
+    {
+        if (m_queue.closed())
+        {
+            return 0;
+        }
+        return Ops_t::TryPushBulk(
+            m_queue, m_stats, a_elems, static_cast<uint32_t>(a_count));
+    }
+
+    /// @brief extracts up to a_maxCount elements from the queue
+    /// @return the number of elements extracted
+    size_t TryPopBulk(T* out_data, size_t a_maxCount)
+    {
+        return Ops_t::TryPopBulk(
+            m_queue, m_stats, out_data, static_cast<uint32_t>(a_maxCount));
+    }
+
+    /// @brief extracts up to a_maxCount elements from the queue waiting up to
+    ///        a_microsecs if the queue is empty
+    /// @return the number of elements extracted. 0 if the timeout was hit
+    ///         (or the queue is closed) and the queue is empty
+    size_t TimedWaitPopBulk(
+        T*                        out_data, 
+        size_t                    a_maxCount, 
+        std::chrono::microseconds a_microsecs)
+    {
+        return Ops_t::TimedWaitPopBulk(
+            m_queue, m_stats, out_data, static_cast<uint32_t>(a_maxCount), 
+            a_microsecs);
+    }
+
+    /// @brief extracts up to a_maxCount elements from the queue waiting with
+    ///        no timeout if the queue is empty
+    /// @return the number of elements extracted. 0 only if the queue is 
+    ///         closed and empty
+    size_t WaitPopBulk(T* out_data, size_t a_maxCount)
+    {
+        return Ops_t::WaitPopBulk(
+            m_queue, m_stats, out_data, static_cast<uint32_t>(a_maxCount));
+    }
+
+    /// @brief statistics of the queue (see queue_stats.h). Everything is 0 if
+    ///        STATS_T is QueueNoStats
+    void GetStats(QueueStatsSnapshot &out_stats) const
+    {
+        m_stats.GetSnapshot(out_stats);
+    }
+
+private:
+    /// the actual queue
+    Queue_t m_queue;
+
+    /// statistics of the queue
+    STATS_T m_stats;
+
+    /// @brief disable copy constructor declaring it private
+    ArrayLockFreeQueueAdapter(const ArrayLockFreeQueueAdapter &a_src);
+};
+
+#endif // __LOCK_FREE_QUEUE_ADAPTER_H__
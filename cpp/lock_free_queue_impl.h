@@ -39,29 +39,61 @@
 #define __LOCK_FREE_QUEUE_IMPL_H__
 
 #include <assert.h> // assert()
+#include <utility>  // std::move, std::forward
 
 template <
     typename ELEM_T, 
     uint32_t Q_SIZE, 
-    template <typename T, uint32_t S> class Q_TYPE>
-ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE>::ArrayLockFreeQueue():
-    m_qImpl()
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::ArrayLockFreeQueue():
+    m_qImpl(),
+    m_notEmptyWait(),
+    m_notFullWait(),
+    m_closed(false)
 {
 }
 
 template <
     typename ELEM_T, 
     uint32_t Q_SIZE, 
-    template <typename T, uint32_t S> class Q_TYPE>
-ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE>::~ArrayLockFreeQueue()
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::ArrayLockFreeQueue(
+    uint32_t                                a_size,
+    const ArrayLockFreeQueueStorageOptions &a_options):
+    m_qImpl(a_size, a_options),
+    m_notEmptyWait(),
+    m_notFullWait(),
+    m_closed(false)
 {
 }
 
 template <
     typename ELEM_T, 
     uint32_t Q_SIZE, 
-    template <typename T, uint32_t S> class Q_TYPE>
-inline uint32_t ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE>::size()
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::~ArrayLockFreeQueue()
+{
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+inline uint32_t ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::capacity()
+{
+    return m_qImpl.capacity();
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+inline uint32_t ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::size()
 {
     return m_qImpl.size();
 }  
@@ -69,8 +101,9 @@ inline uint32_t ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE>::size()
 template <
     typename ELEM_T, 
     uint32_t Q_SIZE, 
-    template <typename T, uint32_t S> class Q_TYPE>
-inline bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE>::full()
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+inline bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::full()
 {
     return m_qImpl.full();
 }  
@@ -78,19 +111,279 @@ inline bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE>::full()
 template <
     typename ELEM_T, 
     uint32_t Q_SIZE, 
-    template <typename T, uint32_t S> class Q_TYPE>
-inline bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE>::push(const ELEM_T &a_data)
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+inline bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::push(const ELEM_T &a_data)
 {
-    return m_qImpl.push(a_data);
+    if (m_qImpl.push(a_data))
+    {
+        m_notEmptyWait.notify();
+        return true;
+    }
+
+    return false;
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+inline bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::push(ELEM_T &&a_data)
+{
+    if (m_qImpl.push(std::move(a_data)))
+    {
+        m_notEmptyWait.notify();
+        return true;
+    }
+
+    return false;
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+template <typename... ARGS>
+inline bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::emplace(ARGS&&... a_args)
+{
+    if (m_qImpl.emplace(std::forward<ARGS>(a_args)...))
+    {
+        m_notEmptyWait.notify();
+        return true;
+    }
+
+    return false;
 }
 
 template <
     typename ELEM_T, 
     uint32_t Q_SIZE, 
-    template <typename T, uint32_t S> class Q_TYPE>
-inline bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE>::pop(ELEM_T &a_data)
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+inline bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::pop(ELEM_T &a_data)
 {
-    return m_qImpl.pop(a_data);
+    if (m_qImpl.pop(a_data))
+    {
+        m_notFullWait.notify();
+        return true;
+    }
+
+    return false;
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+inline uint32_t ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::push_bulk(const ELEM_T *a_data, uint32_t a_count)
+{
+    uint32_t count = m_qImpl.push_bulk(a_data, a_count);
+    if (count > 0)
+    {
+        m_notEmptyWait.notify();
+    }
+
+    return count;
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+inline uint32_t ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::pop_bulk(ELEM_T *a_data, uint32_t a_maxCount)
+{
+    uint32_t count = m_qImpl.pop_bulk(a_data, a_maxCount);
+    if (count > 0)
+    {
+        m_notFullWait.notify();
+    }
+
+    return count;
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+void ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::close()
+{
+    m_closed.store(true, std::memory_order_release);
+
+    // the waiting threads see the new state the next time they try
+    m_notEmptyWait.notify();
+    m_notFullWait.notify();
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+inline 
+bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::closed()
+{
+    return m_closed.load(std::memory_order_acquire);
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::push_wait(const ELEM_T &a_data)
+{
+    bool rv = false;
+    m_notFullWait.wait(
+        [this, &a_data, &rv]() 
+        { 
+            rv = this->push(a_data); 
+            return (rv || this->closed()); 
+        },
+        std::chrono::steady_clock::time_point::max());
+
+    return rv;
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::push_wait(ELEM_T &&a_data)
+{
+    // push leaves a_data untouched when the queue is full. It can be moved
+    // again in the next attempt
+    bool rv = false;
+    m_notFullWait.wait(
+        [this, &a_data, &rv]() 
+        { 
+            rv = this->push(std::move(a_data)); 
+            return (rv || this->closed()); 
+        },
+        std::chrono::steady_clock::time_point::max());
+
+    return rv;
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::push_wait_for(const ELEM_T &a_data, std::chrono::microseconds a_timeout)
+{
+    bool rv = false;
+    m_notFullWait.wait(
+        [this, &a_data, &rv]() 
+        { 
+            rv = this->push(a_data); 
+            return (rv || this->closed()); 
+        },
+        std::chrono::steady_clock::now() + a_timeout);
+
+    return rv;
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::pop_wait(ELEM_T &a_data)
+{
+    bool rv = false;
+    m_notEmptyWait.wait(
+        [this, &a_data, &rv]() 
+        { 
+            rv = this->pop(a_data); 
+            return (rv || this->closed()); 
+        },
+        std::chrono::steady_clock::time_point::max());
+
+    // the queue might have been closed between the failed pop and the check
+    // of the state. Whatever is left in the queue is still handed out
+    return (rv || this->pop(a_data));
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+bool ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::pop_wait_for(ELEM_T &a_data, std::chrono::microseconds a_timeout)
+{
+    bool rv = false;
+    if (m_notEmptyWait.wait(
+        [this, &a_data, &rv]() 
+        { 
+            rv = this->pop(a_data); 
+            return (rv || this->closed()); 
+        },
+        std::chrono::steady_clock::now() + a_timeout) && !rv)
+    {
+        // woken up by close(). Last attempt for what was pushed before it
+        rv = this->pop(a_data);
+    }
+
+    return rv;
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+uint32_t ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::pop_bulk_wait_for(
+    ELEM_T                   *a_data, 
+    uint32_t                  a_maxCount, 
+    std::chrono::microseconds a_timeout)
+{
+    uint32_t count = 0;
+    if (m_notEmptyWait.wait(
+        [this, a_data, a_maxCount, &count]() 
+        { 
+            count = this->pop_bulk(a_data, a_maxCount); 
+            return ((count > 0) || this->closed()); 
+        },
+        std::chrono::steady_clock::now() + a_timeout) && (count == 0))
+    {
+        // woken up by close(). Last attempt for what was pushed before it
+        count = this->pop_bulk(a_data, a_maxCount);
+    }
+
+    return count;
+}
+
+template <
+    typename ELEM_T, 
+    uint32_t Q_SIZE, 
+    template <typename T, uint32_t S> class Q_TYPE,
+    typename WAIT_T>
+uint32_t ArrayLockFreeQueue<ELEM_T, Q_SIZE, Q_TYPE, WAIT_T>::pop_bulk_wait(
+    ELEM_T  *a_data, 
+    uint32_t a_maxCount)
+{
+    uint32_t count = 0;
+    m_notEmptyWait.wait(
+        [this, a_data, a_maxCount, &count]() 
+        { 
+            count = this->pop_bulk(a_data, a_maxCount); 
+            return ((count > 0) || this->closed()); 
+        },
+        std::chrono::steady_clock::time_point::max());
+
+    if (count == 0)
+    {
+        // woken up by close(). Last attempt for what was pushed before it
+        count = this->pop_bulk(a_data, a_maxCount);
+    }
+
+    return count;
 }
 
 #endif // __LOCK_FREE_QUEUE_IMPL_H__
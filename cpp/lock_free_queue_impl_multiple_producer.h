@@ -38,13 +38,14 @@
 #define __LOCK_FREE_QUEUE_IMPL_MULTIPLE_PRODUCER_H__
 
 #include <assert.h> // assert()
+#include <utility>  // std::move, std::forward
 #include <sched.h>  // sched_yield()
 
 template <typename ELEM_T, uint32_t Q_SIZE>
 ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::ArrayLockFreeQueueMultipleProducers():
-    m_writeIndex(0),      // initialisation is not atomic
-    m_readIndex(0),       //
-    m_maximumReadIndex(0) //
+    m_writeIndex(ArrayLockFreeQueueCounter<Q_SIZE>::initial()),      // initialisation is not atomic
+    m_readIndex(ArrayLockFreeQueueCounter<Q_SIZE>::initial()),       //
+    m_maximumReadIndex(ArrayLockFreeQueueCounter<Q_SIZE>::initial()) //
 #ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
     ,m_count(0)           //
 #endif
@@ -58,9 +59,23 @@ template <typename ELEM_T, uint32_t Q_SIZE>
 inline 
 uint32_t ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::countToIndex(uint32_t a_count)
 {
-    // if Q_SIZE is a power of 2 this statement could be also written as 
-    // return (a_count & (Q_SIZE - 1));
-    return (a_count % Q_SIZE);
+    // masks a_count if Q_SIZE is a power of 2. Otherwise a_count % Q_SIZE
+    return ArrayLockFreeQueueCounter<Q_SIZE>::toIndex(a_count);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::countAdd(uint32_t a_count, uint32_t a_n)
+{
+    return ArrayLockFreeQueueCounter<Q_SIZE>::add(a_count, a_n);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::capacity()
+{
+    // one slot is always left empty to tell a full queue from an empty one
+    return (Q_SIZE - 1);
 }
 
 template <typename ELEM_T, uint32_t Q_SIZE>
@@ -83,18 +98,18 @@ uint32_t ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::size()
     // is 5 and m_readIndex 4. Real size is still 1
     // 3. Now the current thread comes back from preemption and reads m_readIndex.
     // currentReadIndex is 4
-    // 4. currentReadIndex is bigger than currentWriteIndex, so
-    // m_totalSize + currentWriteIndex - currentReadIndex is returned, that is,
-    // it returns that the queue is almost full, when it is almost empty
+    // 4. currentReadIndex is bigger than currentWriteIndex, so the distance
+    // from currentReadIndex to currentWriteIndex wraps around, that is, 
+    // it returns that the queue is full, when it is almost empty
     //
-    if (countToIndex(currentWriteIndex) >= countToIndex(currentReadIndex))
+    uint32_t currentSize = ArrayLockFreeQueueCounter<Q_SIZE>::distance(
+        currentReadIndex, currentWriteIndex);
+    if (currentSize > (Q_SIZE - 1))
     {
-        return (currentWriteIndex - currentReadIndex);
-    }
-    else
-    {
-        return (Q_SIZE + currentWriteIndex - currentReadIndex);
+        return (Q_SIZE - 1);
     }
+
+    return currentSize;
 #endif // _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
 }
 
@@ -110,7 +125,7 @@ bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::full()
     uint32_t currentWriteIndex = m_writeIndex;
     uint32_t currentReadIndex  = m_readIndex;
     
-    if (countToIndex(currentWriteIndex + 1) == countToIndex(currentReadIndex))
+    if (countToIndex(countAdd(currentWriteIndex)) == countToIndex(currentReadIndex))
     {
         // the queue is full
         return true;
@@ -125,6 +140,28 @@ bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::full()
 
 template <typename ELEM_T, uint32_t Q_SIZE>
 bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::push(const ELEM_T &a_data)
+{
+    return pushElement(a_data);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::push(ELEM_T &&a_data)
+{
+    return pushElement(std::move(a_data));
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+template <typename... ARGS>
+bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::emplace(ARGS&&... a_args)
+{
+    // the slots of the array are always constructed. The new element is 
+    // built first and then moved into its slot
+    return pushElement(ELEM_T(std::forward<ARGS>(a_args)...));
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+template <typename U>
+bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::pushElement(U &&a_data)
 {
     uint32_t currentWriteIndex;
     
@@ -132,7 +169,7 @@ bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::push(const ELEM_T &a_d
     {
         currentWriteIndex = m_writeIndex.load();
         
-        if (countToIndex(currentWriteIndex + 1) == countToIndex(m_readIndex.load()))
+        if (countToIndex(countAdd(currentWriteIndex)) == countToIndex(m_readIndex.load()))
         {
             // the queue is full
             return false;
@@ -145,36 +182,62 @@ bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::push(const ELEM_T &a_d
     // will yield better performance on some platforms, but here we'd have to
     // load m_writeIndex all over again
     } while (!m_writeIndex.compare_exchange_strong(
-                currentWriteIndex, (currentWriteIndex + 1)));
+                currentWriteIndex, countAdd(currentWriteIndex)) &&
+             ArrayLockFreeQueueCasRetry());
     
     // Just made sure this index is reserved for this thread.
-    m_theQueue[countToIndex(currentWriteIndex)] = a_data;
+    m_theQueue[countToIndex(currentWriteIndex)] = std::forward<U>(a_data);
     
+    // update the maximum read index after saving the piece of data
+    commit(currentWriteIndex, 1);
+
+    // The value was successfully inserted into the queue
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+    m_count.fetch_add(1);
+#endif
+
+    return true;
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+void ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::commit(uint32_t a_writeIndex, uint32_t a_count)
+{
     // update the maximum read index after saving the piece of data. It can't
     // fail if there is only one thread inserting in the queue. It might fail 
     // if there is more than 1 producer thread because this operation has to
-    // be done in the same order as the previous CAS
+    // be done in the same order as the CAS on m_writeIndex
     //
     // using compare_exchange_weak because they are allowed to fail spuriously
     // (act as if *this != expected, even if they are equal), but when the
     // compare_exchange operation is in a loop the weak version will yield
     // better performance on some platforms.
+    // compare_exchange_weak overwrites the expected value with the current 
+    // one when it fails, so it must be reset on every iteration. Otherwise 
+    // this thread would commit the data of a producer that hasn't finished 
+    // writing it yet
+    uint32_t expectedIndex = a_writeIndex;
+    uint32_t spins = 0;
     while (!m_maximumReadIndex.compare_exchange_weak(
-                currentWriteIndex, (currentWriteIndex + 1)))
+                expectedIndex, countAdd(a_writeIndex, a_count)))
     {
-        // this is a good place to yield the thread in case there are more
-        // software threads than hardware processors and you have more
-        // than 1 producer thread
-        // have a look at sched_yield (POSIX.1b)
-        //sched_yield();
-    }
-
-    // The value was successfully inserted into the queue
-#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
-    m_count.fetch_add(1);
-#endif
+        ArrayLockFreeQueueCasRetry();
+        expectedIndex = a_writeIndex;
 
-    return true;
+        // the producers this thread is waiting for might have been preempted 
+        // in the middle of writing their data. Yield the thread in case there
+        // are more software threads than hardware processors so they can 
+        // finish
+        if (++spins == LOCK_FREE_Q_WAIT_SPINS)
+        {
+            spins = 0;
+            sched_yield();
+        }
+        else
+        {
+            ArrayLockFreeQueueCpuRelax();
+        }
+    }
 }
 
 template <typename ELEM_T, uint32_t Q_SIZE>
@@ -202,7 +265,7 @@ bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::pop(ELEM_T &a_data)
         // try to perfrom now the CAS operation on the read index. If we succeed
         // a_data already contains what m_readIndex pointed to before we 
         // increased it
-        if (m_readIndex.compare_exchange_strong(currentReadIndex, (currentReadIndex + 1)))
+        if (m_readIndex.compare_exchange_strong(currentReadIndex, countAdd(currentReadIndex)))
         {
             // got here. The value was retrieved from the queue. Note that the
             // data inside the m_queue array is not deleted nor reseted
@@ -215,6 +278,7 @@ bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::pop(ELEM_T &a_data)
         // it failed retrieving the element off the queue. Someone else must
         // have read the element stored at countToIndex(currentReadIndex)
         // before we could perform the CAS operation        
+        ArrayLockFreeQueueCasRetry();
 
     } while(1); // keep looping to try again!
 
@@ -225,4 +289,116 @@ bool ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::pop(ELEM_T &a_data)
     return false;    
 }
 
+template <typename ELEM_T, uint32_t Q_SIZE>
+uint32_t ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::push_bulk(const ELEM_T *a_data, uint32_t a_count)
+{
+    uint32_t currentWriteIndex;
+    uint32_t count = 0;
+
+    do
+    {
+        currentWriteIndex = m_writeIndex.load();
+
+        // the write index is loaded first. If other threads push and pop 
+        // elements before the read index is loaded, the read index might 
+        // be ahead of currentWriteIndex. The CAS on m_writeIndex would fail
+        // anyway, so load both over again
+        uint32_t currentSize = ArrayLockFreeQueueCounter<Q_SIZE>::distance(
+            m_readIndex.load(), currentWriteIndex);
+        if (currentSize > (Q_SIZE - 1))
+        {
+            continue;
+        }
+
+        count = (Q_SIZE - 1) - currentSize;
+        if (count == 0)
+        {
+            // the queue is full
+            return 0;
+        }
+        if (count > a_count)
+        {
+            count = a_count;
+        }
+
+    // reserve the space for all the elements at once
+    } while (!m_writeIndex.compare_exchange_strong(
+                currentWriteIndex, countAdd(currentWriteIndex, count)) &&
+             ArrayLockFreeQueueCasRetry());
+
+    // Just made sure this range of indexes is reserved for this thread.
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_theQueue[countToIndex(countAdd(currentWriteIndex, i))] = a_data[i];
+    }
+
+    // publish all of them at once
+    commit(currentWriteIndex, count);
+
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+    m_count.fetch_add(count);
+#endif
+
+    return count;
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+uint32_t ArrayLockFreeQueueMultipleProducers<ELEM_T, Q_SIZE>::pop_bulk(ELEM_T *a_data, uint32_t a_maxCount)
+{
+    uint32_t currentReadIndex;
+    uint32_t count;
+
+    do
+    {
+        currentReadIndex = m_readIndex.load();
+
+        // only the elements up to m_maximumReadIndex are committed. The read
+        // index is loaded first so the distance is never negative, but it can
+        // go over the maximum size if this thread is preempted in between. 
+        // In that case the CAS on the read index fails too
+        count = ArrayLockFreeQueueCounter<Q_SIZE>::distance(
+            currentReadIndex, m_maximumReadIndex.load());
+        if (count == 0)
+        {
+            // the queue is empty or producers are still committing their data
+            return 0;
+        }
+        if (count > a_maxCount)
+        {
+            count = a_maxCount;
+        }
+        if (count > (Q_SIZE - 1))
+        {
+            count = (Q_SIZE - 1);
+        }
+
+        // retrieve the data from the queue
+        for (uint32_t i = 0; i < count; i++)
+        {
+            a_data[i] = m_theQueue[countToIndex(countAdd(currentReadIndex, i))];
+        }
+
+        // claim all the elements copied into a_data with a single CAS
+        if (m_readIndex.compare_exchange_strong(
+                currentReadIndex, countAdd(currentReadIndex, count)))
+        {
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+            m_count.fetch_sub(count);
+#endif
+            return count;
+        }
+
+        // it failed retrieving the elements off the queue. Someone else must
+        // have read some of them before we could perform the CAS operation
+        ArrayLockFreeQueueCasRetry();
+
+    } while(1); // keep looping to try again!
+
+    // Something went wrong. it shouldn't be possible to reach here
+    assert(0);
+
+    // Add this return statement to avoid compiler warnings
+    return 0;
+}
+
 #endif // __LOCK_FREE_QUEUE_IMPL_MULTIPLE_PRODUCER_H__
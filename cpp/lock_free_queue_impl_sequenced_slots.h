@@ -0,0 +1,411 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file lock_free_queue_impl_sequenced_slots.h
+/// @brief Implementation of a circular array based lock-free queue for 
+///        multiple producers and multiple consumers with a sequence number
+///        per slot
+/// See http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+/// for more info
+///
+// ============================================================================
+
+#ifndef __LOCK_FREE_QUEUE_IMPL_SEQUENCED_SLOTS_H__
+#define __LOCK_FREE_QUEUE_IMPL_SEQUENCED_SLOTS_H__
+
+#include <assert.h> // assert()
+#include <utility>  // std::move, std::forward
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::ArrayLockFreeQueueSequencedSlots():
+    ArrayLockFreeQueueSequencedSlots(Q_SIZE, ArrayLockFreeQueueStorageOptions())
+{
+    static_assert(Q_SIZE != 0, 
+        "The size of the queue must be passed to the constructor when Q_SIZE is 0");
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::ArrayLockFreeQueueSequencedSlots(
+    uint32_t                                a_size,
+    const ArrayLockFreeQueueStorageOptions &a_options):
+    m_counter(a_size),
+    m_memory(m_counter.size() * sizeof(Slot), a_options),
+    m_theQueue(static_cast<Slot*>(m_memory.get())),
+    m_writeIndex(m_counter.initial()), // initialisation is not atomic
+    m_readIndex(m_counter.initial())   //
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+    ,m_count(0)      //
+#endif
+{
+    // each slot is ready to be written by the producer that reserves the 
+    // first count that maps to it
+    for (uint32_t i = 0; i < m_counter.size(); i++)
+    {
+        uint32_t count = countAdd(m_counter.initial(), i);
+        new (&m_theQueue[countToIndex(count)]) Slot();
+        m_theQueue[countToIndex(count)].m_sequence.store(
+            count, std::memory_order_relaxed);
+    }
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::~ArrayLockFreeQueueSequencedSlots()
+{
+    // destroy the elements still in the queue. Nobody else can be using it,
+    // so every position between both indexes holds a published element
+    uint32_t currentWriteIndex = m_writeIndex.load(std::memory_order_relaxed);
+    for (uint32_t count = m_readIndex.load(std::memory_order_relaxed);
+         count != currentWriteIndex;
+         count = countAdd(count))
+    {
+        Slot &slot = m_theQueue[countToIndex(count)];
+        if (slot.m_sequence.load(std::memory_order_acquire) == countAdd(count))
+        {
+            slot.m_data.destroy();
+        }
+    }
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::capacity()
+{
+    return m_counter.size();
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::countToIndex(uint32_t a_count)
+{
+    // the size is a power of 2. This is a mask
+    return m_counter.toIndex(a_count);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::countAdd(uint32_t a_count, uint32_t a_n)
+{
+    return m_counter.add(a_count, a_n);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::size()
+{
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+
+    return m_count.load();
+#else
+
+    // the write index counts the positions reserved by producers, including 
+    // those whose data is still being written. It is only a snapshot anyway,
+    // both indexes might have moved by the time the second one is loaded
+    uint32_t currentReadIndex  = m_readIndex.load(std::memory_order_relaxed);
+    uint32_t currentWriteIndex = m_writeIndex.load(std::memory_order_relaxed);
+
+    uint32_t currentSize = m_counter.distance(
+        currentReadIndex, currentWriteIndex);
+    if (currentSize > capacity())
+    {
+        // the read index moved too far ahead after it was loaded
+        return capacity();
+    }
+
+    return currentSize;
+#endif // _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+bool ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::full()
+{
+    return (size() == capacity());
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+bool ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::push(const ELEM_T &a_data)
+{
+    return emplace(a_data);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+bool ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::push(ELEM_T &&a_data)
+{
+    return emplace(std::move(a_data));
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+template <typename... ARGS>
+bool ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::emplace(ARGS&&... a_args)
+{
+    Slot* slot;
+    uint32_t currentWriteIndex = m_writeIndex.load(std::memory_order_relaxed);
+
+    do
+    {
+        slot = &m_theQueue[countToIndex(currentWriteIndex)];
+
+        // acquire synchronises with the release store of the consumer that
+        // popped the previous element of this slot. It must be done reading
+        // before this thread writes into it
+        uint32_t sequence = slot->m_sequence.load(std::memory_order_acquire);
+        int32_t  diff = static_cast<int32_t>(sequence - currentWriteIndex);
+
+        if (diff == 0)
+        {
+            // the slot is free. Try to reserve it. The ordering of the data is
+            // provided by the sequence number so the CAS can be relaxed.
+            // compare_exchange_weak is fine here, on failure it reloads 
+            // currentWriteIndex and the loop starts over with the new value
+            if (m_writeIndex.compare_exchange_weak(
+                    currentWriteIndex, countAdd(currentWriteIndex), 
+                    std::memory_order_relaxed))
+            {
+                break;
+            }
+            ArrayLockFreeQueueCasRetry();
+        }
+        else if (diff < 0)
+        {
+            // the slot still holds the element pushed a lap of the array ago.
+            // The queue is full
+            return false;
+        }
+        else
+        {
+            // some other producer reserved this position already
+            currentWriteIndex = m_writeIndex.load(std::memory_order_relaxed);
+        }
+
+    } while(1); // keep looping to try again!
+
+    // Just made sure this slot is reserved for this thread
+    slot->m_data.construct(std::forward<ARGS>(a_args)...);
+
+    // publish the element for the consumer of this position. Other producers
+    // and consumers of other slots do not depend on this store
+    slot->m_sequence.store(countAdd(currentWriteIndex), std::memory_order_release);
+
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+    m_count.fetch_add(1);
+#endif
+
+    return true;
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+bool ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::pop(ELEM_T &a_data)
+{
+    Slot* slot;
+    uint32_t currentReadIndex = m_readIndex.load(std::memory_order_relaxed);
+
+    do
+    {
+        slot = &m_theQueue[countToIndex(currentReadIndex)];
+
+        // acquire synchronises with the release store of the producer that 
+        // wrote the element into this slot
+        uint32_t sequence = slot->m_sequence.load(std::memory_order_acquire);
+        int32_t  diff = static_cast<int32_t>(sequence - countAdd(currentReadIndex));
+
+        if (diff == 0)
+        {
+            // the element is ready. Try to reserve it
+            if (m_readIndex.compare_exchange_weak(
+                    currentReadIndex, countAdd(currentReadIndex), 
+                    std::memory_order_relaxed))
+            {
+                break;
+            }
+            ArrayLockFreeQueueCasRetry();
+        }
+        else if (diff < 0)
+        {
+            // the queue is empty or the producer of this position is still
+            // writing the data into it
+            return false;
+        }
+        else
+        {
+            // some other consumer reserved this position already
+            currentReadIndex = m_readIndex.load(std::memory_order_relaxed);
+        }
+
+    } while(1); // keep looping to try again!
+
+    // Just made sure this slot is reserved for this thread
+    a_data = std::move(*slot->m_data.get());
+    slot->m_data.destroy();
+
+    // give the slot back to the producer of the next lap of the array
+    slot->m_sequence.store(
+        countAdd(currentReadIndex, capacity()), std::memory_order_release);
+
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+    m_count.fetch_sub(1);
+#endif
+
+    return true;
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+uint32_t ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::push_bulk(const ELEM_T *a_data, uint32_t a_count)
+{
+    uint32_t currentWriteIndex = m_writeIndex.load(std::memory_order_relaxed);
+    uint32_t count;
+
+    if (a_count > capacity())
+    {
+        a_count = capacity();
+    }
+
+    do
+    {
+        // count how many consecutive slots are free from currentWriteIndex on.
+        // A free slot stays free until the producer that reserves it writes 
+        // into it, so they can't be taken away once the CAS below succeeds
+        for (count = 0; count < a_count; count++)
+        {
+            uint32_t position = countAdd(currentWriteIndex, count);
+            uint32_t sequence = m_theQueue[countToIndex(position)].m_sequence.load(
+                std::memory_order_acquire);
+            if (sequence != position)
+            {
+                break;
+            }
+        }
+
+        if (count == 0)
+        {
+            uint32_t sequence = m_theQueue[countToIndex(currentWriteIndex)].m_sequence.load(
+                std::memory_order_relaxed);
+            if (static_cast<int32_t>(sequence - currentWriteIndex) < 0)
+            {
+                // the queue is full
+                return 0;
+            }
+
+            // some other producer reserved this position already
+            currentWriteIndex = m_writeIndex.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        // reserve all the free slots at once. On failure currentWriteIndex
+        // is reloaded and the slots are checked again
+        if (m_writeIndex.compare_exchange_weak(
+                currentWriteIndex, countAdd(currentWriteIndex, count), 
+                std::memory_order_relaxed))
+        {
+            break;
+        }
+        ArrayLockFreeQueueCasRetry();
+
+    } while(1); // keep looping to try again!
+
+    // Just made sure these slots are reserved for this thread. Each element
+    // is published on its own so consumers can start with the first one
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t position = countAdd(currentWriteIndex, i);
+        Slot* slot = &m_theQueue[countToIndex(position)];
+
+        slot->m_data.construct(a_data[i]);
+        slot->m_sequence.store(countAdd(position), std::memory_order_release);
+    }
+
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+    m_count.fetch_add(count);
+#endif
+
+    return count;
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+uint32_t ArrayLockFreeQueueSequencedSlots<ELEM_T, Q_SIZE>::pop_bulk(ELEM_T *a_data, uint32_t a_maxCount)
+{
+    uint32_t currentReadIndex = m_readIndex.load(std::memory_order_relaxed);
+    uint32_t count;
+
+    if (a_maxCount > capacity())
+    {
+        a_maxCount = capacity();
+    }
+
+    do
+    {
+        // count how many consecutive elements are ready to be popped
+        for (count = 0; count < a_maxCount; count++)
+        {
+            uint32_t position = countAdd(currentReadIndex, count);
+            uint32_t sequence = m_theQueue[countToIndex(position)].m_sequence.load(
+                std::memory_order_acquire);
+            if (sequence != countAdd(position))
+            {
+                break;
+            }
+        }
+
+        if (count == 0)
+        {
+            uint32_t sequence = m_theQueue[countToIndex(currentReadIndex)].m_sequence.load(
+                std::memory_order_relaxed);
+            if (static_cast<int32_t>(sequence - countAdd(currentReadIndex)) < 0)
+            {
+                // the queue is empty or the producer of this position is 
+                // still writing the data into it
+                return 0;
+            }
+
+            // some other consumer reserved this position already
+            currentReadIndex = m_readIndex.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        // reserve all the ready elements at once
+        if (m_readIndex.compare_exchange_weak(
+                currentReadIndex, countAdd(currentReadIndex, count), 
+                std::memory_order_relaxed))
+        {
+            break;
+        }
+        ArrayLockFreeQueueCasRetry();
+
+    } while(1); // keep looping to try again!
+
+    // Just made sure these slots are reserved for this thread
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t position = countAdd(currentReadIndex, i);
+        Slot* slot = &m_theQueue[countToIndex(position)];
+
+        a_data[i] = std::move(*slot->m_data.get());
+        slot->m_data.destroy();
+        slot->m_sequence.store(countAdd(position, capacity()), std::memory_order_release);
+    }
+
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+    m_count.fetch_sub(count);
+#endif
+
+    return count;
+}
+
+#endif // __LOCK_FREE_QUEUE_IMPL_SEQUENCED_SLOTS_H__
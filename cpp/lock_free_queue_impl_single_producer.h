@@ -38,11 +38,12 @@
 #define __LOCK_FREE_QUEUE_IMPL_SINGLE_PRODUCER_H__
 
 #include <assert.h> // assert()
+#include <utility>  // std::move, std::forward
 
 template <typename ELEM_T, uint32_t Q_SIZE>
 ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::ArrayLockFreeQueueSingleProducer():
-    m_writeIndex(0), // initialisation is not atomic
-    m_readIndex(0)   // 
+    m_writeIndex(ArrayLockFreeQueueCounter<Q_SIZE>::initial()), // initialisation is not atomic
+    m_readIndex(ArrayLockFreeQueueCounter<Q_SIZE>::initial())   // 
 #ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
     ,m_count(0)      // 
 #endif
@@ -56,9 +57,23 @@ template <typename ELEM_T, uint32_t Q_SIZE>
 inline 
 uint32_t ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::countToIndex(uint32_t a_count)
 {
-    // if Q_SIZE is a power of 2 this statement could be also written as 
-    // return (a_count & (Q_SIZE - 1));
-    return (a_count % Q_SIZE);
+    // masks a_count if Q_SIZE is a power of 2. Otherwise a_count % Q_SIZE
+    return ArrayLockFreeQueueCounter<Q_SIZE>::toIndex(a_count);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::countAdd(uint32_t a_count, uint32_t a_n)
+{
+    return ArrayLockFreeQueueCounter<Q_SIZE>::add(a_count, a_n);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::capacity()
+{
+    // one slot is always left empty to tell a full queue from an empty one
+    return (Q_SIZE - 1);
 }
 
 template <typename ELEM_T, uint32_t Q_SIZE>
@@ -79,18 +94,18 @@ uint32_t ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::size()
     // m_readIndex 4. Real size is still 1
     // 3. Now the current thread comes back from preemption and reads m_readIndex.
     // currentReadIndex is 4
-    // 4. currentReadIndex is bigger than currentWriteIndex, so
-    // m_totalSize + currentWriteIndex - currentReadIndex is returned, that is,
-    // it returns that the queue is almost full, when it is almost empty
+    // 4. currentReadIndex is bigger than currentWriteIndex, so the distance
+    // from currentReadIndex to currentWriteIndex wraps around, that is, 
+    // it returns that the queue is full, when it is almost empty
     //
-    if (countToIndex(currentWriteIndex) >= countToIndex(currentReadIndex))
+    uint32_t currentSize = ArrayLockFreeQueueCounter<Q_SIZE>::distance(
+        currentReadIndex, currentWriteIndex);
+    if (currentSize > (Q_SIZE - 1))
     {
-        return (currentWriteIndex - currentReadIndex);
-    }
-    else
-    {
-        return (Q_SIZE + currentWriteIndex - currentReadIndex);
+        return (Q_SIZE - 1);
     }
+
+    return currentSize;
 #endif // _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
 }
 
@@ -104,7 +119,7 @@ bool ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::full()
     uint32_t currentWriteIndex = m_writeIndex.load();
     uint32_t currentReadIndex  = m_readIndex.load();
     
-    if (countToIndex(currentWriteIndex + 1) == countToIndex(currentReadIndex))
+    if (countToIndex(countAdd(currentWriteIndex)) == countToIndex(currentReadIndex))
     {
         // the queue is full
         return true;
@@ -119,13 +134,35 @@ bool ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::full()
 
 template <typename ELEM_T, uint32_t Q_SIZE>
 bool ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::push(const ELEM_T &a_data)
+{
+    return pushElement(a_data);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+bool ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::push(ELEM_T &&a_data)
+{
+    return pushElement(std::move(a_data));
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+template <typename... ARGS>
+bool ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::emplace(ARGS&&... a_args)
+{
+    // the slots of the array are always constructed. The new element is 
+    // built first and then moved into its slot
+    return pushElement(ELEM_T(std::forward<ARGS>(a_args)...));
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+template <typename U>
+bool ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::pushElement(U &&a_data)
 {
     uint32_t currentWriteIndex;
     
     // no need to loop. There is only one producer (this thread)
     currentWriteIndex = m_writeIndex.load();
     
-    if (countToIndex(currentWriteIndex + 1) == 
+    if (countToIndex(countAdd(currentWriteIndex)) == 
             countToIndex(m_readIndex.load()))
     {
         // the queue is full
@@ -133,10 +170,10 @@ bool ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::push(const ELEM_T &a_data
     }
     
     // up to this point we made sure there is space in the Q for more data
-    m_theQueue[countToIndex(currentWriteIndex)] = a_data;
+    m_theQueue[countToIndex(currentWriteIndex)] = std::forward<U>(a_data);
     
-    // increment write index 
-    m_writeIndex.fetch_add(1);
+    // increment write index. This is the only thread writing into it
+    m_writeIndex.store(countAdd(currentWriteIndex));
 
     // The value was successfully inserted into the queue
 #ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
@@ -174,7 +211,7 @@ bool ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::pop(ELEM_T &a_data)
         // will yield better performance on some platforms (but here we'd have to
         // load m_writeIndex all over again, better not to fail spuriously)
         if (m_readIndex.compare_exchange_strong(
-                currentReadIndex, (currentReadIndex + 1)))
+                currentReadIndex, countAdd(currentReadIndex)))
         {
             // got here. The value was retrieved from the queue. Note that the
             // data inside the m_queue array is not deleted nor reseted
@@ -187,6 +224,7 @@ bool ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::pop(ELEM_T &a_data)
         // it failed retrieving the element off the queue. Someone else must
         // have read the element stored at countToIndex(currentReadIndex)
         // before we could perform the CAS operation        
+        ArrayLockFreeQueueCasRetry();
 
     } while(1); // keep looping to try again!
 
@@ -197,5 +235,95 @@ bool ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::pop(ELEM_T &a_data)
     return false;
 }
 
+template <typename ELEM_T, uint32_t Q_SIZE>
+uint32_t ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::push_bulk(const ELEM_T *a_data, uint32_t a_count)
+{
+    // no need to loop. There is only one producer (this thread), so the write
+    // index won't change and the read index can only grow (there can only be
+    // more free space than calculated here)
+    uint32_t currentWriteIndex = m_writeIndex.load();
+    uint32_t currentReadIndex  = m_readIndex.load();
+
+    uint32_t freeSpace = (Q_SIZE - 1) - ArrayLockFreeQueueCounter<Q_SIZE>::distance(
+        currentReadIndex, currentWriteIndex);
+    uint32_t count = (a_count < freeSpace) ? a_count : freeSpace;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_theQueue[countToIndex(countAdd(currentWriteIndex, i))] = a_data[i];
+    }
+
+    if (count > 0)
+    {
+        // publish all the elements at once
+        m_writeIndex.store(countAdd(currentWriteIndex, count));
+
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+        m_count.fetch_add(count);
+#endif
+    }
+
+    return count;
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+uint32_t ArrayLockFreeQueueSingleProducer<ELEM_T, Q_SIZE>::pop_bulk(ELEM_T *a_data, uint32_t a_maxCount)
+{
+    uint32_t currentReadIndex;
+    uint32_t count;
+
+    do
+    {
+        currentReadIndex = m_readIndex.load();
+
+        // both indexes can only grow. The read index is loaded first, so
+        // the distance is never negative, but it can go over the maximum size
+        // if this thread is preempted in between. In that case the CAS on
+        // the read index fails too
+        count = ArrayLockFreeQueueCounter<Q_SIZE>::distance(
+            currentReadIndex, m_writeIndex.load());
+        if (count == 0)
+        {
+            // queue is empty
+            return 0;
+        }
+        if (count > a_maxCount)
+        {
+            count = a_maxCount;
+        }
+        if (count > (Q_SIZE - 1))
+        {
+            count = (Q_SIZE - 1);
+        }
+
+        // retrieve the data from the queue
+        for (uint32_t i = 0; i < count; i++)
+        {
+            a_data[i] = m_theQueue[countToIndex(countAdd(currentReadIndex, i))];
+        }
+
+        // claim all the elements copied into a_data with a single CAS
+        if (m_readIndex.compare_exchange_strong(
+                currentReadIndex, countAdd(currentReadIndex, count)))
+        {
+#ifdef _WITH_LOCK_FREE_Q_KEEP_REAL_SIZE
+            m_count.fetch_sub(count);
+#endif
+            return count;
+        }
+
+        // it failed retrieving the elements off the queue. Someone else must
+        // have read some of them before we could perform the CAS operation
+        ArrayLockFreeQueueCasRetry();
+
+    } while(1); // keep looping to try again!
+
+    // Something went wrong. it shouldn't be possible to reach here
+    assert(0);
+
+    // Add this return statement to avoid compiler warnings
+    return 0;
+}
+
 #endif // __LOCK_FREE_QUEUE_IMPL_SINGLE_PRODUCER_H__
 
@@ -0,0 +1,278 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file lock_free_queue_impl_single_producer_single_consumer.h
+/// @brief Implementation of a circular array based lock-free queue for one 
+///        producer and one consumer thread
+/// See http://www.codeproject.com/Articles/153898/Yet-another-implementation-of-a-lock-free-circular
+/// for more info
+///
+// ============================================================================
+
+#ifndef __LOCK_FREE_QUEUE_IMPL_SINGLE_PRODUCER_SINGLE_CONSUMER_H__
+#define __LOCK_FREE_QUEUE_IMPL_SINGLE_PRODUCER_SINGLE_CONSUMER_H__
+
+#include <assert.h> // assert()
+#include <utility>  // std::move, std::forward
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::ArrayLockFreeQueueSingleProducerSingleConsumer():
+    ArrayLockFreeQueueSingleProducerSingleConsumer(Q_SIZE, ArrayLockFreeQueueStorageOptions())
+{
+    static_assert(Q_SIZE != 0, 
+        "The size of the queue must be passed to the constructor when Q_SIZE is 0");
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::ArrayLockFreeQueueSingleProducerSingleConsumer(
+    uint32_t                                a_size,
+    const ArrayLockFreeQueueStorageOptions &a_options):
+    m_counter(a_size),
+    m_memory(m_counter.size() * sizeof(ArrayLockFreeQueueRawSlot<ELEM_T>), a_options),
+    m_theQueue(static_cast<ArrayLockFreeQueueRawSlot<ELEM_T>*>(m_memory.get())),
+    m_writeIndex(m_counter.initial()),      // initialisation is not atomic
+    m_cachedReadIndex(m_counter.initial()), //
+    m_readIndex(m_counter.initial()),       //
+    m_cachedWriteIndex(m_counter.initial()) //
+{
+    // the slots are raw memory. ArrayLockFreeQueueRawSlot is trivially 
+    // constructible so there is nothing to initialise in them
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::~ArrayLockFreeQueueSingleProducerSingleConsumer()
+{
+    // destroy the elements still in the queue. Nobody else can be using it
+    uint32_t currentWriteIndex = m_writeIndex.load(std::memory_order_acquire);
+    for (uint32_t count = m_readIndex.load(std::memory_order_relaxed);
+         count != currentWriteIndex;
+         count = countAdd(count))
+    {
+        m_theQueue[countToIndex(count)].destroy();
+    }
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::capacity()
+{
+    // one slot is always left empty to tell a full queue from an empty one
+    return (m_counter.size() - 1);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::countToIndex(uint32_t a_count)
+{
+    // masks a_count if the size is a power of 2. Otherwise a_count % Q_SIZE
+    return m_counter.toIndex(a_count);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::countAdd(uint32_t a_count, uint32_t a_n)
+{
+    return m_counter.add(a_count, a_n);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+uint32_t ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::size()
+{
+    // the read index is loaded first. m_readIndex can only grow after that, so
+    // the difference between both values can't be smaller than the real size
+    // at the time the write index is loaded. It can go over the maximum 
+    // though (if both threads are busy pushing and popping in the meantime)
+    uint32_t currentReadIndex  = m_readIndex.load(std::memory_order_acquire);
+    uint32_t currentWriteIndex = m_writeIndex.load(std::memory_order_acquire);
+
+    uint32_t currentSize = m_counter.distance(
+        currentReadIndex, currentWriteIndex);
+    if (currentSize > capacity())
+    {
+        return capacity();
+    }
+
+    return currentSize;
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+inline 
+bool ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::full()
+{
+    uint32_t currentWriteIndex = m_writeIndex.load(std::memory_order_acquire);
+    uint32_t currentReadIndex  = m_readIndex.load(std::memory_order_acquire);
+    
+    if (countToIndex(countAdd(currentWriteIndex)) == countToIndex(currentReadIndex))
+    {
+        // the queue is full
+        return true;
+    }
+    else
+    {
+        // not full!
+        return false;
+    }
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+bool ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::push(const ELEM_T &a_data)
+{
+    return emplace(a_data);
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+bool ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::push(ELEM_T &&a_data)
+{
+    return emplace(std::move(a_data));
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+template <typename... ARGS>
+bool ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::emplace(ARGS&&... a_args)
+{
+    // only this thread writes into m_writeIndex. No ordering needed to read it
+    uint32_t currentWriteIndex = m_writeIndex.load(std::memory_order_relaxed);
+    
+    if (countToIndex(countAdd(currentWriteIndex)) == countToIndex(m_cachedReadIndex))
+    {
+        // the queue looks full from the last time m_readIndex was read. 
+        // Refresh the local copy before giving up. The acquire load 
+        // synchronises with the release store in pop, so the consumer is done
+        // reading the slot that is about to be overwritten
+        m_cachedReadIndex = m_readIndex.load(std::memory_order_acquire);
+
+        if (countToIndex(countAdd(currentWriteIndex)) == countToIndex(m_cachedReadIndex))
+        {
+            // the queue is full
+            return false;
+        }
+    }
+    
+    // up to this point we made sure there is space in the Q for more data
+    m_theQueue[countToIndex(currentWriteIndex)].construct(
+        std::forward<ARGS>(a_args)...);
+    
+    // publish the element. The release store makes the write into the array
+    // visible to the consumer before the new value of the index
+    m_writeIndex.store(countAdd(currentWriteIndex), std::memory_order_release);
+
+    return true;
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+bool ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::pop(ELEM_T &a_data)
+{
+    // only this thread writes into m_readIndex. No ordering needed to read it
+    uint32_t currentReadIndex = m_readIndex.load(std::memory_order_relaxed);
+
+    if (countToIndex(currentReadIndex) == countToIndex(m_cachedWriteIndex))
+    {
+        // the queue looks empty from the last time m_writeIndex was read.
+        // Refresh the local copy. The acquire load synchronises with the 
+        // release store in push, so the element is already in the array
+        m_cachedWriteIndex = m_writeIndex.load(std::memory_order_acquire);
+
+        if (countToIndex(currentReadIndex) == countToIndex(m_cachedWriteIndex))
+        {
+            // queue is empty
+            return false;
+        }
+    }
+
+    // move the data out of the queue. No one else can pop this element
+    ArrayLockFreeQueueRawSlot<ELEM_T> &slot = m_theQueue[countToIndex(currentReadIndex)];
+    a_data = std::move(*slot.get());
+    slot.destroy();
+
+    // give the slot back to the producer. The release store ensures the 
+    // element was read before the producer can overwrite it
+    m_readIndex.store(countAdd(currentReadIndex), std::memory_order_release);
+
+    return true;
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+uint32_t ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::push_bulk(const ELEM_T *a_data, uint32_t a_count)
+{
+    uint32_t currentWriteIndex = m_writeIndex.load(std::memory_order_relaxed);
+
+    uint32_t freeSpace = capacity() - m_counter.distance(
+        m_cachedReadIndex, currentWriteIndex);
+    if (freeSpace < a_count)
+    {
+        // not enough space according to the local copy. Refresh it
+        m_cachedReadIndex = m_readIndex.load(std::memory_order_acquire);
+        freeSpace = capacity() - m_counter.distance(
+            m_cachedReadIndex, currentWriteIndex);
+    }
+
+    uint32_t count = (a_count < freeSpace) ? a_count : freeSpace;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_theQueue[countToIndex(countAdd(currentWriteIndex, i))].construct(a_data[i]);
+    }
+
+    if (count > 0)
+    {
+        // publish all the elements with a single store
+        m_writeIndex.store(
+            countAdd(currentWriteIndex, count), std::memory_order_release);
+    }
+
+    return count;
+}
+
+template <typename ELEM_T, uint32_t Q_SIZE>
+uint32_t ArrayLockFreeQueueSingleProducerSingleConsumer<ELEM_T, Q_SIZE>::pop_bulk(ELEM_T *a_data, uint32_t a_maxCount)
+{
+    uint32_t currentReadIndex = m_readIndex.load(std::memory_order_relaxed);
+
+    uint32_t available = m_counter.distance(
+        currentReadIndex, m_cachedWriteIndex);
+    if (available < a_maxCount)
+    {
+        // there might be more elements than the local copy says. Refresh it
+        m_cachedWriteIndex = m_writeIndex.load(std::memory_order_acquire);
+        available = m_counter.distance(
+            currentReadIndex, m_cachedWriteIndex);
+    }
+
+    uint32_t count = (a_maxCount < available) ? a_maxCount : available;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ArrayLockFreeQueueRawSlot<ELEM_T> &slot = 
+            m_theQueue[countToIndex(countAdd(currentReadIndex, i))];
+        a_data[i] = std::move(*slot.get());
+        slot.destroy();
+    }
+
+    if (count > 0)
+    {
+        // give all the slots back to the producer with a single store
+        m_readIndex.store(
+            countAdd(currentReadIndex, count), std::memory_order_release);
+    }
+
+    return count;
+}
+
+#endif // __LOCK_FREE_QUEUE_IMPL_SINGLE_PRODUCER_SINGLE_CONSUMER_H__
@@ -0,0 +1,139 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file lock_free_queue_storage.h
+/// @brief Memory for the slots of the circular array based lock-free queues
+/// The slots can live in the heap or in an anonymous mapping, optionally 
+/// backed by huge pages, bound to a NUMA node and pre-faulted at construction
+/// so the first elements pushed into the queue don't pay for page faults
+///
+// ============================================================================
+
+#ifndef __LOCK_FREE_QUEUE_STORAGE_H__
+#define __LOCK_FREE_QUEUE_STORAGE_H__
+
+#include <stddef.h> // size_t
+
+// size in bytes of the huge pages used by the HUGE_PAGES and 
+// TRANSPARENT_HUGE_PAGES backings. 2MB is the default huge page size in x86_64
+// and most ARM64 linux kernels
+#ifndef LOCK_FREE_Q_HUGE_PAGE_SIZE
+#define LOCK_FREE_Q_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#endif
+
+// maximum NUMA node number that can be passed in the storage options
+#define LOCK_FREE_Q_MAX_NUMA_NODE 1023
+
+/// @brief how the memory of a queue must be obtained
+struct ArrayLockFreeQueueStorageOptions
+{
+    enum Backing
+    {
+        /// heap memory aligned to LOCK_FREE_Q_CACHE_LINE_SIZE
+        HEAP,
+        /// anonymous private mapping. Page aligned
+        MMAP,
+        /// anonymous private mapping aligned to LOCK_FREE_Q_HUGE_PAGE_SIZE
+        /// tagged with madvise(MADV_HUGEPAGE) so the kernel backs it with
+        /// transparent huge pages if it can
+        TRANSPARENT_HUGE_PAGES,
+        /// mapping backed by the huge pages reserved in the system 
+        /// (MAP_HUGETLB, see /proc/sys/vm/nr_hugepages). It falls back to 
+        /// TRANSPARENT_HUGE_PAGES if there are no huge pages available
+        HUGE_PAGES
+    };
+
+    /// @brief constructor. By default memory comes from the heap with no 
+    ///        NUMA binding and no pre-faulting
+    /// @param a_backing where the memory comes from
+    /// @param a_numaNode NUMA node the memory must be bound to. -1 means no 
+    ///        binding. HEAP memory is replaced by MMAP when a node is given, 
+    ///        since the binding applies to whole pages
+    /// @param a_prefault touch every page of the memory at construction 
+    ArrayLockFreeQueueStorageOptions(
+        Backing a_backing  = HEAP,
+        int     a_numaNode = -1,
+        bool    a_prefault = false):
+        m_backing(a_backing),
+        m_numaNode(a_numaNode),
+        m_prefault(a_prefault)
+    {}
+
+    Backing m_backing;
+    int     m_numaNode;
+    bool    m_prefault;
+};
+
+/// @brief block of memory allocated following a set of storage options
+/// It is released when the object is destroyed. If the memory can't be 
+/// allocated std::bad_alloc is thrown, just like operator new does
+class ArrayLockFreeQueueMemory
+{
+public:
+    /// @brief allocate a_bytes bytes of memory
+    /// The memory is not initialised (it is all zeros when it comes from a 
+    /// mapping)
+    ArrayLockFreeQueueMemory(
+        size_t                                  a_bytes, 
+        const ArrayLockFreeQueueStorageOptions &a_options);
+
+    ~ArrayLockFreeQueueMemory();
+
+    /// @brief pointer to the first byte of the memory
+    inline void* get() const;
+
+    /// @brief where the memory came from. It might not be the one requested
+    ///        if the system didn't support it (no huge pages reserved...)
+    inline ArrayLockFreeQueueStorageOptions::Backing backing() const;
+
+    /// @brief NUMA node the memory is bound to. -1 if it isn't bound to any
+    inline int numaNode() const;
+
+private:
+    /// pointer to the memory
+    void* m_memory;
+    /// number of bytes mapped. Size of the mapping (multiple of the page size)
+    size_t m_mappedBytes;
+    /// where the memory in m_memory came from
+    ArrayLockFreeQueueStorageOptions::Backing m_backing;
+    /// NUMA node the memory is bound to (-1 if none)
+    int m_numaNode;
+
+    /// @brief anonymous private mapping of a_bytes bytes aligned to 
+    ///        a_alignment (a power of 2 multiple of the page size)
+    /// @return pointer to the mapping or 0 if it failed
+    static void* mapAligned(size_t a_bytes, size_t a_alignment, int a_extraFlags);
+
+    /// @brief bind the memory to a_node 
+    /// @return true on success
+    bool bindToNumaNode(int a_node);
+
+    /// @brief write into every page of the memory to fault it in
+    void prefault();
+
+    /// @brief disable copy constructor and operator= declaring them private
+    ArrayLockFreeQueueMemory(const ArrayLockFreeQueueMemory &a_src);
+    ArrayLockFreeQueueMemory& operator=(const ArrayLockFreeQueueMemory &a_src);
+};
+
+#include "lock_free_queue_storage_impl.h"
+
+#endif // __LOCK_FREE_QUEUE_STORAGE_H__
@@ -0,0 +1,229 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file lock_free_queue_storage_impl.h
+/// @brief Implementation of the memory for the slots of the circular array 
+///        based lock-free queues
+///
+// ============================================================================
+
+#ifndef __LOCK_FREE_QUEUE_STORAGE_IMPL_H__
+#define __LOCK_FREE_QUEUE_STORAGE_IMPL_H__
+
+#include <assert.h>     // assert()
+#include <stdint.h>     // uintptr_t
+#include <stdlib.h>     // posix_memalign, free
+#include <string.h>     // memset
+#include <unistd.h>     // sysconf, syscall
+#include <sys/mman.h>   // mmap, munmap, madvise
+#include <sys/syscall.h>// SYS_mbind
+#include <new>          // std::bad_alloc
+
+// policy for mbind as defined in linux/mempolicy.h. numaif.h (libnuma) is 
+// not needed to bind the memory to a node
+#define LOCK_FREE_Q_MPOL_BIND 2
+
+inline ArrayLockFreeQueueMemory::ArrayLockFreeQueueMemory(
+    size_t                                  a_bytes, 
+    const ArrayLockFreeQueueStorageOptions &a_options):
+    m_memory(0),
+    m_mappedBytes(0),
+    m_backing(a_options.m_backing),
+    m_numaNode(-1)
+{
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    if (a_bytes == 0)
+    {
+        a_bytes = 1;
+    }
+
+    if ((m_backing == ArrayLockFreeQueueStorageOptions::HEAP) && 
+        (a_options.m_numaNode >= 0))
+    {
+        // the NUMA policy applies to whole pages. Heap memory shares them 
+        // with whatever else was allocated around it
+        m_backing = ArrayLockFreeQueueStorageOptions::MMAP;
+    }
+
+#ifdef MAP_HUGETLB
+    if (m_backing == ArrayLockFreeQueueStorageOptions::HUGE_PAGES)
+    {
+        m_mappedBytes = (a_bytes + LOCK_FREE_Q_HUGE_PAGE_SIZE - 1) & 
+            ~static_cast<size_t>(LOCK_FREE_Q_HUGE_PAGE_SIZE - 1);
+        m_memory = mapAligned(m_mappedBytes, pageSize, MAP_HUGETLB);
+    }
+#endif
+    if ((m_memory == 0) && 
+        (m_backing == ArrayLockFreeQueueStorageOptions::HUGE_PAGES))
+    {
+        // no huge pages reserved in the system (or not enough of them)
+        m_backing = ArrayLockFreeQueueStorageOptions::TRANSPARENT_HUGE_PAGES;
+    }
+
+    if (m_backing == ArrayLockFreeQueueStorageOptions::TRANSPARENT_HUGE_PAGES)
+    {
+        // the kernel can only use huge pages for aligned ranges of memory
+        m_mappedBytes = (a_bytes + LOCK_FREE_Q_HUGE_PAGE_SIZE - 1) & 
+            ~static_cast<size_t>(LOCK_FREE_Q_HUGE_PAGE_SIZE - 1);
+        m_memory = mapAligned(m_mappedBytes, LOCK_FREE_Q_HUGE_PAGE_SIZE, 0);
+#ifdef MADV_HUGEPAGE
+        if (m_memory != 0)
+        {
+            // it is only a hint. THP might be disabled in the system
+            madvise(m_memory, m_mappedBytes, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    else if (m_backing == ArrayLockFreeQueueStorageOptions::MMAP)
+    {
+        m_mappedBytes = (a_bytes + pageSize - 1) & ~(pageSize - 1);
+        m_memory = mapAligned(m_mappedBytes, pageSize, 0);
+    }
+    else if (m_backing == ArrayLockFreeQueueStorageOptions::HEAP)
+    {
+        if (posix_memalign(&m_memory, LOCK_FREE_Q_CACHE_LINE_SIZE, a_bytes) != 0)
+        {
+            m_memory = 0;
+        }
+        m_mappedBytes = a_bytes;
+    }
+
+    if (m_memory == 0)
+    {
+        throw std::bad_alloc();
+    }
+
+    // the memory must be bound to the node before it is touched for the 
+    // first time. Pages are allocated when they are first written
+    if (a_options.m_numaNode >= 0)
+    {
+        if (bindToNumaNode(a_options.m_numaNode))
+        {
+            m_numaNode = a_options.m_numaNode;
+        }
+    }
+
+    if (a_options.m_prefault)
+    {
+        prefault();
+    }
+}
+
+inline ArrayLockFreeQueueMemory::~ArrayLockFreeQueueMemory()
+{
+    if (m_backing == ArrayLockFreeQueueStorageOptions::HEAP)
+    {
+        free(m_memory);
+    }
+    else
+    {
+        munmap(m_memory, m_mappedBytes);
+    }
+}
+
+inline void* ArrayLockFreeQueueMemory::get() const
+{
+    return m_memory;
+}
+
+inline ArrayLockFreeQueueStorageOptions::Backing ArrayLockFreeQueueMemory::backing() const
+{
+    return m_backing;
+}
+
+inline int ArrayLockFreeQueueMemory::numaNode() const
+{
+    return m_numaNode;
+}
+
+inline void* ArrayLockFreeQueueMemory::mapAligned(
+    size_t a_bytes, 
+    size_t a_alignment, 
+    int    a_extraFlags)
+{
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    // mmap only guarantees page alignment. Map a_alignment extra bytes and 
+    // give the unaligned head and the tail back
+    size_t extraBytes = (a_alignment > pageSize) ? a_alignment : 0;
+
+    void* mapping = mmap(
+        0, a_bytes + extraBytes, PROT_READ | PROT_WRITE, 
+        MAP_PRIVATE | MAP_ANONYMOUS | a_extraFlags, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        return 0;
+    }
+
+    if (extraBytes == 0)
+    {
+        return mapping;
+    }
+
+    uintptr_t start   = reinterpret_cast<uintptr_t>(mapping);
+    uintptr_t aligned = (start + a_alignment - 1) & ~(a_alignment - 1);
+    if (aligned > start)
+    {
+        munmap(mapping, aligned - start);
+    }
+    if ((aligned + a_bytes) < (start + a_bytes + extraBytes))
+    {
+        munmap(reinterpret_cast<void*>(aligned + a_bytes), 
+               (start + a_bytes + extraBytes) - (aligned + a_bytes));
+    }
+
+    return reinterpret_cast<void*>(aligned);
+}
+
+inline bool ArrayLockFreeQueueMemory::bindToNumaNode(int a_node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    assert(a_node <= LOCK_FREE_Q_MAX_NUMA_NODE);
+
+    const size_t bitsPerLong = 8 * sizeof(unsigned long);
+    unsigned long nodeMask[(LOCK_FREE_Q_MAX_NUMA_NODE / (8 * sizeof(unsigned long))) + 1];
+    memset(nodeMask, 0, sizeof(nodeMask));
+    nodeMask[a_node / bitsPerLong] |= (1UL << (a_node % bitsPerLong));
+
+    // the kernel reads (maxnode - 1) bits of the mask
+    return (syscall(SYS_mbind, m_memory, m_mappedBytes, LOCK_FREE_Q_MPOL_BIND, 
+                    nodeMask, (8 * sizeof(nodeMask)) + 1, 0) == 0);
+#else
+    (void)a_node;
+    return false;
+#endif
+}
+
+inline void ArrayLockFreeQueueMemory::prefault()
+{
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    // writing (not reading) is what makes the kernel allocate the page. The
+    // memory is not initialised anyway so a 0 can be written into it
+    volatile char* memory = static_cast<volatile char*>(m_memory);
+    for (size_t i = 0; i < m_mappedBytes; i += pageSize)
+    {
+        memory[i] = 0;
+    }
+}
+
+#endif // __LOCK_FREE_QUEUE_STORAGE_IMPL_H__
@@ -0,0 +1,266 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file lock_free_queue_wait.h
+/// @brief Wait strategies for the blocking calls of the circular array based
+///        lock-free queues (pop_wait, push_wait...)
+/// A wait strategy decides what a thread does while the queue is empty (or 
+/// full): burn the CPU spinning, give the processor away to other threads or 
+/// go to sleep until another thread wakes it up. It trades CPU usage for 
+/// latency. Every strategy implements:
+///
+///   template <typename TRY_T>
+///   bool wait(TRY_T a_try, std::chrono::steady_clock::time_point a_deadline);
+///       calls a_try() until it returns true (return true) or a_deadline is
+///       hit (return false)
+///   void notify();
+///       called after every successful operation on the queue that could 
+///       unblock a thread waiting on the other side
+///
+// ============================================================================
+
+#ifndef __LOCK_FREE_QUEUE_WAIT_H__
+#define __LOCK_FREE_QUEUE_WAIT_H__
+
+#include <stdint.h>     // uint32_t
+#include <limits.h>     // INT_MAX
+#include <sched.h>      // sched_yield()
+#include <atomic>
+#include <chrono>
+#ifdef __linux__
+#include <unistd.h>     // syscall
+#include <sys/syscall.h>// SYS_futex
+#include <linux/futex.h>// FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <time.h>       // struct timespec
+#endif
+
+// number of times a_try is called spinning on the CPU before the thread starts
+// yielding the processor to other threads
+#ifndef LOCK_FREE_Q_WAIT_SPINS
+#define LOCK_FREE_Q_WAIT_SPINS  1024
+#endif
+
+// number of times ArrayLockFreeQueueParkWait yields the processor before the
+// thread is put to sleep
+#ifndef LOCK_FREE_Q_WAIT_YIELDS
+#define LOCK_FREE_Q_WAIT_YIELDS 64
+#endif
+
+/// @brief tell the processor the thread is in a spin loop
+/// It saves power and frees resources for the other hardware threads of the 
+/// same core (pause in x86, yield in ARM)
+inline void ArrayLockFreeQueueCpuRelax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/// @brief the thread spins on the CPU until it succeeds. Lowest latency, but
+///        the waiting thread uses a whole core
+/// a_deadline is only checked every LOCK_FREE_Q_WAIT_SPINS attempts
+class ArrayLockFreeQueueBusySpinWait
+{
+public:
+    template <typename TRY_T>
+    inline bool wait(TRY_T a_try, std::chrono::steady_clock::time_point a_deadline)
+    {
+        for (uint32_t spins = 1; ; spins++)
+        {
+            if (a_try())
+            {
+                return true;
+            }
+
+            if (((spins % LOCK_FREE_Q_WAIT_SPINS) == 0) && 
+                (std::chrono::steady_clock::now() >= a_deadline))
+            {
+                return false;
+            }
+
+            ArrayLockFreeQueueCpuRelax();
+        }
+    }
+
+    inline void notify()
+    {}
+};
+
+/// @brief the thread spins LOCK_FREE_Q_WAIT_SPINS times and then yields the
+///        processor between attempts
+/// Threads never sleep so there is nothing to notify. This is the default
+/// strategy of ArrayLockFreeQueue
+class ArrayLockFreeQueueSpinYieldWait
+{
+public:
+    template <typename TRY_T>
+    inline bool wait(TRY_T a_try, std::chrono::steady_clock::time_point a_deadline)
+    {
+        for (uint32_t spins = 0; spins < LOCK_FREE_Q_WAIT_SPINS; spins++)
+        {
+            if (a_try())
+            {
+                return true;
+            }
+            ArrayLockFreeQueueCpuRelax();
+        }
+
+        while (!a_try())
+        {
+            if (std::chrono::steady_clock::now() >= a_deadline)
+            {
+                return false;
+            }
+            sched_yield();
+        }
+
+        return true;
+    }
+
+    inline void notify()
+    {}
+};
+
+/// @brief the thread spins, then yields the processor, and then sleeps in a 
+///        futex until another thread notifies it (or a_deadline is hit)
+/// The futex works as an eventcount: m_epoch is incremented by every notify
+/// that finds threads sleeping, and a thread only goes to sleep if m_epoch 
+/// hasn't changed since it registered itself as a waiter. notify() costs an 
+/// atomic fence and a load when nobody is sleeping. The system call is only 
+/// made if there are waiters. On systems without futexes the thread yields
+/// instead of sleeping
+class ArrayLockFreeQueueParkWait
+{
+public:
+    ArrayLockFreeQueueParkWait():
+        m_epoch(0),
+        m_waiters(0)
+    {}
+
+    template <typename TRY_T>
+    inline bool wait(TRY_T a_try, std::chrono::steady_clock::time_point a_deadline)
+    {
+        for (uint32_t spins = 0; spins < LOCK_FREE_Q_WAIT_SPINS; spins++)
+        {
+            if (a_try())
+            {
+                return true;
+            }
+            ArrayLockFreeQueueCpuRelax();
+        }
+
+        for (uint32_t yields = 0; yields < LOCK_FREE_Q_WAIT_YIELDS; yields++)
+        {
+            if (a_try())
+            {
+                return true;
+            }
+            if (std::chrono::steady_clock::now() >= a_deadline)
+            {
+                return false;
+            }
+            sched_yield();
+        }
+
+        do
+        {
+            // register as a waiter before trying for the last time. A thread
+            // that makes a_try succeed after this point will see m_waiters > 0
+            // and increment m_epoch, so the futex call below won't sleep
+            m_waiters.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint32_t epoch = m_epoch.load();
+
+            if (a_try())
+            {
+                m_waiters.fetch_sub(1);
+                return true;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now >= a_deadline)
+            {
+                m_waiters.fetch_sub(1);
+                return false;
+            }
+
+            sleep(epoch, a_deadline - now);
+            m_waiters.fetch_sub(1);
+
+        } while (!a_try());
+
+        return true;
+    }
+
+    inline void notify()
+    {
+        // the fence orders the update of the queue done by the caller before
+        // the load of m_waiters (store-load ordering)
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_relaxed) != 0)
+        {
+            m_epoch.fetch_add(1);
+#ifdef __linux__
+            // a bulk operation might unblock more than one waiter
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), 
+                    FUTEX_WAKE_PRIVATE, INT_MAX, 0, 0, 0);
+#endif
+        }
+    }
+
+private:
+    /// incremented every time waiters have to be woken up
+    std::atomic<uint32_t> m_epoch;
+    /// number of threads that are about to sleep or sleeping
+    std::atomic<uint32_t> m_waiters;
+
+    /// @brief sleep while m_epoch is a_epoch for up to a_timeout
+    template <typename DURATION_T>
+    inline void sleep(uint32_t a_epoch, DURATION_T a_timeout)
+    {
+#ifdef __linux__
+        std::chrono::nanoseconds ns = 
+            std::chrono::duration_cast<std::chrono::nanoseconds>(a_timeout);
+        // time_point::max() is used as "no deadline". Don't overflow timespec
+        const std::chrono::nanoseconds maxSleep = std::chrono::hours(24);
+        if (ns > maxSleep)
+        {
+            ns = maxSleep;
+        }
+
+        struct timespec timeout;
+        timeout.tv_sec  = static_cast<time_t>(ns.count() / 1000000000);
+        timeout.tv_nsec = static_cast<long>(ns.count() % 1000000000);
+
+        // returns straight away if m_epoch isn't a_epoch anymore
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), 
+                FUTEX_WAIT_PRIVATE, a_epoch, &timeout, 0, 0);
+#else
+        (void)a_epoch; 
+        (void)a_timeout;
+        sched_yield();
+#endif
+    }
+};
+
+#endif // __LOCK_FREE_QUEUE_WAIT_H__
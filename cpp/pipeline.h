@@ -0,0 +1,270 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file  pipeline.h
+/// @brief A chain of processing stages run by consumer threads
+/// Every stage is a delegate that receives an element by reference, can 
+/// modify it and returns whether it carries on down the pipeline. A stage 
+/// runs on its own ConsumerThreads (as many as its parallelism), or it is
+/// fused with the stage before it and then runs on the same threads, right
+/// after it, without going through a queue. Elements are moved from one 
+/// stage into the queue of the next one, they are never copied:
+///
+///   Pipeline<Order> pipeline;
+///   pipeline.AddStage("decode", MakeDelegate(&decoder, &Decoder::Decode), 
+///       PipelineStageConfig(4));
+///   pipeline.AddStage("risk", MakeDelegate(&risk, &Risk::Check), 
+///       PipelineStageConfig(1, true)); // fused with "decode"
+///   pipeline.AddStage("send", MakeDelegate(&gateway, &Gateway::Send));
+///   pipeline.Start();
+///   pipeline.ProduceOrBlock(order);
+///   ...
+///   pipeline.Join(); // everything produced goes all the way through
+///
+/// Which stages are fused, how many threads each one gets and where they
+/// run (ConsumerThreadAttributes) is configuration: the stage delegates 
+/// don't change when the pipeline is rebalanced. GetStats reports how many
+/// elements each stage processed, its throughput and its queue depth
+///
+// ============================================================================
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory> // std::unique_ptr
+#include <chrono>
+#include <functional>
+#include "consumer_thread.h"
+
+// what AddStage returns for a stage it can't add
+#define PIPELINE_INVALID_STAGE (static_cast<std::size_t>(-1))
+
+/// @brief how a stage of a pipeline is run
+struct PipelineStageConfig
+{
+    /// @brief constructor
+    /// @param a_parallelism number of threads the stage runs on. Elements 
+    ///        are handed out to them in round robin, so they may leave the 
+    ///        stage in a different order than they came in if it is more 
+    ///        than 1. Ignored if the stage is fused, it must be at least 1
+    ///        otherwise
+    /// @param a_fuse true to run the stage on the threads of the stage added
+    ///        before it, right after it. Ignored for the first stage
+    /// @param a_attributes placement and scheduling of the threads of the 
+    ///        stage. Ignored if the stage is fused
+    explicit PipelineStageConfig(
+        std::size_t                     a_parallelism = 1, 
+        bool                            a_fuse        = false,
+        const ConsumerThreadAttributes &a_attributes  = ConsumerThreadAttributes()):
+        m_parallelism(a_parallelism),
+        m_fuse(a_fuse),
+        m_attributes(a_attributes)
+    {}
+
+    std::size_t              m_parallelism;
+    bool                     m_fuse;
+    ConsumerThreadAttributes m_attributes;
+};
+
+/// @brief what GetStats reports per stage
+struct PipelineStageStats
+{
+    std::string m_name;
+    /// threads the stage runs on (the ones of the stage it is fused with)
+    std::size_t m_threads;
+    /// true if the stage is fused with the one before it
+    bool        m_fused;
+    /// elements the stage delegate was called for
+    uint64_t    m_processed;
+    /// elements the stage delegate returned false for
+    uint64_t    m_dropped;
+    /// processed elements per second since the pipeline was started (until
+    /// it was joined)
+    double      m_throughput;
+    /// elements waiting in the queues of the threads of the stage. Always 0
+    /// for fused stages, they don't have queues
+    std::size_t m_queueDepth;
+};
+
+/// @brief a chain of stages run by consumer threads
+/// T type of the elements going through the pipeline. Elements are moved
+///   from stage to stage, so it can be move only
+/// QUEUE_T type of the queue of every consumer thread (see ConsumerThread)
+/// DELEGATE_T template of the delegates (see ConsumerThread). The stage 
+///   delegates are DELEGATE_T<bool(T&)>
+template <typename T, 
+          typename QUEUE_T = SafeQueue<T>, 
+          template <typename> class DELEGATE_T = std::function>
+class Pipeline
+{
+public:
+    typedef DELEGATE_T<bool(T&)> StageDelegate_t;
+
+    Pipeline();
+
+    /// @brief joins the pipeline if it was started and not joined yet
+    virtual ~Pipeline();
+
+    /// @brief adds a stage at the end of the pipeline. It must be called 
+    ///        before Start
+    /// @param a_name name of the stage in the statistics
+    /// @param a_stage called once per element. It gets the element by 
+    ///        reference and returns true for the element to go on to the 
+    ///        next stage, false to drop it. It's called concurrently from 
+    ///        all the threads of the stage
+    /// @param a_config threads the stage runs on
+    /// @return index of the stage. PIPELINE_INVALID_STAGE if the stage 
+    ///         starts a group of fused stages (it is the first stage, or it 
+    ///         isn't fused) and runs on no threads. Nothing is added then
+    std::size_t AddStage(
+        const std::string         &a_name, 
+        StageDelegate_t            a_stage, 
+        const PipelineStageConfig &a_config = PipelineStageConfig());
+
+    /// @brief creates the threads of every stage. Nothing can be produced 
+    ///        before it is called, and no stage can be added after
+    /// The queue of each thread gets the default size of QUEUE_T (the only
+    /// choice for queues with a size chosen at compile time)
+    void Start();
+
+    /// @brief creates the threads of every stage. See above
+    /// @param a_queueSize size of the queue of each thread
+    void Start(std::size_t a_queueSize);
+
+    /// @brief waits until every element produced goes through the whole
+    ///        pipeline and the threads finish. The stages are joined in 
+    ///        order, so each of them is drained into a running next stage
+    void Join();
+
+    /// @brief inserts an element at the beginning of the pipeline
+    /// @return false if the queue of the thread the element was given to is
+    ///         full (a_data is not modified then)
+    bool Produce(const T &a_data);
+    bool Produce(T &&a_data);
+
+    /// @brief inserts an element at the beginning of the pipeline. Blocks 
+    ///        until there is space for it in the queue of the thread it is 
+    ///        given to
+    void ProduceOrBlock(const T &a_data);
+    void ProduceOrBlock(T &&a_data);
+
+    /// @return number of stages
+    std::size_t GetNumStages() const;
+
+    /// @brief statistics of every stage, in the order they were added
+    /// It can be called from any thread after Start (the thread must know 
+    /// Start returned), even while or after Join runs
+    void GetStats(std::vector<PipelineStageStats> &out_stats) const;
+
+private:
+    typedef ConsumerThread<T, QUEUE_T, DELEGATE_T> Thread_t;
+
+    struct Stage
+    {
+        std::string         m_name;
+        StageDelegate_t     m_delegate;
+        PipelineStageConfig m_config;
+    };
+
+    /// @brief counters of a stage in a thread. Only that thread writes them
+    struct StageCounters
+    {
+        StageCounters(): m_processed(0), m_dropped(0) {}
+
+        std::atomic<uint64_t> m_processed;
+        std::atomic<uint64_t> m_dropped;
+    };
+
+    /// @brief a thread of a group of fused stages
+    struct Worker
+    {
+        Worker(std::size_t a_nStages):
+            m_thread(),
+            m_counters(new StageCounters[a_nStages]),
+            m_nextTarget(0)
+        {}
+
+        std::unique_ptr<Thread_t> m_thread;
+        /// one per stage of the group
+        std::unique_ptr<StageCounters[]> m_counters;
+        /// next thread of the next group this one hands an element to. 
+        /// Only this thread uses it
+        std::size_t m_nextTarget;
+    };
+
+    /// @brief stages run one after the other by the same threads. A stage 
+    ///        that isn't fused starts a group
+    struct Group
+    {
+        Group(std::size_t a_firstStage):
+            m_firstStage(a_firstStage),
+            m_endStage(a_firstStage + 1),
+            m_workers(),
+            m_next(0),
+            m_nextWorker(0)
+        {}
+
+        /// [m_firstStage, m_endStage)
+        std::size_t m_firstStage;
+        std::size_t m_endStage;
+        std::vector<std::unique_ptr<Worker> > m_workers;
+        /// group elements are handed to after this one. 0 for the last one
+        Group* m_next;
+        /// next worker an element produced from outside the pipeline will
+        /// be given to (only the first group)
+        std::atomic<std::size_t> m_nextWorker;
+    };
+
+    std::vector<Stage> m_stages;
+    std::vector<std::unique_ptr<Group> > m_groups;
+
+    bool m_started;
+    /// set by Join once m_joinTime is written. GetStats may read both from
+    /// another thread while Join runs
+    std::atomic<bool> m_joined;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_joinTime;
+
+    /// @brief groups the stages and creates the threads
+    /// @param a_newThread creates a thread given its attributes and its 
+    ///        consume delegate
+    template <typename NEW_THREAD_T>
+    void StartThreads(NEW_THREAD_T a_newThread);
+
+    /// @brief consume delegate of the threads of a group. Runs the stages
+    ///        of the group and hands the element to the next one
+    void Process(Group *a_group, Worker *a_worker, T &a_data);
+
+    /// @return the thread of the first group the next element produced from
+    ///         outside the pipeline goes to
+    Thread_t& NextInput();
+
+    /// @brief disable copy constructor declaring it private
+    Pipeline(const Pipeline &a_src);
+};
+
+#include "pipeline_impl.h"
+
+#endif /* _PIPELINE_H_ */
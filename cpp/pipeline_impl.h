@@ -0,0 +1,293 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file  pipeline_impl.h
+/// @brief Implementation of the Pipeline class
+///
+// ============================================================================
+
+#ifndef _PIPELINEIMPL_H_
+#define _PIPELINEIMPL_H_
+
+#include <assert.h>
+#include <utility> // std::move
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+Pipeline<T, QUEUE_T, DELEGATE_T>::Pipeline():
+    m_stages(),
+    m_groups(),
+    m_started(false),
+    m_joined(false),
+    m_startTime(),
+    m_joinTime()
+{
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+Pipeline<T, QUEUE_T, DELEGATE_T>::~Pipeline()
+{
+    if (m_started && !m_joined.load())
+    {
+        Join();
+    }
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+std::size_t Pipeline<T, QUEUE_T, DELEGATE_T>::AddStage(
+    const std::string         &a_name, 
+    StageDelegate_t            a_stage, 
+    const PipelineStageConfig &a_config)
+{
+    assert(!m_started);
+
+    // fuse is ignored for the first stage
+    bool startsGroup = m_stages.empty() || !a_config.m_fuse;
+    if (startsGroup && (a_config.m_parallelism == 0))
+    {
+        return PIPELINE_INVALID_STAGE;
+    }
+
+    Stage stage;
+    stage.m_name = a_name;
+    stage.m_delegate = std::move(a_stage);
+    stage.m_config = a_config;
+    m_stages.push_back(std::move(stage));
+
+    return m_stages.size() - 1;
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void Pipeline<T, QUEUE_T, DELEGATE_T>::Start()
+{
+    StartThreads(
+        [](const ConsumerThreadAttributes &a_attributes, 
+           const typename Thread_t::ConsumeDelegate_t &a_consume)
+        {
+            return new Thread_t(a_attributes, a_consume);
+        });
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void Pipeline<T, QUEUE_T, DELEGATE_T>::Start(std::size_t a_queueSize)
+{
+    StartThreads(
+        [a_queueSize](const ConsumerThreadAttributes &a_attributes, 
+                      const typename Thread_t::ConsumeDelegate_t &a_consume)
+        {
+            return new Thread_t(a_queueSize, a_attributes, a_consume);
+        });
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+template <typename NEW_THREAD_T>
+void Pipeline<T, QUEUE_T, DELEGATE_T>::StartThreads(NEW_THREAD_T a_newThread)
+{
+    assert(!m_started);
+    assert(!m_stages.empty());
+
+    // groups of fused stages
+    for (std::size_t i = 0; i < m_stages.size(); i++)
+    {
+        if ((i == 0) || !m_stages[i].m_config.m_fuse)
+        {
+            if (!m_groups.empty())
+            {
+                m_groups.back()->m_next = new Group(i);
+                m_groups.push_back(std::unique_ptr<Group>(m_groups.back()->m_next));
+            }
+            else
+            {
+                m_groups.push_back(std::unique_ptr<Group>(new Group(i)));
+            }
+        }
+        else
+        {
+            m_groups.back()->m_endStage = i + 1;
+        }
+    }
+
+    // threads are created from the last group to the first one, so every
+    // thread hands elements to a group that is already running
+    m_startTime = std::chrono::steady_clock::now();
+    for (std::size_t g = m_groups.size(); g > 0; g--)
+    {
+        Group *group = m_groups[g - 1].get();
+        const PipelineStageConfig &config = m_stages[group->m_firstStage].m_config;
+        std::size_t nStages = group->m_endStage - group->m_firstStage;
+
+        for (std::size_t w = 0; w < config.m_parallelism; w++)
+        {
+            Worker *worker = new Worker(nStages);
+            group->m_workers.push_back(std::unique_ptr<Worker>(worker));
+
+            typename Thread_t::ConsumeDelegate_t consume = 
+                [this, group, worker](T a_data)
+                {
+                    this->Process(group, worker, a_data);
+                };
+            worker->m_thread.reset(a_newThread(config.m_attributes, consume));
+            // the queue depth in the statistics
+            worker->m_thread->TrackBacklog();
+        }
+    }
+
+    m_started = true;
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void Pipeline<T, QUEUE_T, DELEGATE_T>::Join()
+{
+    assert(m_started && !m_joined.load());
+
+    for (std::size_t g = 0; g < m_groups.size(); g++)
+    {
+        for (std::size_t w = 0; w < m_groups[g]->m_workers.size(); w++)
+        {
+            m_groups[g]->m_workers[w]->m_thread->Join();
+        }
+    }
+
+    // the release store publishes m_joinTime to GetStats
+    m_joinTime = std::chrono::steady_clock::now();
+    m_joined.store(true, std::memory_order_release);
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+bool Pipeline<T, QUEUE_T, DELEGATE_T>::Produce(const T &a_data)
+{
+    assert(m_started);
+
+    return NextInput().Produce(a_data);
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+bool Pipeline<T, QUEUE_T, DELEGATE_T>::Produce(T &&a_data)
+{
+    assert(m_started);
+
+    return NextInput().Produce(std::move(a_data));
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void Pipeline<T, QUEUE_T, DELEGATE_T>::ProduceOrBlock(const T &a_data)
+{
+    assert(m_started);
+
+    NextInput().ProduceOrBlock(a_data);
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void Pipeline<T, QUEUE_T, DELEGATE_T>::ProduceOrBlock(T &&a_data)
+{
+    assert(m_started);
+
+    NextInput().ProduceOrBlock(std::move(a_data));
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+std::size_t Pipeline<T, QUEUE_T, DELEGATE_T>::GetNumStages() const
+{
+    return m_stages.size();
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void Pipeline<T, QUEUE_T, DELEGATE_T>::GetStats(std::vector<PipelineStageStats> &out_stats) const
+{
+    assert(m_started);
+
+    std::chrono::steady_clock::time_point end = 
+        m_joined.load(std::memory_order_acquire) ? 
+            m_joinTime : std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - m_startTime).count();
+
+    out_stats.clear();
+    for (std::size_t g = 0; g < m_groups.size(); g++)
+    {
+        const Group &group = *m_groups[g];
+        for (std::size_t s = group.m_firstStage; s < group.m_endStage; s++)
+        {
+            PipelineStageStats stats;
+            stats.m_name = m_stages[s].m_name;
+            stats.m_threads = group.m_workers.size();
+            stats.m_fused = (s != group.m_firstStage);
+            stats.m_processed = 0;
+            stats.m_dropped = 0;
+            stats.m_queueDepth = 0;
+
+            for (std::size_t w = 0; w < group.m_workers.size(); w++)
+            {
+                const Worker &worker = *group.m_workers[w];
+                const StageCounters &counters = worker.m_counters[s - group.m_firstStage];
+                stats.m_processed += counters.m_processed.load(std::memory_order_relaxed);
+                stats.m_dropped += counters.m_dropped.load(std::memory_order_relaxed);
+                if (!stats.m_fused)
+                {
+                    stats.m_queueDepth += worker.m_thread->Backlog();
+                }
+            }
+
+            stats.m_throughput = (seconds > 0) ? (stats.m_processed / seconds) : 0;
+            out_stats.push_back(stats);
+        }
+    }
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+void Pipeline<T, QUEUE_T, DELEGATE_T>::Process(Group *a_group, Worker *a_worker, T &a_data)
+{
+    for (std::size_t s = a_group->m_firstStage; s < a_group->m_endStage; s++)
+    {
+        bool carryOn = m_stages[s].m_delegate(a_data);
+
+        // only this thread writes the counters. No need for atomic adds
+        StageCounters &counters = a_worker->m_counters[s - a_group->m_firstStage];
+        counters.m_processed.store(
+            counters.m_processed.load(std::memory_order_relaxed) + 1, 
+            std::memory_order_relaxed);
+        if (!carryOn)
+        {
+            counters.m_dropped.store(
+                counters.m_dropped.load(std::memory_order_relaxed) + 1, 
+                std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    Group *next = a_group->m_next;
+    if (next != 0)
+    {
+        // the next group applies its own back-pressure: this thread waits 
+        // if the queue it hands the element to is full
+        std::size_t target = a_worker->m_nextTarget++ % next->m_workers.size();
+        next->m_workers[target]->m_thread->ProduceOrBlock(std::move(a_data));
+    }
+}
+
+template <typename T, typename QUEUE_T, template <typename> class DELEGATE_T>
+typename Pipeline<T, QUEUE_T, DELEGATE_T>::Thread_t& Pipeline<T, QUEUE_T, DELEGATE_T>::NextInput()
+{
+    Group &first = *m_groups[0];
+    std::size_t target = 
+        first.m_nextWorker.fetch_add(1, std::memory_order_relaxed) % first.m_workers.size();
+    return *first.m_workers[target]->m_thread;
+}
+
+#endif /* _PIPELINEIMPL_H_ */
@@ -0,0 +1,486 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file priority_safe_queue.h
+/// @brief Thread-safe queue that doesn't extract the elements in insertion 
+///        order but by priority (or by deadline)
+/// The way elements are ordered is a policy:
+///   - PrioritySafeQueueLanes: a small fixed number of priority lanes, each 
+///     one a FIFO (RingBuffer). A bitmap tells which lanes have something in
+///     them, so finding the highest priority element is a single bit scan.
+///     Elements in the same lane keep their insertion order
+///   - PrioritySafeQueueDeadline: earliest deadline first. A binary heap 
+///     keyed by the deadline of the elements. Elements with the same 
+///     deadline keep their insertion order
+///
+/// The priority (or the deadline) of an element is given explicitly to the 
+/// push calls, or worked out from the element by a functor of the policy 
+/// when it is not. The interface is otherwise the one of SafeQueue, so it can
+/// be used by ConsumerThread (heartbeats or cancels going past bulk data in 
+/// the same consumer):
+///   struct Msg { std::size_t Priority() const; ... };
+///   ConsumerThread<Msg, PrioritySafeQueue<Msg> > consumer(...);
+///
+/// Unlike SafeQueue it can't be copied or moved
+///
+/// Your compiler must have support for c++11. This is an example of how to 
+/// compile an application that makes use of this queue with gcc 4.8:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c app.cpp
+///   $ g++ app.o -o app
+///
+// ============================================================================
+
+#ifndef _PRIORITYSAFEQUEUE_H_
+#define _PRIORITYSAFEQUEUE_H_
+
+#include <stdint.h> // uint64_t
+#include <assert.h>
+#include <condition_variable>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <algorithm> // std::push_heap, std::pop_heap
+#include <utility>   // std::move, std::forward
+#include "ring_buffer.h"
+#include "safe_queue.h" // SAFE_QUEUE_DEFAULT_MAX_SIZE
+#include "queue_stats.h"
+
+/// @brief element of the queue plus the time it was inserted (only if there
+///        are statistics to keep)
+template <typename T, bool STAMPED>
+struct PrioritySafeQueueEntry
+{
+    /// the stamp goes first so this is never mistaken for a copy constructor
+    template <typename... ARGS>
+    explicit PrioritySafeQueueEntry(uint64_t a_stamp, ARGS&&... a_args):
+        m_elem(std::forward<ARGS>(a_args)...),
+        m_stamp(a_stamp)
+    {}
+
+    inline void SetStamp(uint64_t a_stamp) { m_stamp = a_stamp; }
+    inline uint64_t GetStamp() const { return m_stamp; }
+
+    T m_elem;
+    uint64_t m_stamp;
+};
+
+template <typename T>
+struct PrioritySafeQueueEntry<T, false>
+{
+    template <typename... ARGS>
+    explicit PrioritySafeQueueEntry(uint64_t, ARGS&&... a_args):
+        m_elem(std::forward<ARGS>(a_args)...)
+    {}
+
+    inline void SetStamp(uint64_t) {}
+    inline uint64_t GetStamp() const { return 0; }
+
+    T m_elem;
+};
+
+/// @brief default lane of an element for PrioritySafeQueueLanes: what its 
+///        Priority() method returns
+struct PrioritySafeQueueLaneOf
+{
+    template <typename T>
+    inline std::size_t operator()(const T &a_elem) const
+    {
+        return a_elem.Priority();
+    }
+};
+
+/// @brief default deadline of an element for PrioritySafeQueueDeadline: 
+///        what its Deadline() method returns
+struct PrioritySafeQueueDeadlineOf
+{
+    template <typename T>
+    inline std::chrono::steady_clock::time_point operator()(const T &a_elem) const
+    {
+        return a_elem.Deadline();
+    }
+};
+
+/// @brief ordering policy: LANES priority lanes. The highest lane (LANES - 1)
+///        is served first. FIFO order inside each lane
+/// LANE_OF_T functor that returns the lane of an element when it is not 
+///           given to the push call. Lanes out of range are treated as the
+///           highest one
+template <std::size_t LANES = 4, typename LANE_OF_T = PrioritySafeQueueLaneOf>
+struct PrioritySafeQueueLanes
+{
+    static_assert((LANES > 0) && (LANES <= 64),
+        "PrioritySafeQueueLanes supports from 1 up to 64 lanes");
+
+    /// priority of an element
+    typedef std::size_t Key_t;
+
+    template <typename T>
+    static inline Key_t KeyOf(const T &a_elem) { return LANE_OF_T()(a_elem); }
+
+    /// @brief the elements of the queue
+    template <typename ENTRY_T>
+    class Storage
+    {
+    public:
+        /// @param a_capacity every lane is allocated for a_capacity elements
+        ///        (they can all end up in the same lane)
+        explicit Storage(std::size_t a_capacity):
+            m_bitmap(0),
+            m_size(0)
+        {
+            for (std::size_t i = 0; i < LANES; i++)
+            {
+                m_lanes[i].reserve(a_capacity);
+            }
+        }
+
+        inline bool empty() const { return (m_size == 0); }
+        inline std::size_t size() const { return m_size; }
+
+        inline void emplace(Key_t a_lane, ENTRY_T &&a_entry)
+        {
+            if (a_lane >= LANES)
+            {
+                a_lane = LANES - 1;
+            }
+
+            m_lanes[a_lane].emplace(std::move(a_entry));
+            m_bitmap |= (static_cast<uint64_t>(1) << a_lane);
+            m_size++;
+        }
+
+        /// @brief oldest element of the highest priority lane with something
+        ///        in it. The storage can't be empty
+        inline ENTRY_T& front()
+        {
+            return m_lanes[TopLane()].front();
+        }
+
+        inline void pop()
+        {
+            std::size_t lane = TopLane();
+            m_lanes[lane].pop();
+            if (m_lanes[lane].empty())
+            {
+                m_bitmap &= ~(static_cast<uint64_t>(1) << lane);
+            }
+            m_size--;
+        }
+
+    private:
+        /// one FIFO per priority
+        RingBuffer<ENTRY_T> m_lanes[LANES];
+        /// bit i is set if m_lanes[i] is not empty
+        uint64_t m_bitmap;
+        /// number of elements in all the lanes
+        std::size_t m_size;
+
+        inline std::size_t TopLane() const
+        {
+            assert(m_bitmap != 0);
+            return 63 - static_cast<std::size_t>(__builtin_clzll(m_bitmap));
+        }
+    };
+};
+
+/// @brief ordering policy: earliest deadline first. FIFO order for elements
+///        with the same deadline
+/// DEADLINE_OF_T functor that returns the deadline of an element when it is
+///               not given to the push call
+template <typename DEADLINE_OF_T = PrioritySafeQueueDeadlineOf>
+struct PrioritySafeQueueDeadline
+{
+    /// deadline of an element
+    typedef std::chrono::steady_clock::time_point Key_t;
+
+    template <typename T>
+    static inline Key_t KeyOf(const T &a_elem) { return DEADLINE_OF_T()(a_elem); }
+
+    /// @brief the elements of the queue
+    template <typename ENTRY_T>
+    class Storage
+    {
+    public:
+        /// @param a_capacity the heap is allocated for a_capacity elements
+        explicit Storage(std::size_t a_capacity):
+            m_heap(),
+            m_sequence(0)
+        {
+            m_heap.reserve(a_capacity);
+        }
+
+        inline bool empty() const { return m_heap.empty(); }
+        inline std::size_t size() const { return m_heap.size(); }
+
+        inline void emplace(const Key_t &a_deadline, ENTRY_T &&a_entry)
+        {
+            m_heap.push_back(Node(a_deadline, m_sequence++, std::move(a_entry)));
+            std::push_heap(m_heap.begin(), m_heap.end(), Later());
+        }
+
+        /// @brief element with the earliest deadline. The storage can't be
+        ///        empty
+        inline ENTRY_T& front()
+        {
+            assert(!m_heap.empty());
+            return m_heap.front().m_entry;
+        }
+
+        inline void pop()
+        {
+            std::pop_heap(m_heap.begin(), m_heap.end(), Later());
+            m_heap.pop_back();
+        }
+
+    private:
+        struct Node
+        {
+            Node(const Key_t &a_deadline, uint64_t a_sequence, ENTRY_T &&a_entry):
+                m_deadline(a_deadline),
+                m_sequence(a_sequence),
+                m_entry(std::move(a_entry))
+            {}
+
+            Key_t m_deadline;
+            /// insertion order. It breaks the ties between equal deadlines
+            uint64_t m_sequence;
+            ENTRY_T m_entry;
+        };
+
+        /// @brief heap order: the earliest deadline (and the oldest element)
+        ///        on top
+        struct Later
+        {
+            inline bool operator()(const Node &a_left, const Node &a_right) const
+            {
+                return (a_left.m_deadline > a_right.m_deadline) ||
+                       ((a_left.m_deadline == a_right.m_deadline) &&
+                        (a_left.m_sequence > a_right.m_sequence));
+            }
+        };
+
+        /// binary heap of the elements. It only allocates memory if it grows
+        /// past the capacity reserved at construction
+        std::vector<Node> m_heap;
+        /// sequence number of the next element inserted
+        uint64_t m_sequence;
+    };
+};
+
+/// @brief thread-safe queue served by priority (or by deadline)
+/// It uses a mutex+condition variables exactly like SafeQueue does
+/// T type of the elements
+/// ORDER_T ordering policy. PrioritySafeQueueLanes (4 lanes) by default
+/// STATS_T statistics policy (see queue_stats.h). None by default
+template <typename T, 
+          typename ORDER_T = PrioritySafeQueueLanes<>, 
+          typename STATS_T = QueueNoStats>
+class PrioritySafeQueue
+{
+public:
+    /// priority (or deadline) of an element
+    typedef typename ORDER_T::Key_t Key_t;
+
+    /// @brief constructor
+    /// The storage for a_maxSize elements is allocated here if it is not 
+    /// bigger than SAFE_QUEUE_MAX_PREALLOCATED_SIZE
+    /// @param a_maxSize optional parameter with the maximum size of the queue
+    PrioritySafeQueue(std::size_t a_maxSize = SAFE_QUEUE_DEFAULT_MAX_SIZE);
+
+    /// @brief destructor
+    ~PrioritySafeQueue();
+
+    /// @brief Check if the queue is empty
+    /// @return true if the queue is empty. False otherwise
+    bool IsEmpty() const;
+
+    /// @brief closes the queue and wakes up every thread blocked in it
+    /// See SafeQueue::Close
+    void Close();
+
+    /// @brief Check if Close was called on the queue
+    /// @return true if the queue is closed. False otherwise
+    bool IsClosed() const;
+
+    /// @brief inserts an element into the queue. Its priority (or deadline)
+    ///        is given by the ordering policy. If the queue is full the 
+    ///        thread will be blocked until someone else gets an element 
+    ///        from the queue. If the queue is (or gets) closed the element 
+    ///        is discarded
+    /// @return true if the element was inserted. False if it was discarded
+    bool Push(const T &a_elem);
+
+    /// @brief moves an element into the queue. See Push above
+    bool Push(T &&a_elem);
+
+    /// @brief inserts an element into the queue with priority (or deadline)
+    ///        a_key. See Push above
+    bool Push(const T &a_elem, const Key_t &a_key);
+
+    /// @brief moves an element into the queue with priority (or deadline)
+    ///        a_key. See Push above
+    bool Push(T &&a_elem, const Key_t &a_key);
+
+    /// @brief constructs an element in the queue. See Push above
+    /// The element is constructed before waiting for space in the queue
+    /// @param a_args arguments forwarded to the constructor of T
+    template <typename... ARGS>
+    bool Emplace(ARGS&&... a_args);
+
+    /// @brief inserts an element into the queue. Its priority (or deadline)
+    ///        is given by the ordering policy
+    /// @return True if the elem was successfully inserted into the queue.
+    ///         False if it was full or closed
+    bool TryPush(const T &a_elem);
+
+    /// @brief moves an element into the queue. See TryPush above
+    /// a_elem is not modified if the call fails
+    bool TryPush(T &&a_elem);
+
+    /// @brief inserts an element into the queue with priority (or deadline)
+    ///        a_key. See TryPush above
+    bool TryPush(const T &a_elem, const Key_t &a_key);
+
+    /// @brief moves an element into the queue with priority (or deadline)
+    ///        a_key. See TryPush above
+    bool TryPush(T &&a_elem, const Key_t &a_key);
+
+    /// @brief constructs an element in the queue. See TryPush above
+    /// Nothing is constructed if the call fails
+    template <typename... ARGS>
+    bool TryEmplace(ARGS&&... a_args);
+
+    /// @brief extracts the element with the highest priority (earliest 
+    ///        deadline) from the queue. If the queue is empty this call will
+    ///        block the thread until there is something in it
+    /// If the queue is (or gets) closed while it is empty the call returns 
+    /// without modifying out_data
+    void Pop(T &out_data);
+
+    /// @brief extracts the element with the highest priority (earliest 
+    ///        deadline) from the queue
+    /// @return True if the element was retrieved from the queue.
+    ///         False if the queue was empty
+    bool TryPop(T &out_data);
+
+    /// @brief extracts the element with the highest priority (earliest 
+    ///        deadline) from the queue waiting up to a_microsecs if it is 
+    ///        empty
+    /// @return True if the element was retrieved from the queue.
+    ///         False if the timeout was hit (or the queue is closed) and the
+    ///         queue is empty
+    bool TimedWaitPop(T &data, std::chrono::microseconds a_microsecs);
+
+    /// @brief inserts up to a_count elements into the queue. Their 
+    ///        priorities (or deadlines) are given by the ordering policy
+    /// The lock that protects the queue is acquired only once for the whole
+    /// batch
+    /// @return the number of elements inserted into the queue
+    std::size_t TryPushBulk(const T* a_elems, std::size_t a_count);
+
+    /// @brief extracts up to a_maxCount elements from the queue in priority
+    ///        (deadline) order
+    /// @return the number of elements retrieved from the queue
+    std::size_t TryPopBulk(T* out_data, std::size_t a_maxCount);
+
+    /// @brief extracts up to a_maxCount elements from the queue waiting up to
+    ///        a_microsecs if it is empty
+    /// @return the number of elements retrieved from the queue. 0 if the 
+    ///         timeout was hit (or the queue is closed) and the queue is empty
+    std::size_t TimedWaitPopBulk(
+        T*                        out_data, 
+        std::size_t               a_maxCount, 
+        std::chrono::microseconds a_microsecs);
+
+    /// @brief extracts up to a_maxCount elements from the queue waiting with
+    ///        no timeout if it is empty
+    /// @return the number of elements retrieved from the queue. 0 only if the
+    ///         queue is closed and empty
+    std::size_t WaitPopBulk(T* out_data, std::size_t a_maxCount);
+
+    /// @brief statistics of the queue (see queue_stats.h)
+    /// Everything is 0 if STATS_T is QueueNoStats
+    void GetStats(QueueStatsSnapshot &out_stats) const;
+
+private:
+    typedef PrioritySafeQueueEntry<T, STATS_T::ENABLED> Entry_t;
+
+    /// the elements of the queue, ordered by the policy
+    typename ORDER_T::template Storage<Entry_t> m_theQueue;
+    /// maximum number of elements for the queue
+    std::size_t m_maximumSize;
+    /// set by Close. Nothing can be pushed anymore into the queue
+    bool m_closed;
+    /// Mutex to protect the queue
+    mutable std::mutex m_mutex;
+    /// Consumers wait on it for the queue to have something in it
+    std::condition_variable m_notEmpty;
+    /// Producers wait on it for the queue to have some space left
+    std::condition_variable m_notFull;
+    /// number of threads waiting on m_notEmpty. Protected by m_mutex
+    std::size_t m_waitingConsumers;
+    /// number of threads waiting on m_notFull. Protected by m_mutex
+    std::size_t m_waitingProducers;
+    /// statistics of the queue
+    STATS_T m_stats;
+
+    /// @brief blocking insertion of an element already built with priority
+    ///        (or deadline) a_key
+    /// @return false if the queue is (or gets) closed. The entry is discarded
+    inline bool EmplaceEntry(const Key_t &a_key, Entry_t &&a_entry);
+
+    /// @brief non-blocking insertion with priority (or deadline) a_key. The
+    ///        element is only built if there is space for it
+    template <typename... ARGS>
+    inline bool TryEmplaceWithKey(const Key_t &a_key, ARGS&&... a_args);
+
+    /// @brief check if there is space for one more element and the queue is
+    ///        not closed. A full queue is recorded in the statistics
+    /// WARNING: It assumes the caller holds m_mutex
+    inline bool HasSpaceLocked();
+
+    /// @brief inserts a_entry and wakes up a consumer if there is any waiting
+    /// WARNING: It assumes the caller holds m_mutex and that there is space
+    inline void InsertLocked(const Key_t &a_key, Entry_t &&a_entry);
+
+    /// @brief extracts up to a_maxCount elements from the queue and wakes up
+    ///        the next consumer and/or a producer if needed
+    /// WARNING: It assumes the caller holds m_mutex
+    /// @return the number of elements extracted
+    inline std::size_t PopBulkLocked(T* out_data, std::size_t a_maxCount);
+
+    /// @brief wait on m_notEmpty (m_notFull) until there is something in the
+    ///        queue (some space left) or the queue gets closed
+    /// WARNING: the lock must be held on m_mutex
+    inline void WaitNotEmptyLocked(
+        std::unique_lock<std::mutex>                &a_lock,
+        const std::chrono::steady_clock::time_point *a_wakeUpTime = 0);
+    inline void WaitNotFullLocked(std::unique_lock<std::mutex> &a_lock);
+
+    /// @brief the queue can't be copied (or moved)
+    PrioritySafeQueue(const PrioritySafeQueue &a_src);
+    PrioritySafeQueue& operator=(const PrioritySafeQueue &a_src);
+};
+
+// include the implementation file
+#include "priority_safe_queue_impl.h"
+
+#endif /* _PRIORITYSAFEQUEUE_H_ */
@@ -0,0 +1,397 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file priority_safe_queue_impl.h
+/// @brief Implementation of the thread-safe queue served by priority (or by
+///        deadline)
+///
+// ============================================================================
+
+#ifndef _PRIORITYSAFEQUEUEIMPL_H_
+#define _PRIORITYSAFEQUEUEIMPL_H_
+
+template <typename T, typename ORDER_T, typename STATS_T>
+PrioritySafeQueue<T, ORDER_T, STATS_T>::PrioritySafeQueue(std::size_t a_maxSize):
+    m_theQueue((a_maxSize <= SAFE_QUEUE_MAX_PREALLOCATED_SIZE) ? a_maxSize : 0),
+    m_maximumSize(a_maxSize),
+    m_closed(false),
+    m_mutex(),
+    m_notEmpty(),
+    m_notFull(),
+    m_waitingConsumers(0),
+    m_waitingProducers(0),
+    m_stats()
+{
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+PrioritySafeQueue<T, ORDER_T, STATS_T>::~PrioritySafeQueue()
+{
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::IsEmpty() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_theQueue.empty();
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+void PrioritySafeQueue<T, ORDER_T, STATS_T>::Close()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    if (!m_closed)
+    {
+        m_closed = true;
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::IsClosed() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_closed;
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::Push(const T &a_elem)
+{
+    Entry_t entry(0, a_elem);
+    return EmplaceEntry(ORDER_T::KeyOf(entry.m_elem), std::move(entry));
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::Push(T &&a_elem)
+{
+    Entry_t entry(0, std::move(a_elem));
+    return EmplaceEntry(ORDER_T::KeyOf(entry.m_elem), std::move(entry));
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::Push(const T &a_elem, const Key_t &a_key)
+{
+    return EmplaceEntry(a_key, Entry_t(0, a_elem));
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::Push(T &&a_elem, const Key_t &a_key)
+{
+    return EmplaceEntry(a_key, Entry_t(0, std::move(a_elem)));
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+template <typename... ARGS>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::Emplace(ARGS&&... a_args)
+{
+    // the element is built before the lock is acquired. The policy needs it
+    // to work out its priority
+    Entry_t entry(0, std::forward<ARGS>(a_args)...);
+    return EmplaceEntry(ORDER_T::KeyOf(entry.m_elem), std::move(entry));
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::TryPush(const T &a_elem)
+{
+    return TryEmplaceWithKey(ORDER_T::KeyOf(a_elem), a_elem);
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::TryPush(T &&a_elem)
+{
+    // the key is worked out before the element is moved
+    return TryEmplaceWithKey(ORDER_T::KeyOf(a_elem), std::move(a_elem));
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::TryPush(const T &a_elem, const Key_t &a_key)
+{
+    return TryEmplaceWithKey(a_key, a_elem);
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::TryPush(T &&a_elem, const Key_t &a_key)
+{
+    return TryEmplaceWithKey(a_key, std::move(a_elem));
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+template <typename... ARGS>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::TryEmplace(ARGS&&... a_args)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    if (!HasSpaceLocked())
+    {
+        return false;
+    }
+
+    // nothing is built unless there is space for it. The policy needs the
+    // element to work out its priority
+    Entry_t entry(m_stats.Stamp(), std::forward<ARGS>(a_args)...);
+    InsertLocked(ORDER_T::KeyOf(entry.m_elem), std::move(entry));
+
+    return true;
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+void PrioritySafeQueue<T, ORDER_T, STATS_T>::Pop(T &out_data)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+
+    WaitNotEmptyLocked(lk);
+
+    // nothing to pop if the queue was closed
+    PopBulkLocked(&out_data, 1);
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::TryPop(T &out_data)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    return (PopBulkLocked(&out_data, 1) == 1);
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::TimedWaitPop(T &data, std::chrono::microseconds a_microsecs)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+
+    auto wakeUpTime = std::chrono::steady_clock::now() + a_microsecs;
+    WaitNotEmptyLocked(lk, &wakeUpTime);
+
+    // False if it timed-out (or closed) and the queue is still empty
+    return (PopBulkLocked(&data, 1) == 1);
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+std::size_t PrioritySafeQueue<T, ORDER_T, STATS_T>::TryPushBulk(const T* a_elems, std::size_t a_count)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    std::size_t count = 0;
+    while ((count < a_count) && (m_theQueue.size() < m_maximumSize) && 
+           (!m_closed))
+    {
+        InsertLocked(
+            ORDER_T::KeyOf(a_elems[count]), 
+            Entry_t(m_stats.Stamp(), a_elems[count]));
+        count++;
+    }
+
+    if ((count < a_count) && (!m_closed))
+    {
+        m_stats.OnPushFull();
+    }
+
+    return count;
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+std::size_t PrioritySafeQueue<T, ORDER_T, STATS_T>::TryPopBulk(T* out_data, std::size_t a_maxCount)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    return PopBulkLocked(out_data, a_maxCount);
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+std::size_t PrioritySafeQueue<T, ORDER_T, STATS_T>::TimedWaitPopBulk(
+    T*                        out_data, 
+    std::size_t               a_maxCount, 
+    std::chrono::microseconds a_microsecs)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+
+    auto wakeUpTime = std::chrono::steady_clock::now() + a_microsecs;
+    WaitNotEmptyLocked(lk, &wakeUpTime);
+
+    return PopBulkLocked(out_data, a_maxCount);
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+std::size_t PrioritySafeQueue<T, ORDER_T, STATS_T>::WaitPopBulk(T* out_data, std::size_t a_maxCount)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+
+    WaitNotEmptyLocked(lk);
+
+    // 0 only if the queue was closed and there is nothing left in it
+    return PopBulkLocked(out_data, a_maxCount);
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+void PrioritySafeQueue<T, ORDER_T, STATS_T>::GetStats(QueueStatsSnapshot &out_stats) const
+{
+    m_stats.GetSnapshot(out_stats);
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::EmplaceEntry(
+    const Key_t &a_key, Entry_t &&a_entry)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+
+    if (m_theQueue.size() >= m_maximumSize)
+    {
+        m_stats.OnPushFull();
+    }
+
+    WaitNotFullLocked(lk);
+
+    if (m_closed)
+    {
+        // the element is discarded
+        return false;
+    }
+
+    a_entry.SetStamp(m_stats.Stamp());
+    InsertLocked(a_key, std::move(a_entry));
+
+    if ((m_theQueue.size() < m_maximumSize) && (m_waitingProducers > 0))
+    {
+        // there is space left for the next producer
+        m_notFull.notify_one();
+    }
+
+    return true;
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+template <typename... ARGS>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::TryEmplaceWithKey(
+    const Key_t &a_key, ARGS&&... a_args)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    if (!HasSpaceLocked())
+    {
+        return false;
+    }
+
+    // the element can't be built until there is space for it for sure (an
+    // rvalue argument must not be modified if the push fails)
+    InsertLocked(a_key, Entry_t(m_stats.Stamp(), std::forward<ARGS>(a_args)...));
+
+    return true;
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+bool PrioritySafeQueue<T, ORDER_T, STATS_T>::HasSpaceLocked()
+{
+    if (m_closed)
+    {
+        return false;
+    }
+    else if (m_theQueue.size() >= m_maximumSize)
+    {
+        m_stats.OnPushFull();
+        return false;
+    }
+
+    return true;
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+void PrioritySafeQueue<T, ORDER_T, STATS_T>::InsertLocked(
+    const Key_t &a_key, Entry_t &&a_entry)
+{
+    m_theQueue.emplace(a_key, std::move(a_entry));
+    m_stats.OnPush(m_theQueue.size());
+
+    if (m_waitingConsumers > 0)
+    {
+        // only one of them can take the new element
+        m_notEmpty.notify_one();
+    }
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+std::size_t PrioritySafeQueue<T, ORDER_T, STATS_T>::PopBulkLocked(
+    T*          out_data, 
+    std::size_t a_maxCount)
+{
+    std::size_t count = 0;
+    while ((count < a_maxCount) && (!m_theQueue.empty()))
+    {
+        Entry_t &entry = m_theQueue.front();
+        out_data[count] = std::move(entry.m_elem);
+        m_stats.OnPop(entry.GetStamp());
+        m_theQueue.pop();
+        count++;
+    }
+
+    if (count > 0)
+    {
+        if (m_waitingProducers > 0)
+        {
+            // there is space now for (at least) one producer. It wakes up 
+            // the next one if there is still space after it is done
+            m_notFull.notify_one();
+        }
+        if ((!m_theQueue.empty()) && (m_waitingConsumers > 0))
+        {
+            // something was left behind for the next consumer
+            m_notEmpty.notify_one();
+        }
+    }
+
+    return count;
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+void PrioritySafeQueue<T, ORDER_T, STATS_T>::WaitNotEmptyLocked(
+    std::unique_lock<std::mutex>                &a_lock,
+    const std::chrono::steady_clock::time_point *a_wakeUpTime)
+{
+    m_waitingConsumers++;
+    while (m_theQueue.empty() && (!m_closed))
+    {
+        if (a_wakeUpTime == 0)
+        {
+            m_notEmpty.wait(a_lock);
+        }
+        else if (m_notEmpty.wait_until(a_lock, *a_wakeUpTime) == 
+                     std::cv_status::timeout)
+        {
+            // spurious wake ups are handled by the loop. The caller checks
+            // whether there is something in the queue after a time out
+            break;
+        }
+    }
+    m_waitingConsumers--;
+}
+
+template <typename T, typename ORDER_T, typename STATS_T>
+void PrioritySafeQueue<T, ORDER_T, STATS_T>::WaitNotFullLocked(std::unique_lock<std::mutex> &a_lock)
+{
+    m_waitingProducers++;
+    while ((m_theQueue.size() >= m_maximumSize) && (!m_closed))
+    {
+        m_notFull.wait(a_lock);
+    }
+    m_waitingProducers--;
+}
+
+#endif /* _PRIORITYSAFEQUEUEIMPL_H_ */
@@ -0,0 +1,248 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file queue_stats.h
+/// @brief Compile time selectable statistics for the queues
+/// SafeQueue and ArrayLockFreeQueueAdapter take the statistics policy as a 
+/// template parameter. QueueNoStats (the default) does nothing and is 
+/// optimised away completely. QueueStats keeps:
+///   - push, pop and "queue was full" counters
+///   - compare and swap retries of the lock-free queues (only if the queues
+///     are built with _WITH_LOCK_FREE_Q_CAS_STATS, see lock_free_queue.h)
+///   - the highest depth the queue ever reached
+///   - a histogram of the time elements spend in the queue
+/// The counters and the histogram are kept per thread, each thread in its 
+/// own cache lines, so threads updating them don't contend with each other
+///
+/// Example:
+///   SafeQueue<int, QueueStats> queue;
+///   ...
+///   QueueStatsSnapshot stats;
+///   queue.GetStats(stats);
+///   std::cout << stats.m_timeInQueue.Percentile(99.0) << "ns" << std::endl;
+///
+// ============================================================================
+
+#ifndef _QUEUESTATS_H_
+#define _QUEUESTATS_H_
+
+#include <stdint.h> // uint64_t
+#include <stddef.h> // size_t
+#include <atomic>
+#include <chrono>
+#include "ring_buffer.h"
+
+// number of per thread slots of QueueStats. Threads are given a slot the 
+// first time they touch any QueueStats object. If there are more threads 
+// than slots some of them share a slot (it is still correct, but they 
+// contend with each other)
+#ifndef QUEUE_STATS_MAX_THREADS
+#define QUEUE_STATS_MAX_THREADS 16
+#endif
+
+// size in bytes of a cache line. See LOCK_FREE_Q_CACHE_LINE_SIZE
+#ifndef QUEUE_STATS_CACHE_LINE_SIZE
+#define QUEUE_STATS_CACHE_LINE_SIZE 64
+#endif
+
+// the histogram keeps 2^QUEUE_STATS_HISTOGRAM_SUB_BITS linear buckets per 
+// power of 2, so the value reported for a bucket is within 
+// 100 / 2^QUEUE_STATS_HISTOGRAM_SUB_BITS percent of the real one (12.5%)
+#ifndef QUEUE_STATS_HISTOGRAM_SUB_BITS
+#define QUEUE_STATS_HISTOGRAM_SUB_BITS 3
+#endif
+
+// values of 2^QUEUE_STATS_HISTOGRAM_MAX_BITS or more go into the last bucket
+// of the histogram. 2^40ns is about 18 minutes
+#ifndef QUEUE_STATS_HISTOGRAM_MAX_BITS
+#define QUEUE_STATS_HISTOGRAM_MAX_BITS 40
+#endif
+
+/// @brief HDR style histogram (log-linear buckets)
+/// Values under 2^(SUB_BITS + 1) have a bucket each. Every power of 2 above 
+/// that is split in 2^SUB_BITS buckets of the same width
+class QueueStatsHistogram
+{
+public:
+    enum
+    {
+        SUB_BUCKETS = (1 << QUEUE_STATS_HISTOGRAM_SUB_BITS),
+        BUCKETS     = (QUEUE_STATS_HISTOGRAM_MAX_BITS - QUEUE_STATS_HISTOGRAM_SUB_BITS + 1) * SUB_BUCKETS
+    };
+
+    /// @brief constructor. Empty histogram
+    QueueStatsHistogram();
+
+    /// @brief bucket a_value goes into
+    static inline uint32_t BucketIndex(uint64_t a_value);
+
+    /// @brief smallest value that goes into the bucket a_index
+    static inline uint64_t BucketLowerBound(uint32_t a_index);
+
+    /// @brief add a_count values to the bucket a_index
+    inline void Add(uint32_t a_index, uint64_t a_count);
+
+    /// @brief number of values in the histogram
+    uint64_t Count() const;
+
+    /// @brief value under which a_percentile percent of the values are
+    /// @param a_percentile from 0 to 100 (50.0 for the median, 99.9...)
+    /// @return the middle of the bucket the percentile falls in. 0 if the
+    ///         histogram is empty
+    uint64_t Percentile(double a_percentile) const;
+
+    /// @brief number of values in each bucket
+    uint64_t m_counts[BUCKETS];
+};
+
+/// @brief values of every statistic of a QueueStats object at some point
+struct QueueStatsSnapshot
+{
+    QueueStatsSnapshot():
+        m_pushes(0),
+        m_pops(0),
+        m_pushesFull(0),
+        m_casRetries(0),
+        m_highWaterMark(0),
+        m_timeInQueue()
+    {}
+
+    /// elements inserted into the queue
+    uint64_t m_pushes;
+    /// elements extracted from the queue
+    uint64_t m_pops;
+    /// times a push found the queue full (it failed, or it had to wait)
+    uint64_t m_pushesFull;
+    /// failed compare and swap operations in the lock-free queues
+    uint64_t m_casRetries;
+    /// highest depth the queue reached
+    uint64_t m_highWaterMark;
+    /// time elements spent in the queue (ns)
+    QueueStatsHistogram m_timeInQueue;
+};
+
+/// @brief statistics policy that keeps nothing. It costs nothing
+class QueueNoStats
+{
+public:
+    static const bool ENABLED = false;
+
+    /// @brief FIFO of the times the elements were inserted into a queue. 
+    ///        There is nothing to keep
+    struct StampFifo
+    {
+        inline void push(uint64_t) {}
+        inline uint64_t pop() { return 0; }
+        inline void reserve(std::size_t) {}
+    };
+
+    inline uint64_t Stamp() const { return 0; }
+    inline void OnPush(size_t /*a_depth*/) {}
+    inline void OnPushFull() {}
+    inline void OnPop(uint64_t /*a_stamp*/) {}
+    inline void OnCasRetries(uint64_t /*a_retries*/) {}
+    inline void GetSnapshot(QueueStatsSnapshot &out_snapshot) const
+    {
+        out_snapshot = QueueStatsSnapshot();
+    }
+};
+
+/// @brief statistics policy that keeps everything (see the top of the file)
+class QueueStats
+{
+public:
+    static const bool ENABLED = true;
+
+    /// @brief FIFO of the times the elements were inserted into a queue. 
+    ///        Used by the queues that can't keep the time in the element 
+    ///        itself. Not thread-safe
+    class StampFifo
+    {
+    public:
+        inline void push(uint64_t a_stamp) { m_stamps.push(a_stamp); }
+        inline uint64_t pop() 
+        { 
+            uint64_t stamp = m_stamps.front(); 
+            m_stamps.pop(); 
+            return stamp; 
+        }
+        inline void reserve(std::size_t a_capacity) 
+        { 
+            m_stamps.reserve(a_capacity); 
+        }
+    private:
+        RingBuffer<uint64_t> m_stamps;
+    };
+
+    QueueStats();
+
+    /// @brief current time (ns) to be passed later on into OnPop
+    inline uint64_t Stamp() const;
+
+    /// @brief an element was inserted into the queue
+    /// @param a_depth number of elements in the queue after inserting it
+    inline void OnPush(size_t a_depth);
+
+    /// @brief a push found the queue full
+    inline void OnPushFull();
+
+    /// @brief an element was extracted from the queue
+    /// @param a_stamp what Stamp returned when the element was inserted
+    inline void OnPop(uint64_t a_stamp);
+
+    /// @brief compare and swap operations that had to be retried
+    inline void OnCasRetries(uint64_t a_retries);
+
+    /// @brief add up the statistics of every thread
+    void GetSnapshot(QueueStatsSnapshot &out_snapshot) const;
+
+private:
+    /// @brief statistics of one thread. It takes whole cache lines
+    struct ThreadSlot
+    {
+        std::atomic<uint64_t> m_pushes;
+        std::atomic<uint64_t> m_pops;
+        std::atomic<uint64_t> m_pushesFull;
+        std::atomic<uint64_t> m_casRetries;
+        std::atomic<uint64_t> m_timeInQueue[QueueStatsHistogram::BUCKETS];
+
+        /// the slots are not aligned to the cache line. The padding keeps 
+        /// the counters of the next slot out of the last line of this one
+        char m_padding[QUEUE_STATS_CACHE_LINE_SIZE];
+    };
+
+    ThreadSlot m_slots[QUEUE_STATS_MAX_THREADS];
+
+    /// highest depth the queue reached. Shared by all the threads, but it is
+    /// only written when a new maximum is reached
+    std::atomic<uint64_t> m_highWaterMark;
+
+    /// @brief slot of the calling thread
+    inline ThreadSlot& GetSlot();
+
+    /// @brief statistics can't be copied (they belong to a queue)
+    QueueStats(const QueueStats &a_src);
+    QueueStats& operator=(const QueueStats &a_src);
+};
+
+#include "queue_stats_impl.h"
+
+#endif /* _QUEUESTATS_H_ */
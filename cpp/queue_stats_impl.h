@@ -0,0 +1,220 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file queue_stats_impl.h
+/// @brief Implementation of the statistics of the queues
+///
+// ============================================================================
+
+#ifndef _QUEUESTATSIMPL_H_
+#define _QUEUESTATSIMPL_H_
+
+#include <string.h> // memset
+
+/// @brief index of the QueueStats slot of the calling thread
+inline uint32_t QueueStatsThreadIndex()
+{
+    static std::atomic<uint32_t> s_nextIndex(0);
+    static thread_local uint32_t s_index = 
+        s_nextIndex.fetch_add(1, std::memory_order_relaxed) % QUEUE_STATS_MAX_THREADS;
+
+    return s_index;
+}
+
+inline QueueStatsHistogram::QueueStatsHistogram()
+{
+    memset(m_counts, 0, sizeof(m_counts));
+}
+
+inline uint32_t QueueStatsHistogram::BucketIndex(uint64_t a_value)
+{
+    if (a_value < (2 * SUB_BUCKETS))
+    {
+        return static_cast<uint32_t>(a_value);
+    }
+
+    if (a_value >= (static_cast<uint64_t>(1) << QUEUE_STATS_HISTOGRAM_MAX_BITS))
+    {
+        return (BUCKETS - 1);
+    }
+
+    // the position of the most significant bit chooses the power of 2, and
+    // the next QUEUE_STATS_HISTOGRAM_SUB_BITS bits the bucket inside it
+    uint32_t msb   = 63 - static_cast<uint32_t>(__builtin_clzll(a_value));
+    uint32_t shift = msb - QUEUE_STATS_HISTOGRAM_SUB_BITS;
+    uint32_t sub   = static_cast<uint32_t>(a_value >> shift) - SUB_BUCKETS;
+
+    return ((shift + 1) * SUB_BUCKETS) + sub;
+}
+
+inline uint64_t QueueStatsHistogram::BucketLowerBound(uint32_t a_index)
+{
+    if (a_index < (2 * SUB_BUCKETS))
+    {
+        return a_index;
+    }
+
+    uint32_t shift = (a_index / SUB_BUCKETS) - 1;
+    uint64_t sub   = (a_index % SUB_BUCKETS) + SUB_BUCKETS;
+
+    return (sub << shift);
+}
+
+inline void QueueStatsHistogram::Add(uint32_t a_index, uint64_t a_count)
+{
+    m_counts[a_index] += a_count;
+}
+
+inline uint64_t QueueStatsHistogram::Count() const
+{
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < BUCKETS; i++)
+    {
+        count += m_counts[i];
+    }
+
+    return count;
+}
+
+inline uint64_t QueueStatsHistogram::Percentile(double a_percentile) const
+{
+    uint64_t count = Count();
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // number of values that must be at or below the percentile (at least 1)
+    uint64_t target = static_cast<uint64_t>((a_percentile * count) / 100.0);
+    if (target == 0)
+    {
+        target = 1;
+    }
+
+    uint64_t accumulated = 0;
+    for (uint32_t i = 0; i < BUCKETS; i++)
+    {
+        accumulated += m_counts[i];
+        if (accumulated >= target)
+        {
+            if ((i < (2 * SUB_BUCKETS)) || (i == (BUCKETS - 1)))
+            {
+                return BucketLowerBound(i);
+            }
+
+            return (BucketLowerBound(i) + BucketLowerBound(i + 1)) / 2;
+        }
+    }
+
+    return BucketLowerBound(BUCKETS - 1);
+}
+
+inline QueueStats::QueueStats():
+    m_highWaterMark(0)
+{
+    for (uint32_t i = 0; i < QUEUE_STATS_MAX_THREADS; i++)
+    {
+        ThreadSlot &slot = m_slots[i];
+        slot.m_pushes.store(0, std::memory_order_relaxed);
+        slot.m_pops.store(0, std::memory_order_relaxed);
+        slot.m_pushesFull.store(0, std::memory_order_relaxed);
+        slot.m_casRetries.store(0, std::memory_order_relaxed);
+        for (uint32_t j = 0; j < QueueStatsHistogram::BUCKETS; j++)
+        {
+            slot.m_timeInQueue[j].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+inline QueueStats::ThreadSlot& QueueStats::GetSlot()
+{
+    return m_slots[QueueStatsThreadIndex()];
+}
+
+inline uint64_t QueueStats::Stamp() const
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void QueueStats::OnPush(size_t a_depth)
+{
+    // relaxed RMWs on a cache line that (unless there are more threads than
+    // slots) no other thread writes
+    GetSlot().m_pushes.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+    while ((a_depth > highWaterMark) && 
+           (!m_highWaterMark.compare_exchange_weak(
+                highWaterMark, a_depth, std::memory_order_relaxed)))
+    {
+        // highWaterMark was reloaded by compare_exchange_weak. Try again 
+        // only if a_depth is still the highest
+    }
+}
+
+inline void QueueStats::OnPushFull()
+{
+    GetSlot().m_pushesFull.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void QueueStats::OnPop(uint64_t a_stamp)
+{
+    ThreadSlot &slot = GetSlot();
+    slot.m_pops.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t now = Stamp();
+    uint64_t timeInQueue = (now > a_stamp) ? (now - a_stamp) : 0;
+    slot.m_timeInQueue[QueueStatsHistogram::BucketIndex(timeInQueue)].fetch_add(
+        1, std::memory_order_relaxed);
+}
+
+inline void QueueStats::OnCasRetries(uint64_t a_retries)
+{
+    if (a_retries > 0)
+    {
+        GetSlot().m_casRetries.fetch_add(a_retries, std::memory_order_relaxed);
+    }
+}
+
+inline void QueueStats::GetSnapshot(QueueStatsSnapshot &out_snapshot) const
+{
+    out_snapshot = QueueStatsSnapshot();
+
+    for (uint32_t i = 0; i < QUEUE_STATS_MAX_THREADS; i++)
+    {
+        const ThreadSlot &slot = m_slots[i];
+        out_snapshot.m_pushes     += slot.m_pushes.load(std::memory_order_relaxed);
+        out_snapshot.m_pops       += slot.m_pops.load(std::memory_order_relaxed);
+        out_snapshot.m_pushesFull += slot.m_pushesFull.load(std::memory_order_relaxed);
+        out_snapshot.m_casRetries += slot.m_casRetries.load(std::memory_order_relaxed);
+        for (uint32_t j = 0; j < QueueStatsHistogram::BUCKETS; j++)
+        {
+            out_snapshot.m_timeInQueue.Add(
+                j, slot.m_timeInQueue[j].load(std::memory_order_relaxed));
+        }
+    }
+
+    out_snapshot.m_highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+}
+
+#endif /* _QUEUESTATSIMPL_H_ */
@@ -0,0 +1,161 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file ring_buffer.h
+/// @brief FIFO stored in a contiguous circular array
+/// It is the storage of SafeQueue. It has the subset of the std::queue 
+/// interface SafeQueue needs (plus reserve and capacity), so inserting and 
+/// extracting elements are just an indexed construction/destruction in the 
+/// array. Memory is only allocated when an element doesn't fit: the capacity
+/// doubles and it never shrinks on its own (clear and pop keep the memory, 
+/// so popping never allocates). shrink_to_fit gives back what isn't needed
+/// when the owner of the buffer chooses to
+///
+/// Growing gives the strong exception guarantee when T can be moved without
+/// throwing or copied (std::move_if_noexcept), as std::vector does
+///
+/// Not thread-safe
+///
+// ============================================================================
+
+#ifndef _RINGBUFFER_H_
+#define _RINGBUFFER_H_
+
+#include <stddef.h> // size_t
+#include <memory>   // std::allocator
+
+// capacity of a ring buffer the first time it has to grow. It doubles each
+// time after that
+#ifndef RING_BUFFER_MIN_CAPACITY
+#define RING_BUFFER_MIN_CAPACITY 16
+#endif
+
+/// @brief FIFO in a circular array that grows when it's full
+/// T type of the elements
+template <typename T>
+class RingBuffer
+{
+public:
+    /// @brief constructor
+    /// @param a_capacity number of elements the array is allocated for. 0
+    ///        means nothing is allocated until the first element is inserted
+    RingBuffer(std::size_t a_capacity = 0);
+
+    /// @brief destructor. The elements still in the buffer are destroyed
+    ~RingBuffer();
+
+    /// @brief copy constructor. The copy has the same capacity as a_src
+    RingBuffer(const RingBuffer &a_src);
+
+    /// @brief copy assignment. The memory of this buffer is reused if the
+    ///        elements of a_src fit in it
+    RingBuffer& operator=(const RingBuffer &a_src);
+
+    /// @brief move constructor. a_src is left empty with no memory
+    RingBuffer(RingBuffer &&a_src);
+
+    /// @brief move assignment. a_src is left empty with no memory
+    RingBuffer& operator=(RingBuffer &&a_src);
+
+    /// @return true if there are no elements in the buffer
+    inline bool empty() const { return (m_size == 0); }
+
+    /// @return number of elements in the buffer
+    inline std::size_t size() const { return m_size; }
+
+    /// @return number of elements that fit in the buffer before it has to
+    ///         grow
+    inline std::size_t capacity() const { return m_capacity; }
+
+    /// @return a reference to the oldest element. The buffer can't be empty
+    inline T& front();
+    inline const T& front() const;
+
+    /// @brief constructs an element at the back of the buffer. The buffer
+    ///        grows if it is full
+    /// @param a_args arguments forwarded to the constructor of T
+    template <typename... ARGS>
+    inline void emplace(ARGS&&... a_args);
+
+    /// @brief copies/moves an element at the back of the buffer
+    inline void push(const T &a_elem) { emplace(a_elem); }
+    inline void push(T &&a_elem) { emplace(std::move(a_elem)); }
+
+    /// @brief destroys the oldest element. The buffer can't be empty
+    inline void pop();
+
+    /// @brief destroys every element. The memory is kept
+    void clear();
+
+    /// @brief makes sure a_capacity elements fit in the buffer without 
+    ///        allocating any more memory. shrink_to_fit doesn't go below it
+    void reserve(std::size_t a_capacity);
+
+    /// @brief reduces the capacity to the number of elements in the buffer,
+    ///        but not below the biggest capacity passed to the constructor 
+    ///        or reserve. The elements are moved into a new array
+    void shrink_to_fit();
+
+private:
+    /// memory of the array. Only the slots from m_head to m_head + m_size
+    /// (modulo m_capacity) hold an element
+    T* m_elems;
+    /// number of slots in m_elems
+    std::size_t m_capacity;
+    /// slot of the oldest element
+    std::size_t m_head;
+    /// number of elements in the buffer
+    std::size_t m_size;
+    /// capacity shrink_to_fit doesn't go below (see reserve)
+    std::size_t m_minCapacity;
+
+    /// @brief slot of the a_offset-th element counting from the oldest one
+    inline std::size_t Slot(std::size_t a_offset) const;
+
+    /// @brief constructs an element when the buffer is full
+    template <typename... ARGS>
+    void GrowAndEmplace(ARGS&&... a_args);
+
+    /// @brief reallocates if a_capacity elements don't fit in the buffer
+    void Grow(std::size_t a_capacity);
+
+    /// @brief moves the elements into a new array of a_capacity slots. The
+    ///        oldest element ends up in the first one
+    void Reallocate(std::size_t a_capacity);
+
+    /// @brief moves (or copies, see std::move_if_noexcept) the elements 
+    ///        into the first slots of a_elems. If it throws a_elems is left 
+    ///        with no elements and this buffer as it was
+    void MoveInto(T* a_elems);
+
+    /// @brief destroys the elements and the array and takes a_elems, of 
+    ///        a_capacity slots, with the elements already moved into it
+    void Adopt(T* a_elems, std::size_t a_capacity);
+
+    /// @brief copies the elements of a_src at the back of this buffer. There
+    ///        must be enough space for them
+    void CopyFrom(const RingBuffer &a_src);
+};
+
+// include the implementation file
+#include "ring_buffer_impl.h"
+
+#endif /* _RINGBUFFER_H_ */
@@ -0,0 +1,330 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file ring_buffer_impl.h
+/// @brief Implementation of the FIFO stored in a contiguous circular array
+///
+// ============================================================================
+
+#ifndef _RINGBUFFERIMPL_H_
+#define _RINGBUFFERIMPL_H_
+
+#include <assert.h>
+#include <new>     // placement new
+#include <utility> // std::move, std::forward, std::move_if_noexcept
+
+template <typename T>
+RingBuffer<T>::RingBuffer(std::size_t a_capacity):
+    m_elems(0),
+    m_capacity(0),
+    m_head(0),
+    m_size(0),
+    m_minCapacity(0)
+{
+    reserve(a_capacity);
+}
+
+template <typename T>
+RingBuffer<T>::~RingBuffer()
+{
+    clear();
+    if (m_elems != 0)
+    {
+        std::allocator<T>().deallocate(m_elems, m_capacity);
+    }
+}
+
+template <typename T>
+RingBuffer<T>::RingBuffer(const RingBuffer<T> &a_src):
+    m_elems(0),
+    m_capacity(0),
+    m_head(0),
+    m_size(0),
+    m_minCapacity(a_src.m_minCapacity)
+{
+    Grow(a_src.m_capacity);
+    CopyFrom(a_src);
+}
+
+template <typename T>
+RingBuffer<T>& RingBuffer<T>::operator=(const RingBuffer<T> &a_src)
+{
+    if (this != &a_src)
+    {
+        clear();
+        Grow(a_src.m_capacity);
+        if (a_src.m_minCapacity > m_minCapacity)
+        {
+            m_minCapacity = a_src.m_minCapacity;
+        }
+        CopyFrom(a_src);
+    }
+
+    return *this;
+}
+
+template <typename T>
+RingBuffer<T>::RingBuffer(RingBuffer<T> &&a_src):
+    m_elems(a_src.m_elems),
+    m_capacity(a_src.m_capacity),
+    m_head(a_src.m_head),
+    m_size(a_src.m_size),
+    m_minCapacity(a_src.m_minCapacity)
+{
+    a_src.m_elems = 0;
+    a_src.m_capacity = 0;
+    a_src.m_head = 0;
+    a_src.m_size = 0;
+    a_src.m_minCapacity = 0;
+}
+
+template <typename T>
+RingBuffer<T>& RingBuffer<T>::operator=(RingBuffer<T> &&a_src)
+{
+    if (this != &a_src)
+    {
+        clear();
+        if (m_elems != 0)
+        {
+            std::allocator<T>().deallocate(m_elems, m_capacity);
+        }
+
+        m_elems = a_src.m_elems;
+        m_capacity = a_src.m_capacity;
+        m_head = a_src.m_head;
+        m_size = a_src.m_size;
+        m_minCapacity = a_src.m_minCapacity;
+
+        a_src.m_elems = 0;
+        a_src.m_capacity = 0;
+        a_src.m_head = 0;
+        a_src.m_size = 0;
+        a_src.m_minCapacity = 0;
+    }
+
+    return *this;
+}
+
+template <typename T>
+T& RingBuffer<T>::front()
+{
+    assert(m_size > 0);
+    return m_elems[m_head];
+}
+
+template <typename T>
+const T& RingBuffer<T>::front() const
+{
+    assert(m_size > 0);
+    return m_elems[m_head];
+}
+
+template <typename T>
+template <typename... ARGS>
+void RingBuffer<T>::emplace(ARGS&&... a_args)
+{
+    if (m_size == m_capacity)
+    {
+        GrowAndEmplace(std::forward<ARGS>(a_args)...);
+        return;
+    }
+
+    new (&m_elems[Slot(m_size)]) T(std::forward<ARGS>(a_args)...);
+    m_size++;
+}
+
+template <typename T>
+void RingBuffer<T>::pop()
+{
+    assert(m_size > 0);
+
+    m_elems[m_head].~T();
+    m_head = Slot(1);
+    m_size--;
+}
+
+template <typename T>
+void RingBuffer<T>::clear()
+{
+    for (std::size_t i = 0; i < m_size; i++)
+    {
+        m_elems[Slot(i)].~T();
+    }
+    m_size = 0;
+    m_head = 0;
+}
+
+template <typename T>
+void RingBuffer<T>::reserve(std::size_t a_capacity)
+{
+    Grow(a_capacity);
+    if (a_capacity > m_minCapacity)
+    {
+        m_minCapacity = a_capacity;
+    }
+}
+
+template <typename T>
+void RingBuffer<T>::shrink_to_fit()
+{
+    std::size_t capacity = (m_size > m_minCapacity) ? m_size : m_minCapacity;
+    if (capacity >= m_capacity)
+    {
+        return;
+    }
+
+    if (capacity == 0)
+    {
+        // empty and nothing reserved. It allocates again on the next push
+        std::allocator<T>().deallocate(m_elems, m_capacity);
+        m_elems = 0;
+        m_capacity = 0;
+        m_head = 0;
+        return;
+    }
+
+    Reallocate(capacity);
+}
+
+template <typename T>
+std::size_t RingBuffer<T>::Slot(std::size_t a_offset) const
+{
+    // m_head and a_offset are both smaller than m_capacity (a_offset can be 
+    // equal to it only when the buffer is full). No need for a division
+    std::size_t slot = m_head + a_offset;
+    return (slot >= m_capacity) ? (slot - m_capacity) : slot;
+}
+
+template <typename T>
+template <typename... ARGS>
+void RingBuffer<T>::GrowAndEmplace(ARGS&&... a_args)
+{
+    std::size_t capacity = 
+        (m_capacity == 0) ? RING_BUFFER_MIN_CAPACITY : (2 * m_capacity);
+    T* elems = std::allocator<T>().allocate(capacity);
+
+    // the new element is constructed before the others are moved: the 
+    // arguments might refer to one of them (rb.emplace(rb.front()))
+    try
+    {
+        new (&elems[m_size]) T(std::forward<ARGS>(a_args)...);
+    }
+    catch (...)
+    {
+        std::allocator<T>().deallocate(elems, capacity);
+        throw;
+    }
+
+    try
+    {
+        MoveInto(elems);
+    }
+    catch (...)
+    {
+        elems[m_size].~T();
+        std::allocator<T>().deallocate(elems, capacity);
+        throw;
+    }
+
+    Adopt(elems, capacity);
+    m_size++;
+}
+
+template <typename T>
+void RingBuffer<T>::Grow(std::size_t a_capacity)
+{
+    if (a_capacity > m_capacity)
+    {
+        Reallocate(a_capacity);
+    }
+}
+
+template <typename T>
+void RingBuffer<T>::Reallocate(std::size_t a_capacity)
+{
+    assert(a_capacity >= m_size);
+
+    T* elems = std::allocator<T>().allocate(a_capacity);
+    try
+    {
+        MoveInto(elems);
+    }
+    catch (...)
+    {
+        std::allocator<T>().deallocate(elems, a_capacity);
+        throw;
+    }
+
+    Adopt(elems, a_capacity);
+}
+
+template <typename T>
+void RingBuffer<T>::MoveInto(T* a_elems)
+{
+    std::size_t i = 0;
+    try
+    {
+        for (; i < m_size; i++)
+        {
+            new (&a_elems[i]) T(std::move_if_noexcept(m_elems[Slot(i)]));
+        }
+    }
+    catch (...)
+    {
+        while (i > 0)
+        {
+            i--;
+            a_elems[i].~T();
+        }
+        throw;
+    }
+}
+
+template <typename T>
+void RingBuffer<T>::Adopt(T* a_elems, std::size_t a_capacity)
+{
+    for (std::size_t i = 0; i < m_size; i++)
+    {
+        m_elems[Slot(i)].~T();
+    }
+    if (m_elems != 0)
+    {
+        std::allocator<T>().deallocate(m_elems, m_capacity);
+    }
+
+    m_elems = a_elems;
+    m_capacity = a_capacity;
+    m_head = 0;
+}
+
+template <typename T>
+void RingBuffer<T>::CopyFrom(const RingBuffer<T> &a_src)
+{
+    assert(m_capacity - m_size >= a_src.m_size);
+
+    for (std::size_t i = 0; i < a_src.m_size; i++)
+    {
+        new (&m_elems[Slot(m_size)]) T(a_src.m_elems[a_src.Slot(i)]);
+        m_size++;
+    }
+}
+
+#endif /* _RINGBUFFERIMPL_H_ */
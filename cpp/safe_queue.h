@@ -21,8 +21,8 @@
 //
 /// @file safe_queue.h
 /// @brief Definition of a thread-safe queue based on c++11 std calls
-/// It internally contains a std::queue which is protected from concurrent
-/// access by std mutexes and conditional variables
+/// It internally contains a RingBuffer (a circular array) which is protected
+/// from concurrent access by std mutexes and conditional variables
 ///
 /// Your compiler must have support for c++11. This is an example of how to 
 /// compile an application that makes use of this queue with gcc 4.8:
@@ -43,22 +43,39 @@
 #ifndef _SAFEQUEUE_H_
 #define _SAFEQUEUE_H_
 
-#include <queue>
 #include <condition_variable>
 #include <mutex>
 #include <chrono>
 #include <limits> // std::numeric_limits<>::max
+#include "ring_buffer.h"
+#include "queue_stats.h"
 
 #define SAFE_QUEUE_DEFAULT_MAX_SIZE std::numeric_limits<std::size_t >::max()
 
+// bounded queues of up to this many elements allocate the memory for all of
+// them at construction, so pushing and popping never allocate. Bigger (and 
+// unbounded) queues grow their storage when needed. It never shrinks
+#ifndef SAFE_QUEUE_MAX_PREALLOCATED_SIZE
+#define SAFE_QUEUE_MAX_PREALLOCATED_SIZE (64 * 1024)
+#endif
+
 /// @brief thread-safe queue
 /// It uses a mutex+condition variables to protect the internal queue
-/// implementation. Inserting or reading elements use the same mutex
-template <typename T>
+/// implementation. Inserting or reading elements use the same mutex. 
+/// Producers waiting for space and consumers waiting for data sleep on 
+/// different condition variables, and each insertion (or extraction) wakes up
+/// only one of them. A thread woken up that leaves data (or space) behind 
+/// wakes up the next one. See TwoLockSafeQueue (two_lock_safe_queue.h) for a
+/// queue where producers and consumers don't share the lock either
+/// T type of the elements
+/// STATS_T statistics policy (see queue_stats.h). None by default
+template <typename T, typename STATS_T = QueueNoStats>
 class SafeQueue
 {
 public:
     /// @brief constructor
+    /// The storage for a_maxSize elements is allocated here if it is not 
+    /// bigger than SAFE_QUEUE_MAX_PREALLOCATED_SIZE
     /// @param a_maxSize optional parameter with the maximum size of the queue
     SafeQueue(std::size_t a_maxSize = SAFE_QUEUE_DEFAULT_MAX_SIZE);
     
@@ -69,7 +86,7 @@ public:
     /// WARNING: Use with great care, this function call can take a long time
     /// and block other threads from pushing/popping elements into the source
     /// queue
-    SafeQueue(const SafeQueue<T>& a_src);
+    SafeQueue(const SafeQueue<T, STATS_T>& a_src);
     
     /// @brief operator= overloading
     /// This function blocks the a_src and "this" SafeQueues and copies the
@@ -78,13 +95,13 @@ public:
     /// and block other threads from pushing/popping elements into the queues
     /// @param a_src the "right" side of the operator=
     /// @return a const reference to this object
-    const SafeQueue<T>& operator=(const SafeQueue<T> &a_src);
+    const SafeQueue<T, STATS_T>& operator=(const SafeQueue<T, STATS_T> &a_src);
     
     /// @brief move contructor
-    SafeQueue(SafeQueue<T>&& a_src);
+    SafeQueue(SafeQueue<T, STATS_T>&& a_src);
     
     /// @brief move assignment
-    SafeQueue<T>& operator=(SafeQueue<T>&& a_src);
+    SafeQueue<T, STATS_T>& operator=(SafeQueue<T, STATS_T>&& a_src);
 
     /// @brief Check if the queue is empty
     /// This call can block if another thread owns the lock that protects the
@@ -92,12 +109,46 @@ public:
     /// @return true if the queue is empty. False otherwise
     bool IsEmpty() const;
 
+    /// @brief closes the queue and wakes up every thread blocked in it
+    /// Nothing can be inserted into a closed queue: the push calls return 
+    /// false (or 0) straight away, and threads blocked in Push/Emplace give 
+    /// up. Whatever is already in the queue can still be extracted, but the
+    /// pop calls return false (or 0) instead of blocking once the queue is 
+    /// empty. It is meant to tell consumers to finish without having to poll
+    /// a flag. A closed queue can't be reopened
+    void Close();
+
+    /// @brief Check if Close was called on the queue
+    /// @return true if the queue is closed. False otherwise
+    bool IsClosed() const;
+
     /// @brief inserts an element into queue queue
     /// This call can block if another thread owns the lock that protects the
     /// queue. If the queue is full The thread will be blocked in this queue
-    /// until someone else gets an element from the queue
+    /// until someone else gets an element from the queue. If the queue is 
+    /// (or gets) closed the element is discarded
     /// @param element to insert into the queue
-    void Push(const T &a_elem);
+    /// @return true if the element was inserted. False if it was discarded
+    bool Push(const T &a_elem);
+
+    /// @brief inserts an element into queue queue moving it into the queue
+    /// This call can block if another thread owns the lock that protects the
+    /// queue. If the queue is full The thread will be blocked in this queue
+    /// until someone else gets an element from the queue. If the queue is 
+    /// (or gets) closed the element is discarded
+    /// @param element to move into the queue
+    /// @return true if the element was inserted. False if it was discarded
+    bool Push(T &&a_elem);
+
+    /// @brief constructs an element in place at the back of the queue
+    /// This call can block if another thread owns the lock that protects the
+    /// queue. If the queue is full The thread will be blocked in this queue
+    /// until someone else gets an element from the queue. If the queue is 
+    /// (or gets) closed nothing is constructed
+    /// @param a_args arguments forwarded to the constructor of T
+    /// @return true if the element was inserted. False if the queue is closed
+    template <typename... ARGS>
+    bool Emplace(ARGS&&... a_args);
 
     /// @brief inserts an element into queue queue
     /// This call can block if another thread owns the lock that protects the
@@ -108,9 +159,31 @@ public:
     ///         False otherwise
     bool TryPush(const T &a_elem);
 
+    /// @brief inserts an element into queue queue moving it into the queue
+    /// This call can block if another thread owns the lock that protects the
+    /// queue. If the queue is full The call will return false and a_elem 
+    /// won't be modified
+    /// @param element to move into the queue
+    /// @return True if the elem was successfully inserted into the queue.
+    ///         False otherwise
+    bool TryPush(T &&a_elem);
+
+    /// @brief constructs an element in place at the back of the queue
+    /// This call can block if another thread owns the lock that protects the
+    /// queue. If the queue is full The call will return false and nothing 
+    /// will be constructed
+    /// @param a_args arguments forwarded to the constructor of T
+    /// @return True if the elem was successfully inserted into the queue.
+    ///         False otherwise
+    template <typename... ARGS>
+    bool TryEmplace(ARGS&&... a_args);
+
     /// @brief extracts an element from the queue (and deletes it from the q)
     /// If the queue is empty this call will block the thread until there is
-    /// something in the queue to be extracted
+    /// something in the queue to be extracted. The element is moved out of 
+    /// the queue into out_data (it applies to every pop function)
+    /// If the queue is (or gets) closed while it is empty the call returns 
+    /// without modifying out_data. Use WaitPopBulk to tell both cases apart
     /// @param a reference where the element from the queue will be saved to
     void Pop(T &out_data);
 
@@ -132,18 +205,84 @@ public:
     ///        (defined in std::chrono)
     /// @return True if the element was retrieved from the queue.
     ///         False if the timeout was hit and nothing could be extracted
-    ///         from the queue
+    ///         from the queue, or if the queue is closed and empty
     bool TimedWaitPop(T &data, std::chrono::microseconds a_microsecs);
 
+    /// @brief inserts up to a_count elements into the queue
+    /// The lock that protects the queue is acquired only once for the whole
+    /// batch. Elements are inserted in order until the queue gets full
+    /// @param a_elems pointer to the first element of the array to insert
+    /// @param a_count number of elements in the a_elems array
+    /// @return the number of elements inserted into the queue (0 if the queue
+    ///         was full)
+    std::size_t TryPushBulk(const T* a_elems, std::size_t a_count);
+
+    /// @brief extracts up to a_maxCount elements from the queue
+    /// The lock that protects the queue is acquired only once for the whole 
+    /// batch
+    /// @param out_data pointer to an array of at least a_maxCount elements 
+    ///        where the result will be saved to
+    /// @param a_maxCount maximum number of elements to extract
+    /// @return the number of elements retrieved from the queue (0 if the 
+    ///         queue was empty)
+    std::size_t TryPopBulk(T* out_data, std::size_t a_maxCount);
+
+    /// @brief extracts up to a_maxCount elements from the queue
+    /// If the queue is empty this call will block the thread until there
+    /// is something in the queue to be extracted or until the timer
+    /// (3rd parameter) expires. It doesn't wait for the queue to have
+    /// a_maxCount elements, whatever is in the queue is extracted
+    /// @param out_data pointer to an array of at least a_maxCount elements 
+    ///        where the result will be saved to
+    /// @param a_maxCount maximum number of elements to extract
+    /// @param duration to wait before returning if the queue was empty
+    /// @return the number of elements retrieved from the queue. 0 if the 
+    ///         timeout was hit and nothing could be extracted from the queue,
+    ///         or if the queue is closed and empty
+    std::size_t TimedWaitPopBulk(
+        T*                        out_data, 
+        std::size_t               a_maxCount, 
+        std::chrono::microseconds a_microsecs);
+
+    /// @brief extracts up to a_maxCount elements from the queue
+    /// If the queue is empty this call will block the thread (with no 
+    /// timeout) until there is something in the queue to be extracted or 
+    /// until the queue is closed
+    /// @param out_data pointer to an array of at least a_maxCount elements 
+    ///        where the result will be saved to
+    /// @param a_maxCount maximum number of elements to extract
+    /// @return the number of elements retrieved from the queue. 0 only if the
+    ///         queue is closed and empty
+    std::size_t WaitPopBulk(T* out_data, std::size_t a_maxCount);
+
+    /// @brief statistics of the queue (see queue_stats.h)
+    /// Everything is 0 if STATS_T is QueueNoStats. A copy of a queue starts
+    /// with clean statistics
+    /// @param out_stats where the statistics will be saved to
+    void GetStats(QueueStatsSnapshot &out_stats) const;
+
 protected:
     /// the actual queue data structure protected by this SafeQueue wrapper
-    std::queue<T> m_theQueue;
+    RingBuffer<T> m_theQueue;
     /// maximum number of elements for the queue
     std::size_t m_maximumSize;
+    /// set by Close. Nothing can be pushed anymore into the queue
+    bool m_closed;
     /// Mutex to protect the queue
     mutable std::mutex m_mutex;
-    /// Conditional variable to wake up threads
-    mutable std::condition_variable m_cond;
+    /// Consumers wait on it for the queue to have something in it
+    mutable std::condition_variable m_notEmpty;
+    /// Producers wait on it for the queue to have some space left
+    mutable std::condition_variable m_notFull;
+    /// number of threads waiting on m_notEmpty. Protected by m_mutex
+    std::size_t m_waitingConsumers;
+    /// number of threads waiting on m_notFull. Protected by m_mutex
+    std::size_t m_waitingProducers;
+    /// statistics of the queue
+    STATS_T m_stats;
+    /// time every element in m_theQueue was inserted (if STATS_T keeps it).
+    /// Protected by m_mutex
+    typename STATS_T::StampFifo m_stamps;
     
     /// @brief calculate if copying a_src into this instance will need to 
     ///        wake up potential threads waiting to perform push or pop ops.
@@ -152,7 +291,36 @@ protected:
     /// @param a_src const reference to the SafeQueue that will be copied 
     ///        into this object
     /// @return true if threads will need to be waken up. False otherwise
-    inline bool WakeUpSignalNeeded(const SafeQueue<T> &a_src) const;
+    inline bool WakeUpSignalNeeded(const SafeQueue<T, STATS_T> &a_src) const;
+
+    /// @brief extracts up to a_maxCount elements from the queue and wakes up
+    ///        the threads waiting for space if it was full
+    /// WARNING: It assumes the caller holds m_mutex
+    /// @return the number of elements extracted
+    inline std::size_t PopBulkLocked(T* out_data, std::size_t a_maxCount);
+
+    /// @brief inserts an element constructed from a_args and wakes up a 
+    ///        consumer if there is any waiting
+    /// WARNING: It assumes the caller holds m_mutex and that there is space
+    template <typename... ARGS>
+    inline void EmplaceLocked(ARGS&&... a_args);
+
+    /// @brief wait on m_notEmpty (m_notFull) until there is something in the
+    ///        queue (some space left) or the queue gets closed
+    /// WARNING: the lock must be held on m_mutex
+    /// @return false if a_wakeUpTime was hit before that
+    inline bool WaitNotEmptyLocked(
+        std::unique_lock<std::mutex>                &a_lock,
+        const std::chrono::steady_clock::time_point *a_wakeUpTime = 0);
+    inline void WaitNotFullLocked(std::unique_lock<std::mutex> &a_lock);
+
+    /// @brief wakes up every thread waiting on the queue
+    /// WARNING: It assumes the caller holds m_mutex
+    inline void NotifyAllLocked();
+
+    /// @brief number of elements whose storage is allocated at construction
+    ///        for a queue of a_maxSize elements
+    static inline std::size_t PreallocatedSize(std::size_t a_maxSize);
 };
 
 // include the implementation file
@@ -21,8 +21,8 @@
 //
 /// @file safe_queue_impl.h
 /// @brief Implementation of a thread-safe queue based on c++11 std calls
-/// It internally contains a std::queue which is protected from concurrent
-/// access by std mutexes and conditional variables
+/// It internally contains a RingBuffer (a circular array) which is protected
+/// from concurrent access by std mutexes and conditional variables
 ///
 /// @author Faustino Frechilla
 /// @history
@@ -39,26 +39,41 @@
 #ifndef _SAFEQUEUEIMPL_H_
 #define _SAFEQUEUEIMPL_H_
 
-template <typename T>
-SafeQueue<T>::SafeQueue(std::size_t a_maxSize):
-    m_theQueue(),
+#include <utility> // std::move, std::forward
+
+template <typename T, typename STATS_T>
+SafeQueue<T, STATS_T>::SafeQueue(std::size_t a_maxSize):
+    m_theQueue(PreallocatedSize(a_maxSize)),
     m_maximumSize(a_maxSize),
+    m_closed(false),
     m_mutex(),
-    m_cond()
+    m_notEmpty(),
+    m_notFull(),
+    m_waitingConsumers(0),
+    m_waitingProducers(0),
+    m_stats(),
+    m_stamps()
 {
+    m_stamps.reserve(m_theQueue.capacity());
 }
 
-template <typename T>
-SafeQueue<T>::~SafeQueue()
+template <typename T, typename STATS_T>
+SafeQueue<T, STATS_T>::~SafeQueue()
 {
 }
 
-template <typename T>
-SafeQueue<T>::SafeQueue(const SafeQueue<T>& a_src):
+template <typename T, typename STATS_T>
+SafeQueue<T, STATS_T>::SafeQueue(const SafeQueue<T, STATS_T>& a_src):
     m_theQueue(),
     m_maximumSize(0),
+    m_closed(false),
     m_mutex(),
-    m_cond()
+    m_notEmpty(),
+    m_notFull(),
+    m_waitingConsumers(0),
+    m_waitingProducers(0),
+    m_stats(),
+    m_stamps()
 {
     // copying a safe queue involves only copying the data (m_theQueue and
     // m_maximumSize). This object has not been instantiated yet so nobody can
@@ -68,11 +83,13 @@ SafeQueue<T>::SafeQueue(const SafeQueue<T>& a_src):
     std::unique_lock<std::mutex> lk(a_src.m_mutex);
     
     this->m_maximumSize = a_src.m_maximumSize;
+    this->m_closed = a_src.m_closed;
     this->m_theQueue = a_src.m_theQueue;
+    this->m_stamps = a_src.m_stamps;
 }
 
-template <typename T>
-const SafeQueue<T>& SafeQueue<T>::operator=(const SafeQueue<T> &a_src)
+template <typename T, typename STATS_T>
+const SafeQueue<T, STATS_T>& SafeQueue<T, STATS_T>::operator=(const SafeQueue<T, STATS_T> &a_src)
 {
     if (this != &a_src)
     {
@@ -87,25 +104,33 @@ const SafeQueue<T>& SafeQueue<T>::operator=(const SafeQueue<T> &a_src)
         
         // copy data from the left side of the operator= into this intance
         this->m_maximumSize = a_src.m_maximumSize;
+        this->m_closed = a_src.m_closed;
         this->m_theQueue = a_src.m_theQueue;
+        this->m_stamps = a_src.m_stamps;
         
         // time now to wake up threads waiting for data to be inserted
         // or extracted
         if (wakeUpWaitingThreads)
         {            
-            this->m_cond.notify_all();
+            NotifyAllLocked();
         }
     }
     
     return *this;
 }
 
-template <typename T>
-SafeQueue<T>::SafeQueue(SafeQueue<T>&& a_src):
-    m_theQueue(a_src.m_theQueue),       // implicit std::move(a_src.m_theQueue) 
-    m_maximumSize(a_src.m_maximumSize), // move constructor called implicitly
+template <typename T, typename STATS_T>
+SafeQueue<T, STATS_T>::SafeQueue(SafeQueue<T, STATS_T>&& a_src):
+    m_theQueue(std::move(a_src.m_theQueue)), // a_src is a named rvalue 
+    m_maximumSize(a_src.m_maximumSize),      // reference. It must be moved explicitly
+    m_closed(a_src.m_closed),
     m_mutex(), // instantiate a new mutex
-    m_cond()   // instantiate a new conditional variable
+    m_notEmpty(), // instantiate new conditional variables
+    m_notFull(),  //
+    m_waitingConsumers(0),
+    m_waitingProducers(0),
+    m_stats(),
+    m_stamps(std::move(a_src.m_stamps))
 {
     // This object has not been instantiated yet. We can assume no one is using 
     // its mutex. 
@@ -115,8 +140,8 @@ SafeQueue<T>::SafeQueue(SafeQueue<T>&& a_src):
     // conditional variable
 }
 
-template <typename T>
-SafeQueue<T>& SafeQueue<T>::operator=(SafeQueue<T> &&a_src)
+template <typename T, typename STATS_T>
+SafeQueue<T, STATS_T>& SafeQueue<T, STATS_T>::operator=(SafeQueue<T, STATS_T> &&a_src)
 {
     if (this != &a_src)
     {
@@ -130,21 +155,23 @@ SafeQueue<T>& SafeQueue<T>::operator=(SafeQueue<T> &&a_src)
         
         // process data from the temporary copy into this intance
         this->m_maximumSize = std::move(a_src.m_maximumSize);
+        this->m_closed = a_src.m_closed;
         this->m_theQueue = std::move(a_src.m_theQueue);
+        this->m_stamps = std::move(a_src.m_stamps);
         
         // time now to wake up threads waiting for data to be inserted
         // or extracted
         if (wakeUpWaitingThreads)
         {
-            this->m_cond.notify_all();
+            NotifyAllLocked();
         }
     }
     
     return *this;
 }
 
-template <typename T>
-bool SafeQueue<T>::WakeUpSignalNeeded(const SafeQueue<T> &a_src) const
+template <typename T, typename STATS_T>
+bool SafeQueue<T, STATS_T>::WakeUpSignalNeeded(const SafeQueue<T, STATS_T> &a_src) const
 {
     if (this->m_theQueue.empty() && (!a_src.m_theQueue.empty()))
     {
@@ -157,140 +184,311 @@ bool SafeQueue<T>::WakeUpSignalNeeded(const SafeQueue<T> &a_src) const
         // threads waiting for stuff to be pushed into the queue
         return true;
     }
+    else if ((!this->m_closed) && a_src.m_closed)
+    {
+        // every waiting thread has to find out the queue is now closed
+        return true;
+    }
     
     return false;
 }
 
-template <typename T>
-bool SafeQueue<T>::IsEmpty() const
+template <typename T, typename STATS_T>
+bool SafeQueue<T, STATS_T>::IsEmpty() const
 {
     std::lock_guard<std::mutex> lk(m_mutex);
     return m_theQueue.empty();
 }
 
-template <typename T>
-void SafeQueue<T>::Push(const T &a_elem)
+template <typename T, typename STATS_T>
+void SafeQueue<T, STATS_T>::Close()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    if (!m_closed)
+    {
+        m_closed = true;
+
+        // wake up everyone. Consumers blocked on an empty queue and producers
+        // blocked on a full one have to return
+        NotifyAllLocked();
+    }
+}
+
+template <typename T, typename STATS_T>
+bool SafeQueue<T, STATS_T>::IsClosed() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_closed;
+}
+
+template <typename T, typename STATS_T>
+bool SafeQueue<T, STATS_T>::Push(const T &a_elem)
+{
+    return Emplace(a_elem);
+}
+
+template <typename T, typename STATS_T>
+bool SafeQueue<T, STATS_T>::Push(T &&a_elem)
+{
+    return Emplace(std::move(a_elem));
+}
+
+template <typename T, typename STATS_T>
+template <typename... ARGS>
+bool SafeQueue<T, STATS_T>::Emplace(ARGS&&... a_args)
 {
     std::unique_lock<std::mutex> lk(m_mutex);
 
-    while (m_theQueue.size() >= m_maximumSize)
+    if (m_theQueue.size() >= m_maximumSize)
     {
-        m_cond.wait(lk);
+        m_stats.OnPushFull();
     }
 
-    bool queueEmpty = m_theQueue.empty();
+    WaitNotFullLocked(lk);
 
-    m_theQueue.push(a_elem);
+    if (m_closed)
+    {
+        // the element is discarded
+        return false;
+    }
+
+    EmplaceLocked(std::forward<ARGS>(a_args)...);
 
-    if (queueEmpty)
+    if ((m_theQueue.size() < m_maximumSize) && (m_waitingProducers > 0))
     {
-        // wake up threads waiting for stuff
-        m_cond.notify_all();
+        // there is space left for the next producer
+        m_notFull.notify_one();
     }
+
+    return true;
 }
 
-template <typename T>
-bool SafeQueue<T>::TryPush(const T &a_elem)
+template <typename T, typename STATS_T>
+bool SafeQueue<T, STATS_T>::TryPush(const T &a_elem)
+{
+    return TryEmplace(a_elem);
+}
+
+template <typename T, typename STATS_T>
+bool SafeQueue<T, STATS_T>::TryPush(T &&a_elem)
+{
+    return TryEmplace(std::move(a_elem));
+}
+
+template <typename T, typename STATS_T>
+template <typename... ARGS>
+bool SafeQueue<T, STATS_T>::TryEmplace(ARGS&&... a_args)
 {
     std::lock_guard<std::mutex> lk(m_mutex);
 
     bool rv = false;
-    bool queueEmpty = m_theQueue.empty();
 
-    if (m_theQueue.size() < m_maximumSize)
+    if ((m_theQueue.size() < m_maximumSize) && (!m_closed))
     {
-        m_theQueue.push(a_elem);
+        EmplaceLocked(std::forward<ARGS>(a_args)...);
         rv = true;
     }
-
-    if (queueEmpty)
+    else if (!m_closed)
     {
-        // wake up threads waiting for stuff
-        m_cond.notify_all();
+        m_stats.OnPushFull();
     }
 
     return rv;
 }
 
-template <typename T>
-void SafeQueue<T>::Pop(T &out_data)
+template <typename T, typename STATS_T>
+void SafeQueue<T, STATS_T>::Pop(T &out_data)
 {
     std::unique_lock<std::mutex> lk(m_mutex);
 
-    while (m_theQueue.empty())
-    {
-        m_cond.wait(lk);
-    }
+    WaitNotEmptyLocked(lk);
 
-    bool queueFull = (m_theQueue.size() >= m_maximumSize) ? true : false;
+    // nothing to pop if the queue was closed
+    PopBulkLocked(&out_data, 1);
+}
 
-    out_data = m_theQueue.front();
-    m_theQueue.pop();
+template <typename T, typename STATS_T>
+bool SafeQueue<T, STATS_T>::TryPop(T &out_data)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
 
-    if (queueFull)
-    {
-        // wake up threads waiting for stuff
-        m_cond.notify_all();
-    }
+    return (PopBulkLocked(&out_data, 1) == 1);
 }
 
-template <typename T>
-bool SafeQueue<T>::TryPop(T &out_data)
+template <typename T, typename STATS_T>
+bool SafeQueue<T, STATS_T>::TimedWaitPop(T &data, std::chrono::microseconds a_microsecs)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    
+    auto wakeUpTime = std::chrono::steady_clock::now() + a_microsecs;
+    WaitNotEmptyLocked(lk, &wakeUpTime);
+
+    // a closed queue wakes up the thread too, but it's only worth popping if
+    // there is something left in it. False if it timed-out (or closed) and 
+    // the queue is still empty
+    return (PopBulkLocked(&data, 1) == 1);
+}
+
+template <typename T, typename STATS_T>
+std::size_t SafeQueue<T, STATS_T>::TryPushBulk(const T* a_elems, std::size_t a_count)
 {
     std::lock_guard<std::mutex> lk(m_mutex);
 
-    bool rv = false;
-    if (!m_theQueue.empty())
+    std::size_t count = 0;
+    while ((count < a_count) && (m_theQueue.size() < m_maximumSize) && 
+           (!m_closed))
+    {
+        // one consumer is woken up. It wakes up the next one if it leaves 
+        // something behind
+        EmplaceLocked(a_elems[count]);
+        count++;
+    }
+
+    if ((count < a_count) && (!m_closed))
     {
-        bool queueFull = (m_theQueue.size() >= m_maximumSize) ? true : false;
+        m_stats.OnPushFull();
+    }
+
+    return count;
+}
 
-        out_data = m_theQueue.front();
+template <typename T, typename STATS_T>
+std::size_t SafeQueue<T, STATS_T>::PopBulkLocked(T* out_data, std::size_t a_maxCount)
+{
+    std::size_t count = 0;
+    while ((count < a_maxCount) && (!m_theQueue.empty()))
+    {
+        out_data[count] = std::move(m_theQueue.front());
         m_theQueue.pop();
+        m_stats.OnPop(m_stamps.pop());
+        count++;
+    }
 
-        if (queueFull)
+    if (count > 0)
+    {
+        if (m_waitingProducers > 0)
         {
-            // wake up threads waiting for stuff
-            m_cond.notify_all();
+            // there is space now for (at least) one producer. It wakes up 
+            // the next one if there is still space after it is done
+            m_notFull.notify_one();
+        }
+        if ((!m_theQueue.empty()) && (m_waitingConsumers > 0))
+        {
+            // something was left behind for the next consumer
+            m_notEmpty.notify_one();
         }
-
-        rv = true;
     }
 
-    return rv;
+    return count;
+}
+
+template <typename T, typename STATS_T>
+std::size_t SafeQueue<T, STATS_T>::TryPopBulk(T* out_data, std::size_t a_maxCount)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    return PopBulkLocked(out_data, a_maxCount);
 }
 
-template <typename T>
-bool SafeQueue<T>::TimedWaitPop(T &data, std::chrono::microseconds a_microsecs)
+template <typename T, typename STATS_T>
+std::size_t SafeQueue<T, STATS_T>::TimedWaitPopBulk(
+    T*                        out_data, 
+    std::size_t               a_maxCount, 
+    std::chrono::microseconds a_microsecs)
 {
     std::unique_lock<std::mutex> lk(m_mutex);
-    
+
     auto wakeUpTime = std::chrono::steady_clock::now() + a_microsecs;
-    if (m_cond.wait_until(lk, wakeUpTime, 
-        [this](){return (m_theQueue.size() > 0);}))
+    WaitNotEmptyLocked(lk, &wakeUpTime);
+
+    // extract as much as possible in one go. Nothing if the timeout was hit
+    // (or the queue was closed) and the queue is still empty 
+    return PopBulkLocked(out_data, a_maxCount);
+}
+
+template <typename T, typename STATS_T>
+std::size_t SafeQueue<T, STATS_T>::WaitPopBulk(T* out_data, std::size_t a_maxCount)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+
+    WaitNotEmptyLocked(lk);
+
+    // 0 only if the queue was closed and there is nothing left in it
+    return PopBulkLocked(out_data, a_maxCount);
+}
+
+template <typename T, typename STATS_T>
+template <typename... ARGS>
+void SafeQueue<T, STATS_T>::EmplaceLocked(ARGS&&... a_args)
+{
+    m_theQueue.emplace(std::forward<ARGS>(a_args)...);
+    m_stamps.push(m_stats.Stamp());
+    m_stats.OnPush(m_theQueue.size());
+
+    if (m_waitingConsumers > 0)
     {
-        // wait_until returns false if the predicate (3rd parameter) still 
-        // evaluates to false after the rel_time timeout expired
-        // we are in this side of the if-clause because the queue is not empty
-        // (so the 3rd parameter evaluated to true)
-        bool queueFull = (m_theQueue.size() >= m_maximumSize) ? true : false;
-        
-        data = m_theQueue.front();
-        m_theQueue.pop();
-        
-        if (queueFull)
+        // only one of them can take the new element
+        m_notEmpty.notify_one();
+    }
+}
+
+template <typename T, typename STATS_T>
+bool SafeQueue<T, STATS_T>::WaitNotEmptyLocked(
+    std::unique_lock<std::mutex>                &a_lock,
+    const std::chrono::steady_clock::time_point *a_wakeUpTime)
+{
+    bool rv = true;
+
+    m_waitingConsumers++;
+    while (m_theQueue.empty() && (!m_closed) && rv)
+    {
+        if (a_wakeUpTime == 0)
         {
-            // wake up threads waiting to insert things into the queue. 
-            // The queue used to be full, now it's not. 
-            m_cond.notify_all();
+            m_notEmpty.wait(a_lock);
+        }
+        else
+        {
+            // spurious wake ups are handled by the loop. The predicate is 
+            // checked once more after a timeout
+            rv = (m_notEmpty.wait_until(a_lock, *a_wakeUpTime) == 
+                      std::cv_status::no_timeout);
         }
-        
-        return true;
     }
-    else
+    m_waitingConsumers--;
+
+    return (rv || (!m_theQueue.empty()) || m_closed);
+}
+
+template <typename T, typename STATS_T>
+void SafeQueue<T, STATS_T>::WaitNotFullLocked(std::unique_lock<std::mutex> &a_lock)
+{
+    m_waitingProducers++;
+    while ((m_theQueue.size() >= m_maximumSize) && (!m_closed))
     {
-        // timed-out and the queue is still empty
-        return false;
+        m_notFull.wait(a_lock);
     }
+    m_waitingProducers--;
+}
+
+template <typename T, typename STATS_T>
+void SafeQueue<T, STATS_T>::NotifyAllLocked()
+{
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+}
+
+template <typename T, typename STATS_T>
+std::size_t SafeQueue<T, STATS_T>::PreallocatedSize(std::size_t a_maxSize)
+{
+    return (a_maxSize <= SAFE_QUEUE_MAX_PREALLOCATED_SIZE) ? a_maxSize : 0;
+}
+
+template <typename T, typename STATS_T>
+void SafeQueue<T, STATS_T>::GetStats(QueueStatsSnapshot &out_stats) const
+{
+    // the statistics are atomic counters. No need for the lock
+    m_stats.GetSnapshot(out_stats);
 }
 
 #endif /* _SAFEQUEUEIMPL_H_ */
@@ -25,6 +25,10 @@
 /// This file contains a template that can be used to turn your class into a
 /// singleton only by inheritance
 ///
+/// Once the instance is built Instance() is an acquire load of an atomic 
+/// pointer, which is a plain load in x86. CachedInstance() keeps a copy of 
+/// the pointer per thread for the classes used from hot paths
+///
 /// Your compiler must have support for c++11
 ///
 /// @author Faustino Frechilla
@@ -39,7 +43,15 @@
 #ifndef _SINGLETON_H_
 #define _SINGLETON_H_
 
+#include <stdint.h> // uint32_t
 #include <atomic>
+#include <thread> // std::this_thread::yield
+
+// number of times a thread waiting for another one to build the instance 
+// spins on the CPU before it starts yielding the processor
+#ifndef SINGLETON_WAIT_SPINS
+#define SINGLETON_WAIT_SPINS 256
+#endif
 
 /// @brief A templatised class for singletons
 /// Inherit from this class if you wish to make your class a singleton, so only
@@ -64,6 +76,8 @@
 ///
 /// // accessing your brand new singleton
 /// MySingleton::Instance().MyMethod();
+/// // the same, reading the pointer cached by the calling thread
+/// MySingleton::CachedInstance().MyMethod();
 /// 
 template <class TClass>
 class Singleton
@@ -71,29 +85,32 @@ class Singleton
 public:
     /// @brief Gives access to the instance wrapped by this singleton
     /// @return a reference to the instance wrapped by the singleton
-    static TClass& Instance()
+    static inline TClass& Instance()
     {
-        if (m_instancePtr == 0)
+        // the acquire load pairs with the release store of the thread that
+        // built the instance, so the instance is seen fully constructed
+        TClass* instance = m_instancePtr.load(std::memory_order_acquire);
+        if (instance == 0)
         {
-            // In the rare event that two threads come into this section only 
-            // one will acquire the spinlock and build the actual instance
-            while(std::atomic_exchange_explicit(&m_lock, true, std::memory_order_acquire))
-            {
-                ; // spin until acquired
-            }
-            
-            if (m_instancePtr == 0)
-            {
-                // This is the thread that will build the real instance since
-                // it hasn-t been instantiated yet
-                m_instancePtr = new TClass();
-            }
-            
-            // Release spinlock
-            std::atomic_store_explicit(&m_lock, false, std::memory_order_release);
+            instance = BuildInstance();
+        }
+
+        return *instance;
+    }
+
+    /// @brief Same as Instance, but the pointer is cached by each thread the
+    ///        first time it is called. After that it's a load of a thread 
+    ///        local variable without the ordering constraints of Instance
+    /// @return a reference to the instance wrapped by the singleton
+    static inline TClass& CachedInstance()
+    {
+        static thread_local TClass* t_instancePtr = 0;
+        if (t_instancePtr == 0)
+        {
+            t_instancePtr = &Instance();
         }
 
-        return *m_instancePtr;
+        return *t_instancePtr;
     }
 
     /// @brief Gives access to the singleton instance using a pointer
@@ -108,12 +125,58 @@ protected:
     virtual ~Singleton(){};
     
     // the actual instance wrapped around the singleton
-    static TClass *m_instancePtr;
+    static std::atomic<TClass*> m_instancePtr;
     // a spinlock to make this singleton implementation thread-safe
     static std::atomic<bool> m_lock;
+
+private:
+    /// @brief slow path of Instance. Builds the instance unless another 
+    ///        thread did it first
+    /// Kept out of line so the fast path stays small enough to be inlined
+    static __attribute__((noinline)) TClass* BuildInstance()
+    {
+        // In the rare event that two threads come into this section only 
+        // one will acquire the spinlock and build the actual instance. The
+        // rest spin for a while and then yield the processor, in case the
+        // constructor takes long
+        uint32_t spins = 0;
+        while(m_lock.exchange(true, std::memory_order_acquire))
+        {
+            do
+            {
+                if (spins < SINGLETON_WAIT_SPINS)
+                {
+                    spins++;
+#if defined(__i386__) || defined(__x86_64__)
+                    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+                    __asm__ __volatile__("yield");
+#endif
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            } while (m_lock.load(std::memory_order_relaxed));
+        }
+
+        TClass* instance = m_instancePtr.load(std::memory_order_relaxed);
+        if (instance == 0)
+        {
+            // This is the thread that will build the real instance since
+            // it hasn-t been instantiated yet
+            instance = new TClass();
+            m_instancePtr.store(instance, std::memory_order_release);
+        }
+
+        // Release spinlock
+        m_lock.store(false, std::memory_order_release);
+
+        return instance;
+    }
 };
 
-template <class TClass> TClass* Singleton<TClass>::m_instancePtr = 0;
+template <class TClass> std::atomic<TClass*> Singleton<TClass>::m_instancePtr(0);
 template <class TClass> std::atomic<bool> Singleton<TClass>::m_lock(false);
 
 #endif /* _SINGLETON_H_ */
@@ -0,0 +1,215 @@
+// ============================================================================
+/// @file  consumer_thread_pool_test.cpp
+/// @brief file to test the consumer thread pool class
+/// Compiling procedure:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c consumer_thread_pool_test.cpp 
+///   $ g++ consumer_thread_pool_test.o -o consumer_thread_pool_test -pthread
+///
+/// Expected output (the order of the Init calls may vary): 
+///    0ms: worker: Called to Init
+///    0ms: worker: Called to Init
+///    0ms: worker: Called to Init
+///    0ms: worker: Called to Init
+///   10ms: main: producing 1000 elements. Some of them are expensive
+///   41ms: main: all the elements were consumed
+///   42ms: main: producing 1000 elements with 10 keys
+///   43ms: main: all the keys were consumed in order
+///   43ms: main: pool joined
+///   43ms: main: exiting ConsumerThreadPoolTest::run
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <iomanip> // std::setw
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <assert.h>
+
+#include "consumer_thread_pool.h"
+
+#define N_WORKERS  4
+#define N_ELEMENTS 1000
+#define N_KEYS     10
+
+class ConsumerThreadPoolTest
+{
+public:
+    ConsumerThreadPoolTest():
+        m_startTestTime(std::chrono::seconds(0)),
+        m_consumedSum(0),
+        m_consumedCount(0),
+        m_lastPerKey(N_KEYS, -1),
+        m_keyMutex()
+    {}
+    
+    virtual ~ConsumerThreadPoolTest()
+    {}
+
+    void Init()
+    {
+        timedPrint("worker", "Called to Init");
+    }
+
+    void Consume(int a_data)
+    {
+        if ((a_data % 100) == 0)
+        {
+            // an expensive element. The elements queued behind it in the
+            // same worker must be stolen by the others
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        m_consumedSum.fetch_add(a_data);
+        m_consumedCount.fetch_add(1);
+    }
+
+    void ConsumeKeyed(int a_data)
+    {
+        // key in the lower digit, sequence number in the rest
+        int key = a_data % N_KEYS;
+        int seq = a_data / N_KEYS;
+        {
+            std::lock_guard<std::mutex> lk(m_keyMutex);
+            assert(m_lastPerKey[key] == seq - 1);
+            m_lastPerKey[key] = seq;
+        }
+        m_consumedCount.fetch_add(1);
+    }
+
+    int run();
+    
+private:
+    std::chrono::system_clock::time_point m_startTestTime;
+    std::mutex m_printMutex;
+
+    std::atomic<int> m_consumedSum;
+    std::atomic<int> m_consumedCount;
+    std::vector<int> m_lastPerKey;
+    std::mutex m_keyMutex;
+
+    void waitForCount(int a_count)
+    {
+        while (m_consumedCount.load() != a_count)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    //////////////////////////////
+    // Join modes
+    //
+    void joinTest()
+    {
+        std::atomic<int> count(0);
+        auto slowConsume = [&count](int)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                count.fetch_add(1);
+            };
+
+        // every element is consumed before Join returns
+        ConsumerThreadPool<int> drainPool(2, slowConsume);
+        for (int i = 0; i < 100; i++)
+        {
+            assert(drainPool.Produce(i));
+        }
+        drainPool.Join();
+        assert(count.load() == 100);
+        count.store(0);
+
+        // workers stop after the element they are consuming
+        ConsumerThreadPool<int> dropPool(2, slowConsume);
+        for (int i = 0; i < 100; i++)
+        {
+            assert(dropPool.Produce(i));
+        }
+        dropPool.Join(ConsumerThreadPool<int>::JOIN_DROP);
+        assert(count.load() < 100);
+
+        // bounded worker queues
+        ConsumerThreadPool<int> boundedPool(
+            1, [](int){ std::this_thread::sleep_for(std::chrono::milliseconds(10)); }, 
+            &ConsumerThreadPoolTest::DoNothing, 2);
+        int produced = 0;
+        for (int i = 0; i < 10; i++)
+        {
+            produced += boundedPool.Produce(i) ? 1 : 0;
+        }
+        assert(produced < 10);
+        boundedPool.Join(ConsumerThreadPool<int>::JOIN_DROP);
+    }
+
+    static void DoNothing()
+    {}
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+        
+        std::unique_lock<std::mutex> lk(m_printMutex);
+        std::cout << std::setw(5) 
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+        std::cout.flush();
+    }
+};
+
+int main()
+{
+    ConsumerThreadPoolTest theConsumerThreadPoolTest;
+    int theConsumerThreadPoolTestResult;
+    
+    theConsumerThreadPoolTestResult = theConsumerThreadPoolTest.run();
+
+    return theConsumerThreadPoolTestResult;
+}
+
+int ConsumerThreadPoolTest::run()
+{
+    joinTest();
+
+    m_startTestTime = std::chrono::system_clock::now();
+    {
+        ConsumerThreadPool<int> pool(
+                N_WORKERS,
+                std::bind(&ConsumerThreadPoolTest::Consume, this, std::placeholders::_1),
+                std::bind(&ConsumerThreadPoolTest::Init, this));
+        assert(pool.GetNumWorkers() == N_WORKERS);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        
+        timedPrint("main", "producing 1000 elements. Some of them are expensive");
+        int expectedSum = 0;
+        for (int i = 0; i < N_ELEMENTS; i++)
+        {
+            assert(pool.Produce(i));
+            expectedSum += i;
+        }
+        waitForCount(N_ELEMENTS);
+        assert(m_consumedSum.load() == expectedSum);
+        timedPrint("main", "all the elements were consumed");
+    }
+
+    m_consumedCount.store(0);
+    {
+        ConsumerThreadPool<int> keyedPool(
+                N_WORKERS,
+                std::bind(&ConsumerThreadPoolTest::ConsumeKeyed, this, std::placeholders::_1));
+
+        timedPrint("main", "producing 1000 elements with 10 keys");
+        for (int i = 0; i < N_ELEMENTS; i++)
+        {
+            assert(keyedPool.ProduceWithKey(i % N_KEYS, i));
+        }
+        waitForCount(N_ELEMENTS);
+        timedPrint("main", "all the keys were consumed in order");
+
+        keyedPool.Join();
+        timedPrint("main", "pool joined");
+    }
+
+    timedPrint("main", "exiting ConsumerThreadPoolTest::run");
+    
+    return 0;
+}
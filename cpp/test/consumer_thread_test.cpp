@@ -70,8 +70,10 @@
 ///  999ms: consumer1: Consumed 19
 /// 1999ms: consumer1: Consumed 1000
 /// 1999ms: main: thread1 exited
-/// 2015ms: main: thread2 exited
-/// 2015ms: main: exiting ConsumerThreadTest::run
+/// 1999ms: main: thread2 exited
+/// 2117ms: consumer2: Called to Init2
+/// 2117ms: consumer2: Consumed: 2000
+/// 2120ms: main: exiting ConsumerThreadTest::run
 // ============================================================================
 
 #include <iostream>
@@ -79,9 +81,17 @@
 #include <iomanip> // std::setw
 #include <sstream> // std::stringstream
 #include <mutex>
+#include <memory> // std::unique_ptr
+#include <atomic>
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <thread>
 
 #include "safe_queue.h"
 #include "consumer_thread.h"
+#include "lock_free_queue_adapter.h"
+#include "delegate/Delegate.h"
 
 class ConsumerThreadTest
 {
@@ -188,6 +198,472 @@ int ConsumerThreadTest::run()
     //thread1.Produce(1001);
     //thread2.Produce(1001);
 
+    // move-only elements are moved from the producer into the consume 
+    // delegate
+    std::atomic<int> consumedSum(0);
+    {
+        ConsumerThread<std::unique_ptr<int> > thread3(
+            [&consumedSum](std::unique_ptr<int> a_data)
+            {
+                consumedSum.fetch_add(*a_data);
+            });
+
+        std::unique_ptr<int> elem(new int(1));
+        assert(thread3.Produce(std::move(elem)) == true);
+        assert(elem.get() == 0);
+        assert(thread3.Emplace(new int(2)) == true);
+        thread3.ProduceOrBlock(std::unique_ptr<int>(new int(3)));
+        thread3.EmplaceOrBlock(new int(4));
+
+        while (consumedSum.load() != 10)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // the same consumer thread on top of lock-free queues. One producer 
+    // thread (this one) and one consumer, so the SPSC queue fits
+    {
+        typedef ArrayLockFreeQueueAdapter<int, 16, 
+            ArrayLockFreeQueueSingleProducerSingleConsumer, 
+            ArrayLockFreeQueueParkWait> SpscQueue_t;
+        typedef ArrayLockFreeQueueAdapter<int, 0, 
+            ArrayLockFreeQueueSequencedSlots> MpmcQueue_t;
+
+        std::atomic<int> lockFreeSum(0);
+        auto consume = [&lockFreeSum](int a_data)
+            {
+                lockFreeSum.fetch_add(a_data);
+            };
+
+        ConsumerThread<int, SpscQueue_t> thread4(consume);
+        ConsumerThread<int, MpmcQueue_t> thread5(8, consume);
+        for (int i = 0 ; i < 100 ; i++)
+        {
+            thread4.ProduceOrBlock(i);
+            thread5.EmplaceOrBlock(i);
+        }
+
+        while (lockFreeSum.load() != 2 * 4950)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Join wakes up the consumer straight away. Draining (the default) 
+    // consumes everything produced before. Dropping stops after the element
+    // being consumed
+    {
+        std::atomic<int> drainedCount(0);
+        std::atomic<int> droppedCount(0);
+        auto slowConsume = [](std::atomic<int> *a_count)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                a_count->fetch_add(1);
+            };
+
+        ConsumerThread<int> thread6(
+            std::bind(slowConsume, &drainedCount));
+        ConsumerThread<int> thread7(
+            std::bind(slowConsume, &droppedCount));
+        for (int i = 0 ; i < 100 ; i++)
+        {
+            thread6.Produce(i);
+            thread7.Produce(i);
+        }
+
+        thread7.Join(ConsumerThread<int>::JOIN_DROP);
+        assert(droppedCount.load() < 100);
+        thread6.Join();
+        assert(drainedCount.load() == 100);
+
+        // an idle consumer sleeps in its queue until it is joined
+        ConsumerThread<int, ArrayLockFreeQueueAdapter<int, 16, 
+            ArrayLockFreeQueueSingleProducerSingleConsumer, 
+            ArrayLockFreeQueueParkWait> > thread8(
+                std::bind(slowConsume, &drainedCount));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        auto joinStart = std::chrono::steady_clock::now();
+        thread8.Join();
+        assert((std::chrono::steady_clock::now() - joinStart) < 
+               std::chrono::milliseconds(100));
+    }
+
+    // name and CPU affinity are applied before the init delegate is called
+    {
+        std::atomic<bool> initChecked(false);
+        ConsumerThreadAttributes attributes(
+            "consumer9-with-a-long-name", std::vector<int>(1, 0));
+        ConsumerThread<int> thread9(
+            attributes,
+            [](int) {},
+            [&initChecked]()
+            {
+                char name[16];
+                assert(pthread_getname_np(pthread_self(), name, sizeof(name)) == 0);
+                assert(std::string(name) == "consumer9-with-");
+                assert(sched_getcpu() == 0);
+                initChecked.store(true);
+            });
+        thread9.Join();
+        assert(initChecked.load());
+
+        // a CPU that can't exist. The thread runs anyway
+        ConsumerThreadAttributes wrongAttributes(
+            std::string(), std::vector<int>(1, CPU_SETSIZE));
+        assert(wrongAttributes.Apply() == false);
+        ConsumerThread<int> thread10(wrongAttributes, [](int) {});
+        assert(thread10.Produce(1));
+    }
+
+    // statistics of the consumable queue. Everything is 0 with the default
+    // queue
+    {
+        typedef ArrayLockFreeQueueAdapter<int, 16, 
+            ArrayLockFreeQueueMultipleProducers, ArrayLockFreeQueueSpinYieldWait,
+            QueueStats> StatsQueue_t;
+
+        ConsumerThread<int, SafeQueue<int, QueueStats> > thread11([](int) {});
+        ConsumerThread<int, StatsQueue_t> thread12([](int) {});
+        for (int i = 0; i < 10; i++)
+        {
+            thread11.ProduceOrBlock(i);
+            thread12.ProduceOrBlock(i);
+        }
+        thread11.Join();
+        thread12.Join();
+
+        QueueStatsSnapshot stats;
+        thread11.GetQueueStats(stats);
+        assert((stats.m_pushes == 10) && (stats.m_pops == 10));
+        assert((stats.m_highWaterMark >= 1) && (stats.m_highWaterMark <= 10));
+        assert(stats.m_timeInQueue.Count() == 10);
+
+        thread12.GetQueueStats(stats);
+        assert((stats.m_pushes == 10) && (stats.m_pops == 10));
+        assert(stats.m_timeInQueue.Count() == 10);
+
+        ConsumerThread<int> thread13([](int) {});
+        thread13.Produce(1);
+        thread13.Join();
+        thread13.GetQueueStats(stats);
+        assert((stats.m_pushes == 0) && (stats.m_timeInQueue.Count() == 0));
+    }
+
+    // Delegates instead of std::function. Member functions, functions and 
+    // small lambdas, including move-only elements
+    {
+        static_assert(std::is_trivially_copyable<Delegate<void(int)> >::value,
+            "delegates are copied around with memcpy");
+
+        std::atomic<int> delegateSum(0);
+        ConsumerThread<int, SafeQueue<int>, Delegate> thread14(
+            [&delegateSum](int a_data) { delegateSum.fetch_add(a_data); },
+            [&delegateSum]() { delegateSum.fetch_add(1000); });
+        ConsumerThread<std::unique_ptr<int>, SafeQueue<std::unique_ptr<int> >, Delegate> thread15(
+            [&delegateSum](std::unique_ptr<int> a_data) { delegateSum.fetch_add(*a_data); });
+        for (int i = 0 ; i < 100 ; i++)
+        {
+            thread14.ProduceOrBlock(i);
+            thread15.EmplaceOrBlock(new int(i));
+        }
+        thread14.Join();
+        thread15.Join();
+        assert(delegateSum.load() == 1000 + 2 * 4950);
+
+        ConsumerThread<int, SafeQueue<int>, Delegate> thread16(
+            MakeDelegate(this, &ConsumerThreadTest::Consume2),
+            MakeDelegate(this, &ConsumerThreadTest::Init2));
+        thread16.Produce(2000);
+        thread16.Join();
+    }
+
+    // back-pressure: the watermark delegates are called once each time the
+    // backlog crosses them
+    {
+        std::atomic<bool> gateOpen(false);
+        std::atomic<bool> consuming(false);
+        auto gatedConsume = [&gateOpen, &consuming](int)
+            {
+                consuming.store(true);
+                while (!gateOpen.load())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            };
+
+        std::atomic<int> highCount(0);
+        std::atomic<int> lowCount(0);
+        std::atomic<std::size_t> highBacklog(0);
+        std::atomic<std::size_t> lowBacklog(0);
+        ConsumerThread<int> thread17(gatedConsume);
+        thread17.SetWatermarks(10, 2,
+            [&highCount, &highBacklog](std::size_t a_backlog) 
+            { 
+                highBacklog.store(a_backlog); 
+                highCount.fetch_add(1); 
+            },
+            [&lowCount, &lowBacklog](std::size_t a_backlog) 
+            { 
+                lowBacklog.store(a_backlog); 
+                lowCount.fetch_add(1); 
+            });
+        for (int i = 0; i < 20; i++)
+        {
+            assert(thread17.Produce(i));
+        }
+        assert(highCount.load() == 1);
+        assert(highBacklog.load() == 10);
+        assert(thread17.IsAboveHighWatermark());
+
+        gateOpen.store(true);
+        thread17.Join();
+        assert((highCount.load() == 1) && (lowCount.load() == 1));
+        assert(lowBacklog.load() <= 2);
+        assert(!thread17.IsAboveHighWatermark());
+        assert(thread17.Backlog() == 0);
+
+        // ProduceFor waits for the consumer to make space, or gives up
+        gateOpen.store(false);
+        consuming.store(false);
+        ConsumerThread<int> thread18(4, gatedConsume);
+        assert(thread18.Produce(0));
+        while (!consuming.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        while (thread18.Produce(1)) {}
+
+        auto waitStart = std::chrono::steady_clock::now();
+        assert(thread18.ProduceFor(2, std::chrono::milliseconds(10)) == false);
+        assert((std::chrono::steady_clock::now() - waitStart) >= std::chrono::milliseconds(10));
+
+        std::thread opener([&gateOpen]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                gateOpen.store(true);
+            });
+        waitStart = std::chrono::steady_clock::now();
+        assert(thread18.ProduceFor(3, std::chrono::seconds(10)) == true);
+        assert((std::chrono::steady_clock::now() - waitStart) < std::chrono::seconds(5));
+        opener.join();
+        thread18.Join();
+
+        // Join wakes up the producers waiting for space
+        gateOpen.store(false);
+        consuming.store(false);
+        ConsumerThread<int> thread19(4, gatedConsume);
+        assert(thread19.Produce(0));
+        while (!consuming.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        while (thread19.Produce(1)) {}
+
+        std::atomic<bool> waitDone(false);
+        std::thread waiter([&thread19, &waitDone]()
+            {
+                assert(thread19.ProduceFor(2, std::chrono::seconds(10)) == false);
+                waitDone.store(true);
+            });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::thread joiner([&thread19]() { thread19.Join(ConsumerThread<int>::JOIN_DROP); });
+        waitStart = std::chrono::steady_clock::now();
+        while (!waitDone.load())
+        {
+            assert((std::chrono::steady_clock::now() - waitStart) < std::chrono::seconds(5));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        gateOpen.store(true);
+        waiter.join();
+        joiner.join();
+    }
+
+    // coalescing mode: the consumer gets every pending element at once, in
+    // spans that grow with the backlog
+    {
+        std::atomic<bool> gateOpen(false);
+        std::atomic<long> spanSum(0);
+        std::atomic<int> spanCount(0);
+        std::atomic<std::size_t> biggestSpan(0);
+        ConsumerThread<int> thread20(ConsumerThread<int>::COALESCE, 100000, 
+            ConsumerThreadAttributes(),
+            [&](int* a_elems, std::size_t a_count)
+            {
+                while (!gateOpen.load())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                for (std::size_t i = 0; i < a_count; i++)
+                {
+                    spanSum.fetch_add(a_elems[i]);
+                }
+                spanCount.fetch_add(1);
+                if (a_count > biggestSpan.load())
+                {
+                    biggestSpan.store(a_count);
+                }
+            });
+        for (int i = 0; i < 10000; i++)
+        {
+            assert(thread20.Produce(i));
+        }
+        gateOpen.store(true);
+        thread20.Join();
+        assert(spanSum.load() == 49995000L);
+        assert(biggestSpan.load() == CONSUMER_THREAD_MAX_SPAN_SIZE);
+        assert(spanCount.load() < 10000 / CONSUMER_THREAD_BATCH_SIZE);
+
+        // with delegates, and elements moved out of the span
+        std::atomic<int> movedSum(0);
+        ConsumerThread<std::unique_ptr<int>, SafeQueue<std::unique_ptr<int> >, Delegate> thread21(
+            ConsumerThread<std::unique_ptr<int>, SafeQueue<std::unique_ptr<int> >, Delegate>::COALESCE, 
+            1000, ConsumerThreadAttributes(),
+            [&movedSum](std::unique_ptr<int>* a_elems, std::size_t a_count)
+            {
+                for (std::size_t i = 0; i < a_count; i++)
+                {
+                    std::unique_ptr<int> elem(std::move(a_elems[i]));
+                    movedSum.fetch_add(*elem);
+                }
+            });
+        for (int i = 0; i < 100; i++)
+        {
+            thread21.EmplaceOrBlock(new int(i));
+        }
+        thread21.Join();
+        assert(movedSum.load() == 4950);
+    }
+
+    // what is produced once Join closed the queue is discarded, and it 
+    // doesn't count in the backlog
+    {
+        std::atomic<bool> gateOpen(false);
+        std::atomic<int> consumed(0);
+        ConsumerThread<int> thread22(
+            [&gateOpen, &consumed](int)
+            {
+                while (!gateOpen.load())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                consumed.fetch_add(1);
+            });
+        thread22.TrackBacklog();
+        thread22.ProduceOrBlock(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        assert(thread22.Backlog() == 0);
+
+        // Join waits for the consumer, stuck in the first element
+        std::thread joiner([&thread22]() { thread22.Join(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        thread22.ProduceOrBlock(2);
+        int three = 3;
+        thread22.ProduceOrBlock(std::move(three));
+        thread22.EmplaceOrBlock(4);
+        assert(!thread22.Produce(5));
+        assert(thread22.Backlog() == 0);
+
+        gateOpen.store(true);
+        joiner.join();
+        assert(consumed.load() == 1);
+        assert(thread22.Backlog() == 0);
+    }
+
+    // a producer blocked on a full queue when Join closes it loses its
+    // element, and it neither stays in the backlog nor hits the watermark
+    {
+        std::atomic<bool> gateOpen(false);
+        std::atomic<int> consumed(0);
+        std::atomic<int> highCount(0);
+        ConsumerThread<int> thread23(1,
+            [&gateOpen, &consumed](int)
+            {
+                while (!gateOpen.load())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                consumed.fetch_add(1);
+            });
+        thread23.SetWatermarks(2, 0,
+            [&highCount](std::size_t) { highCount.fetch_add(1); },
+            [](std::size_t) {});
+        thread23.ProduceOrBlock(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // the consumer is stuck in the first element. This one fills the queue
+        thread23.ProduceOrBlock(2);
+        assert(thread23.Backlog() == 1);
+
+        std::thread producer([&thread23]() { thread23.ProduceOrBlock(3); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::thread joiner([&thread23]() { thread23.Join(); });
+        producer.join();
+        assert(thread23.Backlog() == 1);
+        assert(highCount.load() == 0);
+
+        gateOpen.store(true);
+        joiner.join();
+        assert(consumed.load() == 2);
+        assert(thread23.Backlog() == 0);
+        assert(highCount.load() == 0);
+    }
+
+    // ProduceFor calls the high watermark delegate without holding its lock,
+    // so the delegate can wait in ProduceFor too
+    {
+        std::atomic<int> stage(0);
+        std::atomic<int> consumed(0);
+        std::atomic<int> highCount(0);
+        std::atomic<bool> nestedProduced(true);
+        auto waitStage = [&stage](int a_stage)
+            {
+                while (stage.load() < a_stage)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            };
+        ConsumerThread<int> thread24(1,
+            [&waitStage, &consumed](int)
+            {
+                waitStage(2);
+                consumed.fetch_add(1);
+            },
+            [&waitStage]() { waitStage(1); });
+        thread24.SetWatermarks(1, 0,
+            [&thread24, &highCount, &nestedProduced](std::size_t)
+            {
+                // the second time it is called from the ProduceFor below,
+                // with the queue full and the consumer stuck
+                if (highCount.fetch_add(1) == 1)
+                {
+                    nestedProduced.store(thread24.ProduceFor(
+                        3, std::chrono::milliseconds(50)));
+                }
+            },
+            [](std::size_t) {});
+        // the consumer is stuck in the init delegate. This fills the queue
+        thread24.ProduceOrBlock(1);
+        assert(highCount.load() == 1);
+
+        std::atomic<bool> produced(false);
+        std::thread producer([&thread24, &produced]()
+            {
+                produced.store(thread24.ProduceFor(2, std::chrono::seconds(10)));
+            });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // the consumer pops 1 (the low watermark) and gets stuck in it. 2 
+        // takes its place and hits the high watermark again
+        stage.store(1);
+        producer.join();
+        assert(produced.load());
+        assert(highCount.load() == 2);
+        assert(!nestedProduced.load());
+
+        stage.store(2);
+        thread24.Join();
+        assert(consumed.load() == 2);
+    }
+
     timedPrint("main", "exiting ConsumerThreadTest::run");
     
     return 0;
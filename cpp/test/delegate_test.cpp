@@ -0,0 +1,244 @@
+// ============================================================================
+/// @file  delegate_test.cpp
+/// @brief file to test the Delegate class (delegate/Delegate.h)
+/// Compiling procedure:
+///   $ g++ -I.. -g -O0 -Wall -std=c++11 -c delegate_test.cpp 
+///   $ g++ delegate_test.o -o delegate_test
+///
+/// Expected output: 
+///    0ms: main: member functions OK
+///    0ms: main: functions and function objects OK
+///    0ms: main: comparison and copy OK
+///    0ms: main: conversion from FastDelegate OK
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <iomanip> // std::setw
+#include <memory>  // std::unique_ptr
+#include <string>
+#include <vector>
+#include <string.h> // memcpy
+#include <assert.h>
+
+#include "delegate/Delegate.h"
+
+class Base1
+{
+public:
+    Base1(): m_base1(1) {}
+    virtual ~Base1() {}
+    int m_base1;
+};
+
+class Base2
+{
+public:
+    Base2(): m_base2(2) {}
+    virtual ~Base2() {}
+    virtual int Value(int a_add) const { return m_base2 + a_add; }
+    int m_base2;
+};
+
+/// multiple inheritance, so "this" has to be adjusted to call Base2 members
+class Derived : public Base1, public Base2
+{
+public:
+    Derived(): m_derived(3) {}
+    virtual int Value(int a_add) const { return m_derived + a_add; }
+    int m_derived;
+};
+
+class DelegateTest
+{
+public:
+    DelegateTest():
+        m_startTestTime(std::chrono::system_clock::now()),
+        m_total(0)
+    {}
+
+    int Add(int a_value)
+    {
+        m_total += a_value;
+        return m_total;
+    }
+
+    int Total() const
+    {
+        return m_total;
+    }
+
+    // more arguments than the old Delegate (8) could take
+    int Sum(int a1, int a2, int a3, int a4, int a5, int a6, int a7, int a8, int a9, int a10)
+    {
+        return a1 + a2 + a3 + a4 + a5 + a6 + a7 + a8 + a9 + a10;
+    }
+
+    static int Twice(int a_value)
+    {
+        return 2 * a_value;
+    }
+
+    int run();
+
+private:
+    std::chrono::system_clock::time_point m_startTestTime;
+    int m_total;
+
+    void memberTest();
+    void functorTest();
+    void compareTest();
+    void fastDelegateTest();
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+        std::cout << std::setw(5) 
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+    }
+};
+
+int main()
+{
+    DelegateTest theDelegateTest;
+    return theDelegateTest.run();
+}
+
+int DelegateTest::run()
+{
+    memberTest();
+    functorTest();
+    compareTest();
+    fastDelegateTest();
+
+    return 0;
+}
+
+void DelegateTest::memberTest()
+{
+    Delegate<int(int)> add = MakeDelegate(this, &DelegateTest::Add);
+    assert(add(2) == 2);
+    assert(add(3) == 5);
+
+    const DelegateTest *constThis = this;
+    Delegate<int()> total = MakeDelegate(constThis, &DelegateTest::Total);
+    assert(total() == 5);
+
+    Delegate<int(int, int, int, int, int, int, int, int, int, int)> sum(
+        this, &DelegateTest::Sum);
+    assert(sum(1, 2, 3, 4, 5, 6, 7, 8, 9, 10) == 55);
+
+    // virtual functions through a base that is not the first one
+    Derived derived;
+    Base2 base2;
+    Delegate<int(int)> derivedValue = MakeDelegate(static_cast<Base2*>(&derived), &Base2::Value);
+    Delegate<int(int)> baseValue = MakeDelegate(&base2, &Base2::Value);
+    assert(derivedValue(10) == 13);
+    assert(baseValue(10) == 12);
+
+    timedPrint("main", "member functions OK");
+}
+
+void DelegateTest::functorTest()
+{
+    Delegate<int(int)> twice = &DelegateTest::Twice;
+    assert(twice(4) == 8);
+    assert(MakeDelegate(&DelegateTest::Twice)(5) == 10);
+
+    // capturing lambdas are kept inside the delegate
+    int calls = 0;
+    int *callsPtr = &calls;
+    Delegate<void(const std::string&)> count = 
+        [&calls, callsPtr](const std::string &a_str) { calls += a_str.size(); (*callsPtr)++; };
+    count(std::string("four"));
+    assert(calls == 5);
+
+    // the function object can change its own state
+    Delegate<int()> counter = [calls]() mutable { return ++calls; };
+    assert(counter() == 6);
+    assert(counter() == 7);
+    assert(calls == 5);
+
+    // move-only parameters are moved all the way into the function
+    Delegate<int(std::unique_ptr<int>)> consume = 
+        [](std::unique_ptr<int> a_ptr) { return *a_ptr; };
+    std::unique_ptr<int> ptr(new int(42));
+    assert(consume(std::move(ptr)) == 42);
+    assert(ptr.get() == 0);
+
+    // and references are references
+    Delegate<void(std::vector<int>&)> append = 
+        [](std::vector<int> &a_vector) { a_vector.push_back(1); };
+    std::vector<int> vector;
+    append(vector);
+    assert(vector.size() == 1);
+
+    timedPrint("main", "functions and function objects OK");
+}
+
+void DelegateTest::compareTest()
+{
+    Delegate<int(int)> empty;
+    assert(empty.empty() && !empty && !static_cast<bool>(empty));
+    assert(empty == Delegate<int(int)>());
+    assert(Delegate<int(int)>(static_cast<int(*)(int)>(0)).empty());
+
+    Delegate<int(int)> add = MakeDelegate(this, &DelegateTest::Add);
+    Delegate<int(int)> twice = &DelegateTest::Twice;
+    assert(add && !add.empty());
+    assert(add == MakeDelegate(this, &DelegateTest::Add));
+    assert(add != twice);
+    assert(twice == MakeDelegate(&DelegateTest::Twice));
+
+    // copies (even with memcpy) call the same thing
+    static_assert(std::is_trivially_copyable<Delegate<int(int)> >::value,
+        "delegates must be trivially copyable");
+    int captured = 7;
+    Delegate<int(int)> lambda = [&captured](int a_value) { return captured * a_value; };
+    Delegate<int(int)> copy;
+    memcpy(&copy, &lambda, sizeof(copy));
+    assert(copy(2) == 14);
+    assert(copy == lambda);
+
+    copy = add;
+    m_total = 0;
+    assert(copy(1) == 1);
+    assert(copy == add);
+    copy.clear();
+    assert(copy.empty());
+    assert(copy == empty);
+
+    timedPrint("main", "comparison and copy OK");
+}
+
+void DelegateTest::fastDelegateTest()
+{
+    typedef Delegate<int(int)>::Base_t FastDelegate_t;
+
+    // bound to the same member function of the same object
+    m_total = 0;
+    Delegate<int(int)> add(FastDelegate_t(this, &DelegateTest::Add));
+    assert(add(3) == 3);
+    assert(add == MakeDelegate(this, &DelegateTest::Add));
+
+    Derived derived;
+    const Base2 *base2 = &derived;
+    Delegate<int(int)> value = FastDelegate_t(base2, &Base2::Value);
+    assert(value(1) == 4);
+
+    // free functions don't go through the FastDelegate once converted
+    Delegate<int(int)> twice;
+    {
+        FastDelegate_t fastTwice(&DelegateTest::Twice);
+        twice = fastTwice;
+    }
+    assert(twice(4) == 8);
+    assert(twice == MakeDelegate(&DelegateTest::Twice));
+
+    assert(Delegate<int(int)>(FastDelegate_t()).empty());
+    twice = FastDelegate_t();
+    assert(twice.empty());
+
+    timedPrint("main", "conversion from FastDelegate OK");
+}
@@ -0,0 +1,297 @@
+// ============================================================================
+/// @file  dummylogger_test.cpp
+/// @brief file to test DummyLogger, synchronous and asynchronous modes
+/// Compiling procedure:
+///   $ g++ -I.. -g -O0 -Wall -std=c++11 -D_REENTRANT -c dummylogger_test.cpp 
+///   $ g++ dummylogger_test.o -o dummylogger_test -pthread
+///
+/// Build it with -DDUMMY_LOGGER_UNBOUNDED_QUEUE to test the logger on top of
+/// the unbounded queue (nothing is dropped then)
+///
+/// Expected output: 
+/// synchronous message 1
+/// [14/Oct/2026 10:00:00.000] INFO synchronous binary message 2
+///    8ms: main: 4 threads logged 4000 messages without mixing them up
+///   10ms: main: 3984 messages dropped while the sink was blocked
+///   12ms: main: binary records formatted by the consumer thread
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <iomanip> // std::setw
+#include <sstream> // std::stringstream
+#include <string>
+#include <vector>
+#include <thread>
+#include <assert.h>
+#include <stdio.h>  // sscanf
+#include <string.h> // memset
+#include <time.h>   // strptime, mktime
+#include <unistd.h> // pipe
+
+#include "dummylogger.h"
+
+#define DUMMY_LOGGER_TEST_THREADS  4
+#define DUMMY_LOGGER_TEST_MESSAGES 1000
+
+class DummyLoggerTest
+{
+public:
+    DummyLoggerTest():
+        m_startTestTime(std::chrono::system_clock::now())
+    {}
+
+    int run();
+
+private:
+    std::chrono::system_clock::time_point m_startTestTime;
+
+    void asyncTest();
+    void dropTest();
+    void binaryTest();
+
+    /// @brief reads everything written into a_fd until it is closed
+    static std::string ReadAll(int a_fd)
+    {
+        std::string data;
+        char buffer[4096];
+        ssize_t size;
+        while ((size = read(a_fd, buffer, sizeof(buffer))) > 0)
+        {
+            data.append(buffer, size);
+        }
+        return data;
+    }
+
+    /// @brief splits a_data in lines
+    static std::vector<std::string> Lines(const std::string &a_data)
+    {
+        std::vector<std::string> lines;
+        std::stringstream stream(a_data);
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+        std::cout << std::setw(5) 
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+    }
+};
+
+int main()
+{
+    DummyLoggerTest theDummyLoggerTest;
+    return theDummyLoggerTest.run();
+}
+
+int DummyLoggerTest::run()
+{
+    DummyLogger::Instance() << "synchronous message " << 1 << std::endl;
+    assert(!DummyLogger::Instance().IsAsync());
+    DUMMY_LOG(DUMMY_LOGGER_INFO, "synchronous binary message %d", 2);
+
+    asyncTest();
+    dropTest();
+    binaryTest();
+
+    return 0;
+}
+
+void DummyLoggerTest::asyncTest()
+{
+    int fds[2];
+    assert(pipe(fds) == 0);
+    std::string output;
+    std::thread reader([&output, &fds]() { output = ReadAll(fds[0]); });
+
+    DummyLogger::Instance().StartAsync(fds[1], 
+        DUMMY_LOGGER_TEST_THREADS * DUMMY_LOGGER_TEST_MESSAGES);
+    assert(DummyLogger::Instance().IsAsync());
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < DUMMY_LOGGER_TEST_THREADS; i++)
+    {
+        threads.push_back(std::thread([i]()
+            {
+                for (int j = 0; j < DUMMY_LOGGER_TEST_MESSAGES; j++)
+                {
+                    // formatting state is kept per thread
+                    DummyLogger::Instance() << "thread " << i << " message " 
+                        << std::hex << j << std::dec << " end" << std::endl;
+                }
+            }));
+    }
+    for (std::size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+
+    // messages longer than a record are truncated
+    std::string longMessage(2 * DUMMY_LOGGER_RECORD_SIZE, 'x');
+    DummyLogger::Instance() << longMessage << std::endl;
+
+    DummyLogger::Instance().StopAsync();
+    assert(!DummyLogger::Instance().IsAsync());
+    close(fds[1]);
+    reader.join();
+    close(fds[0]);
+
+    // every message is whole and in order for each thread
+    std::vector<std::string> lines = Lines(output);
+    assert(lines.size() == DUMMY_LOGGER_TEST_THREADS * DUMMY_LOGGER_TEST_MESSAGES + 1);
+    std::vector<int> next(DUMMY_LOGGER_TEST_THREADS, 0);
+    for (std::size_t i = 0; i + 1 < lines.size(); i++)
+    {
+        int thread;
+        unsigned int message;
+        char end[4];
+        assert(sscanf(lines[i].c_str(), "thread %d message %x %3s", &thread, &message, end) == 3);
+        assert(std::string(end) == "end");
+        assert((thread >= 0) && (thread < DUMMY_LOGGER_TEST_THREADS));
+        assert(static_cast<int>(message) == next[thread]);
+        next[thread]++;
+    }
+    assert(lines.back() == std::string(DUMMY_LOGGER_RECORD_SIZE - 1, 'x'));
+    assert(DummyLogger::Instance().Dropped() == 0);
+
+    std::stringstream strStream;
+    strStream << DUMMY_LOGGER_TEST_THREADS << " threads logged " 
+              << (lines.size() - 1) << " messages without mixing them up";
+    timedPrint("main", strStream.str().c_str());
+}
+
+void DummyLoggerTest::dropTest()
+{
+    // nobody reads the pipe until the messages are logged. The consumer 
+    // thread blocks writing into it, the queue fills up and the rest is 
+    // dropped. Logging doesn't block
+    int fds[2];
+    assert(pipe(fds) == 0);
+    DummyLogger::Instance().StartAsync(fds[1], 16);
+
+    std::string filler(DUMMY_LOGGER_RECORD_SIZE / 2, 'y');
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 4 * DUMMY_LOGGER_TEST_MESSAGES; i++)
+    {
+        DummyLogger::Instance() << filler << i << std::endl;
+    }
+    assert((std::chrono::steady_clock::now() - start) < std::chrono::seconds(5));
+
+    std::string output;
+    std::thread reader([&output, &fds]() { output = ReadAll(fds[0]); });
+    DummyLogger::Instance().StopAsync();
+    close(fds[1]);
+    reader.join();
+    close(fds[0]);
+
+    uint64_t dropped = DummyLogger::Instance().Dropped();
+#ifdef DUMMY_LOGGER_UNBOUNDED_QUEUE
+    // the queue grows instead
+    assert(dropped == 0);
+#else
+    assert(dropped > 0);
+#endif
+
+    // what was written plus what was dropped is what was logged, and the 
+    // drops are reported
+    std::vector<std::string> lines = Lines(output);
+    uint64_t written = 0;
+    uint64_t reported = 0;
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        unsigned long long count;
+        if (sscanf(lines[i].c_str(), "DummyLogger: %llu messages dropped", &count) == 1)
+        {
+            reported += count;
+        }
+        else
+        {
+            assert(lines[i].compare(0, filler.size(), filler) == 0);
+            written++;
+        }
+    }
+    assert(reported == dropped);
+    assert(written + dropped == 4 * DUMMY_LOGGER_TEST_MESSAGES);
+
+    std::stringstream strStream;
+    strStream << dropped << " messages dropped while the sink was blocked";
+    timedPrint("main", strStream.str().c_str());
+}
+
+void DummyLoggerTest::binaryTest()
+{
+    int fds[2];
+    assert(pipe(fds) == 0);
+    std::string output;
+    std::thread reader([&output, &fds]() { output = ReadAll(fds[0]); });
+
+    DummyLogger::Instance().StartAsync(fds[1]);
+    time_t before = time(0);
+
+    std::string name("order");
+    const char* side = "buy";
+    DUMMY_LOG(DUMMY_LOGGER_INFO, "%s %d %s %.2f", name, 42, side, 10.5);
+    // length modifiers are not needed, and a conversion not matching the 
+    // type of its argument formats the argument according to its type
+    DUMMY_LOG(DUMMY_LOGGER_WARNING, "%ld|%5d|%-4s|%x|%c|%d%%", -1, 7, "ab", 255u, 'z', 3.5);
+    // missing arguments leave the conversion as it is
+    DUMMY_LOG(DUMMY_LOGGER_ERROR, "missing %d %s", 1);
+    DUMMY_LOG(DUMMY_LOGGER_DEBUG, "no arguments");
+    // width and precision can't be taken from the arguments. Those 
+    // conversions are written as they are, and they don't use any argument
+    DUMMY_LOG(DUMMY_LOGGER_INFO, "%*d|%-.*s|%d|%*", 5, 42, "abc");
+    // strings are copied into the record and truncated to fit in it
+    std::string longString(2 * DUMMY_LOGGER_RECORD_SIZE, 's');
+    DUMMY_LOG(DUMMY_LOGGER_INFO, "%s", longString);
+    // binary records and text ones are written in the order they are logged
+    DummyLogger::Instance() << "text message" << std::endl;
+
+    DummyLogger::Instance().StopAsync();
+    time_t after = time(0);
+    close(fds[1]);
+    reader.join();
+    close(fds[0]);
+
+    std::vector<std::string> lines = Lines(output);
+    assert(lines.size() == 7);
+
+    // the layout scripts/log_merger.py parses: 
+    // [%d/%b/%Y %H:%M:%S.%f] LEVEL message
+    std::vector<std::string> messages;
+    for (std::size_t i = 0; i + 1 < lines.size(); i++)
+    {
+        const std::string &line = lines[i];
+        std::size_t close = line.find("] ");
+        assert((line[0] == '[') && (close != std::string::npos));
+
+        struct tm brokenDown;
+        memset(&brokenDown, 0, sizeof(brokenDown));
+        const char* millis = strptime(line.c_str() + 1, "%d/%b/%Y %H:%M:%S", &brokenDown);
+        assert(millis != 0);
+        assert((millis[0] == '.') && (millis + 4 == line.c_str() + close));
+        brokenDown.tm_isdst = -1;
+        time_t logged = mktime(&brokenDown);
+        assert((logged >= before - 1) && (logged <= after));
+
+        messages.push_back(line.substr(close + 2));
+    }
+
+    assert(messages[0] == "INFO order 42 buy 10.50");
+    assert(messages[1] == "WARNING -1|    7|ab  |ff|z|3.5%");
+    assert(messages[2] == "ERROR missing 1 %s");
+    assert(messages[3] == "DEBUG no arguments");
+    assert(messages[4] == "INFO %*d|%-.*s|5|%*");
+    assert(messages[5].compare(0, 5, "INFO ") == 0);
+    assert(messages[5].find_first_not_of('s', 5) == std::string::npos);
+    assert(lines[5].size() < DUMMY_LOGGER_RECORD_SIZE);
+    assert(lines[6] == "text message");
+
+    timedPrint("main", "binary records formatted by the consumer thread");
+}
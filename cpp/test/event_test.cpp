@@ -0,0 +1,251 @@
+// ============================================================================
+/// @file  event_test.cpp
+/// @brief file to test the multicast delegate Event (delegate/Event.h)
+/// Compiling procedure:
+///   $ g++ -I.. -g -O0 -Wall -std=c++11 -D_REENTRANT -c event_test.cpp 
+///   $ g++ event_test.o -o event_test -pthread
+///
+/// Expected output: 
+///    0ms: main: subscribers called in order
+///    0ms: main: subscribed and unsubscribed from inside Fire
+///    0ms: main: changed each other's event while firing in two threads
+///   22ms: main: fired 400000 times while subscribing and unsubscribing
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <iomanip> // std::setw
+#include <sstream> // std::stringstream
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <assert.h>
+
+#include "delegate/Event.h"
+
+#define EVENT_TEST_FIRING_THREADS 4
+#define EVENT_TEST_FIRES_PER_THREAD 100000
+
+class EventTest
+{
+public:
+    EventTest():
+        m_startTestTime(std::chrono::system_clock::now()),
+        m_calls()
+    {}
+
+    void Record(int a_value)
+    {
+        m_calls.push_back(a_value);
+    }
+
+    int Ignored(int a_value)
+    {
+        m_calls.push_back(-a_value);
+        return a_value;
+    }
+
+    int run();
+
+private:
+    std::chrono::system_clock::time_point m_startTestTime;
+    std::vector<int> m_calls;
+
+    void basicTest();
+    void reentrantTest();
+    void crossTest();
+    void concurrentTest();
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+        std::cout << std::setw(5) 
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+    }
+};
+
+int main()
+{
+    EventTest theEventTest;
+    return theEventTest.run();
+}
+
+int EventTest::run()
+{
+    basicTest();
+    reentrantTest();
+    crossTest();
+    concurrentTest();
+
+    return 0;
+}
+
+void EventTest::basicTest()
+{
+    Event<void(int)> event;
+    assert(event.Size() == 0);
+    event.Fire(0); // nobody to call
+
+    int total = 0;
+    Delegate<void(int)> record = MakeDelegate(this, &EventTest::Record);
+    Delegate<void(int)> addToTotal = [&total](int a_value) { total += a_value; };
+    event.Subscribe(record);
+    event.Subscribe(addToTotal);
+    event.Subscribe(record);
+    assert(event.Size() == 3);
+
+    event.Fire(5);
+    event(6);
+    assert(total == 11);
+    assert((m_calls.size() == 4) && (m_calls[0] == 5) && (m_calls[3] == 6));
+
+    // one subscription at a time
+    m_calls.clear();
+    assert(event.Unsubscribe(record));
+    event.Fire(7);
+    assert((m_calls.size() == 1) && (total == 18));
+    assert(event.Unsubscribe(record));
+    assert(!event.Unsubscribe(record));
+    assert(event.Size() == 1);
+
+    event.Clear();
+    assert(event.Size() == 0);
+    event.Fire(8);
+    assert(total == 18);
+    assert(!event.Unsubscribe(addToTotal));
+
+    // return values are ignored
+    m_calls.clear();
+    Event<int(int)> returning;
+    returning.Subscribe(MakeDelegate(this, &EventTest::Ignored));
+    returning.Fire(3);
+    assert((m_calls.size() == 1) && (m_calls[0] == -3));
+
+    timedPrint("main", "subscribers called in order");
+}
+
+void EventTest::reentrantTest()
+{
+    // a one-shot subscriber that unsubscribes itself and subscribes another
+    // one. The changes apply from the next call of Fire
+    Event<void(int)> event;
+    int firstCalls = 0;
+    int secondCalls = 0;
+    Delegate<void(int)> second = [&secondCalls](int) { secondCalls++; };
+    Delegate<void(int)> first;
+    first = [&event, &first, &second, &firstCalls](int) 
+        { 
+            firstCalls++;
+            assert(event.Unsubscribe(first));
+            event.Subscribe(second);
+            assert(event.Size() == 1);
+        };
+    event.Subscribe(first);
+
+    event.Fire(1);
+    assert((firstCalls == 1) && (secondCalls == 0));
+    event.Fire(2);
+    event.Fire(3);
+    assert((firstCalls == 1) && (secondCalls == 2));
+
+    // a change made from outside frees what was left behind
+    event.Subscribe(first);
+    event.Clear();
+    event.Fire(4);
+    assert((firstCalls == 1) && (secondCalls == 2));
+
+    timedPrint("main", "subscribed and unsubscribed from inside Fire");
+}
+
+void EventTest::crossTest()
+{
+    // a delegate of each event subscribes to the other one while both are
+    // being fired, each in its own thread. Neither of them can wait for the
+    // other thread to leave Fire
+    Event<void(int)> eventA;
+    Event<void(int)> eventB;
+    std::atomic<int> firing(0);
+    Delegate<void(int)> nothing = [](int) {};
+    auto subscribeTo = [&firing, &nothing](Event<void(int)> &a_event)
+        {
+            firing.fetch_add(1);
+            while (firing.load() < 2)
+            {
+                std::this_thread::yield();
+            }
+            a_event.Subscribe(nothing);
+        };
+    eventA.Subscribe([&eventB, &subscribeTo](int) { subscribeTo(eventB); });
+    eventB.Subscribe([&eventA, &subscribeTo](int) { subscribeTo(eventA); });
+
+    std::thread firingA([&eventA]() { eventA.Fire(1); });
+    std::thread firingB([&eventB]() { eventB.Fire(2); });
+    firingA.join();
+    firingB.join();
+    assert((eventA.Size() == 2) && (eventB.Size() == 2));
+
+    // changes made from outside free what was left behind
+    eventA.Clear();
+    eventB.Clear();
+
+    timedPrint("main", "changed each other's event while firing in two threads");
+}
+
+void EventTest::concurrentTest()
+{
+    // the counters owned by each subscriber. "always" is never unsubscribed
+    // so it must be called exactly once per Fire. The rest come and go
+    Event<void(uint64_t)> event;
+    std::atomic<uint64_t> alwaysCalls(0);
+    std::atomic<uint64_t> sometimesCalls(0);
+    std::atomic<bool> done(false);
+
+    event.Subscribe([&alwaysCalls](uint64_t) { alwaysCalls.fetch_add(1); });
+
+    std::vector<std::thread> firing;
+    for (int i = 0; i < EVENT_TEST_FIRING_THREADS; i++)
+    {
+        firing.push_back(std::thread([&event]()
+            {
+                for (uint64_t j = 0; j < EVENT_TEST_FIRES_PER_THREAD; j++)
+                {
+                    event.Fire(j);
+                }
+            }));
+    }
+
+    std::thread changing([&event, &sometimesCalls, &done]()
+        {
+            Delegate<void(uint64_t)> sometimes[3];
+            for (int i = 0; i < 3; i++)
+            {
+                // different captures so they are different delegates
+                sometimes[i] = [&sometimesCalls, i](uint64_t) { sometimesCalls.fetch_add(i + 1); };
+            }
+
+            uint64_t round = 0;
+            while (!done.load())
+            {
+                event.Subscribe(sometimes[round % 3]);
+                if (round >= 2)
+                {
+                    assert(event.Unsubscribe(sometimes[(round - 2) % 3]));
+                }
+                round++;
+            }
+        });
+
+    for (std::size_t i = 0; i < firing.size(); i++)
+    {
+        firing[i].join();
+    }
+    done.store(true);
+    changing.join();
+
+    assert(alwaysCalls.load() == EVENT_TEST_FIRING_THREADS * EVENT_TEST_FIRES_PER_THREAD);
+
+    std::stringstream strStream;
+    strStream << "fired " << alwaysCalls.load() << " times while subscribing and unsubscribing";
+    timedPrint("main", strStream.str().c_str());
+}
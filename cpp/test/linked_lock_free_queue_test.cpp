@@ -0,0 +1,302 @@
+// ============================================================================
+/// @file  linked_lock_free_queue_test.cpp
+/// @brief file to test the unbounded linked lock-free queue and its adapter
+/// Compiling procedure:
+///   $ g++ -I.. -g -O0 -Wall -std=c++11 -D_REENTRANT -c linked_lock_free_queue_test.cpp 
+///   $ g++ linked_lock_free_queue_test.o -o linked_lock_free_queue_test -pthread
+///
+/// Expected output: 
+///   142ms: main: 4 producers pushed 400000 elements in order
+///   149ms: main: nodes are recycled, no allocation once the pool is warm
+///   161ms: main: no pushes after Close
+///   191ms: main: ConsumerThread consumed 100000 elements from the linked queue
+///   193ms: main: move only elements, and the ones left are destroyed
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <iomanip> // std::setw
+#include <sstream> // std::stringstream
+#include <vector>
+#include <memory>  // std::unique_ptr, std::shared_ptr
+#include <thread>
+#include <atomic>
+#include <new>     // std::bad_alloc
+#include <stdlib.h>// malloc, free
+#include <assert.h>
+
+#include "linked_lock_free_queue_adapter.h"
+#include "consumer_thread.h"
+
+#define LINKED_Q_TEST_PRODUCERS 4
+#define LINKED_Q_TEST_ELEMENTS  100000
+#define LINKED_Q_TEST_POOL_SIZE 128
+
+/// number of times operator new was called
+static std::atomic<uint64_t> g_allocations(0);
+
+void* operator new(std::size_t a_size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(a_size == 0 ? 1 : a_size);
+    if (ptr == 0)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* a_ptr) noexcept
+{
+    free(a_ptr);
+}
+
+class LinkedLockFreeQueueTest
+{
+public:
+    LinkedLockFreeQueueTest():
+        m_startTestTime(std::chrono::system_clock::now())
+    {}
+
+    int run();
+
+private:
+    std::chrono::system_clock::time_point m_startTestTime;
+
+    void producersTest();
+    void recycleTest();
+    void closeTest();
+    void consumerThreadTest();
+    void moveOnlyTest();
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+        std::cout << std::setw(5) 
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+    }
+};
+
+int main()
+{
+    LinkedLockFreeQueueTest theLinkedLockFreeQueueTest;
+    return theLinkedLockFreeQueueTest.run();
+}
+
+int LinkedLockFreeQueueTest::run()
+{
+    producersTest();
+    recycleTest();
+    closeTest();
+    consumerThreadTest();
+    moveOnlyTest();
+
+    return 0;
+}
+
+void LinkedLockFreeQueueTest::producersTest()
+{
+    // elements are (producer << 32) | sequence number
+    LinkedLockFreeQueueAdapter<uint64_t, ArrayLockFreeQueueParkWait, QueueStats> queue;
+
+    std::vector<std::thread> producers;
+    for (uint64_t i = 0; i < LINKED_Q_TEST_PRODUCERS; i++)
+    {
+        producers.push_back(std::thread([i, &queue]()
+            {
+                for (uint64_t j = 0; j < LINKED_Q_TEST_ELEMENTS; j++)
+                {
+                    // the queue is unbounded. It never fails
+                    assert(queue.TryPush((i << 32) | j));
+                }
+            }));
+    }
+
+    // elements of each producer come out in the order they were pushed
+    std::vector<uint64_t> next(LINKED_Q_TEST_PRODUCERS, 0);
+    uint64_t buffer[64];
+    uint64_t popped = 0;
+    while (popped < LINKED_Q_TEST_PRODUCERS * LINKED_Q_TEST_ELEMENTS)
+    {
+        size_t count = queue.TimedWaitPopBulk(
+            buffer, 64, std::chrono::microseconds(100000));
+        assert(count > 0);
+        for (size_t i = 0; i < count; i++)
+        {
+            uint64_t producer = buffer[i] >> 32;
+            assert(producer < LINKED_Q_TEST_PRODUCERS);
+            assert((buffer[i] & 0xffffffff) == next[producer]);
+            next[producer]++;
+        }
+        popped += count;
+    }
+
+    for (std::size_t i = 0; i < producers.size(); i++)
+    {
+        producers[i].join();
+    }
+    assert(queue.IsEmpty());
+    uint64_t data;
+    assert(!queue.TryPop(data));
+
+    QueueStatsSnapshot stats;
+    queue.GetStats(stats);
+    assert(stats.m_pushes == LINKED_Q_TEST_PRODUCERS * LINKED_Q_TEST_ELEMENTS);
+    assert(stats.m_pops == stats.m_pushes);
+    assert(stats.m_pushesFull == 0);
+    assert((stats.m_highWaterMark > 0) && (stats.m_highWaterMark <= stats.m_pushes));
+
+    std::stringstream strStream;
+    strStream << LINKED_Q_TEST_PRODUCERS << " producers pushed " << popped 
+              << " elements in order";
+    timedPrint("main", strStream.str().c_str());
+}
+
+void LinkedLockFreeQueueTest::recycleTest()
+{
+    LinkedLockFreeQueueAdapter<int> queue(LINKED_Q_TEST_POOL_SIZE);
+
+    // the nodes allocated by the constructor go round and round
+    uint64_t allocations = g_allocations.load();
+    for (int round = 0; round < 100; round++)
+    {
+        for (int i = 0; i < LINKED_Q_TEST_POOL_SIZE; i++)
+        {
+            queue.Push(i);
+        }
+
+        int buffer[LINKED_Q_TEST_POOL_SIZE];
+        assert(queue.TryPopBulk(buffer, LINKED_Q_TEST_POOL_SIZE) == LINKED_Q_TEST_POOL_SIZE);
+        for (int i = 0; i < LINKED_Q_TEST_POOL_SIZE; i++)
+        {
+            assert(buffer[i] == i);
+        }
+    }
+    assert(g_allocations.load() == allocations);
+
+    // more elements than nodes. The queue grows and the pool with it
+    for (int i = 0; i < 2 * LINKED_Q_TEST_POOL_SIZE; i++)
+    {
+        queue.Push(i);
+    }
+    assert(g_allocations.load() == allocations + LINKED_Q_TEST_POOL_SIZE);
+    for (int i = 0; i < 2 * LINKED_Q_TEST_POOL_SIZE; i++)
+    {
+        int data;
+        assert(queue.TryPop(data));
+        assert(data == i);
+    }
+    allocations = g_allocations.load();
+    for (int i = 0; i < 2 * LINKED_Q_TEST_POOL_SIZE; i++)
+    {
+        queue.Push(i);
+    }
+    assert(g_allocations.load() == allocations);
+
+    timedPrint("main", "nodes are recycled, no allocation once the pool is warm");
+}
+
+void LinkedLockFreeQueueTest::closeTest()
+{
+    LinkedLockFreeQueueAdapter<int> queue;
+    assert(queue.IsEmpty());
+    assert(!queue.IsClosed());
+
+    int data = 0;
+    assert(!queue.TimedWaitPop(data, std::chrono::microseconds(1000)));
+    queue.Push(1);
+    queue.Emplace(2);
+
+    // a consumer waiting on the queue is woken up by Close. It still gets 
+    // what was pushed before
+    int buffer[4];
+    std::thread consumer([&queue, &buffer]()
+        {
+            assert(queue.WaitPopBulk(buffer, 4) == 2);
+            assert(queue.WaitPopBulk(buffer + 2, 2) == 0);
+        });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    queue.Close();
+    consumer.join();
+    assert((buffer[0] == 1) && (buffer[1] == 2));
+
+    assert(queue.IsClosed());
+    assert(!queue.TryPush(3));
+    assert(!queue.TryEmplace(3));
+    assert(queue.TryPushBulk(buffer, 2) == 0);
+    queue.Push(3);
+    assert(queue.IsEmpty());
+    assert(!queue.TryPop(data));
+    // Pop returns instead of blocking
+    data = 0;
+    queue.Pop(data);
+    assert(data == 0);
+
+    timedPrint("main", "no pushes after Close");
+}
+
+void LinkedLockFreeQueueTest::consumerThreadTest()
+{
+    std::atomic<uint64_t> sum(0);
+    std::atomic<uint64_t> consumed(0);
+    ConsumerThread<uint64_t, LinkedLockFreeQueueAdapter<uint64_t> > consumer(
+        LINKED_Q_TEST_POOL_SIZE,
+        [&sum, &consumed](uint64_t a_data) 
+        {
+            sum.fetch_add(a_data, std::memory_order_relaxed);
+            consumed.fetch_add(1, std::memory_order_relaxed);
+        });
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < LINKED_Q_TEST_PRODUCERS; i++)
+    {
+        producers.push_back(std::thread([&consumer]()
+            {
+                for (uint64_t j = 0; j < LINKED_Q_TEST_ELEMENTS / LINKED_Q_TEST_PRODUCERS; j++)
+                {
+                    assert(consumer.Produce(j));
+                }
+            }));
+    }
+    for (std::size_t i = 0; i < producers.size(); i++)
+    {
+        producers[i].join();
+    }
+    consumer.Join();
+
+    uint64_t perProducer = LINKED_Q_TEST_ELEMENTS / LINKED_Q_TEST_PRODUCERS;
+    assert(consumed.load() == LINKED_Q_TEST_ELEMENTS);
+    assert(sum.load() == LINKED_Q_TEST_PRODUCERS * (perProducer * (perProducer - 1) / 2));
+
+    std::stringstream strStream;
+    strStream << "ConsumerThread consumed " << consumed.load() 
+              << " elements from the linked queue";
+    timedPrint("main", strStream.str().c_str());
+}
+
+void LinkedLockFreeQueueTest::moveOnlyTest()
+{
+    std::shared_ptr<int> tracker(new int(0));
+    {
+        LinkedLockFreeQueueAdapter<std::unique_ptr<std::shared_ptr<int> > > queue;
+        for (int i = 0; i < 10; i++)
+        {
+            std::unique_ptr<std::shared_ptr<int> > elem(new std::shared_ptr<int>(tracker));
+            assert(queue.TryPush(std::move(elem)));
+            assert(!elem);
+        }
+        queue.Emplace(new std::shared_ptr<int>(tracker));
+        assert(tracker.use_count() == 12);
+
+        std::unique_ptr<std::shared_ptr<int> > data;
+        assert(queue.TryPop(data));
+        assert(data && (*data == tracker));
+        data.reset();
+        assert(tracker.use_count() == 11);
+    }
+    // the elements left in the queue are destroyed with it
+    assert(tracker.use_count() == 1);
+
+    timedPrint("main", "move only elements, and the ones left are destroyed");
+}
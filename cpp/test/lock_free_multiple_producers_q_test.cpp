@@ -72,6 +72,7 @@
 #include <chrono>
 #include <memory>
 #include <thread>
+#include <functional> // std::bind
 #include <mutex>
 #include <string>
 #include <assert.h>
@@ -111,6 +112,8 @@ public:
         int data;
         m_startTestTime = std::chrono::system_clock::now();
         
+        bulkTest();
+        
         timedPrint("main", "About to create 3 consumers and 3 producers");
         m_producerThread1.reset(new std::thread(
             std::bind(&ArrayLockFreeQueueTest::runProducer, this, PRODUCER1)));
@@ -225,6 +228,33 @@ private:
         timedPrint(name.c_str(), "Done!");
     }
     
+    //////////////////////////////
+    // push/pop bulk tests. Run before the threads are created
+    //
+    void bulkTest()
+    {
+        int bulkIn[QUEUE_SIZE + 5];
+        int bulkOut[QUEUE_SIZE + 5];
+        for (int i = 0; i < QUEUE_SIZE + 5; i++)
+        {
+            bulkIn[i] = i;
+        }
+
+        // only QUEUE_SIZE elements fit in the queue
+        assert(m_queue.push_bulk(bulkIn, QUEUE_SIZE + 5) == QUEUE_SIZE);
+        assert(m_queue.push_bulk(bulkIn, 1) == 0);
+        assert(m_queue.pop_bulk(bulkOut, 4) == 4);
+        assert(m_queue.push_bulk(bulkIn, 2) == 2);
+        assert(m_queue.pop_bulk(bulkOut + 4, QUEUE_SIZE + 5) == QUEUE_SIZE - 2);
+        for (int i = 0; i < QUEUE_SIZE; i++)
+        {
+            assert(bulkOut[i] == i);
+        }
+        assert((bulkOut[QUEUE_SIZE] == 0) && (bulkOut[QUEUE_SIZE + 1] == 1));
+        assert(m_queue.pop_bulk(bulkOut, 1) == 0);
+        assert(m_queue.size() == 0);
+    }
+
     void timedPrint(const char* a_who, const char* a_msg)
     {
         auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
@@ -0,0 +1,392 @@
+// ============================================================================
+/// @file  lock_free_queue_stress_test.cpp
+/// @brief Stress test of every circular array based lock free queue policy
+///        Many producers and consumers on small queues whose counters roll
+///        over from 0xFFFFFFFF to 0 a few thousand elements after starting
+/// Every element carries the producer that pushed it and a sequence number.
+/// The consumers check that no element is lost or popped twice, and that the
+/// elements of each producer are popped in the order they were pushed (each
+/// consumer must see increasing sequence numbers for a given producer).
+/// Producers and consumers mix single and bulk operations.
+///
+/// Compiling procedure:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c lock_free_queue_stress_test.cpp
+///   $ g++ lock_free_queue_stress_test.o -o lock_free_queue_stress_test -pthread -std=c++11
+/// or with ThreadSanitizer:
+///   $ make tsan
+///   $ make run_tsan STRESS_SECONDS=600
+///
+/// Usage:
+///   $ ./lock_free_queue_stress_test [seconds]
+/// Each configuration runs STRESS_DEFAULT_ROUNDS rounds by default. If
+/// [seconds] is given the configurations keep running rounds until that many
+/// seconds have passed (split evenly between them) for a long stress run
+///
+/// Expected output:
+///   120ms: main: single_producer capacity=14 producers=1 consumers=3 rounds=3 elements=60000 OK
+///   219ms: main: single_producer capacity=15 producers=1 consumers=3 rounds=3 elements=60000 OK
+///   280ms: main: single_producer_single_consumer capacity=15 producers=1 consumers=1 rounds=3 elements=60000 OK
+///   296ms: main: single_producer_single_consumer capacity=1023 producers=1 consumers=1 rounds=3 elements=60000 OK
+///   940ms: main: multiple_producers capacity=14 producers=4 consumers=4 rounds=3 elements=240000 OK
+///  1466ms: main: multiple_producers capacity=15 producers=4 consumers=4 rounds=3 elements=240000 OK
+///  1514ms: main: multiple_producers capacity=999 producers=3 consumers=2 rounds=3 elements=180000 OK
+///  2001ms: main: sequenced_slots capacity=16 producers=4 consumers=4 rounds=3 elements=240000 OK
+///  2082ms: main: sequenced_slots capacity=128 producers=3 consumers=3 rounds=3 elements=180000 OK
+///  2082ms: main: Done!
+// ============================================================================
+
+// the counters of the queues start at most 4096 elements away from rolling
+// over. It must be under the biggest multiple of the sizes not a power of 2 
+// that fits in a uint32_t (see ArrayLockFreeQueueCounter)
+#define LOCK_FREE_Q_INITIAL_COUNT 0xFFFFF000u
+
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <functional> // std::function
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <sstream> // std::stringstream
+#include <assert.h>
+#include <stdlib.h>  // atoi
+#include <sched.h>   // sched_yield
+#include <iomanip>   // std::setw
+#include "lock_free_queue.h"
+
+#define STRESS_DEFAULT_ROUNDS   3
+#define STRESS_ELEMENTS_PER_PRODUCER 20000
+// bulk operations move up to this many elements at once
+#define STRESS_MAX_BULK         8
+// number of failed push/pop attempts before yielding the processor. The test
+// must make progress on machines with less cores than threads
+#define STRESS_SPINS_BEFORE_YIELD 64
+
+class LockFreeQueueStressTest
+{
+public:
+    explicit LockFreeQueueStressTest(int a_seconds):
+        m_seconds(a_seconds),
+        m_startTestTime(std::chrono::seconds(0)),
+        m_printMutex()
+    {}
+
+    virtual ~LockFreeQueueStressTest()
+    {}
+
+    int run()
+    {
+        m_startTestTime = std::chrono::steady_clock::now();
+
+        typedef ArrayLockFreeQueue<uint64_t, 15, ArrayLockFreeQueueSingleProducer> Sp15_t;
+        typedef ArrayLockFreeQueue<uint64_t, 16, ArrayLockFreeQueueSingleProducer> Sp16_t;
+        typedef ArrayLockFreeQueue<uint64_t, 16, ArrayLockFreeQueueSingleProducerSingleConsumer> Spsc16_t;
+        typedef ArrayLockFreeQueue<uint64_t, 0, ArrayLockFreeQueueSingleProducerSingleConsumer> SpscN_t;
+        typedef ArrayLockFreeQueue<uint64_t, 15, ArrayLockFreeQueueMultipleProducers> Mp15_t;
+        typedef ArrayLockFreeQueue<uint64_t, 16, ArrayLockFreeQueueMultipleProducers> Mp16_t;
+        typedef ArrayLockFreeQueue<uint64_t, 1000, ArrayLockFreeQueueMultipleProducers> Mp1000_t;
+        typedef ArrayLockFreeQueue<uint64_t, 16, ArrayLockFreeQueueSequencedSlots> Seq16_t;
+        typedef ArrayLockFreeQueue<uint64_t, 0, ArrayLockFreeQueueSequencedSlots> SeqN_t;
+
+        stress<Sp15_t>("single_producer", 1, 3, []() { return new Sp15_t(); });
+        stress<Sp16_t>("single_producer", 1, 3, []() { return new Sp16_t(); });
+        stress<Spsc16_t>("single_producer_single_consumer", 1, 1, 
+            []() { return new Spsc16_t(); });
+        stress<SpscN_t>("single_producer_single_consumer", 1, 1, 
+            []() { return new SpscN_t(1000); });
+        stress<Mp15_t>("multiple_producers", 4, 4, []() { return new Mp15_t(); });
+        stress<Mp16_t>("multiple_producers", 4, 4, []() { return new Mp16_t(); });
+        stress<Mp1000_t>("multiple_producers", 3, 2, []() { return new Mp1000_t(); });
+        stress<Seq16_t>("sequenced_slots", 4, 4, []() { return new Seq16_t(); });
+        stress<SeqN_t>("sequenced_slots", 3, 3, []() { return new SeqN_t(100); });
+
+        timedPrint("main", "Done!");
+
+        return 0;
+    }
+
+private:
+    /// number of calls to stress in run()
+    static const int N_CONFIGURATIONS = 9;
+
+    int m_seconds;
+    std::chrono::steady_clock::time_point m_startTestTime;
+    std::mutex m_printMutex;
+
+    /// @brief state shared by the threads of one round
+    struct Round
+    {
+        Round(unsigned a_producers, unsigned a_consumers):
+            m_nProducers(a_producers),
+            m_nConsumers(a_consumers),
+            m_total(static_cast<uint64_t>(a_producers) * STRESS_ELEMENTS_PER_PRODUCER),
+            m_seen(new std::atomic<uint8_t>[m_total]),
+            m_consumed(0),
+            m_duplicated(0),
+            m_outOfOrder(0),
+            m_startFlag(false)
+        {
+            for (uint64_t i = 0; i < m_total; i++)
+            {
+                m_seen[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        unsigned m_nProducers;
+        unsigned m_nConsumers;
+        uint64_t m_total;
+        /// times each element was popped
+        std::unique_ptr<std::atomic<uint8_t>[]> m_seen;
+        std::atomic<uint64_t> m_consumed;
+        std::atomic<uint64_t> m_duplicated;
+        std::atomic<uint64_t> m_outOfOrder;
+        std::atomic<bool> m_startFlag;
+    };
+
+    /// @brief cheap pseudo random numbers to choose the next operation
+    static inline uint32_t nextRandom(uint32_t &a_state)
+    {
+        a_state ^= a_state << 13;
+        a_state ^= a_state >> 17;
+        a_state ^= a_state << 5;
+        return a_state;
+    }
+
+    static inline void backOff(unsigned &a_spins)
+    {
+        if (++a_spins == STRESS_SPINS_BEFORE_YIELD)
+        {
+            a_spins = 0;
+            sched_yield();
+        }
+    }
+
+    /// @brief run rounds of a_producers producers and a_consumers consumers,
+    ///        each round on a new queue returned by a_create
+    template <typename QUEUE_T>
+    void stress(
+        const char*               a_name,
+        unsigned                  a_producers,
+        unsigned                  a_consumers,
+        std::function<QUEUE_T*()> a_create)
+    {
+        auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::milliseconds((m_seconds * 1000) / N_CONFIGURATIONS);
+
+        uint32_t capacity = 0;
+        int rounds = 0;
+        while ((rounds < STRESS_DEFAULT_ROUNDS) ||
+               (std::chrono::steady_clock::now() < deadline))
+        {
+            std::unique_ptr<QUEUE_T> queue(a_create());
+            capacity = queue->capacity();
+
+            // the counters must roll over during the round
+            assert((static_cast<uint64_t>(LOCK_FREE_Q_INITIAL_COUNT) + 
+                    (a_producers * STRESS_ELEMENTS_PER_PRODUCER)) > 0xFFFFFFFFull);
+
+            stressRound(*queue, a_producers, a_consumers);
+            rounds++;
+        }
+
+        std::stringstream msg;
+        msg << a_name
+            << " capacity="  << capacity
+            << " producers=" << a_producers
+            << " consumers=" << a_consumers
+            << " rounds="    << rounds
+            << " elements="  << (rounds * a_producers * STRESS_ELEMENTS_PER_PRODUCER)
+            << " OK";
+        timedPrint("main", msg.str().c_str());
+    }
+
+    template <typename QUEUE_T>
+    void stressRound(QUEUE_T &a_queue, unsigned a_producers, unsigned a_consumers)
+    {
+        Round round(a_producers, a_consumers);
+        std::vector<std::thread> threads;
+
+        for (unsigned i = 0; i < a_consumers; i++)
+        {
+            threads.push_back(std::thread(
+                &LockFreeQueueStressTest::runConsumer<QUEUE_T>, 
+                &a_queue, &round, i));
+        }
+        for (unsigned i = 0; i < a_producers; i++)
+        {
+            threads.push_back(std::thread(
+                &LockFreeQueueStressTest::runProducer<QUEUE_T>, 
+                &a_queue, &round, i));
+        }
+
+        round.m_startFlag.store(true);
+        for (std::size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i].join();
+        }
+
+        // nothing lost, nothing popped twice, nothing out of order and 
+        // nothing left behind
+        uint64_t lost = 0;
+        for (uint64_t i = 0; i < round.m_total; i++)
+        {
+            if (round.m_seen[i].load(std::memory_order_relaxed) == 0)
+            {
+                lost++;
+            }
+        }
+        if ((lost != 0) || 
+            (round.m_duplicated.load() != 0) || 
+            (round.m_outOfOrder.load() != 0))
+        {
+            std::stringstream msg;
+            msg << "lost=" << lost
+                << " duplicated=" << round.m_duplicated.load()
+                << " out_of_order=" << round.m_outOfOrder.load();
+            timedPrint("main", msg.str().c_str());
+        }
+        assert(lost == 0);
+        assert(round.m_duplicated.load() == 0);
+        assert(round.m_outOfOrder.load() == 0);
+
+        uint64_t data;
+        assert(a_queue.size() == 0);
+        assert(a_queue.pop(data) == false);
+    }
+
+    template <typename QUEUE_T>
+    static void runProducer(QUEUE_T *a_queue, Round *a_round, unsigned a_index)
+    {
+        uint64_t elems[STRESS_MAX_BULK];
+        uint32_t random = 0x9E3779B9u * (a_index + 1);
+        uint32_t seq = 0;
+
+        while (!a_round->m_startFlag.load())
+            ;
+
+        unsigned spins = 0;
+        while (seq < STRESS_ELEMENTS_PER_PRODUCER)
+        {
+            uint32_t r = nextRandom(random);
+            if ((r & 1) == 0)
+            {
+                uint64_t elem = (static_cast<uint64_t>(a_index) << 32) | seq;
+                if (a_queue->push(elem))
+                {
+                    seq++;
+                    spins = 0;
+                }
+                else
+                {
+                    backOff(spins);
+                }
+            }
+            else
+            {
+                uint32_t count = 1 + ((r >> 1) % STRESS_MAX_BULK);
+                if (count > (STRESS_ELEMENTS_PER_PRODUCER - seq))
+                {
+                    count = STRESS_ELEMENTS_PER_PRODUCER - seq;
+                }
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    elems[i] = (static_cast<uint64_t>(a_index) << 32) | (seq + i);
+                }
+
+                // only the first elements of the array go in if there isn't
+                // space for all of them
+                uint32_t pushed = a_queue->push_bulk(elems, count);
+                seq += pushed;
+                if (pushed == 0)
+                {
+                    backOff(spins);
+                }
+                else
+                {
+                    spins = 0;
+                }
+            }
+        }
+    }
+
+    template <typename QUEUE_T>
+    static void runConsumer(QUEUE_T *a_queue, Round *a_round, unsigned a_index)
+    {
+        uint64_t elems[STRESS_MAX_BULK];
+        uint32_t random = 0x7F4A7C15u * (a_index + 1);
+        // last sequence number popped by this consumer from each producer
+        std::vector<int64_t> lastSeq(a_round->m_nProducers, -1);
+
+        while (!a_round->m_startFlag.load())
+            ;
+
+        unsigned spins = 0;
+        while (a_round->m_consumed.load() < a_round->m_total)
+        {
+            uint32_t r = nextRandom(random);
+            uint32_t count;
+            if ((r & 1) == 0)
+            {
+                count = a_queue->pop(elems[0]) ? 1 : 0;
+            }
+            else
+            {
+                count = a_queue->pop_bulk(elems, 1 + ((r >> 1) % STRESS_MAX_BULK));
+            }
+
+            if (count == 0)
+            {
+                backOff(spins);
+                continue;
+            }
+            spins = 0;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                uint32_t producer = static_cast<uint32_t>(elems[i] >> 32);
+                uint32_t seq      = static_cast<uint32_t>(elems[i] & 0xFFFFFFFFu);
+                assert(producer < a_round->m_nProducers);
+                assert(seq < STRESS_ELEMENTS_PER_PRODUCER);
+
+                uint64_t position = 
+                    (static_cast<uint64_t>(producer) * STRESS_ELEMENTS_PER_PRODUCER) + seq;
+                if (a_round->m_seen[position].fetch_add(1, std::memory_order_relaxed) != 0)
+                {
+                    a_round->m_duplicated.fetch_add(1);
+                }
+                if (static_cast<int64_t>(seq) <= lastSeq[producer])
+                {
+                    a_round->m_outOfOrder.fetch_add(1);
+                }
+                lastSeq[producer] = seq;
+            }
+
+            a_round->m_consumed.fetch_add(count);
+        }
+    }
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::steady_clock::now() - m_startTestTime;
+
+        std::unique_lock<std::mutex> lk(m_printMutex);
+        std::cout << std::setw(5)
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+        std::cout.flush();
+    }
+};
+
+int main(int argc, char** argv)
+{
+    int seconds = 0;
+    if (argc > 1)
+    {
+        seconds = atoi(argv[1]);
+    }
+
+    LockFreeQueueStressTest theStressTest(seconds);
+
+    return theStressTest.run();
+}
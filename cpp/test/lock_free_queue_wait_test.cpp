@@ -0,0 +1,195 @@
+// ============================================================================
+/// @file  lock_free_queue_wait_test.cpp
+/// @brief Testing the blocking calls of the circular array based lock free 
+///        queue with the different wait strategies
+/// Compiling procedure:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c lock_free_queue_wait_test.cpp
+///   $ g++ lock_free_queue_wait_test.o -o lock_free_queue_wait_test -pthread -std=c++11
+///
+/// Expected output:
+///     0ms: main: busy spin: About to push and pop 20000 elements
+///     5ms: main: busy spin: Done!
+///     5ms: main: spin yield: About to push and pop 20000 elements
+///    10ms: main: spin yield: Done!
+///    10ms: main: park: About to push and pop 20000 elements
+///    20ms: main: park: Done!
+///    20ms: main: park: Waiting 100ms on an empty queue
+///   120ms: main: park: Timed out
+///   120ms: main: park: Waiting on an empty queue until someone pushes something
+///   220ms: producer: Pushing an element into the queue
+///   220ms: main: park: Woken up. Done!
+/// (the busy spin run is skipped in single processor machines)
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <string>
+#include <assert.h>
+#include <iomanip> // std::setw
+#include "lock_free_queue.h"
+
+#define QUEUE_SIZE 16
+#define N_ELEMENTS 20000
+
+class ArrayLockFreeQueueWaitTest
+{
+public:
+    ArrayLockFreeQueueWaitTest():
+        m_startTestTime(std::chrono::seconds(0)),
+        m_printMutex()
+    {}
+
+    virtual ~ArrayLockFreeQueueWaitTest()
+    {}
+
+    int run()
+    {
+        m_startTestTime = std::chrono::system_clock::now();
+
+        // a busy spinning thread only gives the processor away when the 
+        // scheduler preempts it. It needs a core of its own
+        if (std::thread::hardware_concurrency() > 1)
+        {
+            runPingPong<ArrayLockFreeQueueBusySpinWait>("busy spin");
+        }
+        runPingPong<ArrayLockFreeQueueSpinYieldWait>("spin yield");
+        runPingPong<ArrayLockFreeQueueParkWait>("park");
+
+        runParkTimeout();
+        closeTest();
+
+        return 0;
+    }
+
+private:
+    std::chrono::system_clock::time_point m_startTestTime;
+    std::mutex m_printMutex;
+
+    /// @brief a producer and a consumer blocking on a small queue. Both of 
+    ///        them have to wait for each other all the time
+    template <typename WAIT_T>
+    void runPingPong(const char* a_name)
+    {
+        typedef ArrayLockFreeQueue<
+            int, QUEUE_SIZE, ArrayLockFreeQueueSingleProducerSingleConsumer, WAIT_T> Queue_t;
+        Queue_t queue;
+
+        timedPrint("main", (std::string(a_name) + 
+            ": About to push and pop 20000 elements").c_str());
+
+        std::thread producer([&queue]()
+            {
+                for (int i = 0; i < N_ELEMENTS; i++)
+                {
+                    queue.push_wait(i);
+                }
+            });
+
+        int data;
+        for (int i = 0; i < N_ELEMENTS; i++)
+        {
+            queue.pop_wait(data);
+            assert(data == i);
+        }
+        producer.join();
+        assert(queue.pop(data) == false);
+
+        timedPrint("main", (std::string(a_name) + ": Done!").c_str());
+    }
+
+    /// @brief consumer parked in the futex until the timeout or a producer
+    ///        wakes it up
+    void runParkTimeout()
+    {
+        typedef ArrayLockFreeQueue<
+            int, QUEUE_SIZE, ArrayLockFreeQueueMultipleProducers, ArrayLockFreeQueueParkWait> Queue_t;
+        Queue_t queue;
+        int data;
+
+        timedPrint("main", "park: Waiting 100ms on an empty queue");
+        auto start = std::chrono::steady_clock::now();
+        assert(queue.pop_wait_for(data, std::chrono::milliseconds(100)) == false);
+        assert((std::chrono::steady_clock::now() - start) >= std::chrono::milliseconds(100));
+        timedPrint("main", "park: Timed out");
+
+        timedPrint("main", "park: Waiting on an empty queue until someone pushes something");
+        std::thread producer([this, &queue]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                timedPrint("producer", "Pushing an element into the queue");
+                assert(queue.push(1000) == true);
+            });
+
+        queue.pop_wait(data);
+        assert(data == 1000);
+        producer.join();
+
+        // push_wait_for on a full queue times out too
+        for (int i = 0; i < QUEUE_SIZE - 1; i++)
+        {
+            assert(queue.push(i) == true);
+        }
+        assert(queue.push_wait_for(QUEUE_SIZE, std::chrono::milliseconds(10)) == false);
+
+        int bulk[QUEUE_SIZE];
+        assert(queue.pop_bulk_wait_for(
+            bulk, QUEUE_SIZE, std::chrono::milliseconds(10)) == QUEUE_SIZE - 1);
+        assert(queue.pop_bulk_wait_for(
+            bulk, QUEUE_SIZE, std::chrono::milliseconds(10)) == 0);
+
+        timedPrint("main", "park: Woken up. Done!");
+    }
+
+    /// @brief close() wakes up the threads waiting with no timeout
+    void closeTest()
+    {
+        typedef ArrayLockFreeQueue<
+            int, QUEUE_SIZE, ArrayLockFreeQueueMultipleProducers, ArrayLockFreeQueueParkWait> Queue_t;
+        Queue_t queue;
+        int bulk[QUEUE_SIZE];
+
+        std::thread closer([&queue]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                queue.close();
+            });
+        assert(queue.pop_bulk_wait(bulk, QUEUE_SIZE) == 0);
+        closer.join();
+        assert(queue.closed());
+
+        // the elements pushed before closing the queue can still be popped.
+        // Nothing blocks once the queue is closed
+        assert(queue.push(1) == true);
+        assert(queue.pop_bulk_wait(bulk, QUEUE_SIZE) == 1);
+        assert(bulk[0] == 1);
+        assert(queue.pop_wait(bulk[0]) == false);
+        for (int i = 0; i < QUEUE_SIZE - 1; i++)
+        {
+            assert(queue.push(i) == true);
+        }
+        assert(queue.push_wait(QUEUE_SIZE) == false);
+    }
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+
+        std::unique_lock<std::mutex> lk(m_printMutex);
+        std::cout << std::setw(5)
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+        std::cout.flush();
+    }
+};
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    int waitResult;
+    ArrayLockFreeQueueWaitTest waitTest;
+
+    waitResult = waitTest.run();
+
+    return waitResult;
+}
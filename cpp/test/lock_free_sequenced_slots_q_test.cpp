@@ -0,0 +1,322 @@
+// ============================================================================
+/// @file  lock_free_sequenced_slots_q_test.cpp
+/// @brief Testing the circular array based lock free queue implementation
+///        Multiple producers and consumers with a sequence number per slot
+/// Compiling procedure:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c lock_free_sequenced_slots_q_test.cpp
+///   $ g++ lock_free_sequenced_slots_q_test.o -o lock_free_sequenced_slots_q_test -pthread -std=c++11
+///
+/// Expected output:
+///     0ms: main: Filling up the queue from the main thread
+///     0ms: main: Emptying the queue from the main thread
+///     0ms: main: About to create 3 consumers and 3 producers
+///     0ms: producer1: About to push 300000 elements
+///     0ms: producer2: About to push 300000 elements
+///     0ms: producer3: About to push 300000 elements
+///   650ms: producer2: Done!
+///   650ms: producer3: Done!
+///   655ms: producer1: Done!
+///   655ms: consumer1: Done!
+///   655ms: consumer3: Done!
+///   655ms: consumer2: Done!
+///   655ms: main: Every element was popped once and in order. Done!
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <functional> // std::bind
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <assert.h>
+#include <iomanip> // std::setw
+#include "lock_free_queue.h"
+
+#define QUEUE_SIZE  16
+#define N_PRODUCERS 3
+#define N_CONSUMERS 3
+#define N_ELEMENTS_PER_PRODUCER 300000
+
+class ArrayLockFreeQueueTest
+{
+public:
+
+    typedef ArrayLockFreeQueue<
+        uint64_t,
+        QUEUE_SIZE,
+        ArrayLockFreeQueueSequencedSlots> TestQueueType_t;
+
+    ArrayLockFreeQueueTest():
+        m_queue(),
+        m_startTestTime(std::chrono::seconds(0)),
+        m_printMutex(),
+        m_consumedElements(0)
+    {
+        for (int i = 0; i < N_PRODUCERS; i++)
+        {
+            m_sumPerProducer[i].store(0);
+        }
+    }
+
+    virtual ~ArrayLockFreeQueueTest()
+    {}
+
+    int run()
+    {
+        uint64_t data;
+        m_startTestTime = std::chrono::system_clock::now();
+
+        // all the Q_SIZE slots can be used in this implementation
+        timedPrint("main", "Filling up the queue from the main thread");
+        for (uint64_t i = 0; i < QUEUE_SIZE; i++)
+        {
+            assert(m_queue.push(i) == true);
+        }
+        assert(m_queue.full());
+        assert(m_queue.size() == QUEUE_SIZE);
+        assert(m_queue.push(QUEUE_SIZE) == false);
+
+        timedPrint("main", "Emptying the queue from the main thread");
+        for (uint64_t i = 0; i < QUEUE_SIZE; i++)
+        {
+            assert(m_queue.pop(data) == true);
+            assert(data == i);
+        }
+        assert(m_queue.size() == 0);
+        assert(m_queue.pop(data) == false);
+
+        // bulk operations
+        uint64_t bulkIn[QUEUE_SIZE + 5];
+        uint64_t bulkOut[QUEUE_SIZE + 5];
+        for (uint64_t i = 0; i < QUEUE_SIZE + 5; i++)
+        {
+            bulkIn[i] = i;
+        }
+        assert(m_queue.push_bulk(bulkIn, QUEUE_SIZE + 5) == QUEUE_SIZE);
+        assert(m_queue.push_bulk(bulkIn, 1) == 0);
+        assert(m_queue.pop_bulk(bulkOut, 4) == 4);
+        assert(m_queue.push_bulk(bulkIn, 2) == 2);
+        assert(m_queue.pop_bulk(bulkOut + 4, QUEUE_SIZE + 5) == QUEUE_SIZE - 2);
+        for (uint64_t i = 0; i < QUEUE_SIZE; i++)
+        {
+            assert(bulkOut[i] == i);
+        }
+        assert((bulkOut[QUEUE_SIZE] == 0) && (bulkOut[QUEUE_SIZE + 1] == 1));
+        assert(m_queue.pop_bulk(bulkOut, 1) == 0);
+
+        moveOnlyTest();
+        storageTest();
+
+        timedPrint("main", "About to create 3 consumers and 3 producers");
+        std::vector<std::thread> threads;
+        for (int i = 0; i < N_CONSUMERS; i++)
+        {
+            threads.push_back(std::thread(
+                std::bind(&ArrayLockFreeQueueTest::runConsumer, this, i)));
+        }
+        for (int i = 0; i < N_PRODUCERS; i++)
+        {
+            threads.push_back(std::thread(
+                std::bind(&ArrayLockFreeQueueTest::runProducer, this, i)));
+        }
+
+        for (std::size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i].join();
+        }
+
+        // every element of every producer must have been popped exactly once
+        uint64_t expectedSum =
+            (uint64_t(N_ELEMENTS_PER_PRODUCER) * (N_ELEMENTS_PER_PRODUCER - 1)) / 2;
+        for (int i = 0; i < N_PRODUCERS; i++)
+        {
+            assert(m_sumPerProducer[i].load() == expectedSum);
+        }
+        assert(m_queue.pop(data) == false);
+
+        timedPrint("main", "Every element was popped once and in order. Done!");
+
+        return 0;
+    }
+
+private:
+    TestQueueType_t m_queue;
+    std::chrono::system_clock::time_point m_startTestTime;
+    std::mutex m_printMutex;
+
+    /// number of elements popped by all the consumers
+    std::atomic<uint64_t> m_consumedElements;
+    /// sum of the sequence numbers popped per producer
+    std::atomic<uint64_t> m_sumPerProducer[N_PRODUCERS];
+
+    void runProducer(int a_id)
+    {
+        std::string name = "producer" + std::to_string(a_id + 1);
+
+        timedPrint(name.c_str(), "About to push 300000 elements");
+        for (uint64_t i = 0; i < N_ELEMENTS_PER_PRODUCER; i++)
+        {
+            // producer id in the upper 32 bits, sequence in the lower ones
+            while (m_queue.push((uint64_t(a_id) << 32) | i) == false)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        timedPrint(name.c_str(), "Done!");
+    }
+
+    void runConsumer(int a_id)
+    {
+        std::string name = "consumer" + std::to_string(a_id + 1);
+        const uint64_t total = uint64_t(N_PRODUCERS) * N_ELEMENTS_PER_PRODUCER;
+
+        // last sequence number seen from each producer. The queue is FIFO so
+        // the elements of a producer can only be seen in increasing order
+        int64_t lastSeen[N_PRODUCERS];
+        for (int i = 0; i < N_PRODUCERS; i++)
+        {
+            lastSeen[i] = -1;
+        }
+
+        uint64_t data;
+        while (m_consumedElements.load() < total)
+        {
+            if (m_queue.pop(data) == false)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            int      producer = static_cast<int>(data >> 32);
+            uint64_t sequence = data & 0xFFFFFFFF;
+            assert(producer < N_PRODUCERS);
+            assert(static_cast<int64_t>(sequence) > lastSeen[producer]);
+            lastSeen[producer] = sequence;
+
+            m_sumPerProducer[producer].fetch_add(sequence);
+            m_consumedElements.fetch_add(1);
+        }
+
+        timedPrint(name.c_str(), "Done!");
+    }
+
+    //////////////////////////////
+    // move-only and non default constructible elements
+    //
+    struct Tracked
+    {
+        explicit Tracked(int a_value): value(a_value) { s_alive++; }
+        Tracked(Tracked &&a_src): value(a_src.value) { s_alive++; }
+        Tracked& operator=(Tracked &&a_src) { value = a_src.value; return *this; }
+        ~Tracked() { s_alive--; }
+
+        Tracked(const Tracked&) = delete;
+        Tracked& operator=(const Tracked&) = delete;
+
+        int value;
+        static int s_alive;
+    };
+
+    void moveOnlyTest()
+    {
+        {
+            // the queue doesn't construct any element until something is pushed
+            ArrayLockFreeQueue<Tracked, QUEUE_SIZE, ArrayLockFreeQueueSequencedSlots> q;
+            assert(Tracked::s_alive == 0);
+
+            assert(q.emplace(1) == true);
+            assert(q.push(Tracked(2)) == true);
+            assert(Tracked::s_alive == 2);
+
+            Tracked out(0);
+            assert(q.pop(out) == true);
+            assert(out.value == 1);
+            assert(Tracked::s_alive == 2); // out and the one left in the queue
+
+            // the element left in the queue is destroyed with the queue
+            assert(q.emplace(3) == true);
+        }
+        assert(Tracked::s_alive == 0);
+
+        ArrayLockFreeQueue<std::unique_ptr<int>, QUEUE_SIZE, ArrayLockFreeQueueSequencedSlots> q;
+        std::unique_ptr<int> in(new int(42));
+        std::unique_ptr<int> out;
+        assert(q.push(std::move(in)) == true);
+        assert(q.emplace(new int(43)) == true);
+        assert(q.pop(out) == true);
+        assert(*out == 42);
+        assert(q.pop(out) == true);
+        assert(*out == 43);
+        assert(q.pop(out) == false);
+    }
+
+    //////////////////////////////
+    // size chosen at run time and memory that doesn't come from the heap
+    //
+    void storageTest()
+    {
+        typedef ArrayLockFreeQueue<
+            uint64_t, 0, ArrayLockFreeQueueSequencedSlots> RuntimeSizeQueue_t;
+
+        // rounded up to the next power of 2
+        RuntimeSizeQueue_t q1(1000);
+        assert(q1.capacity() == 1024);
+
+        const ArrayLockFreeQueueStorageOptions::Backing backings[] = 
+        {
+            ArrayLockFreeQueueStorageOptions::HEAP,
+            ArrayLockFreeQueueStorageOptions::MMAP,
+            ArrayLockFreeQueueStorageOptions::TRANSPARENT_HUGE_PAGES,
+            // it falls back to transparent huge pages if none are reserved
+            ArrayLockFreeQueueStorageOptions::HUGE_PAGES
+        };
+        for (std::size_t i = 0; i < sizeof(backings) / sizeof(backings[0]); i++)
+        {
+            // NUMA node 0 exists in every linux system
+            RuntimeSizeQueue_t q2(
+                64, ArrayLockFreeQueueStorageOptions(backings[i], 0, true));
+            assert(q2.capacity() == 64);
+
+            for (uint64_t j = 0; j < 64; j++)
+            {
+                assert(q2.push(j) == true);
+            }
+            assert(q2.push(64) == false);
+
+            uint64_t data;
+            for (uint64_t j = 0; j < 64; j++)
+            {
+                assert(q2.pop(data) == true);
+                assert(data == j);
+            }
+            assert(q2.pop(data) == false);
+        }
+    }
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+
+        std::unique_lock<std::mutex> lk(m_printMutex);
+        std::cout << std::setw(5)
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+        std::cout.flush();
+    }
+};
+
+int ArrayLockFreeQueueTest::Tracked::s_alive = 0;
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    int sequencedSlotsResult;
+    ArrayLockFreeQueueTest sequencedSlotsTest;
+
+    sequencedSlotsResult = sequencedSlotsTest.run();
+
+    return sequencedSlotsResult;
+}
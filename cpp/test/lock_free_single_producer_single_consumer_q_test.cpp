@@ -0,0 +1,222 @@
+// ============================================================================
+/// @file  lock_free_single_producer_single_consumer_q_test.cpp
+/// @brief Testing the circular array based lock free queue implementation
+///        (single producer single consumer implementation)
+/// Compiling procedure:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c lock_free_single_producer_single_consumer_q_test.cpp
+///   $ g++ lock_free_single_producer_single_consumer_q_test.o -o lock_free_single_producer_single_consumer_q_test -pthread -std=c++11
+///
+/// Expected output:
+///     0ms: main: Filling up the queue from the main thread
+///     0ms: main: Emptying the queue from the main thread
+///     0ms: main: About to create the consumer and the producer
+///     0ms: producer: About to push 1000000 elements
+///   250ms: producer: Done!
+///   250ms: consumer: Done! All elements were popped in order
+///   250ms: main: Done!
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <functional> // std::bind
+#include <mutex>
+#include <string>
+#include <assert.h>
+#include <iomanip> // std::setw
+#include "lock_free_queue.h"
+
+#define QUEUE_SIZE 15
+#define N_ELEMENTS 1000000
+
+class ArrayLockFreeQueueTest
+{
+public:
+
+    typedef ArrayLockFreeQueue<
+        int,
+        QUEUE_SIZE + 1,
+        ArrayLockFreeQueueSingleProducerSingleConsumer> TestQueueType_t;
+
+    ArrayLockFreeQueueTest():
+        m_queue(),
+        m_startTestTime(std::chrono::seconds(0)),
+        m_printMutex()
+    {}
+
+    virtual ~ArrayLockFreeQueueTest()
+    {}
+
+    int run()
+    {
+        int data;
+        m_startTestTime = std::chrono::system_clock::now();
+
+        // the main thread plays both roles before the threads are created
+        timedPrint("main", "Filling up the queue from the main thread");
+        assert(m_queue.size() == 0);
+        for (int i = 0; i < QUEUE_SIZE; i++)
+        {
+            assert(m_queue.push(i) == true);
+        }
+        assert(m_queue.full());
+        assert(m_queue.size() == QUEUE_SIZE);
+        assert(m_queue.push(QUEUE_SIZE) == false);
+
+        timedPrint("main", "Emptying the queue from the main thread");
+        for (int i = 0; i < QUEUE_SIZE; i++)
+        {
+            assert(m_queue.pop(data) == true);
+            assert(data == i);
+        }
+        assert(m_queue.size() == 0);
+        assert(m_queue.pop(data) == false);
+
+        // bulk operations. Only QUEUE_SIZE elements fit in the queue
+        int bulkIn[QUEUE_SIZE + 5];
+        int bulkOut[QUEUE_SIZE + 5];
+        for (int i = 0; i < QUEUE_SIZE + 5; i++)
+        {
+            bulkIn[i] = i;
+        }
+        assert(m_queue.push_bulk(bulkIn, QUEUE_SIZE + 5) == QUEUE_SIZE);
+        assert(m_queue.push_bulk(bulkIn, 1) == 0);
+        assert(m_queue.pop_bulk(bulkOut, 4) == 4);
+        assert(m_queue.push_bulk(bulkIn, 2) == 2);
+        assert(m_queue.pop_bulk(bulkOut + 4, QUEUE_SIZE + 5) == QUEUE_SIZE - 2);
+        for (int i = 0; i < QUEUE_SIZE; i++)
+        {
+            assert(bulkOut[i] == i);
+        }
+        assert((bulkOut[QUEUE_SIZE] == 0) && (bulkOut[QUEUE_SIZE + 1] == 1));
+        assert(m_queue.pop_bulk(bulkOut, 1) == 0);
+
+        moveOnlyTest();
+
+        timedPrint("main", "About to create the consumer and the producer");
+        m_producerThread.reset(new std::thread(std::bind(&ArrayLockFreeQueueTest::runProducer, this)));
+        m_consumerThread.reset(new std::thread(std::bind(&ArrayLockFreeQueueTest::runConsumer, this)));
+
+        m_producerThread->join();
+        m_consumerThread->join();
+
+        assert(m_queue.pop(data) == false);
+        timedPrint("main", "Done!");
+
+        return 0;
+    }
+
+private:
+    TestQueueType_t m_queue;
+    std::chrono::system_clock::time_point m_startTestTime;
+    std::mutex m_printMutex;
+
+    std::unique_ptr<std::thread> m_producerThread;
+    std::unique_ptr<std::thread> m_consumerThread;
+
+    void runProducer()
+    {
+        timedPrint("producer", "About to push 1000000 elements");
+        for (int i = 0; i < N_ELEMENTS; i++)
+        {
+            while (m_queue.push(i) == false)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        timedPrint("producer", "Done!");
+    }
+
+    void runConsumer()
+    {
+        int data;
+
+        for (int i = 0; i < N_ELEMENTS; i++)
+        {
+            while (m_queue.pop(data) == false)
+            {
+                std::this_thread::yield();
+            }
+
+            // there is only one producer. Strict order must be kept
+            assert(data == i);
+        }
+
+        timedPrint("consumer", "Done! All elements were popped in order");
+    }
+
+    //////////////////////////////
+    // move-only and non default constructible elements
+    //
+    struct Tracked
+    {
+        explicit Tracked(int a_value): value(a_value) { s_alive++; }
+        Tracked(Tracked &&a_src): value(a_src.value) { s_alive++; }
+        Tracked& operator=(Tracked &&a_src) { value = a_src.value; return *this; }
+        ~Tracked() { s_alive--; }
+
+        Tracked(const Tracked&) = delete;
+        Tracked& operator=(const Tracked&) = delete;
+
+        int value;
+        static int s_alive;
+    };
+
+    void moveOnlyTest()
+    {
+        {
+            // the queue doesn't construct any element until something is pushed
+            ArrayLockFreeQueue<Tracked, QUEUE_SIZE + 1, ArrayLockFreeQueueSingleProducerSingleConsumer> q;
+            assert(Tracked::s_alive == 0);
+
+            assert(q.emplace(1) == true);
+            assert(q.push(Tracked(2)) == true);
+            assert(Tracked::s_alive == 2);
+
+            Tracked out(0);
+            assert(q.pop(out) == true);
+            assert(out.value == 1);
+            assert(Tracked::s_alive == 2); // out and the one left in the queue
+
+            // the element left in the queue is destroyed with the queue
+            assert(q.emplace(3) == true);
+        }
+        assert(Tracked::s_alive == 0);
+
+        ArrayLockFreeQueue<std::unique_ptr<int>, QUEUE_SIZE + 1, ArrayLockFreeQueueSingleProducerSingleConsumer> q;
+        std::unique_ptr<int> in(new int(42));
+        std::unique_ptr<int> out;
+        assert(q.push(std::move(in)) == true);
+        assert(q.emplace(new int(43)) == true);
+        assert(q.pop(out) == true);
+        assert(*out == 42);
+        assert(q.pop(out) == true);
+        assert(*out == 43);
+        assert(q.pop(out) == false);
+    }
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+
+        std::unique_lock<std::mutex> lk(m_printMutex);
+        std::cout << std::setw(5)
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+        std::cout.flush();
+    }
+};
+
+int ArrayLockFreeQueueTest::Tracked::s_alive = 0;
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    int spscResult;
+    ArrayLockFreeQueueTest spscTest;
+
+    spscResult = spscTest.run();
+
+    return spscResult;
+}
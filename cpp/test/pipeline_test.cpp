@@ -0,0 +1,229 @@
+// ============================================================================
+/// @file  pipeline_test.cpp
+/// @brief file to test the Pipeline class
+/// Compiling procedure:
+///   $ g++ -I.. -g -O0 -Wall -std=c++11 -D_REENTRANT -c pipeline_test.cpp 
+///   $ g++ pipeline_test.o -o pipeline_test -pthread
+///
+/// Expected output: 
+///    3ms: main: stage parse: threads=2 fused=0 processed=10000 dropped=0
+///    3ms: main: stage even: threads=2 fused=1 processed=10000 dropped=5000
+///    3ms: main: stage sum: threads=1 fused=0 processed=5000 dropped=0
+///    5ms: main: every element went through the lock-free pipeline
+///    9ms: main: move only elements went through the pipeline of delegates
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <iomanip> // std::setw
+#include <sstream> // std::stringstream
+#include <string>
+#include <vector>
+#include <memory>  // std::unique_ptr
+#include <atomic>
+#include <thread>
+#include <assert.h>
+
+#include "pipeline.h"
+#include "lock_free_queue_adapter.h"
+#include "delegate/Delegate.h"
+
+#define PIPELINE_TEST_ELEMENTS 10000
+
+class PipelineTest
+{
+public:
+    PipelineTest():
+        m_startTestTime(std::chrono::system_clock::now())
+    {}
+
+    int run();
+
+private:
+    std::chrono::system_clock::time_point m_startTestTime;
+
+    void stagesTest();
+    void lockFreeTest();
+    void delegateTest();
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+        std::cout << std::setw(5) 
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+    }
+};
+
+int main()
+{
+    PipelineTest thePipelineTest;
+    return thePipelineTest.run();
+}
+
+int PipelineTest::run()
+{
+    stagesTest();
+    lockFreeTest();
+    delegateTest();
+
+    return 0;
+}
+
+void PipelineTest::stagesTest()
+{
+    // parse runs on 2 threads, even is fused with it and drops the odd 
+    // numbers, sum runs on a thread of its own
+    std::atomic<long> sum(0);
+    Pipeline<std::string> pipeline;
+    // a group of stages needs threads, and the first stage always starts one
+    // (it can't be fused)
+    assert(pipeline.AddStage("none", 
+        [](std::string &) { return true; }, 
+        PipelineStageConfig(0, true)) == PIPELINE_INVALID_STAGE);
+    assert(pipeline.GetNumStages() == 0);
+    assert(pipeline.AddStage("parse", 
+        [](std::string &a_data) 
+        { 
+            a_data = std::to_string(std::stol(a_data) * 2 + (std::stol(a_data) % 2));
+            return true;
+        }, 
+        PipelineStageConfig(2)) == 0);
+    assert(pipeline.AddStage("even", 
+        [](std::string &a_data) { return (std::stol(a_data) % 2) == 0; }, 
+        PipelineStageConfig(1, true)) == 1);
+    assert(pipeline.AddStage("sum", 
+        [&sum](std::string &a_data) { sum.fetch_add(std::stol(a_data)); return true; }) == 2);
+    assert(pipeline.AddStage("none", 
+        [](std::string &) { return true; }, 
+        PipelineStageConfig(0)) == PIPELINE_INVALID_STAGE);
+    assert(pipeline.GetNumStages() == 3);
+    pipeline.Start(64);
+
+    // statistics can be read from another thread while the pipeline runs 
+    // and while it is joined
+    std::atomic<bool> joined(false);
+    std::thread monitor([&pipeline, &joined]()
+        {
+            std::vector<PipelineStageStats> running;
+            while (!joined.load())
+            {
+                pipeline.GetStats(running);
+                assert(running.size() == 3);
+            }
+        });
+
+    for (int i = 0; i < PIPELINE_TEST_ELEMENTS; i++)
+    {
+        pipeline.ProduceOrBlock(std::to_string(i));
+    }
+    pipeline.Join();
+    joined.store(true);
+    monitor.join();
+
+    // sum of 2 * i for the even i
+    long expected = 0;
+    for (long i = 0; i < PIPELINE_TEST_ELEMENTS; i += 2)
+    {
+        expected += 2 * i;
+    }
+    assert(sum.load() == expected);
+
+    std::vector<PipelineStageStats> stats;
+    pipeline.GetStats(stats);
+    assert(stats.size() == 3);
+    assert((stats[0].m_name == "parse") && (stats[0].m_threads == 2) && !stats[0].m_fused);
+    assert((stats[1].m_name == "even") && (stats[1].m_threads == 2) && stats[1].m_fused);
+    assert((stats[2].m_name == "sum") && (stats[2].m_threads == 1) && !stats[2].m_fused);
+    assert((stats[0].m_processed == PIPELINE_TEST_ELEMENTS) && (stats[0].m_dropped == 0));
+    assert((stats[1].m_processed == PIPELINE_TEST_ELEMENTS) && 
+           (stats[1].m_dropped == PIPELINE_TEST_ELEMENTS / 2));
+    assert((stats[2].m_processed == PIPELINE_TEST_ELEMENTS / 2) && (stats[2].m_dropped == 0));
+    for (std::size_t i = 0; i < stats.size(); i++)
+    {
+        assert(stats[i].m_throughput > 0);
+        assert(stats[i].m_queueDepth == 0);
+
+        std::stringstream strStream;
+        strStream << "stage " << stats[i].m_name 
+                  << ": threads=" << stats[i].m_threads
+                  << " fused=" << stats[i].m_fused
+                  << " processed=" << stats[i].m_processed
+                  << " dropped=" << stats[i].m_dropped;
+        timedPrint("main", strStream.str().c_str());
+    }
+}
+
+void PipelineTest::lockFreeTest()
+{
+    // on top of lock-free queues. Several producers hand elements to each
+    // thread, so multiple producer queues are needed
+    typedef ArrayLockFreeQueueAdapter<int, 0, ArrayLockFreeQueueSequencedSlots, 
+        ArrayLockFreeQueueParkWait> Queue_t;
+
+    std::atomic<long> sum(0);
+    std::atomic<int> count(0);
+    {
+        Pipeline<int, Queue_t> pipeline;
+        pipeline.AddStage("double", 
+            [](int &a_data) { a_data *= 2; return true; }, PipelineStageConfig(3));
+        pipeline.AddStage("increment", 
+            [](int &a_data) { a_data += 1; return true; }, PipelineStageConfig(2));
+        pipeline.AddStage("sum", 
+            [&sum, &count](int &a_data) 
+            { 
+                sum.fetch_add(a_data); 
+                count.fetch_add(1); 
+                return true; 
+            }, 
+            PipelineStageConfig(1, true));
+        pipeline.Start(16);
+
+        for (int i = 0; i < PIPELINE_TEST_ELEMENTS; i++)
+        {
+            pipeline.ProduceOrBlock(i);
+        }
+        // joined by the destructor
+    }
+
+    assert(count.load() == PIPELINE_TEST_ELEMENTS);
+    assert(sum.load() == 
+        2L * (PIPELINE_TEST_ELEMENTS - 1) * PIPELINE_TEST_ELEMENTS / 2 + PIPELINE_TEST_ELEMENTS);
+    timedPrint("main", "every element went through the lock-free pipeline");
+}
+
+void PipelineTest::delegateTest()
+{
+    // move only elements, moved from stage to stage. Delegates instead of 
+    // std::function
+    typedef std::unique_ptr<int> Elem_t;
+    std::atomic<long> sum(0);
+
+    Pipeline<Elem_t, SafeQueue<Elem_t>, Delegate> pipeline;
+    pipeline.AddStage("square", 
+        [](Elem_t &a_data) { *a_data = *a_data * *a_data; return true; });
+    pipeline.AddStage("sink", 
+        [&sum](Elem_t &a_data) 
+        { 
+            Elem_t owned(std::move(a_data));
+            sum.fetch_add(*owned); 
+            return true; 
+        }, 
+        PipelineStageConfig(2));
+    pipeline.Start();
+
+    for (int i = 0; i < 100; i++)
+    {
+        Elem_t elem(new int(i));
+        assert(pipeline.Produce(std::move(elem)));
+        assert(elem.get() == 0);
+    }
+    pipeline.Join();
+
+    assert(sum.load() == 328350);
+
+    std::vector<PipelineStageStats> stats;
+    pipeline.GetStats(stats);
+    assert((stats[0].m_processed == 100) && (stats[1].m_processed == 100));
+    timedPrint("main", "move only elements went through the pipeline of delegates");
+}
@@ -0,0 +1,303 @@
+// ============================================================================
+/// @file  priority_safe_queue_test.cpp
+/// @brief Testing the thread-safe queue served by priority (or by deadline)
+/// Compiling procedure:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c priority_safe_queue_test.cpp
+///   $ g++ priority_safe_queue_test.o -o priority_safe_queue_test
+///
+/// Expected output:
+///     0ms: main: Checking lanes, deadlines, close and stats
+///    33ms: main: Bulk data queued up in the consumer thread
+///   123ms: main: heartbeat consumed before the bulk data
+///   123ms: main: Done!
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <assert.h>
+#include <iomanip> // std::setw
+#include "priority_safe_queue.h"
+#include "consumer_thread.h"
+
+#define QUEUE_SIZE 10
+
+/// @brief message with a priority. Heartbeats go in the highest lane
+struct Msg
+{
+    enum Type { BULK = 0, CANCEL = 2, HEARTBEAT = 3 };
+
+    Msg(): m_type(BULK), m_seq(0) {}
+    Msg(Type a_type, int a_seq): m_type(a_type), m_seq(a_seq) {}
+
+    std::size_t Priority() const { return m_type; }
+
+    Type m_type;
+    int  m_seq;
+};
+
+/// @brief task with a deadline
+struct Task
+{
+    Task(): m_deadline(), m_id(0) {}
+    Task(std::chrono::steady_clock::time_point a_deadline, int a_id): 
+        m_deadline(a_deadline), m_id(a_id) {}
+
+    std::chrono::steady_clock::time_point Deadline() const { return m_deadline; }
+
+    std::chrono::steady_clock::time_point m_deadline;
+    int m_id;
+};
+
+class PrioritySafeQueueTest
+{
+public:
+    PrioritySafeQueueTest():
+        m_startTestTime(std::chrono::seconds(0)),
+        m_printMutex()
+    {}
+
+    virtual ~PrioritySafeQueueTest()
+    {}
+
+    int run()
+    {
+        m_startTestTime = std::chrono::system_clock::now();
+
+        timedPrint("main", "Checking lanes, deadlines, close and stats");
+        lanesTest();
+        deadlineTest();
+        closeTest();
+        statsTest();
+
+        consumerThreadTest();
+
+        timedPrint("main", "Done!");
+        return 0;
+    }
+
+private:
+    std::chrono::system_clock::time_point m_startTestTime;
+    std::mutex m_printMutex;
+
+    //////////////////////////////
+    // highest lane first. FIFO inside each lane
+    //
+    void lanesTest()
+    {
+        PrioritySafeQueue<Msg> q(QUEUE_SIZE);
+        Msg out;
+
+        q.Push(Msg(Msg::BULK, 0));
+        q.Push(Msg(Msg::BULK, 1));
+        assert(q.TryPush(Msg(Msg::CANCEL, 2)));
+        q.Emplace(Msg::HEARTBEAT, 3);
+        assert(q.TryEmplace(Msg::CANCEL, 4));
+        // explicit lane. It doesn't matter what the element says
+        q.Push(Msg(Msg::BULK, 5), 1);
+        // lanes out of range go to the highest one
+        assert(q.TryPush(Msg(Msg::BULK, 6), 100));
+
+        int expected[] = {3, 6, 2, 4, 5, 0, 1};
+        for (int i = 0; i < 7; i++)
+        {
+            assert(q.TryPop(out));
+            assert(out.m_seq == expected[i]);
+        }
+        assert(q.IsEmpty());
+        assert(q.TryPop(out) == false);
+
+        // bulk calls
+        Msg in[QUEUE_SIZE + 2];
+        for (int i = 0; i < QUEUE_SIZE + 2; i++)
+        {
+            in[i] = Msg((i % 3 == 0) ? Msg::HEARTBEAT : Msg::BULK, i);
+        }
+        assert(q.TryPushBulk(in, QUEUE_SIZE + 2) == QUEUE_SIZE);
+        assert(q.TryPush(in[0]) == false);
+
+        Msg outBulk[QUEUE_SIZE];
+        assert(q.TryPopBulk(outBulk, 4) == 4);
+        assert((outBulk[0].m_seq == 0) && (outBulk[1].m_seq == 3) &&
+               (outBulk[2].m_seq == 6) && (outBulk[3].m_seq == 9));
+        assert(q.TimedWaitPopBulk(
+            outBulk, QUEUE_SIZE, std::chrono::microseconds(0)) == QUEUE_SIZE - 4);
+        assert((outBulk[0].m_seq == 1) && (outBulk[5].m_seq == 8));
+        assert(q.TimedWaitPop(out, std::chrono::microseconds(1000)) == false);
+
+        // the element is not modified if the push fails
+        PrioritySafeQueue<std::unique_ptr<int>, PrioritySafeQueueLanes<2> > q2(1);
+        std::unique_ptr<int> elem(new int(1));
+        std::unique_ptr<int> outElem;
+        assert(q2.TryPush(std::move(elem), 0));
+        elem.reset(new int(2));
+        assert(q2.TryPush(std::move(elem), 1) == false);
+        assert(elem.get() != 0);
+        q2.Pop(outElem);
+        assert(*outElem == 1);
+    }
+
+    //////////////////////////////
+    // earliest deadline first. FIFO for equal deadlines
+    //
+    void deadlineTest()
+    {
+        typedef PrioritySafeQueue<Task, PrioritySafeQueueDeadline<> > EdfQueue_t;
+        EdfQueue_t q(QUEUE_SIZE);
+        Task out;
+
+        auto now = std::chrono::steady_clock::now();
+        q.Push(Task(now + std::chrono::milliseconds(30), 0));
+        q.Push(Task(now + std::chrono::milliseconds(10), 1));
+        q.Emplace(now + std::chrono::milliseconds(20), 2);
+        assert(q.TryPush(Task(now + std::chrono::milliseconds(10), 3)));
+        // explicit deadline
+        q.Push(Task(now, 4), now + std::chrono::milliseconds(5));
+        assert(q.TryPush(Task(now, 5), now + std::chrono::milliseconds(40)));
+
+        int expected[] = {4, 1, 3, 2, 0, 5};
+        for (int i = 0; i < 6; i++)
+        {
+            assert(q.TryPop(out));
+            assert(out.m_id == expected[i]);
+        }
+        assert(q.IsEmpty());
+
+        // the heap keeps working as it grows (the queue is unbounded) and 
+        // elements go in in reverse order of deadline
+        PrioritySafeQueue<int, PrioritySafeQueueDeadline<> > q2;
+        for (int i = 0; i < 1000; i++)
+        {
+            q2.Push(i, now + std::chrono::microseconds(1000 - i));
+        }
+        int outInt[10];
+        std::size_t count;
+        int expectedInt = 999;
+        while ((count = q2.TryPopBulk(outInt, 10)) > 0)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                assert(outInt[i] == expectedInt--);
+            }
+        }
+        assert(expectedInt == -1);
+    }
+
+    //////////////////////////////
+    // Close wakes up blocked threads and rejects new elements
+    //
+    void closeTest()
+    {
+        PrioritySafeQueue<Msg> q(1);
+        Msg out[2];
+
+        std::thread consumer([&q, &out]()
+            {
+                assert(q.WaitPopBulk(out, 2) == 1);
+                assert(out[0].m_seq == 1);
+                assert(q.WaitPopBulk(out, 2) == 0);
+            });
+        q.Push(Msg(Msg::BULK, 1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        q.Close();
+        consumer.join();
+        assert(q.IsClosed());
+        assert(q.TryPush(Msg(Msg::BULK, 2)) == false);
+        assert(q.TryEmplace(Msg::BULK, 2) == false);
+        q.Push(Msg(Msg::BULK, 3));
+        assert(q.IsEmpty());
+
+        // a producer blocked on a full queue gives up
+        PrioritySafeQueue<Msg> q2(1);
+        q2.Push(Msg(Msg::BULK, 4));
+        std::thread producer([&q2]()
+            {
+                q2.Push(Msg(Msg::HEARTBEAT, 5));
+            });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        q2.Close();
+        producer.join();
+        assert(q2.TimedWaitPopBulk(out, 2, std::chrono::seconds(1)) == 1);
+        assert(out[0].m_seq == 4);
+    }
+
+    //////////////////////////////
+    // statistics policy
+    //
+    void statsTest()
+    {
+        PrioritySafeQueue<Msg, PrioritySafeQueueLanes<4>, QueueStats> q(2);
+        Msg out;
+        q.Push(Msg(Msg::BULK, 0));
+        q.Push(Msg(Msg::HEARTBEAT, 1));
+        assert(q.TryPush(Msg(Msg::BULK, 2)) == false);
+        assert(q.TryPop(out) && (out.m_seq == 1));
+        assert(q.TryPop(out) && (out.m_seq == 0));
+
+        QueueStatsSnapshot stats;
+        q.GetStats(stats);
+        assert(stats.m_pushes == 2);
+        assert(stats.m_pops == 2);
+        assert(stats.m_pushesFull == 1);
+        assert(stats.m_highWaterMark == 2);
+        assert(stats.m_timeInQueue.Count() == 2);
+    }
+
+    //////////////////////////////
+    // a heartbeat goes past the bulk data already queued up in a consumer
+    // thread
+    //
+    void consumerThreadTest()
+    {
+        std::vector<int> consumed;
+        std::mutex consumedMutex;
+        ConsumerThread<Msg, PrioritySafeQueue<Msg> > consumer(
+            [&consumed, &consumedMutex](Msg a_msg)
+            {
+                // the first element keeps the consumer busy while the rest
+                // are queued up
+                if (a_msg.m_seq == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+                std::lock_guard<std::mutex> lk(consumedMutex);
+                consumed.push_back(a_msg.m_seq);
+            });
+
+        consumer.Produce(Msg(Msg::BULK, 0));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        for (int i = 1; i <= 5; i++)
+        {
+            consumer.Produce(Msg(Msg::BULK, i));
+        }
+        consumer.Emplace(Msg::HEARTBEAT, 6);
+        timedPrint("main", "Bulk data queued up in the consumer thread");
+        consumer.Join();
+
+        assert(consumed.size() == 7);
+        assert((consumed[0] == 0) && (consumed[1] == 6) && (consumed[2] == 1));
+        assert(consumed[6] == 5);
+
+        timedPrint("main", "heartbeat consumed before the bulk data");
+    }
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+
+        std::unique_lock<std::mutex> lk(m_printMutex);
+        std::cout << std::setw(5)
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+        std::cout.flush();
+    }
+};
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    PrioritySafeQueueTest thePrioritySafeQueueTest;
+    return thePrioritySafeQueueTest.run();
+}
@@ -51,11 +51,37 @@
 #include <chrono>
 #include <memory>
 #include <thread>
+#include <functional> // std::bind
 #include <string>
+#include <stdexcept> // std::runtime_error
 #include <assert.h>
 #include <iomanip> // std::setw
 #include "safe_queue.h"
 
+/// @brief element whose copies can be made to fail. Its move constructor may 
+///        throw, so RingBuffer copies it when it grows
+struct RingBufferThrower
+{
+    static int s_alive;
+    static int s_copiesLeft;
+
+    explicit RingBufferThrower(int a_value): m_value(a_value) { s_alive++; }
+    RingBufferThrower(const RingBufferThrower &a_src): m_value(a_src.m_value)
+    {
+        if (s_copiesLeft-- == 0)
+        {
+            throw std::runtime_error("copy failed");
+        }
+        s_alive++;
+    }
+    RingBufferThrower(RingBufferThrower &&a_src): m_value(a_src.m_value) { s_alive++; }
+    ~RingBufferThrower() { s_alive--; }
+
+    int m_value;
+};
+int RingBufferThrower::s_alive = 0;
+int RingBufferThrower::s_copiesLeft = 0;
+
 #define QUEUE_SIZE 10
 
 class SafeQueueTest
@@ -76,6 +102,11 @@ public:
         
         copyConstructorTest();
         moveContructorTest();
+        bulkTest();
+        moveOnlyTest();
+        closeTest();
+        statsTest();
+        ringBufferTest();
         
         timedPrint("main", "About to create the consumer and the producer");
         m_producerThread.reset(new std::thread(std::bind(&SafeQueueTest::runProducer, this)));
@@ -221,6 +252,302 @@ private:
         assert(q2.IsEmpty());
     }
     
+    //////////////////////////////
+    // push/pop bulk tests
+    //
+    void bulkTest()
+    {
+        int in[QUEUE_SIZE + 5];
+        int out[QUEUE_SIZE + 5];
+        for (int i = 0; i < QUEUE_SIZE + 5; i++)
+        {
+            in[i] = i;
+        }
+
+        SafeQueue<int> q(QUEUE_SIZE);
+
+        // only QUEUE_SIZE elements fit in the queue
+        assert(q.TryPushBulk(in, QUEUE_SIZE + 5) == QUEUE_SIZE);
+        assert(q.TryPushBulk(in, 1) == 0);
+
+        assert(q.TryPopBulk(out, 3) == 3);
+        assert((out[0] == 0) && (out[1] == 1) && (out[2] == 2));
+        assert(q.TimedWaitPopBulk(
+            out, QUEUE_SIZE + 5, std::chrono::microseconds(0)) == QUEUE_SIZE - 3);
+        assert((out[0] == 3) && (out[QUEUE_SIZE - 4] == QUEUE_SIZE - 1));
+
+        assert(q.IsEmpty());
+        assert(q.TryPopBulk(out, 1) == 0);
+        assert(q.TimedWaitPopBulk(out, 1, std::chrono::microseconds(1000)) == 0);
+    }
+
+    //////////////////////////////
+    // move-only elements
+    //
+    void moveOnlyTest()
+    {
+        SafeQueue<std::unique_ptr<int> > q1(2);
+        std::unique_ptr<int> elem(new int(1));
+        std::unique_ptr<int> out;
+
+        q1.Push(std::move(elem));
+        assert(elem.get() == 0);
+        assert(q1.TryEmplace(new int(2)) == true);
+
+        // the queue is full. elem must be left untouched
+        elem.reset(new int(3));
+        assert(q1.TryPush(std::move(elem)) == false);
+        assert(elem.get() != 0);
+
+        // move constructor. The elements are moved, not copied
+        SafeQueue<std::unique_ptr<int> > q2(std::move(q1));
+        q2.Pop(out);
+        assert(*out == 1);
+        assert(q2.TryPop(out) == true);
+        assert(*out == 2);
+        assert(q2.IsEmpty());
+
+        q2.Emplace(new int(4));
+        assert(q2.TimedWaitPop(out, std::chrono::microseconds(0)) == true);
+        assert(*out == 4);
+    }
+
+    //////////////////////////////
+    // Close wakes up blocked threads and rejects new elements
+    //
+    void closeTest()
+    {
+        SafeQueue<int> q(2);
+        int out[2];
+
+        // a consumer blocked with no timeout on an empty queue
+        std::thread consumer([&q, &out]()
+            {
+                assert(q.WaitPopBulk(out, 2) == 1);
+                assert(out[0] == 1);
+                assert(q.WaitPopBulk(out, 2) == 0);
+            });
+        q.Push(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        q.Close();
+        consumer.join();
+        assert(q.IsClosed());
+
+        // nothing goes into a closed queue
+        assert(q.TryPush(2) == false);
+        assert(q.TryPushBulk(out, 2) == 0);
+        q.Push(3);
+        assert(q.IsEmpty());
+        assert(q.TimedWaitPop(out[0], std::chrono::seconds(1)) == false);
+
+        // the elements pushed before closing the queue can still be popped,
+        // and a producer blocked on a full queue gives up
+        SafeQueue<int> q2(1);
+        q2.Push(4);
+        std::thread producer([&q2]()
+            {
+                q2.Push(5);
+            });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        q2.Close();
+        producer.join();
+        assert(q2.TimedWaitPopBulk(out, 2, std::chrono::seconds(1)) == 1);
+        assert(out[0] == 4);
+        assert(q2.IsEmpty());
+    }
+
+    //////////////////////////////
+    // statistics policy
+    //
+    void statsTest()
+    {
+        // every value falls in a bucket whose lower bound is not above it
+        for (uint64_t value = 0; value < 100000; value += 7)
+        {
+            uint32_t index = QueueStatsHistogram::BucketIndex(value);
+            assert(QueueStatsHistogram::BucketLowerBound(index) <= value);
+            assert(QueueStatsHistogram::BucketLowerBound(index + 1) > value);
+        }
+
+        SafeQueue<int, QueueStats> q(4);
+        int out[4] = {0, 0, 0, 0};
+        q.Push(1);
+        q.Push(2);
+        assert(q.TryPushBulk(out, 4) == 2);
+        assert(q.TryPush(3) == false);
+        q.Pop(out[0]);
+        assert(out[0] == 1);
+        assert(q.TryPopBulk(out, 4) == 3);
+
+        QueueStatsSnapshot stats;
+        q.GetStats(stats);
+        assert(stats.m_pushes == 4);
+        assert(stats.m_pops == 4);
+        assert(stats.m_pushesFull == 2);
+        assert(stats.m_highWaterMark == 4);
+        assert(stats.m_timeInQueue.Count() == 4);
+        assert(stats.m_timeInQueue.Percentile(50.0) <= 
+               stats.m_timeInQueue.Percentile(100.0));
+
+        // the default policy keeps nothing
+        SafeQueue<int> q2(4);
+        q2.Push(1);
+        q2.GetStats(stats);
+        assert((stats.m_pushes == 0) && (stats.m_timeInQueue.Count() == 0));
+    }
+
+    //////////////////////////////
+    // storage of the queue
+    //
+    void ringBufferTest()
+    {
+        // elements wrap around the end of the array and keep their order
+        RingBuffer<int> rb(4);
+        assert(rb.capacity() == 4);
+        int next = 0;
+        for (int i = 0; i < 10; i++)
+        {
+            rb.push(i * 2);
+            rb.push(i * 2 + 1);
+            assert(rb.front() == next);
+            rb.pop();
+            next++;
+        }
+        assert((rb.size() == 10) && (rb.front() == next));
+        assert(rb.capacity() == 16);
+
+        // clear keeps the memory. Copies keep the capacity and the order
+        RingBuffer<int> copy(rb);
+        rb.clear();
+        assert(rb.empty() && (rb.capacity() == 16));
+        assert((copy.size() == 10) && (copy.capacity() == 16));
+        for (int i = 0; i < 10; i++)
+        {
+            assert(copy.front() == next + i);
+            copy.pop();
+        }
+
+        // elements are destroyed with the buffer, and moved when it grows
+        std::shared_ptr<int> elem(new int(1));
+        {
+            RingBuffer<std::shared_ptr<int> > rb2;
+            assert(rb2.capacity() == 0);
+            for (int i = 0; i < RING_BUFFER_MIN_CAPACITY + 1; i++)
+            {
+                rb2.push(elem);
+            }
+            assert(elem.use_count() == RING_BUFFER_MIN_CAPACITY + 2);
+
+            RingBuffer<std::shared_ptr<int> > rb3(std::move(rb2));
+            assert(rb2.empty() && (rb2.capacity() == 0));
+            rb3.pop();
+            assert(elem.use_count() == RING_BUFFER_MIN_CAPACITY + 1);
+        }
+        assert(elem.use_count() == 1);
+
+        // the new element is constructed before the buffer grows, so it can
+        // be a copy of one of the elements in it
+        {
+            RingBuffer<std::string> rb4;
+            for (int i = 0; i < RING_BUFFER_MIN_CAPACITY; i++)
+            {
+                rb4.push(std::string(64, static_cast<char>('a' + i)));
+            }
+            assert(rb4.size() == rb4.capacity());
+            rb4.emplace(rb4.front());
+            assert(rb4.capacity() == 2 * RING_BUFFER_MIN_CAPACITY);
+            for (int i = 0; i < RING_BUFFER_MIN_CAPACITY; i++)
+            {
+                assert(rb4.front() == std::string(64, static_cast<char>('a' + i)));
+                rb4.pop();
+            }
+            assert((rb4.size() == 1) && (rb4.front() == std::string(64, 'a')));
+        }
+
+        // a copy failing while the buffer grows leaves it as it was
+        {
+            RingBuffer<RingBufferThrower> rb5;
+            for (int i = 0; i < RING_BUFFER_MIN_CAPACITY; i++)
+            {
+                rb5.emplace(i);
+            }
+            RingBufferThrower::s_copiesLeft = 5;
+            bool thrown = false;
+            try
+            {
+                rb5.emplace(RING_BUFFER_MIN_CAPACITY);
+            }
+            catch (const std::runtime_error &)
+            {
+                thrown = true;
+            }
+            assert(thrown);
+            assert((rb5.size() == RING_BUFFER_MIN_CAPACITY) && 
+                   (rb5.capacity() == RING_BUFFER_MIN_CAPACITY));
+            assert(RingBufferThrower::s_alive == RING_BUFFER_MIN_CAPACITY);
+            for (int i = 0; i < RING_BUFFER_MIN_CAPACITY; i++)
+            {
+                assert(rb5.front().m_value == i);
+                rb5.pop();
+            }
+        }
+        assert(RingBufferThrower::s_alive == 0);
+
+        // popping never gives memory back (nor allocates). shrink_to_fit 
+        // does, down to what was reserved
+        {
+            RingBuffer<int> rb6;
+            for (int i = 0; i < 1024; i++)
+            {
+                rb6.push(i);
+            }
+            assert(rb6.capacity() == 1024);
+            for (int i = 0; i < 1000; i++)
+            {
+                assert(rb6.front() == i);
+                rb6.pop();
+            }
+            assert(rb6.capacity() == 1024);
+            rb6.shrink_to_fit();
+            assert((rb6.size() == 24) && (rb6.capacity() == 24));
+            for (int i = 1000; i < 1024; i++)
+            {
+                assert(rb6.front() == i);
+                rb6.pop();
+            }
+            rb6.shrink_to_fit();
+            assert(rb6.empty() && (rb6.capacity() == 0));
+            rb6.push(1);
+            assert((rb6.front() == 1) && (rb6.capacity() == RING_BUFFER_MIN_CAPACITY));
+
+            RingBuffer<int> rb7(100);
+            for (int i = 0; i < 1000; i++)
+            {
+                rb7.push(i);
+            }
+            assert(rb7.capacity() > 1000);
+            for (int i = 0; i < 1000; i++)
+            {
+                rb7.pop();
+            }
+            rb7.shrink_to_fit();
+            assert(rb7.capacity() == 100);
+        }
+
+        // unbounded queues keep growing
+        SafeQueue<int> q;
+        for (int i = 0; i < 1000; i++)
+        {
+            q.Push(i);
+        }
+        for (int i = 0; i < 1000; i++)
+        {
+            int out = -1;
+            assert(q.TryPop(out) && (out == i));
+        }
+        assert(q.IsEmpty());
+    }
+
     void timedPrint(const char* a_who, const char* a_msg)
     {
         auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
@@ -1,5 +1,9 @@
 #include <iostream>
 #include <assert.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
 #include "singleton.h"
 
 // compilation: 
@@ -20,13 +24,38 @@ private:
     virtual ~MySingleton() {}
 };
 
+/// a singleton that takes a while to build, so the threads that try to 
+/// use it first have to wait for it
+class SlowSingleton :
+    public Singleton<SlowSingleton>
+{
+public:
+    static std::atomic<int> m_constructions;
+    int m_value;
+
+private:
+    friend class Singleton<SlowSingleton>;
+
+    SlowSingleton(): m_value(0)
+    {
+        m_constructions.fetch_add(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        m_value = 42;
+    }
+    virtual ~SlowSingleton() {}
+};
+
+std::atomic<int> SlowSingleton::m_constructions(0);
+
+#define SINGLETON_TEST_THREADS 8
+
 class SingletonTest
 {
 public:
-    // TODO check thread safety of initialisation
     int run(); 
     
 private:
+    void concurrentTest();
 };
 
 int SingletonTest::run()
@@ -53,10 +82,48 @@ int SingletonTest::run()
     std::cout << "B: " << MySingleton::GetPtr()->b << std::endl;
     
     assert(MySingleton::GetPtr() == &(MySingleton::Instance()));
+    assert(MySingleton::GetPtr() == &(MySingleton::CachedInstance()));
     
+    concurrentTest();
+
     return 0;
 }
 
+void SingletonTest::concurrentTest()
+{
+    // every thread asks for the instance at the same time. Only one builds
+    // it and all of them see it fully built
+    std::atomic<bool> start(false);
+    std::atomic<int> seen(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < SINGLETON_TEST_THREADS; i++)
+    {
+        threads.push_back(std::thread([&start, &seen, i]()
+            {
+                while (!start.load())
+                {
+                    std::this_thread::yield();
+                }
+
+                SlowSingleton &instance = (i % 2) ? 
+                    SlowSingleton::Instance() : SlowSingleton::CachedInstance();
+                assert(instance.m_value == 42);
+                assert(&instance == &(SlowSingleton::CachedInstance()));
+                seen.fetch_add(1);
+            }));
+    }
+
+    start.store(true);
+    for (std::size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+
+    assert(seen.load() == SINGLETON_TEST_THREADS);
+    assert(SlowSingleton::m_constructions.load() == 1);
+    std::cout << "Built once for " << SINGLETON_TEST_THREADS << " threads" << std::endl;
+}
+
 int main()
 {
     SingletonTest theTest;
@@ -0,0 +1,346 @@
+// ============================================================================
+/// @file  two_lock_safe_queue_test.cpp
+/// @brief Testing the thread-safe queue with separate locks for producers and
+///        consumers
+/// Compiling procedure:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c two_lock_safe_queue_test.cpp
+///   $ g++ two_lock_safe_queue_test.o -o two_lock_safe_queue_test
+///
+/// Expected output:
+///     0ms: main: Checking bulk, move-only, close and stats
+///     0ms: main: 4 producers and 4 consumers. 200000 elements per producer
+///   520ms: main: every element was popped once and in order per producer
+///   525ms: main: every element was consumed by the consumer thread
+///   525ms: main: Done!
+// ============================================================================
+
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <assert.h>
+#include <iomanip> // std::setw
+#include "two_lock_safe_queue.h"
+#include "consumer_thread.h"
+
+#define QUEUE_SIZE 10
+
+#define N_PRODUCERS 4
+#define N_CONSUMERS 4
+#define ELEMS_PER_PRODUCER 200000
+#define CONCURRENT_QUEUE_SIZE 64
+
+class TwoLockSafeQueueTest
+{
+public:
+    TwoLockSafeQueueTest():
+        m_startTestTime(std::chrono::seconds(0)),
+        m_printMutex()
+    {}
+
+    virtual ~TwoLockSafeQueueTest()
+    {}
+
+    int run()
+    {
+        m_startTestTime = std::chrono::system_clock::now();
+
+        timedPrint("main", "Checking bulk, move-only, close and stats");
+        bulkTest();
+        moveOnlyTest();
+        closeTest();
+        statsTest();
+
+        concurrentTest();
+        consumerThreadTest();
+
+        timedPrint("main", "Done!");
+        return 0;
+    }
+
+private:
+    std::chrono::system_clock::time_point m_startTestTime;
+    std::mutex m_printMutex;
+
+    void bulkTest()
+    {
+        int in[QUEUE_SIZE + 5];
+        int out[QUEUE_SIZE + 5];
+        for (int i = 0; i < QUEUE_SIZE + 5; i++)
+        {
+            in[i] = i;
+        }
+
+        TwoLockSafeQueue<int> q(QUEUE_SIZE);
+
+        // only QUEUE_SIZE elements fit in the queue
+        assert(q.TryPushBulk(in, QUEUE_SIZE + 5) == QUEUE_SIZE);
+        assert(q.TryPushBulk(in, 1) == 0);
+        assert(q.TryPush(0) == false);
+
+        assert(q.TryPopBulk(out, 3) == 3);
+        assert((out[0] == 0) && (out[1] == 1) && (out[2] == 2));
+        assert(q.TryPushBulk(in, 5) == 3);
+        assert(q.TimedWaitPopBulk(
+            out, QUEUE_SIZE + 5, std::chrono::microseconds(0)) == QUEUE_SIZE);
+        assert((out[0] == 3) && (out[QUEUE_SIZE - 4] == QUEUE_SIZE - 1));
+        assert((out[QUEUE_SIZE - 3] == 0) && (out[QUEUE_SIZE - 1] == 2));
+
+        assert(q.IsEmpty());
+        assert(q.TryPopBulk(out, 1) == 0);
+        assert(q.TimedWaitPopBulk(out, 1, std::chrono::microseconds(1000)) == 0);
+        assert(q.TimedWaitPop(out[0], std::chrono::microseconds(1000)) == false);
+
+        // the elements left in the queue are destroyed with it
+        TwoLockSafeQueue<std::shared_ptr<int> > q2(QUEUE_SIZE);
+        std::shared_ptr<int> elem(new int(1));
+        q2.Push(elem);
+        q2.Push(elem);
+        assert(elem.use_count() == 3);
+        {
+            TwoLockSafeQueue<std::shared_ptr<int> > q3(QUEUE_SIZE);
+            q3.Push(elem);
+            assert(elem.use_count() == 4);
+        }
+        assert(elem.use_count() == 3);
+        assert(q2.TryPop(elem));
+        assert(elem.use_count() == 2);
+    }
+
+    //////////////////////////////
+    // move-only elements
+    //
+    void moveOnlyTest()
+    {
+        TwoLockSafeQueue<std::unique_ptr<int> > q(2);
+        std::unique_ptr<int> elem(new int(1));
+        std::unique_ptr<int> out;
+
+        q.Push(std::move(elem));
+        assert(elem.get() == 0);
+        assert(q.TryEmplace(new int(2)) == true);
+
+        // the queue is full. elem must be left untouched
+        elem.reset(new int(3));
+        assert(q.TryPush(std::move(elem)) == false);
+        assert(elem.get() != 0);
+
+        q.Pop(out);
+        assert(*out == 1);
+        assert(q.TryPop(out) == true);
+        assert(*out == 2);
+        assert(q.IsEmpty());
+
+        q.Emplace(new int(4));
+        assert(q.TimedWaitPop(out, std::chrono::microseconds(0)) == true);
+        assert(*out == 4);
+    }
+
+    //////////////////////////////
+    // Close wakes up blocked threads and rejects new elements
+    //
+    void closeTest()
+    {
+        TwoLockSafeQueue<int> q(2);
+        int out[2];
+
+        // a consumer blocked with no timeout on an empty queue
+        std::thread consumer([&q, &out]()
+            {
+                assert(q.WaitPopBulk(out, 2) == 1);
+                assert(out[0] == 1);
+                assert(q.WaitPopBulk(out, 2) == 0);
+            });
+        q.Push(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        q.Close();
+        consumer.join();
+        assert(q.IsClosed());
+
+        // nothing goes into a closed queue
+        assert(q.TryPush(2) == false);
+        assert(q.TryPushBulk(out, 2) == 0);
+        q.Push(3);
+        assert(q.IsEmpty());
+        assert(q.TimedWaitPop(out[0], std::chrono::seconds(1)) == false);
+
+        // the elements pushed before closing the queue can still be popped,
+        // and a producer blocked on a full queue gives up
+        TwoLockSafeQueue<int> q2(1);
+        q2.Push(4);
+        std::thread producer([&q2]()
+            {
+                q2.Push(5);
+            });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        q2.Close();
+        producer.join();
+        assert(q2.TimedWaitPopBulk(out, 2, std::chrono::seconds(1)) == 1);
+        assert(out[0] == 4);
+        assert(q2.IsEmpty());
+    }
+
+    //////////////////////////////
+    // statistics policy
+    //
+    void statsTest()
+    {
+        TwoLockSafeQueue<int, QueueStats> q(4);
+        int out[4] = {0, 0, 0, 0};
+        q.Push(1);
+        q.Push(2);
+        assert(q.TryPushBulk(out, 4) == 2);
+        assert(q.TryPush(3) == false);
+        q.Pop(out[0]);
+        assert(out[0] == 1);
+        assert(q.TryPopBulk(out, 4) == 3);
+
+        QueueStatsSnapshot stats;
+        q.GetStats(stats);
+        assert(stats.m_pushes == 4);
+        assert(stats.m_pops == 4);
+        assert(stats.m_pushesFull == 2);
+        assert(stats.m_highWaterMark == 4);
+        assert(stats.m_timeInQueue.Count() == 4);
+
+        // the default policy keeps nothing
+        TwoLockSafeQueue<int> q2(4);
+        q2.Push(1);
+        q2.GetStats(stats);
+        assert((stats.m_pushes == 0) && (stats.m_timeInQueue.Count() == 0));
+    }
+
+    //////////////////////////////
+    // several producers and consumers on a small queue, so both sides block
+    // on each other all the time. Each element encodes its producer and its
+    // sequence number
+    //
+    void concurrentTest()
+    {
+        std::cout << std::setw(5) << 0 << "ms: main: " << N_PRODUCERS 
+                  << " producers and " << N_CONSUMERS << " consumers. " 
+                  << ELEMS_PER_PRODUCER << " elements per producer" << std::endl;
+
+        TwoLockSafeQueue<uint32_t> q(CONCURRENT_QUEUE_SIZE);
+        std::vector<std::vector<uint32_t> > popped(N_CONSUMERS);
+        std::vector<std::thread> threads;
+
+        for (uint32_t c = 0; c < N_CONSUMERS; c++)
+        {
+            threads.push_back(std::thread([&q, &popped, c]()
+                {
+                    uint32_t out[8];
+                    std::size_t count;
+                    while ((count = q.WaitPopBulk(out, (c % 2) ? 8 : 1)) > 0)
+                    {
+                        popped[c].insert(popped[c].end(), out, out + count);
+                    }
+                }));
+        }
+        for (uint32_t p = 0; p < N_PRODUCERS; p++)
+        {
+            threads.push_back(std::thread([&q, p]()
+                {
+                    uint32_t batch[4];
+                    uint32_t i = 0;
+                    while (i < ELEMS_PER_PRODUCER)
+                    {
+                        if ((p % 2) == 0)
+                        {
+                            q.Push((p << 24) | i);
+                            i++;
+                            continue;
+                        }
+
+                        uint32_t n = ELEMS_PER_PRODUCER - i;
+                        n = (n < 4) ? n : 4;
+                        for (uint32_t j = 0; j < n; j++)
+                        {
+                            batch[j] = (p << 24) | (i + j);
+                        }
+                        std::size_t pushed = q.TryPushBulk(batch, n);
+                        if (pushed == 0)
+                        {
+                            std::this_thread::yield();
+                        }
+                        i += pushed;
+                    }
+                }));
+        }
+
+        for (uint32_t p = 0; p < N_PRODUCERS; p++)
+        {
+            threads[N_CONSUMERS + p].join();
+        }
+        q.Close();
+        for (uint32_t c = 0; c < N_CONSUMERS; c++)
+        {
+            threads[c].join();
+        }
+        assert(q.IsEmpty());
+
+        // elements of the same producer are seen in order by each consumer, 
+        // and nothing is lost or duplicated
+        std::vector<uint32_t> seen(N_PRODUCERS, 0);
+        for (uint32_t c = 0; c < N_CONSUMERS; c++)
+        {
+            std::vector<uint32_t> last(N_PRODUCERS, 0);
+            std::vector<bool> first(N_PRODUCERS, true);
+            for (std::size_t k = 0; k < popped[c].size(); k++)
+            {
+                uint32_t p = popped[c][k] >> 24;
+                uint32_t i = popped[c][k] & 0xFFFFFF;
+                assert(p < N_PRODUCERS);
+                assert(first[p] || (i > last[p]));
+                first[p] = false;
+                last[p] = i;
+                seen[p]++;
+            }
+        }
+        for (uint32_t p = 0; p < N_PRODUCERS; p++)
+        {
+            assert(seen[p] == ELEMS_PER_PRODUCER);
+        }
+
+        timedPrint("main", "every element was popped once and in order per producer");
+    }
+
+    //////////////////////////////
+    // the queue can be used by ConsumerThread
+    //
+    void consumerThreadTest()
+    {
+        std::atomic<uint32_t> sum(0);
+        ConsumerThread<uint32_t, TwoLockSafeQueue<uint32_t> > consumer(
+            QUEUE_SIZE, [&sum](uint32_t a_elem) { sum += a_elem; });
+
+        for (uint32_t i = 1; i <= 1000; i++)
+        {
+            consumer.ProduceOrBlock(i);
+        }
+        consumer.Join();
+        assert(sum.load() == 500500);
+
+        timedPrint("main", "every element was consumed by the consumer thread");
+    }
+
+    void timedPrint(const char* a_who, const char* a_msg)
+    {
+        auto elapsed = std::chrono::system_clock::now() - m_startTestTime;
+
+        std::unique_lock<std::mutex> lk(m_printMutex);
+        std::cout << std::setw(5)
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << "ms: " << a_who << ": " << a_msg << std::endl;
+        std::cout.flush();
+    }
+};
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    TwoLockSafeQueueTest theTwoLockSafeQueueTest;
+    return theTwoLockSafeQueueTest.run();
+}
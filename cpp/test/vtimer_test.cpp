@@ -1,5 +1,8 @@
 #include <iostream>
+#include <vector>
+#include <assert.h>
 #include "vtimer.h"
+#include "delegate/Delegate.h"
 
 // compilation: 
 // $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT vtimer_test.cpp -o vtimer_test
@@ -19,9 +22,19 @@ public:
             static_cast<int>(a_currentTime) << std::endl;
     }
     
+    void CountingCallback(const uint32_t &a_currentTime)
+    {
+        m_calls.push_back(a_currentTime);
+    }
+
     int run(); 
     
 private:
+    std::vector<uint32_t> m_calls;
+
+    void callableTest();
+    void setTest();
+    void policyTest();
 };
 
 void GlobalCallback(uint32_t a_currentTime)
@@ -88,10 +101,112 @@ int VTimerTest::run()
     virtual_timer2.Update(1); 
     // call!
     virtual_timer2.Update(2); 
+
+    callableTest();
+    setTest();
+    policyTest();
     
     return 0;
 }
 
+void VTimerTest::callableTest()
+{
+    // callback through a Delegate
+    VTimer<uint32_t, Delegate<void(const uint32_t&)> > delegate_timer(
+        MakeDelegate(this, &VTimerTest::CountingCallback), 10);
+    m_calls.clear();
+    delegate_timer.Update(1);
+    delegate_timer.Update(10);
+    delegate_timer.Update(11);
+    delegate_timer.Update(25);
+    assert((m_calls.size() == 2) && (m_calls[0] == 11) && (m_calls[1] == 25));
+
+    // and a lambda stored inside a Delegate
+    int delegateCalls = 0;
+    VTimer<uint32_t, Delegate<void(const uint32_t&)> > lambda_delegate_timer(
+        [&delegateCalls](const uint32_t&) { delegateCalls++; }, 
+        10);
+    lambda_delegate_timer.Update(1);
+    lambda_delegate_timer.Update(11);
+    assert(delegateCalls == 1);
+
+    // a lambda stored in the timer itself
+    int calls = 0;
+    auto lambda_timer = MakeVTimer<uint32_t>(
+        [&calls](const uint32_t&) { calls++; }, 
+        5);
+    lambda_timer.Update(1);
+    lambda_timer.Update(6);
+    lambda_timer.Update(7);
+    lambda_timer.Update(11);
+    assert(calls == 2);
+
+    std::cout << "Delegate and lambda timers called as expected" << std::endl;
+}
+
+void VTimerTest::setTest()
+{
+    // a set of timers behaves exactly like the same timers on their own
+    typedef Delegate<void(const uint32_t&)> Callback_t;
+    VTimerSet<uint32_t, Callback_t> timer_set;
+    std::vector<uint32_t> alone_calls;
+    std::vector<VTimer<uint32_t> > alone;
+
+    timer_set.Reserve(4);
+    for (uint32_t period = 0; period < 4; period++)
+    {
+        timer_set.Add(MakeDelegate(this, &VTimerTest::CountingCallback), period * 3);
+        alone.push_back(VTimer<uint32_t>(
+            [&alone_calls](const uint32_t &a_time) { alone_calls.push_back(a_time); },
+            period * 3));
+    }
+    assert(timer_set.Size() == 4);
+
+    m_calls.clear();
+    uint32_t times[] = {0, 0, 1, 3, 2, 7, 7, 9, 20, 21, 40};
+    for (uint32_t i = 0; i < sizeof(times) / sizeof(times[0]); i++)
+    {
+        timer_set.Update(times[i]);
+        for (std::size_t j = 0; j < alone.size(); j++)
+        {
+            alone[j].Update(times[i]);
+        }
+    }
+    assert(m_calls == alone_calls);
+
+    // the last timer takes the index of the one removed
+    timer_set.Remove(0);
+    timer_set.Remove(timer_set.Size() - 1);
+    assert(timer_set.Size() == 2);
+    std::swap(alone[0], alone[3]);
+    alone.pop_back();
+    alone.pop_back();
+    m_calls.clear();
+    alone_calls.clear();
+    for (uint32_t time = 41; time < 70; time += 4)
+    {
+        timer_set.Update(time);
+        for (std::size_t j = 0; j < alone.size(); j++)
+        {
+            alone[j].Update(time);
+        }
+    }
+    assert(!m_calls.empty() && (m_calls == alone_calls));
+
+    // lambdas can't be assigned. Removing moves them around
+    int calls = 0;
+    auto counter = [&calls](const uint32_t&) { calls++; };
+    VTimerSet<uint32_t, decltype(counter)> lambda_set;
+    lambda_set.Add(counter, 1);
+    lambda_set.Add(counter, 2);
+    lambda_set.Remove(0);
+    lambda_set.Update(1);
+    lambda_set.Update(3);
+    assert((lambda_set.Size() == 1) && (calls == 1));
+
+    std::cout << "Timer sets called as expected" << std::endl;
+}
+
 int main()
 {
     VTimerTest theTest;
@@ -100,4 +215,87 @@ int main()
     theVTimerTestResult = theTest.run();
  
     return theVTimerTestResult;
-}
\ No newline at end of file
+}
+void VTimerTest::policyTest()
+{
+    // period 10, initialised at 0. Updated at 10 and then late at 35
+    // (deadlines 20 and 30 passed), then at 36, 37 and 40
+    uint32_t times[] = {0, 10, 35, 36, 37, 40};
+    uint32_t count = sizeof(times) / sizeof(times[0]);
+
+    // fixed delay shifts the schedule: 10 -> 20 -> 35 -> 45
+    uint32_t expectedDelay[] = {10, 10, 10, 9, 8, 5};
+    int calls = 0;
+    auto delay = MakeVTimer<uint32_t>(
+        [&calls](const uint32_t&) { calls++; }, 10);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        assert(delay.Update(times[i]) == expectedDelay[i]);
+    }
+    assert((calls == 2) && (delay.MissedPeriods() == 0));
+
+    // fixed rate keeps the grid and catches up one call per update: 
+    // 10 -> 20 -> 30 -> 40 -> 50
+    uint32_t expectedRate[] = {10, 10, 0, 4, 3, 10};
+    calls = 0;
+    auto rate = MakeVTimer<uint32_t, VTimerFixedRate>(
+        [&calls](const uint32_t&) { calls++; }, 10);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        assert(rate.Update(times[i]) == expectedRate[i]);
+    }
+    assert(calls == 4);
+
+    // coalesce calls once at 35 skipping 20, goes on at 40
+    uint32_t expectedCoalesce[] = {10, 10, 5, 4, 3, 10};
+    std::vector<uint64_t> missed;
+    VTimer<uint32_t, std::function<void(const uint32_t&)>, VTimerCoalesce>* coalesce_ptr = 0;
+    VTimer<uint32_t, std::function<void(const uint32_t&)>, VTimerCoalesce> coalesce(
+        [&missed, &coalesce_ptr](const uint32_t&) { missed.push_back(coalesce_ptr->MissedPeriods()); }, 
+        10);
+    coalesce_ptr = &coalesce;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        assert(coalesce.Update(times[i]) == expectedCoalesce[i]);
+    }
+    // the callback can check how many periods it is standing for
+    assert((missed.size() == 3) && (missed[0] == 0) && (missed[1] == 1) && (missed[2] == 0));
+    assert(coalesce.MissedPeriods() == 0);
+
+    // burst calls for 20 and 30 at 35
+    uint32_t expectedBurst[] = {10, 10, 5, 4, 3, 10};
+    std::vector<uint32_t> burstCalls;
+    auto burst = MakeVTimer<uint32_t, VTimerBurst>(
+        [&burstCalls](const uint32_t &a_time) { burstCalls.push_back(a_time); }, 10);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        assert(burst.Update(times[i]) == expectedBurst[i]);
+    }
+    assert((burstCalls.size() == 4) && (burstCalls[1] == 35) && (burstCalls[2] == 35));
+
+    // period 0 is called on each update whatever the policy (but the first
+    // one, which initialises the timer)
+    calls = 0;
+    auto burstZero = MakeVTimer<uint32_t, VTimerBurst>(
+        [&calls](const uint32_t&) { calls++; }, 0);
+    auto coalesceZero = MakeVTimer<uint32_t, VTimerCoalesce>(
+        [&calls](const uint32_t&) { calls++; }, 0);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        assert((burstZero.Update(times[i]) == 0) == (i > 0));
+        coalesceZero.Update(times[i]);
+    }
+    assert(calls == 10);
+
+    // a set waits for the earliest of its timers
+    VTimerSet<uint32_t, std::function<void(const uint32_t&)>, VTimerFixedRate> timer_set;
+    assert(timer_set.Update(0) == std::numeric_limits<uint32_t>::max());
+    timer_set.Add([](const uint32_t&) {}, 10);
+    timer_set.Add([](const uint32_t&) {}, 4);
+    assert(timer_set.Update(0) == 4);
+    assert(timer_set.Update(3) == 1);
+    assert(timer_set.Update(9) == 0); // 4 called, 8 pending
+    assert(timer_set.Update(9) == 1);
+
+    std::cout << "Scheduling policies called as expected" << std::endl;
+}
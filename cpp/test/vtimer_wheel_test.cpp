@@ -0,0 +1,280 @@
+// ============================================================================
+/// @file  vtimer_wheel_test.cpp
+/// @brief Testing the hierarchical timing wheel of virtual timers
+/// The wheel is checked against a trivial implementation (a list of timers
+/// looked at one by one) with random timers, cancellations and updates,
+/// including delays and jumps in time longer than what the wheels cover
+/// Compiling procedure:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c vtimer_wheel_test.cpp
+///   $ g++ vtimer_wheel_test.o -o vtimer_wheel_test
+///
+/// Expected output:
+///   Global Callback called at 15
+///   Callback called at 31
+///   Global Callback called at 31
+///   Global Callback called at 46
+///   random test: 20000 updates. 9841 timers scheduled. 856 cancelled. 2806879 callbacks
+///   Done!
+// ============================================================================
+
+#include <iostream>
+#include <vector>
+#include <algorithm> // std::sort
+#include <random>
+#include <assert.h>
+#include "vtimer_wheel.h"
+
+#define RANDOM_UPDATES 20000
+
+typedef VTimerWheel<uint64_t> Wheel_t;
+
+/// @brief the trivial implementation the wheel is compared against
+struct ReferenceTimer
+{
+    uint64_t m_expiry;
+    uint64_t m_period;
+    bool     m_periodic;
+    bool     m_alive;
+};
+
+class VTimerWheelTest
+{
+public:
+    VTimerWheelTest():
+        m_wheel(0),
+        m_fired()
+    {}
+
+    void Callback(uint32_t a_currentTime)
+    {
+        std::cout << "Callback called at " << a_currentTime << std::endl;
+    }
+
+    int run()
+    {
+        exampleTest();
+        callbackTest();
+        resolutionTest();
+        randomTest();
+
+        std::cout << "Done!" << std::endl;
+        return 0;
+    }
+
+private:
+    Wheel_t m_wheel;
+    std::vector<uint32_t> m_fired;
+
+    static void GlobalCallback(uint32_t a_currentTime)
+    {
+        std::cout << "Global Callback called at " << a_currentTime << std::endl;
+    }
+
+    //////////////////////////////
+    // like vtimer_test but with one wheel driving both timers
+    //
+    void exampleTest()
+    {
+        VTimerWheel<uint32_t> wheel(0);
+        wheel.SchedulePeriodic(&VTimerWheelTest::GlobalCallback, 15);
+        VTimerWheel<uint32_t>::Handle_t handle = wheel.ScheduleOnce(
+            std::bind(&VTimerWheelTest::Callback, this, std::placeholders::_1), 30);
+
+        assert(wheel.Size() == 2);
+        assert(wheel.IsScheduled(handle));
+        assert(wheel.Update(14) == 0);
+        assert(wheel.Update(15) == 1);
+        // both expire in the same update
+        assert(wheel.Update(31) == 2);
+        assert(!wheel.IsScheduled(handle));
+        assert(wheel.Cancel(handle) == false);
+        // time going backwards is ignored
+        assert(wheel.Update(2) == 0);
+        assert(wheel.Update(45) == 0);
+        assert(wheel.Update(46) == 1);
+        assert(wheel.Size() == 1);
+    }
+
+    //////////////////////////////
+    // callbacks scheduling and cancelling timers
+    //
+    void callbackTest()
+    {
+        Wheel_t wheel(100);
+        Wheel_t::Handle_t periodic = 0;
+        Wheel_t::Handle_t other = 0;
+        int calls = 0;
+
+        // a periodic timer that cancels itself on its third call
+        periodic = wheel.SchedulePeriodic([&](const uint64_t&)
+            {
+                if (++calls == 3)
+                {
+                    assert(wheel.Cancel(periodic));
+                }
+            }, 10);
+
+        // a timer that cancels another one expiring in the same update, and
+        // schedules a new one with no delay
+        int otherCalls = 0;
+        int noDelayCalls = 0;
+        wheel.ScheduleOnce([&](const uint64_t&)
+            {
+                assert(wheel.Cancel(other));
+                wheel.ScheduleOnce([&](const uint64_t&) { noDelayCalls++; }, 0);
+            }, 5);
+        other = wheel.ScheduleOnce([&](const uint64_t&) { otherCalls++; }, 5);
+
+        // the timer with no delay doesn't expire in the update that 
+        // scheduled it
+        assert(wheel.Update(105) == 1);
+        assert((otherCalls == 0) && (noDelayCalls == 0));
+        assert(wheel.Update(106) == 1);
+        assert(noDelayCalls == 1);
+
+        assert(wheel.Update(110) == 1);
+        assert(wheel.Update(120) == 1);
+        assert(wheel.Update(130) == 1);
+        assert((calls == 3) && (!wheel.IsScheduled(periodic)));
+        assert(wheel.Update(1000) == 0);
+        assert(wheel.Size() == 0);
+
+        // a periodic timer with no period expires at every tick
+        Wheel_t::Handle_t everyTick = wheel.SchedulePeriodic([&](const uint64_t&) { calls++; }, 0);
+        assert(wheel.Update(1000) == 0);
+        assert(wheel.Update(1001) == 1);
+        assert(wheel.Update(1005) == 1);
+        assert(wheel.Cancel(everyTick));
+        assert(wheel.Cancel(everyTick) == false);
+    }
+
+    //////////////////////////////
+    // timers never expire before their time with a resolution bigger than 1
+    //
+    void resolutionTest()
+    {
+        Wheel_t wheel(3, 10);
+        int calls = 0;
+        wheel.ScheduleOnce([&](const uint64_t &a_time) 
+            { 
+                assert(a_time >= 18);
+                calls++; 
+            }, 15);
+        assert(wheel.Update(18) == 0);
+        assert(wheel.Update(19) == 0);
+        // tick boundary at or after the expiry time (18)
+        assert(wheel.Update(20) == 1);
+        assert(calls == 1);
+    }
+
+    //////////////////////////////
+    // the wheel against a list of timers
+    //
+    void randomTest()
+    {
+        std::mt19937_64 rng(1234);
+        std::vector<ReferenceTimer> reference;
+        std::vector<Wheel_t::Handle_t> handles;
+        uint64_t now = 0;
+        uint64_t scheduled = 0;
+        uint64_t cancelled = 0;
+        uint64_t callbacks = 0;
+
+        for (int update = 0; update < RANDOM_UPDATES; update++)
+        {
+            // new timers. Most of them close, a few very far away (further
+            // than what the wheels cover: 2^32 ticks)
+            int newTimers = static_cast<int>(rng() % 2);
+            for (int i = 0; i < newTimers; i++)
+            {
+                uint64_t delay;
+                switch (rng() % 8)
+                {
+                case 0:  delay = rng() % (static_cast<uint64_t>(1) << 40); break;
+                case 1:  delay = rng() % (1 << 20); break;
+                case 2:  delay = 0; break;
+                default: delay = rng() % 600; break;
+                }
+                bool periodic = ((rng() % 8) == 0);
+
+                uint32_t id = static_cast<uint32_t>(reference.size());
+                Wheel_t::VTimerCallback_t callback = 
+                    [this, id](const uint64_t&) { m_fired.push_back(id); };
+                handles.push_back(periodic ? 
+                    m_wheel.SchedulePeriodic(callback, delay) :
+                    m_wheel.ScheduleOnce(callback, delay));
+
+                ReferenceTimer timer;
+                timer.m_expiry   = now + ((delay == 0) ? 1 : delay);
+                timer.m_period   = delay;
+                timer.m_periodic = periodic;
+                timer.m_alive    = true;
+                reference.push_back(timer);
+                scheduled++;
+            }
+
+            // cancel a random timer from time to time
+            if ((!reference.empty()) && ((rng() % 3) == 0))
+            {
+                std::size_t id = rng() % reference.size();
+                assert(m_wheel.Cancel(handles[id]) == reference[id].m_alive);
+                if (reference[id].m_alive)
+                {
+                    cancelled++;
+                }
+                reference[id].m_alive = false;
+            }
+
+            // time moves forward. Sometimes a lot
+            switch (rng() % 100)
+            {
+            case 0:  now += (static_cast<uint64_t>(1) << 33) + (rng() % 1000); break;
+            case 1:  now += rng() % (1 << 22); break;
+            default: now += rng() % 300; break;
+            }
+
+            std::vector<uint32_t> expected;
+            for (std::size_t id = 0; id < reference.size(); id++)
+            {
+                ReferenceTimer &timer = reference[id];
+                if (timer.m_alive && (timer.m_expiry <= now))
+                {
+                    expected.push_back(static_cast<uint32_t>(id));
+                    if (timer.m_periodic)
+                    {
+                        timer.m_expiry = now + ((timer.m_period == 0) ? 1 : timer.m_period);
+                    }
+                    else
+                    {
+                        timer.m_alive = false;
+                    }
+                }
+            }
+
+            m_fired.clear();
+            assert(m_wheel.Update(now) == expected.size());
+            std::sort(m_fired.begin(), m_fired.end());
+            assert(m_fired == expected);
+            callbacks += m_fired.size();
+        }
+
+        std::size_t alive = 0;
+        for (std::size_t id = 0; id < reference.size(); id++)
+        {
+            alive += reference[id].m_alive ? 1 : 0;
+            assert(m_wheel.IsScheduled(handles[id]) == reference[id].m_alive);
+        }
+        assert(m_wheel.Size() == alive);
+
+        std::cout << "random test: " << RANDOM_UPDATES << " updates. " 
+                  << scheduled << " timers scheduled. " << cancelled 
+                  << " cancelled. " << callbacks << " callbacks" << std::endl;
+    }
+};
+
+int main()
+{
+    VTimerWheelTest theTest;
+
+    return theTest.run();
+}
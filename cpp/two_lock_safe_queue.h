@@ -0,0 +1,289 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file two_lock_safe_queue.h
+/// @brief Thread-safe queue with a lock for the producers and another one for
+///        the consumers
+/// It is a linked list with a dummy node at the front (Michael and Scott's 
+/// two-lock queue). Producers only touch the tail of the list and consumers 
+/// only the head, so each side is protected by its own mutex and a producer
+/// never has to wait for a consumer to release its lock (or viceversa). The
+/// number of elements is kept in an atomic counter shared by both sides.
+/// Consumers sleep on a "not empty" condition variable and producers on a
+/// "not full" one. A single thread is woken up each time, and it wakes up the
+/// next one if it leaves data (or space) behind.
+///
+/// The interface is the one of SafeQueue, so it can be used wherever 
+/// SafeQueue is (ConsumerThread for instance):
+///   ConsumerThread<int, TwoLockSafeQueue<int> > consumer(...);
+/// Unlike SafeQueue it can't be copied or moved. Every element inserted 
+/// takes a node allocated from the heap
+///
+/// Your compiler must have support for c++11. This is an example of how to 
+/// compile an application that makes use of this queue with gcc 4.8:
+///   $ g++ -g -O0 -Wall -std=c++11 -D_REENTRANT -c app.cpp
+///   $ g++ app.o -o app
+///
+// ============================================================================
+
+#ifndef _TWOLOCKSAFEQUEUE_H_
+#define _TWOLOCKSAFEQUEUE_H_
+
+#include <stdint.h> // uint64_t
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <chrono>
+#include <type_traits> // std::aligned_storage
+#include "safe_queue.h" // SAFE_QUEUE_DEFAULT_MAX_SIZE
+#include "queue_stats.h"
+
+// size in bytes of a cache line. The data used by the consumers and the data
+// used by the producers are kept this far from each other so they don't 
+// share a cache line
+#ifndef TWO_LOCK_SAFE_QUEUE_CACHE_LINE_SIZE
+#define TWO_LOCK_SAFE_QUEUE_CACHE_LINE_SIZE 64
+#endif
+
+/// @brief time a node was inserted into the queue. Nothing is kept if the
+///        statistics are disabled
+template <bool ENABLED>
+struct TwoLockSafeQueueStamp
+{
+    inline void SetStamp(uint64_t a_stamp) { m_stamp = a_stamp; }
+    inline uint64_t GetStamp() const { return m_stamp; }
+
+    uint64_t m_stamp;
+};
+
+template <>
+struct TwoLockSafeQueueStamp<false>
+{
+    inline void SetStamp(uint64_t) {}
+    inline uint64_t GetStamp() const { return 0; }
+};
+
+/// @brief thread-safe queue with separate locks for producers and consumers
+/// T type of the elements
+/// STATS_T statistics policy (see queue_stats.h). None by default
+template <typename T, typename STATS_T = QueueNoStats>
+class TwoLockSafeQueue
+{
+public:
+    /// @brief constructor
+    /// @param a_maxSize optional parameter with the maximum size of the queue
+    TwoLockSafeQueue(std::size_t a_maxSize = SAFE_QUEUE_DEFAULT_MAX_SIZE);
+
+    /// @brief destructor. The elements still in the queue are destroyed
+    ~TwoLockSafeQueue();
+
+    /// @brief Check if the queue is empty. It doesn't take any lock
+    /// @return true if the queue is empty. False otherwise
+    bool IsEmpty() const;
+
+    /// @brief closes the queue and wakes up every thread blocked in it
+    /// See SafeQueue::Close
+    void Close();
+
+    /// @brief Check if Close was called on the queue
+    /// @return true if the queue is closed. False otherwise
+    bool IsClosed() const;
+
+    /// @brief inserts an element into the queue. If the queue is full the 
+    ///        thread will be blocked until someone else gets an element from
+    ///        the queue. If the queue is (or gets) closed the element is 
+    ///        discarded
+    /// @return true if the element was inserted. False if it was discarded
+    bool Push(const T &a_elem);
+
+    /// @brief moves an element into the queue. See Push above
+    bool Push(T &&a_elem);
+
+    /// @brief constructs an element at the back of the queue. See Push above
+    /// The element is constructed before waiting for space in the queue
+    /// @param a_args arguments forwarded to the constructor of T
+    template <typename... ARGS>
+    bool Emplace(ARGS&&... a_args);
+
+    /// @brief inserts an element into the queue
+    /// @return True if the elem was successfully inserted into the queue.
+    ///         False if it was full or closed
+    bool TryPush(const T &a_elem);
+
+    /// @brief moves an element into the queue
+    /// @return True if the elem was successfully inserted into the queue.
+    ///         False if it was full or closed (a_elem is not modified then)
+    bool TryPush(T &&a_elem);
+
+    /// @brief constructs an element at the back of the queue
+    /// @return True if the elem was successfully inserted into the queue.
+    ///         False if it was full or closed (nothing is constructed then)
+    template <typename... ARGS>
+    bool TryEmplace(ARGS&&... a_args);
+
+    /// @brief extracts an element from the queue. If the queue is empty this
+    ///        call will block the thread until there is something in it
+    /// If the queue is (or gets) closed while it is empty the call returns 
+    /// without modifying out_data
+    void Pop(T &out_data);
+
+    /// @brief extracts an element from the queue
+    /// @return True if the element was retrieved from the queue.
+    ///         False if the queue was empty
+    bool TryPop(T &out_data);
+
+    /// @brief extracts an element from the queue waiting up to a_microsecs 
+    ///        if it is empty
+    /// @return True if the element was retrieved from the queue.
+    ///         False if the timeout was hit (or the queue is closed) and the
+    ///         queue is empty
+    bool TimedWaitPop(T &data, std::chrono::microseconds a_microsecs);
+
+    /// @brief inserts up to a_count elements into the queue
+    /// The producers' lock is acquired only once for the whole batch
+    /// @return the number of elements inserted into the queue
+    std::size_t TryPushBulk(const T* a_elems, std::size_t a_count);
+
+    /// @brief extracts up to a_maxCount elements from the queue
+    /// The consumers' lock is acquired only once for the whole batch
+    /// @return the number of elements retrieved from the queue
+    std::size_t TryPopBulk(T* out_data, std::size_t a_maxCount);
+
+    /// @brief extracts up to a_maxCount elements from the queue waiting up to
+    ///        a_microsecs if it is empty
+    /// @return the number of elements retrieved from the queue. 0 if the 
+    ///         timeout was hit (or the queue is closed) and the queue is empty
+    std::size_t TimedWaitPopBulk(
+        T*                        out_data, 
+        std::size_t               a_maxCount, 
+        std::chrono::microseconds a_microsecs);
+
+    /// @brief extracts up to a_maxCount elements from the queue waiting with
+    ///        no timeout if it is empty
+    /// @return the number of elements retrieved from the queue. 0 only if the
+    ///         queue is closed and empty
+    std::size_t WaitPopBulk(T* out_data, std::size_t a_maxCount);
+
+    /// @brief statistics of the queue (see queue_stats.h)
+    /// Everything is 0 if STATS_T is QueueNoStats
+    void GetStats(QueueStatsSnapshot &out_stats) const;
+
+private:
+    /// @brief node of the linked list. The element is constructed in place
+    ///        when it is pushed. The first node of the list (the dummy one)
+    ///        doesn't hold any
+    struct Node : public TwoLockSafeQueueStamp<STATS_T::ENABLED>
+    {
+        Node(): m_next(0) {}
+
+        inline T* Elem() { return reinterpret_cast<T*>(&m_storage); }
+
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+        Node* m_next;
+    };
+
+    /// first node of the list (dummy). Protected by m_headMutex
+    Node* m_head;
+    /// protects the consumers' side of the queue
+    mutable std::mutex m_headMutex;
+    /// Consumers wait on it for the queue to have something in it
+    std::condition_variable m_notEmpty;
+    /// number of threads waiting on m_notEmpty. Protected by m_headMutex
+    std::size_t m_waitingConsumers;
+
+    /// keeps the consumers' data and the producers' data in different cache
+    /// lines
+    char m_padding[TWO_LOCK_SAFE_QUEUE_CACHE_LINE_SIZE];
+
+    /// last node of the list. Protected by m_tailMutex
+    Node* m_tail;
+    /// protects the producers' side of the queue
+    mutable std::mutex m_tailMutex;
+    /// Producers wait on it for the queue to have some space left
+    std::condition_variable m_notFull;
+    /// number of threads waiting on m_notFull. Protected by m_tailMutex
+    std::size_t m_waitingProducers;
+
+    /// number of elements in the queue. A consumer can only follow the 
+    /// m_next pointer of the nodes this counter says were linked
+    std::atomic<std::size_t> m_count;
+    /// maximum number of elements for the queue
+    std::size_t m_maximumSize;
+    /// set by Close. Nothing can be pushed anymore into the queue
+    std::atomic<bool> m_closed;
+    /// statistics of the queue
+    STATS_T m_stats;
+
+    /// @brief links into the list a chain of a_count nodes that goes from 
+    ///        a_first to a_last, and wakes up a consumer if the queue was 
+    ///        empty. Stats are updated
+    /// WARNING: a_lock must hold m_tailMutex on entry. It is released on exit
+    inline void LinkNodes(
+        std::unique_lock<std::mutex> &a_lock,
+        Node                         *a_first,
+        Node                         *a_last,
+        std::size_t                   a_count);
+
+    /// @brief extracts up to a_maxCount elements and wakes up the next 
+    ///        consumer and/or a producer if needed
+    /// WARNING: a_lock must hold m_headMutex on entry. It is released on exit
+    /// @return the number of elements extracted
+    inline std::size_t PopBulkAndUnlock(
+        std::unique_lock<std::mutex> &a_lock,
+        T*                            out_data,
+        std::size_t                   a_maxCount);
+
+    /// @brief wait on m_notEmpty until there is something in the queue or 
+    ///        the queue gets closed (or a_wakeUpTime is reached)
+    /// WARNING: the lock must be held on m_headMutex
+    inline void WaitNotEmptyLocked(
+        std::unique_lock<std::mutex>                &a_lock,
+        const std::chrono::steady_clock::time_point *a_wakeUpTime = 0);
+
+    /// @brief wait on m_notFull until there is space in the queue or the 
+    ///        queue gets closed
+    /// WARNING: the lock must be held on m_tailMutex
+    inline void WaitNotFullLocked(std::unique_lock<std::mutex> &a_lock);
+
+    /// @brief wake up one consumer (producer) if there is any waiting
+    /// WARNING: they acquire m_headMutex (m_tailMutex). The other mutex must
+    /// not be held by the caller
+    inline void SignalNotEmpty();
+    inline void SignalNotFull();
+
+    /// @brief free space in the queue (an estimate if called without 
+    ///        m_tailMutex)
+    inline std::size_t FreeSpace() const;
+
+    /// @brief frees a_count nodes of the chain that starts at a_first. 
+    ///        Their elements are destroyed if a_destroyElems is true
+    static inline void DeleteNodes(
+        Node* a_first, std::size_t a_count, bool a_destroyElems);
+
+    /// @brief the queue can't be copied (or moved)
+    TwoLockSafeQueue(const TwoLockSafeQueue &a_src);
+    TwoLockSafeQueue& operator=(const TwoLockSafeQueue &a_src);
+};
+
+// include the implementation file
+#include "two_lock_safe_queue_impl.h"
+
+#endif /* _TWOLOCKSAFEQUEUE_H_ */
@@ -0,0 +1,496 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file two_lock_safe_queue_impl.h
+/// @brief Implementation of the thread-safe queue with a lock for the 
+///        producers and another one for the consumers
+///
+// ============================================================================
+
+#ifndef _TWOLOCKSAFEQUEUEIMPL_H_
+#define _TWOLOCKSAFEQUEUEIMPL_H_
+
+#include <assert.h>
+#include <new>     // placement new
+#include <utility> // std::move, std::forward
+
+template <typename T, typename STATS_T>
+TwoLockSafeQueue<T, STATS_T>::TwoLockSafeQueue(std::size_t a_maxSize):
+    m_head(new Node()),
+    m_headMutex(),
+    m_notEmpty(),
+    m_waitingConsumers(0),
+    m_tail(m_head),
+    m_tailMutex(),
+    m_notFull(),
+    m_waitingProducers(0),
+    m_count(0),
+    m_maximumSize(a_maxSize),
+    m_closed(false),
+    m_stats()
+{
+    assert(a_maxSize > 0);
+}
+
+template <typename T, typename STATS_T>
+TwoLockSafeQueue<T, STATS_T>::~TwoLockSafeQueue()
+{
+    // nobody else can be using the queue now. The dummy node doesn't hold 
+    // any element
+    Node* first = m_head->m_next;
+    delete m_head;
+    DeleteNodes(first, m_count.load(), true);
+}
+
+template <typename T, typename STATS_T>
+bool TwoLockSafeQueue<T, STATS_T>::IsEmpty() const
+{
+    return (m_count.load() == 0);
+}
+
+template <typename T, typename STATS_T>
+void TwoLockSafeQueue<T, STATS_T>::Close()
+{
+    m_closed.store(true);
+
+    // a thread that checked m_closed before the store above is already 
+    // waiting by the time the lock is acquired here, so it gets the 
+    // notification
+    {
+        std::lock_guard<std::mutex> lk(m_headMutex);
+        m_notEmpty.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lk(m_tailMutex);
+        m_notFull.notify_all();
+    }
+}
+
+template <typename T, typename STATS_T>
+bool TwoLockSafeQueue<T, STATS_T>::IsClosed() const
+{
+    return m_closed.load();
+}
+
+template <typename T, typename STATS_T>
+bool TwoLockSafeQueue<T, STATS_T>::Push(const T &a_elem)
+{
+    return Emplace(a_elem);
+}
+
+template <typename T, typename STATS_T>
+bool TwoLockSafeQueue<T, STATS_T>::Push(T &&a_elem)
+{
+    return Emplace(std::move(a_elem));
+}
+
+template <typename T, typename STATS_T>
+template <typename... ARGS>
+bool TwoLockSafeQueue<T, STATS_T>::Emplace(ARGS&&... a_args)
+{
+    // allocation and construction happen before the lock is acquired
+    Node* node = new Node();
+    new (node->Elem()) T(std::forward<ARGS>(a_args)...);
+
+    std::unique_lock<std::mutex> lk(m_tailMutex);
+
+    if (FreeSpace() == 0)
+    {
+        m_stats.OnPushFull();
+    }
+
+    WaitNotFullLocked(lk);
+
+    if (m_closed.load())
+    {
+        // the element is discarded
+        lk.unlock();
+        DeleteNodes(node, 1, true);
+        return false;
+    }
+
+    LinkNodes(lk, node, node, 1);
+    return true;
+}
+
+template <typename T, typename STATS_T>
+bool TwoLockSafeQueue<T, STATS_T>::TryPush(const T &a_elem)
+{
+    return TryEmplace(a_elem);
+}
+
+template <typename T, typename STATS_T>
+bool TwoLockSafeQueue<T, STATS_T>::TryPush(T &&a_elem)
+{
+    return TryEmplace(std::move(a_elem));
+}
+
+template <typename T, typename STATS_T>
+template <typename... ARGS>
+bool TwoLockSafeQueue<T, STATS_T>::TryEmplace(ARGS&&... a_args)
+{
+    if (m_closed.load())
+    {
+        return false;
+    }
+    else if (FreeSpace() == 0)
+    {
+        m_stats.OnPushFull();
+        return false;
+    }
+
+    // the element can't be constructed until there is space for it for sure
+    // (an rvalue argument must not be modified if the push fails). Only the
+    // allocation of the node is done before the lock is acquired
+    Node* node = new Node();
+
+    std::unique_lock<std::mutex> lk(m_tailMutex);
+
+    if (m_closed.load() || (FreeSpace() == 0))
+    {
+        if (!m_closed.load())
+        {
+            m_stats.OnPushFull();
+        }
+
+        lk.unlock();
+        DeleteNodes(node, 1, false);
+        return false;
+    }
+
+    new (node->Elem()) T(std::forward<ARGS>(a_args)...);
+    LinkNodes(lk, node, node, 1);
+
+    return true;
+}
+
+template <typename T, typename STATS_T>
+bool TwoLockSafeQueue<T, STATS_T>::TryPop(T &out_data)
+{
+    std::unique_lock<std::mutex> lk(m_headMutex);
+
+    return (PopBulkAndUnlock(lk, &out_data, 1) == 1);
+}
+
+template <typename T, typename STATS_T>
+void TwoLockSafeQueue<T, STATS_T>::Pop(T &out_data)
+{
+    std::unique_lock<std::mutex> lk(m_headMutex);
+
+    WaitNotEmptyLocked(lk);
+
+    // nothing to pop if the queue was closed
+    PopBulkAndUnlock(lk, &out_data, 1);
+}
+
+template <typename T, typename STATS_T>
+bool TwoLockSafeQueue<T, STATS_T>::TimedWaitPop(T &data, std::chrono::microseconds a_microsecs)
+{
+    std::unique_lock<std::mutex> lk(m_headMutex);
+
+    auto wakeUpTime = std::chrono::steady_clock::now() + a_microsecs;
+    WaitNotEmptyLocked(lk, &wakeUpTime);
+
+    // False if it timed-out (or closed) and the queue is still empty
+    return (PopBulkAndUnlock(lk, &data, 1) == 1);
+}
+
+template <typename T, typename STATS_T>
+std::size_t TwoLockSafeQueue<T, STATS_T>::TryPushBulk(const T* a_elems, std::size_t a_count)
+{
+    if ((a_count == 0) || m_closed.load())
+    {
+        return 0;
+    }
+
+    // consumers can only make more space. The nodes for as many elements as
+    // fit now are built before the lock is acquired 
+    std::size_t count = FreeSpace();
+    if (count > a_count)
+    {
+        count = a_count;
+    }
+    else if (count == 0)
+    {
+        m_stats.OnPushFull();
+        return 0;
+    }
+
+    Node* first = new Node();
+    new (first->Elem()) T(a_elems[0]);
+    Node* last = first;
+    for (std::size_t i = 1; i < count; i++)
+    {
+        last->m_next = new Node();
+        last = last->m_next;
+        new (last->Elem()) T(a_elems[i]);
+    }
+
+    std::unique_lock<std::mutex> lk(m_tailMutex);
+
+    // other producers might have taken part of that space in the meantime
+    std::size_t space = m_closed.load() ? 0 : FreeSpace();
+    std::size_t linked = (count < space) ? count : space;
+
+    if ((linked < a_count) && (!m_closed.load()))
+    {
+        m_stats.OnPushFull();
+    }
+
+    Node* leftOver = first;
+    if (linked > 0)
+    {
+        last = first;
+        for (std::size_t i = 1; i < linked; i++)
+        {
+            last = last->m_next;
+        }
+        leftOver = last->m_next;
+        last->m_next = 0;
+
+        LinkNodes(lk, first, last, linked);
+    }
+    else
+    {
+        lk.unlock();
+    }
+
+    DeleteNodes(leftOver, count - linked, true);
+
+    return linked;
+}
+
+template <typename T, typename STATS_T>
+std::size_t TwoLockSafeQueue<T, STATS_T>::TryPopBulk(T* out_data, std::size_t a_maxCount)
+{
+    std::unique_lock<std::mutex> lk(m_headMutex);
+
+    return PopBulkAndUnlock(lk, out_data, a_maxCount);
+}
+
+template <typename T, typename STATS_T>
+std::size_t TwoLockSafeQueue<T, STATS_T>::TimedWaitPopBulk(
+    T*                        out_data, 
+    std::size_t               a_maxCount, 
+    std::chrono::microseconds a_microsecs)
+{
+    std::unique_lock<std::mutex> lk(m_headMutex);
+
+    auto wakeUpTime = std::chrono::steady_clock::now() + a_microsecs;
+    WaitNotEmptyLocked(lk, &wakeUpTime);
+
+    // Nothing if the timeout was hit (or the queue was closed) and the queue
+    // is still empty
+    return PopBulkAndUnlock(lk, out_data, a_maxCount);
+}
+
+template <typename T, typename STATS_T>
+std::size_t TwoLockSafeQueue<T, STATS_T>::WaitPopBulk(T* out_data, std::size_t a_maxCount)
+{
+    std::unique_lock<std::mutex> lk(m_headMutex);
+
+    WaitNotEmptyLocked(lk);
+
+    // 0 only if the queue was closed and there is nothing left in it
+    return PopBulkAndUnlock(lk, out_data, a_maxCount);
+}
+
+template <typename T, typename STATS_T>
+void TwoLockSafeQueue<T, STATS_T>::GetStats(QueueStatsSnapshot &out_stats) const
+{
+    m_stats.GetSnapshot(out_stats);
+}
+
+template <typename T, typename STATS_T>
+void TwoLockSafeQueue<T, STATS_T>::LinkNodes(
+    std::unique_lock<std::mutex> &a_lock,
+    Node                         *a_first,
+    Node                         *a_last,
+    std::size_t                   a_count)
+{
+    uint64_t stamp = m_stats.Stamp();
+    for (Node* node = a_first; node != 0; node = node->m_next)
+    {
+        node->SetStamp(stamp);
+    }
+
+    m_tail->m_next = a_first;
+    m_tail = a_last;
+
+    // the nodes must be linked before the counter is updated. Consumers 
+    // don't look at the m_next pointer of a node until the counter says 
+    // there is something after it
+    std::size_t oldCount = m_count.fetch_add(a_count);
+    for (std::size_t i = 1; i <= a_count; i++)
+    {
+        m_stats.OnPush(oldCount + i);
+    }
+
+    if ((oldCount + a_count < m_maximumSize) && (m_waitingProducers > 0))
+    {
+        // there is space left for the next producer
+        m_notFull.notify_one();
+    }
+
+    a_lock.unlock();
+
+    if (oldCount == 0)
+    {
+        // consumers only wait on an empty queue. If there are more of them
+        // waiting and more elements in the queue the first consumer wakes up
+        // the next one
+        SignalNotEmpty();
+    }
+}
+
+template <typename T, typename STATS_T>
+std::size_t TwoLockSafeQueue<T, STATS_T>::PopBulkAndUnlock(
+    std::unique_lock<std::mutex> &a_lock,
+    T*                            out_data,
+    std::size_t                   a_maxCount)
+{
+    // the counter is only decremented by the consumers, who are holding 
+    // m_headMutex. What it says is there now will still be there
+    std::size_t count = m_count.load();
+    if (count > a_maxCount)
+    {
+        count = a_maxCount;
+    }
+    if (count == 0)
+    {
+        a_lock.unlock();
+        return 0;
+    }
+
+    Node* oldHead = m_head;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        // the first node with an element becomes the new dummy node
+        m_head = m_head->m_next;
+        out_data[i] = std::move(*(m_head->Elem()));
+        m_head->Elem()->~T();
+        m_stats.OnPop(m_head->GetStamp());
+    }
+
+    std::size_t oldCount = m_count.fetch_sub(count);
+
+    if ((oldCount > count) && (m_waitingConsumers > 0))
+    {
+        // something was left behind for the next consumer
+        m_notEmpty.notify_one();
+    }
+
+    a_lock.unlock();
+
+    // the nodes that were at the front aren't reachable anymore
+    DeleteNodes(oldHead, count, false);
+
+    if (oldCount == m_maximumSize)
+    {
+        // producers only wait on a full queue. The first one woken up wakes
+        // up the next one if there is still space after it is done
+        SignalNotFull();
+    }
+
+    return count;
+}
+
+template <typename T, typename STATS_T>
+void TwoLockSafeQueue<T, STATS_T>::WaitNotEmptyLocked(
+    std::unique_lock<std::mutex>                &a_lock,
+    const std::chrono::steady_clock::time_point *a_wakeUpTime)
+{
+    m_waitingConsumers++;
+    while ((m_count.load() == 0) && (!m_closed.load()))
+    {
+        if (a_wakeUpTime == 0)
+        {
+            m_notEmpty.wait(a_lock);
+        }
+        else if (m_notEmpty.wait_until(a_lock, *a_wakeUpTime) == 
+                     std::cv_status::timeout)
+        {
+            // spurious wake ups are handled by the loop. The caller checks
+            // whether there is something in the queue after a time out
+            break;
+        }
+    }
+    m_waitingConsumers--;
+}
+
+template <typename T, typename STATS_T>
+void TwoLockSafeQueue<T, STATS_T>::WaitNotFullLocked(std::unique_lock<std::mutex> &a_lock)
+{
+    m_waitingProducers++;
+    while ((FreeSpace() == 0) && (!m_closed.load()))
+    {
+        m_notFull.wait(a_lock);
+    }
+    m_waitingProducers--;
+}
+
+template <typename T, typename STATS_T>
+void TwoLockSafeQueue<T, STATS_T>::SignalNotEmpty()
+{
+    // the lock must be acquired even if m_waitingConsumers could be read 
+    // without it. A consumer could be in between checking the counter and 
+    // waiting on the condition variable
+    std::lock_guard<std::mutex> lk(m_headMutex);
+    if (m_waitingConsumers > 0)
+    {
+        m_notEmpty.notify_one();
+    }
+}
+
+template <typename T, typename STATS_T>
+void TwoLockSafeQueue<T, STATS_T>::SignalNotFull()
+{
+    std::lock_guard<std::mutex> lk(m_tailMutex);
+    if (m_waitingProducers > 0)
+    {
+        m_notFull.notify_one();
+    }
+}
+
+template <typename T, typename STATS_T>
+std::size_t TwoLockSafeQueue<T, STATS_T>::FreeSpace() const
+{
+    std::size_t count = m_count.load();
+    return (count < m_maximumSize) ? (m_maximumSize - count) : 0;
+}
+
+template <typename T, typename STATS_T>
+void TwoLockSafeQueue<T, STATS_T>::DeleteNodes(
+    Node* a_first, std::size_t a_count, bool a_destroyElems)
+{
+    for (std::size_t i = 0; i < a_count; i++)
+    {
+        Node* next = a_first->m_next;
+        if (a_destroyElems)
+        {
+            a_first->Elem()->~T();
+        }
+        delete a_first;
+        a_first = next;
+    }
+}
+
+#endif /* _TWOLOCKSAFEQUEUEIMPL_H_ */
@@ -28,6 +28,30 @@
 /// is called as expected.
 /// An object of this class is not thead-safe by itself. If used in a
 /// multi-thread system it will need to be protected from outside
+/// To drive thousands of timers with a single update see VTimerWheel 
+/// (vtimer_wheel.h), or VTimerSet below for timers that share the same 
+/// type of callback
+///
+/// The callback is a std::function by default. Any callable type can be 
+/// used instead so calling it doesn't involve an allocation or an indirect 
+/// call the compiler can't see through. For instance a Delegate 
+/// (delegate/Delegate.h) or a lambda (MakeVTimer deduces its type):
+///
+/// VTimer<uint32_t, Delegate<void(const uint32_t&)> > delegate_timer(
+///     MakeDelegate(&obj, &MyClass::Callback), 15);
+/// auto lambda_timer = MakeVTimer<uint32_t>(
+///     [&](const uint32_t &a_time) { /* ... */ }, 15);
+///
+/// Late updates can be handled following different scheduling policies
+/// (VTimerFixedDelay by default, VTimerFixedRate, VTimerCoalesce and 
+/// VTimerBurst). Update returns the time left until the next expiry:
+///
+/// VTimer<uint64_t, std::function<void(const uint64_t&)>, VTimerFixedRate>
+///     publisher(std::bind(&Publish, std::placeholders::_1), 100);
+/// while (running)
+/// {
+///     SleepFor(publisher.Update(Now()));
+/// }
 ///
 /// Your compiler must have support for c++11. Example of usage:
 ///
@@ -54,8 +78,159 @@
 
 #include <stdint.h>   // types (uint64_t...)
 #include <functional> // std::function
+#include <vector>
+#include <new>        // placement new
+#include <utility>    // std::move
+#include <limits>     // std::numeric_limits
 #include <assert.h>
 
+/// @brief Scheduling policies. They decide what happens to a timer once 
+///        the current time gets to its next expiry time, in particular when 
+///        the timer is updated late and one or more periods were missed 
+///        in between
+/// Each of them calls the callback with the current time and moves the next
+/// expiry time forward. Before calling the callback they set how many expiry
+/// times passed without a call of their own (see VTimer::MissedPeriods)
+
+/// @brief the next expiry time is the current time plus the period (the 
+///        original behaviour and the default). A late update shifts the
+///        rest of the schedule forward by the time it was late
+struct VTimerFixedDelay
+{
+    template <typename TIME_TYPE, typename CALLBACK_T>
+    static inline void Expire(
+        CALLBACK_T      &a_callback, 
+        TIME_TYPE       &a_nextExpiryTime,
+        const TIME_TYPE &a_period,
+        const TIME_TYPE &a_currentTime,
+        uint64_t        &out_missedPeriods)
+    {
+        a_nextExpiryTime = a_currentTime + a_period;
+        out_missedPeriods = 0;
+        a_callback(a_currentTime);
+    }
+};
+
+/// @brief the next expiry time is the previous one plus the period, so late
+///        updates don't make the timer drift. The callback is called once 
+///        per update. After a long delay the timer stays expired, and it 
+///        is called again by the following updates until it catches up
+///        (Update returns 0 meanwhile)
+struct VTimerFixedRate
+{
+    template <typename TIME_TYPE, typename CALLBACK_T>
+    static inline void Expire(
+        CALLBACK_T      &a_callback, 
+        TIME_TYPE       &a_nextExpiryTime,
+        const TIME_TYPE &a_period,
+        const TIME_TYPE &a_currentTime,
+        uint64_t        &out_missedPeriods)
+    {
+        a_nextExpiryTime = a_nextExpiryTime + a_period;
+        out_missedPeriods = 0;
+        a_callback(a_currentTime);
+    }
+};
+
+/// @brief the callback is called once however many periods were missed and
+///        the next expiry time is the first one of the original schedule
+///        still in the future. It returns how many periods were skipped
+/// TIME_TYPE must also support operator-, operator/ and operator*
+struct VTimerCoalesce
+{
+    template <typename TIME_TYPE, typename CALLBACK_T>
+    static inline void Expire(
+        CALLBACK_T      &a_callback, 
+        TIME_TYPE       &a_nextExpiryTime,
+        const TIME_TYPE &a_period,
+        const TIME_TYPE &a_currentTime,
+        uint64_t        &out_missedPeriods)
+    {
+        if (a_period == TIME_TYPE(0))
+        {
+            // there is no schedule to go back to
+            a_nextExpiryTime = a_currentTime;
+            out_missedPeriods = 0;
+        }
+        else
+        {
+            TIME_TYPE skipped = (a_currentTime - a_nextExpiryTime) / a_period;
+            a_nextExpiryTime = a_nextExpiryTime + a_period + (skipped * a_period);
+            out_missedPeriods = static_cast<uint64_t>(skipped);
+        }
+
+        a_callback(a_currentTime);
+    }
+};
+
+/// @brief the callback is called once per missed period in the same 
+///        update, so the number of calls is the same as if the timer had 
+///        never been late. The next expiry time is the previous one plus 
+///        the period, like VTimerFixedRate
+struct VTimerBurst
+{
+    template <typename TIME_TYPE, typename CALLBACK_T>
+    static inline void Expire(
+        CALLBACK_T      &a_callback, 
+        TIME_TYPE       &a_nextExpiryTime,
+        const TIME_TYPE &a_period,
+        const TIME_TYPE &a_currentTime,
+        uint64_t        &out_missedPeriods)
+    {
+        out_missedPeriods = 0;
+        do
+        {
+            a_nextExpiryTime = a_nextExpiryTime + a_period;
+            a_callback(a_currentTime);
+        } while ((a_currentTime >= a_nextExpiryTime) && !(a_period == TIME_TYPE(0)));
+    }
+};
+
+/// @brief what happens to a timer once the current time gets to its next
+///        expiry time (or the timer is updated for the first time: its next
+///        expiry time is still 0). Shared by VTimer and VTimerSet
+/// out_missedPeriods is set to the expiry times missed according to POLICY_T
+template <typename POLICY_T, typename TIME_TYPE, typename CALLBACK_T>
+inline void VTimerUpdate(
+    CALLBACK_T      &a_callback, 
+    TIME_TYPE       &a_nextExpiryTime,
+    const TIME_TYPE &a_period,
+    const TIME_TYPE &a_currentTime,
+    uint64_t        &out_missedPeriods)
+{
+    if (a_nextExpiryTime == 0)
+    {
+        if ((a_currentTime + a_period) == 0)
+        {
+            // corner case. Period is "0" and Update is initialised with
+            // time 0. m_nextExpiryTime is initalised to 1
+            a_nextExpiryTime = 1;
+        }
+        else
+        {
+            a_nextExpiryTime = a_currentTime + a_period;
+        }
+        out_missedPeriods = 0;
+        return;
+    }
+
+    POLICY_T::Expire(
+        a_callback, a_nextExpiryTime, a_period, a_currentTime, out_missedPeriods);
+}
+
+/// @brief time left until a_nextExpiryTime. 0 if the timer is expired
+template <typename TIME_TYPE>
+inline TIME_TYPE VTimerTimeToExpiry(
+    const TIME_TYPE &a_nextExpiryTime,
+    const TIME_TYPE &a_currentTime)
+{
+    if (a_currentTime >= a_nextExpiryTime)
+    {
+        return TIME_TYPE(0);
+    }
+    return a_nextExpiryTime - a_currentTime;
+}
+
 /// @brief a Virtual Timer
 /// Calls a callback function when a timeout expires. It does not
 /// have a real timer by itself, an object of this class needs to be updated 
@@ -66,19 +241,28 @@
 /// instantiation. Bear in mind TIME_TYPE must have at least support
 /// for copy constructor, operator=, operator>=, operator== and operator+ 
 /// and it should also be able to be initialised with a 0: "TIME_TYPE obj(0)"
-template <typename TIME_TYPE>
+/// operator- is needed too so Update can return the time left to the next
+/// expiry
+/// CALLBACK_T type of the callback. Anything that can be called with a 
+/// "const TIME_TYPE&" and be move constructed. std::function by default
+/// POLICY_T what to do when updates are late: VTimerFixedDelay (default),
+/// VTimerFixedRate, VTimerCoalesce or VTimerBurst
+template <typename TIME_TYPE, 
+          typename CALLBACK_T = std::function<void(const TIME_TYPE&)>,
+          typename POLICY_T = VTimerFixedDelay>
 class VTimer
 {
 public:
-    typedef std::function<void(const TIME_TYPE&)> VTimerCallback_t;
+    typedef CALLBACK_T VTimerCallback_t;
 
     /// @brief constructor of a virtual timer
     /// @param a_callback Callback function that will get called on expiration
     /// @param period of time between calls. It must be greater or equal to 0
     VTimer(VTimerCallback_t a_callback, TIME_TYPE a_period):
-        m_callback(a_callback),
+        m_callback(std::move(a_callback)),
         m_nextExpiryTime(0),
-        m_period(a_period)
+        m_period(a_period),
+        m_missedPeriods(0)
     {
         assert(a_period >= 0);
     }
@@ -99,33 +283,32 @@ public:
     ///     initialised (but the callback is not called)
     ///   - When "a_currentTime" is set to 0 the callback won't ever get called
     ///   - If "a_currentTime" goes backwards in time
+    /// How late updates are handled depends on POLICY_T
     /// @param a_currentTime
-    inline void Update(TIME_TYPE a_currentTime)
+    /// @return time left until the next expiry, so whoever drives the timer
+    ///         can sleep that much instead of polling. 0 if the timer is 
+    ///         still expired (a VTimerFixedRate timer catching up, or a 
+    ///         timer of period 0)
+    inline TIME_TYPE Update(TIME_TYPE a_currentTime)
     {
         assert(a_currentTime >= 0);
 
-        if (m_nextExpiryTime == 0)
+        if (a_currentTime >= m_nextExpiryTime)
         {
-            if ((a_currentTime + m_period) == 0)
-            {
-                // corner case. Period is "0" and Update is initialised with
-                // time 0. m_nextExpiryTime is initalised to 1
-                m_nextExpiryTime = 1;
-            }
-            else
-            {
-                m_nextExpiryTime = a_currentTime + m_period;
-            }
-        }
-        else if (a_currentTime >= m_nextExpiryTime)
-        {
-            m_nextExpiryTime = a_currentTime + m_period;
-            m_callback(a_currentTime);
+            VTimerUpdate<POLICY_T>(
+                m_callback, m_nextExpiryTime, m_period, a_currentTime, m_missedPeriods);
         }
+
+        return VTimerTimeToExpiry(m_nextExpiryTime, a_currentTime);
     }
 
+    /// @return number of expiry times skipped by the last call of the 
+    ///         callback (only VTimerCoalesce skips them). It can be checked 
+    ///         from inside the callback
+    inline uint64_t MissedPeriods() const { return m_missedPeriods; }
+
 private:
-    /// a pointer to the callback function
+    /// the callback function
     VTimerCallback_t m_callback;
     
     /// timestamp of the next time the callback function will get called
@@ -133,6 +316,165 @@ private:
     
     /// the timeout period
     TIME_TYPE m_period;
+
+    /// expiry times skipped by the last call of the callback
+    uint64_t m_missedPeriods;
+};
+
+/// @brief builds a VTimer deducing the type of the callback. Mostly useful 
+///        for lambdas, whose type can't be written down
+/// @return the new timer
+template <typename TIME_TYPE, typename CALLBACK_T>
+inline VTimer<TIME_TYPE, CALLBACK_T> MakeVTimer(CALLBACK_T a_callback, TIME_TYPE a_period)
+{
+    return VTimer<TIME_TYPE, CALLBACK_T>(std::move(a_callback), a_period);
+}
+
+/// @brief same as above with a scheduling policy other than the default
+///        MakeVTimer<uint32_t, VTimerFixedRate>(callback, period)
+template <typename TIME_TYPE, typename POLICY_T, typename CALLBACK_T>
+inline VTimer<TIME_TYPE, CALLBACK_T, POLICY_T> MakeVTimer(CALLBACK_T a_callback, TIME_TYPE a_period)
+{
+    return VTimer<TIME_TYPE, CALLBACK_T, POLICY_T>(std::move(a_callback), a_period);
+}
+
+/// @brief a set of virtual timers with the same type of callback
+/// They behave exactly as VTimer objects, but they are all updated with a 
+/// single call. The expiry times are kept in a contiguous array apart from
+/// the callbacks, so an update is one comparison per timer in a tight loop
+/// that only leaves it for the timers that expire
+/// Callbacks must not add or remove timers from the set being updated
+/// Every timer of the set follows the same scheduling policy POLICY_T
+template <typename TIME_TYPE, 
+          typename CALLBACK_T = std::function<void(const TIME_TYPE&)>,
+          typename POLICY_T = VTimerFixedDelay>
+class VTimerSet
+{
+public:
+    typedef CALLBACK_T VTimerCallback_t;
+
+    VTimerSet():
+        m_nextExpiryTimes(),
+        m_periods(),
+        m_callbacks(),
+        m_missedPeriods(),
+        m_updating(false)
+    {}
+
+    /// @brief destructor
+    virtual ~VTimerSet()
+    {}
+
+    /// @brief adds a timer to the set. Like a new VTimer, it is initialised 
+    ///        the first time the set is updated after this call
+    /// @param a_callback Callback function that will get called on expiration
+    /// @param period of time between calls. It must be greater or equal to 0
+    /// @return the index of the new timer
+    std::size_t Add(VTimerCallback_t a_callback, TIME_TYPE a_period)
+    {
+        assert(a_period >= 0);
+        assert(!m_updating);
+
+        m_nextExpiryTimes.push_back(TIME_TYPE(0));
+        m_periods.push_back(a_period);
+        m_callbacks.push_back(std::move(a_callback));
+        m_missedPeriods.push_back(0);
+
+        return m_callbacks.size() - 1;
+    }
+
+    /// @brief removes the timer a_index. The last timer of the set takes 
+    ///        its index
+    void Remove(std::size_t a_index)
+    {
+        assert(a_index < m_callbacks.size());
+        assert(!m_updating);
+
+        std::size_t last = m_callbacks.size() - 1;
+        if (a_index != last)
+        {
+            m_nextExpiryTimes[a_index] = m_nextExpiryTimes[last];
+            m_periods[a_index] = m_periods[last];
+            m_missedPeriods[a_index] = m_missedPeriods[last];
+            // callables such as lambdas can't be assigned, only constructed
+            m_callbacks[a_index].~CALLBACK_T();
+            new (&m_callbacks[a_index]) CALLBACK_T(std::move(m_callbacks[last]));
+        }
+
+        m_nextExpiryTimes.pop_back();
+        m_periods.pop_back();
+        m_callbacks.pop_back();
+        m_missedPeriods.pop_back();
+    }
+
+    /// @return number of timers in the set
+    inline std::size_t Size() const { return m_callbacks.size(); }
+
+    /// @brief makes space for a_count timers
+    void Reserve(std::size_t a_count)
+    {
+        m_nextExpiryTimes.reserve(a_count);
+        m_periods.reserve(a_count);
+        m_callbacks.reserve(a_count);
+        m_missedPeriods.reserve(a_count);
+    }
+
+    /// @return see VTimer::MissedPeriods
+    inline uint64_t MissedPeriods(std::size_t a_index) const
+    {
+        assert(a_index < m_missedPeriods.size());
+        return m_missedPeriods[a_index];
+    }
+
+    /// @brief update the current time of every timer in the set
+    /// See VTimer::Update. The callbacks are called in index order
+    /// @param a_currentTime
+    /// @return time left until the earliest next expiry of the set. 
+    ///         std::numeric_limits<TIME_TYPE>::max() if the set is empty
+    inline TIME_TYPE Update(TIME_TYPE a_currentTime)
+    {
+        assert(a_currentTime >= 0);
+        assert(!m_updating);
+
+        m_updating = true;
+
+        TIME_TYPE   earliest = std::numeric_limits<TIME_TYPE>::max();
+        TIME_TYPE*  nextExpiryTimes = m_nextExpiryTimes.data();
+        std::size_t count = m_nextExpiryTimes.size();
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (a_currentTime >= nextExpiryTimes[i])
+            {
+                VTimerUpdate<POLICY_T>(
+                    m_callbacks[i], nextExpiryTimes[i], m_periods[i], 
+                    a_currentTime, m_missedPeriods[i]);
+            }
+            if (earliest >= nextExpiryTimes[i])
+            {
+                earliest = nextExpiryTimes[i];
+            }
+        }
+
+        m_updating = false;
+
+        if (count == 0)
+        {
+            return earliest;
+        }
+        return VTimerTimeToExpiry(earliest, a_currentTime);
+    }
+
+private:
+    /// timestamp of the next time each callback will get called
+    std::vector<TIME_TYPE> m_nextExpiryTimes;
+    /// the timeout period of each timer
+    std::vector<TIME_TYPE> m_periods;
+    /// the callback of each timer
+    std::vector<CALLBACK_T> m_callbacks;
+    /// expiry times skipped by the last call of each callback
+    std::vector<uint64_t> m_missedPeriods;
+    /// set while Update is running
+    bool m_updating;
 };
 
 #endif /* _VTIMER_H_ */
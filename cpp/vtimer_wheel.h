@@ -0,0 +1,246 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file  vtimer_wheel.h
+/// @brief Hierarchical timing wheel to drive a large number of virtual timers
+///
+/// VTimer has to be updated one by one with the current time. VTimerWheel 
+/// keeps many timers (one-shot or periodic) and it's updated only once: 
+/// scheduling and cancelling a timer is O(1), and an update costs in 
+/// proportion to the timers that expire (plus one step per non empty slot 
+/// the time goes past), not to the number of timers.
+///
+/// Timers are kept in LEVELS wheels of SLOTS slots each. A slot of the first 
+/// wheel holds the timers that expire in one particular tick, a slot of the
+/// second one the timers that expire in a particular group of SLOTS ticks 
+/// and so on. When the time gets to a slot of an upper wheel its timers are
+/// spread into the wheel below. Timers further away than what the wheels 
+/// cover wait in an overflow list. A bitmap per wheel lets updates skip the
+/// slots with nothing in them
+///
+/// Like VTimer it doesn't maintain the current time by itself. The callback
+/// of a timer is called from the thread that calls Update, with the time 
+/// passed into Update. It is not thread-safe. Callbacks can schedule and 
+/// cancel timers (themselves included)
+///
+/// Example of usage:
+///
+/// VTimerWheel<uint32_t> wheel(0);
+/// VTimerWheel<uint32_t>::Handle_t timeout = wheel.ScheduleOnce(
+///     std::bind(&Session::OnTimeout, &session, std::placeholders::_1), 30);
+/// wheel.SchedulePeriodic(&GlobalCallback, 15);
+/// /* ... */
+/// wheel.Update(now);
+/// wheel.Cancel(timeout);
+///
+// ============================================================================
+
+#ifndef _VTIMERWHEEL_H_
+#define _VTIMERWHEEL_H_
+
+#include <stdint.h>   // types (uint64_t...)
+#include <functional> // std::function
+#include <vector>
+#include <assert.h>
+
+/// @brief a hierarchical timing wheel of virtual timers
+/// TIME_TYPE has the same requirements as in VTimer, and it must also 
+/// support operator/, operator* and operator<, and be convertible into a 
+/// uint64_t (an integral type). Time is counted in ticks of a_resolution 
+/// units of TIME_TYPE
+template <typename TIME_TYPE>
+class VTimerWheel
+{
+public:
+    /// same signature as VTimer callbacks. The time passed into Update is
+    /// passed into the callback
+    typedef std::function<void(const TIME_TYPE&)> VTimerCallback_t;
+
+    /// identifies a timer of the wheel. 0 is never a valid handle. A handle
+    /// is not valid anymore once its timer is cancelled (or it fired if it
+    /// was a one-shot one), even if the wheel reuses its memory
+    typedef uint64_t Handle_t;
+
+    /// number of wheels and slots per wheel. They cover 2^32 ticks
+    static const uint32_t LEVELS     = 4;
+    static const uint32_t SLOT_BITS  = 8;
+    static const uint32_t SLOTS      = (1 << SLOT_BITS);
+
+    /// @brief constructor
+    /// @param a_currentTime time the wheel starts at
+    /// @param a_resolution duration of a tick. Timers expire at the first
+    ///        update on or after the first tick boundary at or after their 
+    ///        expiry time. It must be greater than 0
+    explicit VTimerWheel(TIME_TYPE a_currentTime = 0, TIME_TYPE a_resolution = 1);
+
+    /// @brief destructor. Pending timers are discarded
+    virtual ~VTimerWheel();
+
+    /// @brief schedules a timer that expires only once
+    /// @param a_callback function to call when the timer expires
+    /// @param a_delay the timer expires at the current time (the one of the 
+    ///        last update) plus a_delay. Timers never expire during the 
+    ///        update they were scheduled from: a timer with no delay 
+    ///        scheduled from a callback expires at the next tick
+    /// @return the handle of the new timer
+    Handle_t ScheduleOnce(VTimerCallback_t a_callback, TIME_TYPE a_delay);
+
+    /// @brief schedules a timer that expires every a_period
+    /// Like in VTimer, the next expiry time is calculated from the time 
+    /// passed into the update the timer expired in. Periods shorter than a
+    /// tick expire once per tick
+    /// @return the handle of the new timer
+    Handle_t SchedulePeriodic(VTimerCallback_t a_callback, TIME_TYPE a_period);
+
+    /// @brief cancels a timer. The callback won't be called again
+    /// It can be called from any callback (the one of the timer included)
+    /// @return true if the timer was scheduled. False if the handle is not
+    ///         valid anymore
+    bool Cancel(Handle_t a_handle);
+
+    /// @return true if a_handle belongs to a pending timer
+    bool IsScheduled(Handle_t a_handle) const;
+
+    /// @brief number of pending timers
+    inline std::size_t Size() const { return m_size; }
+
+    /// @brief update the current time. Every timer that expired since the 
+    ///        last update is called, in expiry order (the order of the timers
+    ///        that expire in the same tick is not specified)
+    /// Nothing happens if a_currentTime goes backwards in time
+    /// @return the number of callbacks called
+    std::size_t Update(TIME_TYPE a_currentTime);
+
+private:
+    /// index of no node
+    static const uint32_t NIL = 0xFFFFFFFF;
+    /// slot index of the overflow list
+    static const uint32_t OVERFLOW_SLOT = LEVELS * SLOTS;
+
+    enum NodeState
+    {
+        NODE_FREE,
+        NODE_SCHEDULED,
+        /// its callback is being called. It's not in any slot
+        NODE_FIRING
+    };
+
+    /// @brief a timer
+    struct Node
+    {
+        Node():
+            m_callback(),
+            m_expiry(0),
+            m_period(0),
+            m_prev(NIL),
+            m_next(NIL),
+            m_slot(NIL),
+            m_generation(1),
+            m_state(NODE_FREE),
+            m_periodic(false)
+        {}
+
+        VTimerCallback_t m_callback;
+        /// tick the timer expires at
+        uint64_t  m_expiry;
+        TIME_TYPE m_period;
+        /// links in the list of the slot (or in the list of free nodes)
+        uint32_t  m_prev;
+        uint32_t  m_next;
+        /// slot the timer is in
+        uint32_t  m_slot;
+        /// incremented every time the node is freed. It invalidates handles
+        uint32_t  m_generation;
+        NodeState m_state;
+        bool      m_periodic;
+    };
+
+    /// @brief first and last timers in a slot
+    struct Slot
+    {
+        Slot(): m_head(NIL), m_tail(NIL) {}
+
+        uint32_t m_head;
+        uint32_t m_tail;
+    };
+
+    /// every timer ever allocated. Nodes are reused once they are freed
+    std::vector<Node> m_nodes;
+    /// first free node
+    uint32_t m_freeHead;
+    /// the wheels (level by level) plus the overflow list
+    Slot m_slots[LEVELS * SLOTS + 1];
+    /// a bit per slot, set if there is something in it
+    uint64_t m_bitmap[LEVELS][SLOTS / 64];
+    /// last tick processed
+    uint64_t m_currentTick;
+    /// time passed into the last update
+    TIME_TYPE m_currentTime;
+    /// duration of a tick
+    TIME_TYPE m_resolution;
+    /// number of pending timers
+    std::size_t m_size;
+
+    Handle_t Schedule(VTimerCallback_t &a_callback, TIME_TYPE a_delay, bool a_periodic);
+
+    /// @brief index of the node of a valid handle. NIL otherwise
+    inline uint32_t NodeOf(Handle_t a_handle) const;
+
+    /// @brief first tick at or after a_time (and after the tick of the 
+    ///        current time)
+    inline uint64_t ExpiryTick(const TIME_TYPE &a_time) const;
+
+    /// @brief puts a node in the slot its expiry tick belongs to, relative
+    ///        to the current tick
+    inline void Insert(uint32_t a_node);
+
+    /// @brief takes a node out of its slot
+    inline void Unlink(uint32_t a_node);
+
+    /// @brief gets a free node (allocating a new one if there is none)
+    inline uint32_t AllocNode();
+    inline void FreeNode(uint32_t a_node);
+
+    /// @brief first tick after the current one when something has to be 
+    ///        done (a slot expires or has to be spread into a lower wheel)
+    /// @return that tick. UINT64_MAX if there is no timer
+    inline uint64_t NextEventTick() const;
+
+    /// @brief moves the wheel to a_tick, spreading and firing timers
+    /// @return the number of callbacks called
+    inline std::size_t ProcessTick(uint64_t a_tick, const TIME_TYPE &a_currentTime);
+
+    /// @brief re-inserts every timer of a slot relative to the current tick
+    inline void Cascade(uint32_t a_slot);
+
+    /// @brief first slot with something in it at a level from a_from on
+    /// @return the slot. SLOTS if there is none
+    inline uint32_t NextSlot(uint32_t a_level, uint32_t a_from) const;
+
+    /// @brief the wheel can't be copied
+    VTimerWheel(const VTimerWheel &a_src);
+    VTimerWheel& operator=(const VTimerWheel &a_src);
+};
+
+// include the implementation file
+#include "vtimer_wheel_impl.h"
+
+#endif /* _VTIMERWHEEL_H_ */
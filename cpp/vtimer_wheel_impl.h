@@ -0,0 +1,433 @@
+// ============================================================================
+// Copyright (c) 2026 misc-playground contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// @file  vtimer_wheel_impl.h
+/// @brief Implementation of the hierarchical timing wheel of virtual timers
+///
+// ============================================================================
+
+#ifndef _VTIMERWHEELIMPL_H_
+#define _VTIMERWHEELIMPL_H_
+
+#include <string.h> // memset
+#include <utility>  // std::move
+
+template <typename TIME_TYPE>
+VTimerWheel<TIME_TYPE>::VTimerWheel(TIME_TYPE a_currentTime, TIME_TYPE a_resolution):
+    m_nodes(),
+    m_freeHead(NIL),
+    m_currentTick(0),
+    m_currentTime(a_currentTime),
+    m_resolution(a_resolution),
+    m_size(0)
+{
+    assert(a_currentTime >= 0);
+    assert(!(a_resolution < 1));
+
+    memset(m_bitmap, 0, sizeof(m_bitmap));
+    m_currentTick = static_cast<uint64_t>(a_currentTime / a_resolution);
+}
+
+template <typename TIME_TYPE>
+VTimerWheel<TIME_TYPE>::~VTimerWheel()
+{
+}
+
+template <typename TIME_TYPE>
+typename VTimerWheel<TIME_TYPE>::Handle_t VTimerWheel<TIME_TYPE>::ScheduleOnce(
+    VTimerCallback_t a_callback, TIME_TYPE a_delay)
+{
+    return Schedule(a_callback, a_delay, false);
+}
+
+template <typename TIME_TYPE>
+typename VTimerWheel<TIME_TYPE>::Handle_t VTimerWheel<TIME_TYPE>::SchedulePeriodic(
+    VTimerCallback_t a_callback, TIME_TYPE a_period)
+{
+    return Schedule(a_callback, a_period, true);
+}
+
+template <typename TIME_TYPE>
+bool VTimerWheel<TIME_TYPE>::Cancel(Handle_t a_handle)
+{
+    uint32_t index = NodeOf(a_handle);
+    if (index == NIL)
+    {
+        return false;
+    }
+
+    if (m_nodes[index].m_state == NODE_SCHEDULED)
+    {
+        Unlink(index);
+    }
+    // a firing node is in no slot. Whoever is calling its callback finds out
+    // the node was freed when the callback returns
+    FreeNode(index);
+
+    return true;
+}
+
+template <typename TIME_TYPE>
+bool VTimerWheel<TIME_TYPE>::IsScheduled(Handle_t a_handle) const
+{
+    uint32_t index = NodeOf(a_handle);
+    return (index != NIL) && 
+           ((m_nodes[index].m_state == NODE_SCHEDULED) || m_nodes[index].m_periodic);
+}
+
+template <typename TIME_TYPE>
+std::size_t VTimerWheel<TIME_TYPE>::Update(TIME_TYPE a_currentTime)
+{
+    assert(a_currentTime >= 0);
+
+    if (a_currentTime < m_currentTime)
+    {
+        // time went backwards
+        return 0;
+    }
+
+    m_currentTime = a_currentTime;
+    uint64_t targetTick = static_cast<uint64_t>(a_currentTime / m_resolution);
+
+    std::size_t fired = 0;
+    while (m_currentTick < targetTick)
+    {
+        // jump straight to the next tick with something to do. Callbacks 
+        // might schedule new timers, so it's worked out every time
+        uint64_t tick = NextEventTick();
+        if (tick > targetTick)
+        {
+            m_currentTick = targetTick;
+        }
+        else
+        {
+            fired += ProcessTick(tick, a_currentTime);
+        }
+    }
+
+    return fired;
+}
+
+template <typename TIME_TYPE>
+typename VTimerWheel<TIME_TYPE>::Handle_t VTimerWheel<TIME_TYPE>::Schedule(
+    VTimerCallback_t &a_callback, TIME_TYPE a_delay, bool a_periodic)
+{
+    assert(a_delay >= 0);
+
+    uint32_t index = AllocNode();
+    Node &node = m_nodes[index];
+
+    node.m_callback = std::move(a_callback);
+    node.m_expiry   = ExpiryTick(m_currentTime + a_delay);
+    node.m_period   = a_delay;
+    node.m_periodic = a_periodic;
+    node.m_state    = NODE_SCHEDULED;
+    Insert(index);
+    m_size++;
+
+    return (static_cast<Handle_t>(node.m_generation) << 32) | index;
+}
+
+template <typename TIME_TYPE>
+uint32_t VTimerWheel<TIME_TYPE>::NodeOf(Handle_t a_handle) const
+{
+    uint32_t index = static_cast<uint32_t>(a_handle & 0xFFFFFFFF);
+    uint32_t generation = static_cast<uint32_t>(a_handle >> 32);
+
+    if ((index >= m_nodes.size()) || 
+        (m_nodes[index].m_state == NODE_FREE) ||
+        (m_nodes[index].m_generation != generation))
+    {
+        return NIL;
+    }
+
+    return index;
+}
+
+template <typename TIME_TYPE>
+uint64_t VTimerWheel<TIME_TYPE>::ExpiryTick(const TIME_TYPE &a_time) const
+{
+    TIME_TYPE ticks = a_time / m_resolution;
+    if ((ticks * m_resolution) < a_time)
+    {
+        // round up. It never expires before its time
+        ticks = ticks + 1;
+    }
+
+    // the current time is the one of the update being processed (if any).
+    // Nothing expires twice (or gets scheduled and expires) in one update
+    uint64_t tick = static_cast<uint64_t>(ticks);
+    uint64_t minTick = static_cast<uint64_t>(m_currentTime / m_resolution) + 1;
+    return (tick >= minTick) ? tick : minTick;
+}
+
+template <typename TIME_TYPE>
+void VTimerWheel<TIME_TYPE>::Insert(uint32_t a_node)
+{
+    Node &node = m_nodes[a_node];
+    assert(node.m_expiry >= m_currentTick);
+
+    // the level is the one of the most significant digit (SLOT_BITS bits 
+    // each) that differs between the expiry tick and the current tick. The 
+    // slot is the value of that digit in the expiry tick
+    uint64_t diff = node.m_expiry ^ m_currentTick;
+    uint32_t slot;
+    if ((diff >> (LEVELS * SLOT_BITS)) != 0)
+    {
+        slot = OVERFLOW_SLOT;
+    }
+    else
+    {
+        uint32_t level = 0;
+        if (diff != 0)
+        {
+            level = (63 - static_cast<uint32_t>(__builtin_clzll(diff))) / SLOT_BITS;
+        }
+        uint32_t digit = static_cast<uint32_t>(node.m_expiry >> (level * SLOT_BITS)) & (SLOTS - 1);
+
+        slot = (level * SLOTS) + digit;
+        m_bitmap[level][digit / 64] |= (static_cast<uint64_t>(1) << (digit % 64));
+    }
+
+    // appended at the back. Timers expire in scheduling order
+    node.m_slot = slot;
+    node.m_next = NIL;
+    node.m_prev = m_slots[slot].m_tail;
+    if (m_slots[slot].m_tail == NIL)
+    {
+        m_slots[slot].m_head = a_node;
+    }
+    else
+    {
+        m_nodes[m_slots[slot].m_tail].m_next = a_node;
+    }
+    m_slots[slot].m_tail = a_node;
+}
+
+template <typename TIME_TYPE>
+void VTimerWheel<TIME_TYPE>::Unlink(uint32_t a_node)
+{
+    Node &node = m_nodes[a_node];
+    Slot &slot = m_slots[node.m_slot];
+
+    if (node.m_prev == NIL)
+    {
+        slot.m_head = node.m_next;
+    }
+    else
+    {
+        m_nodes[node.m_prev].m_next = node.m_next;
+    }
+
+    if (node.m_next == NIL)
+    {
+        slot.m_tail = node.m_prev;
+    }
+    else
+    {
+        m_nodes[node.m_next].m_prev = node.m_prev;
+    }
+
+    if ((slot.m_head == NIL) && (node.m_slot != OVERFLOW_SLOT))
+    {
+        uint32_t level = node.m_slot / SLOTS;
+        uint32_t digit = node.m_slot % SLOTS;
+        m_bitmap[level][digit / 64] &= ~(static_cast<uint64_t>(1) << (digit % 64));
+    }
+
+    node.m_prev = NIL;
+    node.m_next = NIL;
+    node.m_slot = NIL;
+}
+
+template <typename TIME_TYPE>
+uint32_t VTimerWheel<TIME_TYPE>::AllocNode()
+{
+    if (m_freeHead == NIL)
+    {
+        assert(m_nodes.size() < NIL);
+        m_nodes.push_back(Node());
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    uint32_t index = m_freeHead;
+    m_freeHead = m_nodes[index].m_next;
+    m_nodes[index].m_next = NIL;
+
+    return index;
+}
+
+template <typename TIME_TYPE>
+void VTimerWheel<TIME_TYPE>::FreeNode(uint32_t a_node)
+{
+    Node &node = m_nodes[a_node];
+
+    node.m_callback = VTimerCallback_t();
+    node.m_state = NODE_FREE;
+    node.m_periodic = false;
+    node.m_generation++;
+    if (node.m_generation == 0)
+    {
+        // 0 would make handle 0 valid
+        node.m_generation = 1;
+    }
+
+    node.m_next = m_freeHead;
+    m_freeHead = a_node;
+    m_size--;
+}
+
+template <typename TIME_TYPE>
+uint64_t VTimerWheel<TIME_TYPE>::NextEventTick() const
+{
+    uint64_t next = UINT64_MAX;
+
+    // a timer at a level always sits in a slot after the current digit of
+    // that level. The first one is where the next thing happens at that level
+    for (uint32_t level = 0; level < LEVELS; level++)
+    {
+        uint32_t shift = level * SLOT_BITS;
+        uint32_t digit = static_cast<uint32_t>(m_currentTick >> shift) & (SLOTS - 1);
+        uint32_t slot = NextSlot(level, digit + 1);
+        if (slot < SLOTS)
+        {
+            uint64_t tick = 
+                ((m_currentTick >> (shift + SLOT_BITS)) << (shift + SLOT_BITS)) |
+                (static_cast<uint64_t>(slot) << shift);
+            next = (tick < next) ? tick : next;
+        }
+    }
+
+    if (m_slots[OVERFLOW_SLOT].m_head != NIL)
+    {
+        // the overflow list is looked at once the whole wheel turns around
+        uint32_t shift = LEVELS * SLOT_BITS;
+        uint64_t tick = ((m_currentTick >> shift) + 1) << shift;
+        next = (tick < next) ? tick : next;
+    }
+
+    return next;
+}
+
+template <typename TIME_TYPE>
+std::size_t VTimerWheel<TIME_TYPE>::ProcessTick(uint64_t a_tick, const TIME_TYPE &a_currentTime)
+{
+    m_currentTick = a_tick;
+
+    // spread the timers from the top down. A timer can go down several
+    // levels in one go
+    if ((a_tick & ((static_cast<uint64_t>(1) << (LEVELS * SLOT_BITS)) - 1)) == 0)
+    {
+        Cascade(OVERFLOW_SLOT);
+    }
+    for (uint32_t level = LEVELS - 1; level > 0; level--)
+    {
+        uint32_t shift = level * SLOT_BITS;
+        if ((a_tick & ((static_cast<uint64_t>(1) << shift) - 1)) == 0)
+        {
+            uint32_t digit = static_cast<uint32_t>(a_tick >> shift) & (SLOTS - 1);
+            Cascade((level * SLOTS) + digit);
+        }
+    }
+
+    // timers scheduled from the callbacks expire after this tick, so they 
+    // never end up in this slot
+    std::size_t fired = 0;
+    uint32_t slot = static_cast<uint32_t>(a_tick) & (SLOTS - 1);
+    while (m_slots[slot].m_head != NIL)
+    {
+        uint32_t index = m_slots[slot].m_head;
+        Unlink(index);
+
+        Node &node = m_nodes[index];
+        uint32_t generation = node.m_generation;
+        node.m_state = NODE_FIRING;
+
+        // the callback is moved out of the node. It might schedule new 
+        // timers (m_nodes can be reallocated) or cancel this one
+        VTimerCallback_t callback(std::move(node.m_callback));
+        callback(a_currentTime);
+        fired++;
+
+        Node &firedNode = m_nodes[index];
+        if ((firedNode.m_generation != generation) || 
+            (firedNode.m_state != NODE_FIRING))
+        {
+            // cancelled from a callback
+            continue;
+        }
+
+        if (firedNode.m_periodic)
+        {
+            firedNode.m_callback = std::move(callback);
+            firedNode.m_expiry = ExpiryTick(a_currentTime + firedNode.m_period);
+            firedNode.m_state = NODE_SCHEDULED;
+            Insert(index);
+        }
+        else
+        {
+            FreeNode(index);
+        }
+    }
+
+    return fired;
+}
+
+template <typename TIME_TYPE>
+void VTimerWheel<TIME_TYPE>::Cascade(uint32_t a_slot)
+{
+    // the timers already re-inserted in the same slot (overflow timers still
+    // too far away) are not visited again
+    uint32_t last = m_slots[a_slot].m_tail;
+    while (m_slots[a_slot].m_head != NIL)
+    {
+        uint32_t index = m_slots[a_slot].m_head;
+        Unlink(index);
+        Insert(index);
+
+        if (index == last)
+        {
+            break;
+        }
+    }
+}
+
+template <typename TIME_TYPE>
+uint32_t VTimerWheel<TIME_TYPE>::NextSlot(uint32_t a_level, uint32_t a_from) const
+{
+    for (uint32_t word = a_from / 64; word < (SLOTS / 64); word++)
+    {
+        uint64_t bits = m_bitmap[a_level][word];
+        if (word == (a_from / 64))
+        {
+            // ignore the slots before a_from
+            bits &= (~static_cast<uint64_t>(0)) << (a_from % 64);
+        }
+        if (bits != 0)
+        {
+            return (word * 64) + static_cast<uint32_t>(__builtin_ctzll(bits));
+        }
+    }
+
+    return SLOTS;
+}
+
+#endif /* _VTIMERWHEELIMPL_H_ */